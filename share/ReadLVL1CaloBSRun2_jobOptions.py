@@ -58,6 +58,21 @@ ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::TriggerTowerAuxContainer/xAOD
 ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::TriggerTowerContainer/xAODTriggerTowersSpare"]
 ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::TriggerTowerAuxContainer/xAODTriggerTowersSpareAux."]
 ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CPMTowerContainer/xAODCPMTowers" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CPMTowerAuxContainer/xAODCPMTowersAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXCPTobContainer/xAODCMXCPTobs" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXCPTobAuxContainer/xAODCMXCPTobsAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXCPHitsContainer/xAODCMXCPHits" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXCPHitsAuxContainer/xAODCMXCPHitsAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::JetElementContainer/xAODJetElements" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::JetElementAuxContainer/xAODJetElementsAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::JEMEtSumsContainer/xAODJEMEtSums" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::JEMEtSumsAuxContainer/xAODJEMEtSumsAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXJetTobContainer/xAODCMXJetTobs" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXJetTobAuxContainer/xAODCMXJetTobsAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXJetHitsContainer/xAODCMXJetHits" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXJetHitsAuxContainer/xAODCMXJetHitsAux." ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXEtSumsContainer/xAODCMXEtSums" ]
+ByteStreamAddressProviderSvc.TypeNames += [ "xAOD::CMXEtSumsAuxContainer/xAODCMXEtSumsAux." ]
 
 ByteStreamAddressProviderSvc.TypeNames += [ "DataVector<LVL1::RODHeader>/RODHeaders" ]
 ByteStreamAddressProviderSvc.TypeNames += [ "DataVector<LVL1::RODHeader>/RODHeadersPP" ]
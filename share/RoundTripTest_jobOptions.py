@@ -0,0 +1,22 @@
+# Bytestream encode/decode round trip test, needs no input file.
+# Requires the library built with the test algorithms (see cmt/requirements).
+
+from TrigT1CaloByteStream.TrigT1CaloByteStreamConf import LVL1BS__PpmByteStreamV1Tool
+from TrigT1CaloByteStream.TrigT1CaloByteStreamConf import LVL1BS__PpmByteStreamV2Tool
+from TrigT1CaloByteStream.TrigT1CaloByteStreamConf import LVL1BS__CpByteStreamV2Tool
+from TrigT1CaloByteStream.TrigT1CaloByteStreamConf import LVL1BS__JepByteStreamV2Tool
+from TrigT1CaloByteStream.TrigT1CaloByteStreamConf import LVL1BS__L1CaloByteStreamReadTool
+from TrigT1CaloByteStream.TrigT1CaloByteStreamConf import LVL1BS__RoundTripTester
+ToolSvc = Service("ToolSvc")
+ToolSvc += LVL1BS__PpmByteStreamV1Tool("PpmByteStreamV1Tool")
+ToolSvc += LVL1BS__PpmByteStreamV2Tool("PpmByteStreamV2Tool")
+ToolSvc += LVL1BS__CpByteStreamV2Tool("CpByteStreamV2Tool")
+ToolSvc += LVL1BS__JepByteStreamV2Tool("JepByteStreamV2Tool")
+ToolSvc += LVL1BS__L1CaloByteStreamReadTool("L1CaloByteStreamReadTool")
+
+from AthenaCommon.AlgSequence import AlgSequence
+topSequence = AlgSequence()
+topSequence += LVL1BS__RoundTripTester("RoundTripTester",
+               Occupancy = 0.05,
+               SlicesFADC = 5)
+theApp.EvtMax = 100
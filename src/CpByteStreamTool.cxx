@@ -1,6 +1,5 @@
 
 #include <numeric>
-#include <set>
 #include <utility>
 
 #include "GaudiKernel/IInterface.h"
@@ -21,6 +20,7 @@
 #include "CmmSubBlock.h"
 #include "CpmSubBlock.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 #include "L1CaloUserHeader.h"
@@ -475,7 +475,7 @@ StatusCode CpByteStreamTool::convertBs(
   // Loop over ROB fragments
 
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();
   for (; rob != robEnd; ++rob) {
@@ -500,7 +500,7 @@ StatusCode CpByteStreamTool::convertBs(
 
     // Skip duplicate fragments
 
-    if (!dupCheck.insert(robid).second) {
+    if (!dupCheck.insert(robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
       if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
       continue;
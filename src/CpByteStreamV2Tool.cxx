@@ -1,13 +1,16 @@
 
 #include <numeric>
-#include <set>
+#include <sstream>
 #include <utility>
 
+#include "GaudiKernel/IIncidentSvc.h"
 #include "GaudiKernel/IInterface.h"
+#include "GaudiKernel/Incident.h"
 #include "GaudiKernel/MsgStream.h"
 #include "GaudiKernel/StatusCode.h"
 
 #include "ByteStreamCnvSvcBase/FullEventAssembler.h"
+#include "StoreGate/SegMemSvc.h"
 
 #include "TrigT1CaloEvent/CMXCPHits.h"
 #include "TrigT1CaloEvent/CMXCPTob.h"
@@ -20,7 +23,10 @@
 #include "CmxCpSubBlock.h"
 #include "CmxSubBlock.h"
 #include "CpmSubBlockV2.h"
+#include "L1CaloCrateRods.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
+#include "L1CaloRodValidator.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 #include "L1CaloUserHeader.h"
@@ -46,6 +52,7 @@ CpByteStreamV2Tool::CpByteStreamV2Tool(const std::string &type,
                                        const std::string &name,
                                        const IInterface  *parent)
     : AthAlgTool(type, name, parent),
+      m_sms("SegMemSvc/SegMemSvc", name),
       m_cpmMaps("LVL1::CpmMappingTool/CpmMappingTool"),
       m_errorTool("LVL1BS::L1CaloErrorByteStreamTool/L1CaloErrorByteStreamTool"),
       m_channels(80), m_crates(4), m_modules(14), m_cmxs(2), m_maxTobs(5),
@@ -69,6 +76,8 @@ CpByteStreamV2Tool::CpByteStreamV2Tool(const std::string &type,
     // Properties for reading bytestream only
     declareProperty("ROBSourceIDs",       m_sourceIDs,
                     "ROB fragment source identifiers");
+    declareProperty("SliceWindow",        m_sliceWindow = -1,
+                    "If >=0, only read slices within this distance of triggered slice");
 
     // Properties for writing bytestream only
     declareProperty("DataVersion",    m_version     = 2,                //  <<== CHECK
@@ -85,6 +94,10 @@ CpByteStreamV2Tool::CpByteStreamV2Tool(const std::string &type,
                     "Minimum crate number, allows partial output");
     declareProperty("CrateMax",       m_crateMax = m_crates - 1,
                     "Maximum crate number, allows partial output");
+    declareProperty("ParallelCrates", m_parallelCrates = false,
+                    "Encode each crate on its own thread");
+    declareProperty("ValidateRods",   m_validateRods = true,
+                    "Reject RODs with bad sub-block structure before unpacking");
 
 }
 
@@ -121,6 +134,27 @@ StatusCode CpByteStreamV2Tool::initialize()
     }
     else msg(MSG::INFO) << "Retrieved tool " << m_errorTool << endreq;
 
+    sc = m_sms.retrieve();
+    if (sc.isFailure())
+    {
+        msg(MSG::ERROR) << "Failed to retrieve service " << m_sms << endreq;
+        return sc;
+    }
+    else msg(MSG::INFO) << "Retrieved service " << m_sms << endreq;
+
+    ServiceHandle<IIncidentSvc> incSvc("IncidentSvc", name());
+    sc = incSvc.retrieve();
+    if (sc.isFailure())
+    {
+        msg(MSG::ERROR) << "Failed to retrieve service " << incSvc << endreq;
+        return sc;
+    }
+    incSvc->addListener(this, IncidentType::BeginEvent);
+
+    m_ttPool.setMemSvc(&*m_sms);
+    m_tobPool.setMemSvc(&*m_sms);
+    m_hitsPool.setMemSvc(&*m_sms);
+
     m_srcIdMap      = new L1CaloSrcIdMap();
     m_towerKey      = new LVL1::TriggerTowerKey();
     m_cpmSubBlock   = new CpmSubBlockV2();
@@ -134,6 +168,14 @@ StatusCode CpByteStreamV2Tool::initialize()
 
 StatusCode CpByteStreamV2Tool::finalize()
 {
+    msg(MSG::INFO) << "Pool usage (peak objects/bytes): CPMTower "
+                   << m_ttPool.peak() << "/" << m_ttPool.bytes()
+                   << "  CMXCPTob " << m_tobPool.peak() << "/"
+                   << m_tobPool.bytes() << "  CMXCPHits "
+                   << m_hitsPool.peak() << "/" << m_hitsPool.bytes() << endreq;
+    m_hitsPool.clear();
+    m_tobPool.clear();
+    m_ttPool.clear();
     delete m_fea;
     delete m_rodStatus;
     delete m_cmxCpSubBlock;
@@ -143,15 +185,25 @@ StatusCode CpByteStreamV2Tool::finalize()
     return StatusCode::SUCCESS;
 }
 
+// Start of event - previous event's collections have been cleared
+
+void CpByteStreamV2Tool::handle(const Incident& inc)
+{
+    if (inc.type() == IncidentType::BeginEvent)
+    {
+        m_ttPool.clear();
+        m_tobPool.clear();
+        m_hitsPool.clear();
+    }
+}
+
 // Conversion bytestream to CPM towers
 
 StatusCode CpByteStreamV2Tool::convert(
     const IROBDataProviderSvc::VROBFRAG &robFrags,
     DataVector<LVL1::CPMTower> *const ttCollection)
 {
-    m_ttCollection = ttCollection;
-    m_ttMap.clear();
-    return convertBs(robFrags, CPM_TOWERS);
+    return convertBs(robFrags, setCollection(ttCollection));
 }
 
 // Conversion bytestream to CMX-CP TOBs
@@ -160,9 +212,7 @@ StatusCode CpByteStreamV2Tool::convert(
     const IROBDataProviderSvc::VROBFRAG &robFrags,
     DataVector<LVL1::CMXCPTob> *const tobCollection)
 {
-    m_tobCollection = tobCollection;
-    m_tobMap.clear();
-    return convertBs(robFrags, CMX_CP_TOBS);
+    return convertBs(robFrags, setCollection(tobCollection));
 }
 
 // Conversion bytestream to CMX-CP hits
@@ -171,9 +221,7 @@ StatusCode CpByteStreamV2Tool::convert(
     const IROBDataProviderSvc::VROBFRAG &robFrags,
     DataVector<LVL1::CMXCPHits> *const hitCollection)
 {
-    m_hitCollection = hitCollection;
-    m_hitsMap.clear();
-    return convertBs(robFrags, CMX_CP_HITS);
+    return convertBs(robFrags, setCollection(hitCollection));
 }
 
 // Conversion of CP container to bytestream
@@ -190,10 +238,7 @@ StatusCode CpByteStreamV2Tool::convert(const LVL1::CPBSCollectionV2 *const cp,
     const uint16_t minorVersion = m_srcIdMap->minorVersion();
     m_fea->setRodMinorVersion(minorVersion);
     m_rodStatusMap.clear();
-
-    // Pointer to ROD data vector
-
-    FullEventAssembler<L1CaloSrcIdMap>::RODDATA *theROD = 0;
+    m_rodBuffers.clear();
 
     // Set up the container maps
 
@@ -201,7 +246,56 @@ StatusCode CpByteStreamV2Tool::convert(const LVL1::CPBSCollectionV2 *const cp,
     setupCmxCpTobMap(cp->tobs());
     setupCmxCpHitsMap(cp->hits());
 
-    // Loop over data
+    // Encode the crates, concurrently if requested, then add their RODs
+    // to the event in crate order so the output is always the same
+
+    if (m_chanKeys.empty()) setupChannelKeys();
+    const bool parallel = m_parallelCrates && m_crateMax > m_crateMin;
+    const bool crateDebug = debug && !parallel;
+    encodeCrates(m_crateEncoders, m_crateMin, m_crateMax, parallel,
+                 [this, crateDebug](int crate, CrateEncoder& enc)
+                 { encodeCrate(crate, enc, crateDebug); });
+    std::vector<uint32_t> rodIds;
+    for (int crate = m_crateMin; crate <= m_crateMax; ++crate)
+    {
+        const CrateEncoder *const enc = m_crateEncoders[crate - m_crateMin];
+        if (enc->rods.failed())
+        {
+            msg(MSG::ERROR) << enc->rods.error() << endreq;
+            return StatusCode::FAILURE;
+        }
+        enc->rods.merge(m_fea, m_rodBuffers);
+        enc->rods.rodIds(rodIds);
+        for (size_t i = 0; i < rodIds.size(); ++i)
+        {
+            m_rodStatusMap.insert(make_pair(rodIds[i], m_rodStatus));
+        }
+    }
+
+    // Fill the raw event
+
+    m_rodBuffers.record();
+    m_fea->fill(re, msg());
+
+    // Set ROD status words
+
+    //L1CaloRodStatus::setStatus(re, m_rodStatusMap, m_srcIdMap);
+
+    return StatusCode::SUCCESS;
+}
+
+// Encode the RODs of one crate.  Uses no tool state which changes during
+// encoding, so crates can be done on separate threads.
+
+void CpByteStreamV2Tool::encodeCrate(const int crate, CrateEncoder &enc,
+                                     const bool debug)
+{
+    if (debug) msg(MSG::DEBUG);
+    enc.rods.clear();
+
+    // Pointer to ROD data vector
+
+    FullEventAssembler<L1CaloSrcIdMap>::RODDATA *theROD = 0;
 
     const bool neutralFormat   = m_dataFormat == L1CaloSubBlock::NEUTRAL;
     const int  modulesPerSlink = m_modules / m_slinks;
@@ -209,268 +303,258 @@ StatusCode CpByteStreamV2Tool::convert(const LVL1::CPBSCollectionV2 *const cp,
     int trigCpm       = 0;
     int timeslicesNew = 1;
     int trigCpmNew    = 0;
-    for (int crate = m_crateMin; crate <= m_crateMax; ++crate)
-    {
-        const int hwCrate = crate + m_crateOffsetHw;
+    const int hwCrate = crate + m_crateOffsetHw;
 
-        // CPM modules are numbered 1 to m_modules
-        for (int module = 1; module <= m_modules; ++module)
-        {
-            const int mod = module - 1;
+    // CPM modules are numbered 1 to m_modules
+    for (int module = 1; module <= m_modules; ++module)
+    {
+        const int mod = module - 1;
 
-            // Pack required number of modules per slink
+        // Pack required number of modules per slink
 
-            if (mod % modulesPerSlink == 0)
+        if (mod % modulesPerSlink == 0)
+        {
+            const int daqOrRoi = 0;
+            const int slink = (m_slinks == 2) ? 2 * (mod / modulesPerSlink)
+                              : mod / modulesPerSlink;
+            if (debug)
             {
-                const int daqOrRoi = 0;
-                const int slink = (m_slinks == 2) ? 2 * (mod / modulesPerSlink)
-                                  : mod / modulesPerSlink;
-                if (debug)
-                {
-                    msg() << "Treating crate " << hwCrate
-                          << " slink " << slink << endreq;
-                }
-                // Get number of CPM slices and triggered slice offset
-                // for this slink
-                if ( ! slinkSlices(crate, module, modulesPerSlink,
-                                   timeslices, trigCpm))
-                {
-                    msg(MSG::ERROR) << "Inconsistent number of slices or "
-                                    << "triggered slice offsets in data for crate "
-                                    << hwCrate << " slink " << slink << endreq;
-                    return StatusCode::FAILURE;
-                }
-                timeslicesNew = (m_forceSlices) ? m_forceSlices : timeslices;
-                trigCpmNew    = ModifySlices::peak(trigCpm, timeslices, timeslicesNew);
-                if (debug)
+                msg() << "Treating crate " << hwCrate
+                      << " slink " << slink << endreq;
+            }
+            // Get number of CPM slices and triggered slice offset
+            // for this slink
+            if ( ! slinkSlices(crate, module, modulesPerSlink,
+                               timeslices, trigCpm))
+            {
+                std::ostringstream error;
+                error << "Inconsistent number of slices or "
+                      << "triggered slice offsets in data for crate "
+                      << hwCrate << " slink " << slink;
+                enc.rods.setError(error.str());
+                return;
+            }
+            timeslicesNew = (m_forceSlices) ? m_forceSlices : timeslices;
+            trigCpmNew    = ModifySlices::peak(trigCpm, timeslices, timeslicesNew);
+            if (debug)
+            {
+                msg() << "Data Version/Format: " << m_version
+                      << " " << m_dataFormat << endreq
+                      << "Slices/offset: " << timeslices << " " << trigCpm;
+                if (timeslices != timeslicesNew)
                 {
-                    msg() << "Data Version/Format: " << m_version
-                          << " " << m_dataFormat << endreq
-                          << "Slices/offset: " << timeslices << " " << trigCpm;
-                    if (timeslices != timeslicesNew)
-                    {
-                        msg() << " modified to " << timeslicesNew << " " << trigCpmNew;
-                    }
-                    msg() << endreq;
+                    msg() << " modified to " << timeslicesNew << " " << trigCpmNew;
                 }
-                L1CaloUserHeader userHeader;
-                userHeader.setCpm(trigCpmNew);
-                const uint32_t rodIdCpm = m_srcIdMap->getRodID(hwCrate, slink, daqOrRoi,
-                                          m_subDetector);
-                theROD = m_fea->getRodData(rodIdCpm);
-                theROD->push_back(userHeader.header());
-                m_rodStatusMap.insert(make_pair(rodIdCpm, m_rodStatus));
+                msg() << endreq;
             }
-            if (debug) msg() << "Module " << module << endreq;
+            L1CaloUserHeader userHeader;
+            userHeader.setCpm(trigCpmNew);
+            const uint32_t rodIdCpm = m_srcIdMap->getRodID(hwCrate, slink, daqOrRoi,
+                                      m_subDetector);
+            theROD = enc.rods.newRod(rodIdCpm, timeslicesNew);
+            theROD->push_back(userHeader.header());
+        }
+        if (debug) msg() << "Module " << module << endreq;
 
-            // Create a sub-block for each slice (except Neutral format)
+        // Set up a sub-block for each slice (except Neutral format),
+        // reusing the blocks and their buffers from previous modules
 
-            m_cpmBlocks.clear();
-            for (int slice = 0; slice < timeslicesNew; ++slice)
-            {
-                CpmSubBlockV2 *const subBlock = new CpmSubBlockV2();
-                subBlock->setCpmHeader(m_version, m_dataFormat, slice,
-                                       hwCrate, module, timeslicesNew);
-                m_cpmBlocks.push_back(subBlock);
-                if (neutralFormat) break;
-            }
+        const int cpmBlocks = (neutralFormat) ? 1 : timeslicesNew;
+        while (static_cast<int>(enc.cpmBlocks.size()) < cpmBlocks)
+        {
+            enc.cpmBlocks.push_back(new CpmSubBlockV2());
+        }
+        for (int slice = 0; slice < cpmBlocks; ++slice)
+        {
+            CpmSubBlockV2 *const subBlock = enc.cpmBlocks[slice];
+            subBlock->clear();
+            subBlock->setCpmHeader(m_version, m_dataFormat, slice,
+                                   hwCrate, module, timeslicesNew);
+        }
 
-            // Find CPM towers corresponding to each eta/phi pair and fill
-            // sub-blocks
+        // Find CPM towers corresponding to each eta/phi pair and fill
+        // sub-blocks
 
-            for (int chan = 0; chan < m_channels; ++chan)
+        for (int chan = 0; chan < m_channels; ++chan)
+        {
+            unsigned int key = 0;
+            if (channelKey(crate, module, chan, key))
             {
-                double eta = 0.;
-                double phi = 0.;
-                int layer = 0;
-                if (m_cpmMaps->mapping(crate, module, chan, eta, phi, layer))
+                const LVL1::CPMTower *const tt = findCpmTower(key);
+                if (tt )
                 {
-                    const unsigned int key = m_towerKey->ttKey(phi, eta);
-                    const LVL1::CPMTower *const tt = findCpmTower(key);
-                    if (tt )
+                    std::vector<int> emData;
+                    std::vector<int> hadData;
+                    std::vector<int> emError;
+                    std::vector<int> hadError;
+                    ModifySlices::data(tt->emEnergyVec(),  emData,   timeslicesNew);
+                    ModifySlices::data(tt->hadEnergyVec(), hadData,  timeslicesNew);
+                    ModifySlices::data(tt->emErrorVec(),   emError,  timeslicesNew);
+                    ModifySlices::data(tt->hadErrorVec(),  hadError, timeslicesNew);
+                    for (int slice = 0; slice < timeslicesNew; ++slice)
                     {
-                        std::vector<int> emData;
-                        std::vector<int> hadData;
-                        std::vector<int> emError;
-                        std::vector<int> hadError;
-                        ModifySlices::data(tt->emEnergyVec(),  emData,   timeslicesNew);
-                        ModifySlices::data(tt->hadEnergyVec(), hadData,  timeslicesNew);
-                        ModifySlices::data(tt->emErrorVec(),   emError,  timeslicesNew);
-                        ModifySlices::data(tt->hadErrorVec(),  hadError, timeslicesNew);
-                        for (int slice = 0; slice < timeslicesNew; ++slice)
+                        const LVL1::DataError emErrBits(emError[slice]);
+                        const LVL1::DataError hadErrBits(hadError[slice]);
+                        const int emErr  =
+                            (emErrBits.get(LVL1::DataError::LinkDown) << 1) |
+                            emErrBits.get(LVL1::DataError::Parity);
+                        const int hadErr =
+                            (hadErrBits.get(LVL1::DataError::LinkDown) << 1) |
+                            hadErrBits.get(LVL1::DataError::Parity);
+                        const int index  = ( neutralFormat ) ? 0 : slice;
+                        CpmSubBlockV2 *const subBlock = enc.cpmBlocks[index];
+                        subBlock->fillTowerData(slice, chan, emData[slice],
+                                                hadData[slice], emErr, hadErr);
+                        if ((emErrBits.error() >> LVL1::DataError::GLinkParity))
                         {
-                            const LVL1::DataError emErrBits(emError[slice]);
-                            const LVL1::DataError hadErrBits(hadError[slice]);
-                            const int emErr  =
-                                (emErrBits.get(LVL1::DataError::LinkDown) << 1) |
-                                emErrBits.get(LVL1::DataError::Parity);
-                            const int hadErr =
-                                (hadErrBits.get(LVL1::DataError::LinkDown) << 1) |
-                                hadErrBits.get(LVL1::DataError::Parity);
-                            const int index  = ( neutralFormat ) ? 0 : slice;
-                            CpmSubBlockV2 *const subBlock = m_cpmBlocks[index];
-                            subBlock->fillTowerData(slice, chan, emData[slice],
-                                                    hadData[slice], emErr, hadErr);
-                            if ((emErrBits.error() >> LVL1::DataError::GLinkParity))
-                            {
-                                int gLinkParity   = emErrBits.get(LVL1::DataError::GLinkParity);
-                                int gLinkProtocol = emErrBits.get(LVL1::DataError::GLinkProtocol);
-                                int bCNMismatch   = emErrBits.get(LVL1::DataError::BCNMismatch);
-                                int fIFOOverflow  = emErrBits.get(LVL1::DataError::FIFOOverflow);
-                                int moduleError   = emErrBits.get(LVL1::DataError::ModuleError);
-                                int gLinkDown     = emErrBits.get(LVL1::DataError::GLinkDown);
-                                int gLinkTimeout  = emErrBits.get(LVL1::DataError::GLinkTimeout);
-                                uint32_t failingBCN = emErrBits.get(LVL1::DataError::FailingBCN);
-                                subBlock->setStatus(failingBCN, gLinkTimeout, gLinkDown,
-                                                    moduleError, fIFOOverflow, bCNMismatch,
-                                                    gLinkProtocol, gLinkParity);
-                            }
+                            int gLinkParity   = emErrBits.get(LVL1::DataError::GLinkParity);
+                            int gLinkProtocol = emErrBits.get(LVL1::DataError::GLinkProtocol);
+                            int bCNMismatch   = emErrBits.get(LVL1::DataError::BCNMismatch);
+                            int fIFOOverflow  = emErrBits.get(LVL1::DataError::FIFOOverflow);
+                            int moduleError   = emErrBits.get(LVL1::DataError::ModuleError);
+                            int gLinkDown     = emErrBits.get(LVL1::DataError::GLinkDown);
+                            int gLinkTimeout  = emErrBits.get(LVL1::DataError::GLinkTimeout);
+                            uint32_t failingBCN = emErrBits.get(LVL1::DataError::FailingBCN);
+                            subBlock->setStatus(failingBCN, gLinkTimeout, gLinkDown,
+                                                moduleError, fIFOOverflow, bCNMismatch,
+                                                gLinkProtocol, gLinkParity);
                         }
                     }
                 }
             }
+        }
 
-            // Pack and write the sub-blocks
+        // Pack and write the sub-blocks
 
-            DataVector<CpmSubBlockV2>::const_iterator pos;
-            for (pos = m_cpmBlocks.begin(); pos != m_cpmBlocks.end(); ++pos)
+        for (int index = 0; index < cpmBlocks; ++index)
+        {
+            CpmSubBlockV2 *const subBlock = enc.cpmBlocks[index];
+            if ( !subBlock->pack())
             {
-                CpmSubBlockV2 *const subBlock = *pos;
-                if ( !subBlock->pack())
-                {
-                    msg(MSG::ERROR) << "CPM sub-block packing failed" << endreq;
-                    return StatusCode::FAILURE;
-                }
-                if (debug)
-                {
-                    msg() << "CPM sub-block data words: "
-                          << subBlock->dataWords() << endreq;
-                }
-                subBlock->write(theROD);
+                enc.rods.setError("CPM sub-block packing failed");
+                return;
             }
+            if (debug)
+            {
+                msg() << "CPM sub-block data words: "
+                      << subBlock->dataWords() << endreq;
+            }
+            subBlock->write(theROD);
         }
+    }
 
-        // Append CMXs to last S-Link of the crate
+    // Append CMXs to last S-Link of the crate
 
-        for (int cmx = 0; cmx < m_cmxs; ++cmx)
-        {
+    for (int cmx = 0; cmx < m_cmxs; ++cmx)
+    {
 
-            // Create a sub-block for each slice (except Neutral format)
+        // Set up a sub-block for each slice (except Neutral format)
 
-            m_cmxBlocks.clear();
-            const int summing = (crate == m_crates - 1) ? CmxSubBlock::SYSTEM
-                                : CmxSubBlock::CRATE;
-            for (int slice = 0; slice < timeslicesNew; ++slice)
-            {
-                CmxCpSubBlock *const block = new CmxCpSubBlock();
-                block->setCmxHeader(m_version, m_dataFormat, slice, hwCrate,
-                                    summing, CmxSubBlock::CMX_CP, cmx, timeslicesNew);
-                m_cmxBlocks.push_back(block);
-                if (neutralFormat) break;
-            }
+        const int summing = (crate == m_crates - 1) ? CmxSubBlock::SYSTEM
+                            : CmxSubBlock::CRATE;
+        const int cmxBlocks = (neutralFormat) ? 1 : timeslicesNew;
+        while (static_cast<int>(enc.cmxBlocks.size()) < cmxBlocks)
+        {
+            enc.cmxBlocks.push_back(new CmxCpSubBlock());
+        }
+        for (int slice = 0; slice < cmxBlocks; ++slice)
+        {
+            CmxCpSubBlock *const block = enc.cmxBlocks[slice];
+            block->clear();
+            block->setCmxHeader(m_version, m_dataFormat, slice, hwCrate,
+                                summing, CmxSubBlock::CMX_CP, cmx, timeslicesNew);
+        }
 
-            // CMX-CP Tobs
+        // CMX-CP Tobs
 
-            for (int cpm = 1; cpm <= m_modules; ++cpm)
+        for (int cpm = 1; cpm <= m_modules; ++cpm)
+        {
+            for (int chip = 0; chip < m_chips; ++chip)
             {
-                for (int chip = 0; chip < m_chips; ++chip)
+                for (int loc = 0; loc < m_locs; ++loc)
                 {
-                    for (int loc = 0; loc < m_locs; ++loc)
+                    const int key = tobKey(crate, cmx, cpm, chip, loc);
+                    const LVL1::CMXCPTob *const ct = findCmxCpTob(key);
+                    if ( ct )
                     {
-                        const int key = tobKey(crate, cmx, cpm, chip, loc);
-                        const LVL1::CMXCPTob *const ct = findCmxCpTob(key);
-                        if ( ct )
+                        std::vector<int> energy;
+                        std::vector<int> isolation;
+                        std::vector<int> error;
+                        std::vector<unsigned int> presence;
+                        ModifySlices::data(ct->energyVec(),      energy,    timeslicesNew);
+                        ModifySlices::data(ct->isolationVec(),   isolation, timeslicesNew);
+                        ModifySlices::data(ct->errorVec(),       error,     timeslicesNew);
+                        ModifySlices::data(ct->presenceMapVec(), presence,  timeslicesNew);
+                        for (int slice = 0; slice < timeslicesNew; ++slice)
                         {
-                            std::vector<int> energy;
-                            std::vector<int> isolation;
-                            std::vector<int> error;
-                            std::vector<unsigned int> presence;
-                            ModifySlices::data(ct->energyVec(),      energy,    timeslicesNew);
-                            ModifySlices::data(ct->isolationVec(),   isolation, timeslicesNew);
-                            ModifySlices::data(ct->errorVec(),       error,     timeslicesNew);
-                            ModifySlices::data(ct->presenceMapVec(), presence,  timeslicesNew);
-                            for (int slice = 0; slice < timeslicesNew; ++slice)
-                            {
-                                const LVL1::DataError errBits(error[slice]);
-                                int err = errBits.get(LVL1::DataError::ParityMerge);
-                                err |= (errBits.get(LVL1::DataError::ParityPhase0)) << 1;
-                                err |= (errBits.get(LVL1::DataError::ParityPhase1)) << 2;
-                                err |= (errBits.get(LVL1::DataError::ParityPhase2)) << 3;
-                                err |= (errBits.get(LVL1::DataError::ParityPhase3)) << 4;
-                                err |= (errBits.get(LVL1::DataError::Overflow)) << 5;
-                                const int index = ( neutralFormat ) ? 0 : slice;
-                                CmxCpSubBlock *const subBlock = m_cmxBlocks[index];
-                                subBlock->setTob(slice, cpm, chip, loc, energy[slice],
-                                                 isolation[slice], err);
-                                subBlock->setPresenceMap(slice, cpm, presence[slice]);
-                            }
+                            const LVL1::DataError errBits(error[slice]);
+                            int err = errBits.get(LVL1::DataError::ParityMerge);
+                            err |= (errBits.get(LVL1::DataError::ParityPhase0)) << 1;
+                            err |= (errBits.get(LVL1::DataError::ParityPhase1)) << 2;
+                            err |= (errBits.get(LVL1::DataError::ParityPhase2)) << 3;
+                            err |= (errBits.get(LVL1::DataError::ParityPhase3)) << 4;
+                            err |= (errBits.get(LVL1::DataError::Overflow)) << 5;
+                            const int index = ( neutralFormat ) ? 0 : slice;
+                            CmxCpSubBlock *const subBlock = enc.cmxBlocks[index];
+                            subBlock->setTob(slice, cpm, chip, loc, energy[slice],
+                                             isolation[slice], err);
+                            subBlock->setPresenceMap(slice, cpm, presence[slice]);
                         }
                     }
                 }
             }
+        }
 
-            // CMX-CP Hits
+        // CMX-CP Hits
 
-            for (int source = 0; source < LVL1::CMXCPHits::MAXSOURCE; ++source)
+        for (int source = 0; source < LVL1::CMXCPHits::MAXSOURCE; ++source)
+        {
+            const int key = hitsKey(crate, cmx, source);
+            const LVL1::CMXCPHits *const ch = findCmxCpHits(key);
+            if ( ch )
             {
-                const int key = hitsKey(crate, cmx, source);
-                const LVL1::CMXCPHits *const ch = findCmxCpHits(key);
-                if ( ch )
+                std::vector<unsigned int> hits0;
+                std::vector<unsigned int> hits1;
+                std::vector<int> err0;
+                std::vector<int> err1;
+                ModifySlices::data(ch->hitsVec0(),  hits0, timeslicesNew);
+                ModifySlices::data(ch->hitsVec1(),  hits1, timeslicesNew);
+                ModifySlices::data(ch->errorVec0(), err0,  timeslicesNew);
+                ModifySlices::data(ch->errorVec1(), err1,  timeslicesNew);
+                for (int slice = 0; slice < timeslicesNew; ++slice)
                 {
-                    std::vector<unsigned int> hits0;
-                    std::vector<unsigned int> hits1;
-                    std::vector<int> err0;
-                    std::vector<int> err1;
-                    ModifySlices::data(ch->hitsVec0(),  hits0, timeslicesNew);
-                    ModifySlices::data(ch->hitsVec1(),  hits1, timeslicesNew);
-                    ModifySlices::data(ch->errorVec0(), err0,  timeslicesNew);
-                    ModifySlices::data(ch->errorVec1(), err1,  timeslicesNew);
-                    for (int slice = 0; slice < timeslicesNew; ++slice)
+                    const LVL1::DataError err0Bits(err0[slice]);
+                    const LVL1::DataError err1Bits(err1[slice]);
+                    const int index = ( neutralFormat ) ? 0 : slice;
+                    CmxCpSubBlock *const subBlock = enc.cmxBlocks[index];
+                    subBlock->setHits(slice, source, 0, hits0[slice],                // Assuming CMXCPHits::source == CmxCpSubBlock::source
+                                      err0Bits.get(LVL1::DataError::Parity));
+                    subBlock->setHits(slice, source, 1, hits1[slice],
+                                      err1Bits.get(LVL1::DataError::Parity));
+                    if (neutralFormat)   // Neutral format wants RoI overflow bit
                     {
-                        const LVL1::DataError err0Bits(err0[slice]);
-                        const LVL1::DataError err1Bits(err1[slice]);
-                        const int index = ( neutralFormat ) ? 0 : slice;
-                        CmxCpSubBlock *const subBlock = m_cmxBlocks[index];
-                        subBlock->setHits(slice, source, 0, hits0[slice],                // Assuming CMXCPHits::source == CmxCpSubBlock::source
-                                          err0Bits.get(LVL1::DataError::Parity));
-                        subBlock->setHits(slice, source, 1, hits1[slice],
-                                          err1Bits.get(LVL1::DataError::Parity));
-                        if (neutralFormat)   // Neutral format wants RoI overflow bit
-                        {
-                            subBlock->setRoiOverflow(slice, source,
-                                                     err0Bits.get(LVL1::DataError::Overflow));
-                        }
+                        subBlock->setRoiOverflow(slice, source,
+                                                 err0Bits.get(LVL1::DataError::Overflow));
                     }
                 }
             }
-            DataVector<CmxCpSubBlock>::const_iterator cos = m_cmxBlocks.begin();
-            for (; cos != m_cmxBlocks.end(); ++cos)
+        }
+        for (int index = 0; index < cmxBlocks; ++index)
+        {
+            CmxCpSubBlock *const subBlock = enc.cmxBlocks[index];
+            if ( !subBlock->pack())
             {
-                CmxCpSubBlock *const subBlock = *cos;
-                if ( !subBlock->pack())
-                {
-                    msg(MSG::ERROR) << "CMX-Cp sub-block packing failed" << endreq;
-                    return StatusCode::FAILURE;
-                }
-                if (debug)
-                {
-                    msg() << "CMX-Cp sub-block data words: "
-                          << subBlock->dataWords() << endreq;
-                }
-                subBlock->write(theROD);
+                enc.rods.setError("CMX-Cp sub-block packing failed");
+                return;
             }
+            if (debug)
+            {
+                msg() << "CMX-Cp sub-block data words: "
+                      << subBlock->dataWords() << endreq;
+            }
+            subBlock->write(theROD);
         }
     }
-
-    // Fill the raw event
-
-    m_fea->fill(re, msg());
-
-    // Set ROD status words
-
-    //L1CaloRodStatus::setStatus(re, m_rodStatusMap, m_srcIdMap);
-
-    return StatusCode::SUCCESS;
 }
 
 // Return reference to vector with all possible Source Identifiers
@@ -503,6 +587,53 @@ const std::vector<uint32_t> &CpByteStreamV2Tool::sourceIDs(
     return m_sourceIDs;
 }
 
+// Set up output collection for conversion
+
+CpByteStreamV2Tool::CollectionType CpByteStreamV2Tool::setCollection(
+    CpmTowerCollection *const ttCollection)
+{
+    m_ttCollection = ttCollection;
+    m_ttMap.clear();
+    return CPM_TOWERS;
+}
+
+CpByteStreamV2Tool::CollectionType CpByteStreamV2Tool::setCollection(
+    CmxCpTobCollection *const tobCollection)
+{
+    m_tobCollection = tobCollection;
+    m_tobMap.clear();
+    return CMX_CP_TOBS;
+}
+
+CpByteStreamV2Tool::CollectionType CpByteStreamV2Tool::setCollection(
+    CmxCpHitsCollection *const hitCollection)
+{
+    m_hitCollection = hitCollection;
+    m_hitsMap.clear();
+    return CMX_CP_HITS;
+}
+
+// Check ROD source ID, remembering those already found valid
+
+bool CpByteStreamV2Tool::validRodId(const uint32_t sourceID,
+                                    const uint32_t robid)
+{
+    std::map<uint32_t, uint32_t>::const_iterator iter =
+                                                m_validRodIds.find(sourceID);
+    if (iter != m_validRodIds.end()) return iter->second == robid;
+    if (m_srcIdMap->getRobID(sourceID) != robid           ||
+            m_srcIdMap->subDet(sourceID)   != m_subDetector   ||
+            m_srcIdMap->daqOrRoi(sourceID) != 0               ||
+            (m_srcIdMap->slink(sourceID) != 0 && m_srcIdMap->slink(sourceID) != 2) ||
+            m_srcIdMap->crate(sourceID)    <  m_crateOffsetHw ||
+            m_srcIdMap->crate(sourceID)    >= m_crateOffsetHw + m_crates)
+    {
+        return false;
+    }
+    m_validRodIds.insert(std::make_pair(sourceID, robid));
+    return true;
+}
+
 // Convert bytestream to given container type
 
 StatusCode CpByteStreamV2Tool::convertBs(
@@ -512,10 +643,14 @@ StatusCode CpByteStreamV2Tool::convertBs(
     const bool debug = msgLvl(MSG::DEBUG);
     if (debug) msg(MSG::DEBUG);
 
+    m_ttStage.clear();
+    m_tobStage.clear();
+    m_hitsStage.clear();
+
     // Loop over ROB fragments
 
     int robCount = 0;
-    std::set<uint32_t> dupCheck;
+    L1CaloRobIdSet dupCheck;
     ROBIterator rob    = robFrags.begin();
     ROBIterator robEnd = robFrags.end();
     for (; rob != robEnd; ++rob)
@@ -540,7 +675,7 @@ StatusCode CpByteStreamV2Tool::convertBs(
 
         // Skip duplicate fragments
 
-        if (!dupCheck.insert(robid).second)
+        if (!dupCheck.insert(robid))
         {
             m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
             if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
@@ -563,12 +698,7 @@ StatusCode CpByteStreamV2Tool::convertBs(
 
         // Check identifier
         const uint32_t sourceID = (*rob)->rod_source_id();
-        if (m_srcIdMap->getRobID(sourceID) != robid           ||
-                m_srcIdMap->subDet(sourceID)   != m_subDetector   ||
-                m_srcIdMap->daqOrRoi(sourceID) != 0               ||
-                (m_srcIdMap->slink(sourceID) != 0 && m_srcIdMap->slink(sourceID) != 2) ||
-                m_srcIdMap->crate(sourceID)    <  m_crateOffsetHw ||
-                m_srcIdMap->crate(sourceID)    >= m_crateOffsetHw + m_crates)
+        if (!validRodId(sourceID, robid))
         {
             m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_ROD_ID);
             if (debug)
@@ -622,6 +752,21 @@ StatusCode CpByteStreamV2Tool::convertBs(
                   << "Triggered slice offset: "  << trigCpm << endreq;
         }
 
+        // Check sub-block structure before creating any objects
+
+        if (m_validateRods)
+        {
+            const int rodErr = L1CaloRodValidator::checkCpJep(payload,
+                               payloadEnd, true, rodCrate, trigCpm);
+            if (rodErr != L1CaloSubBlock::ERROR_NONE)
+            {
+                m_errorTool->rodError(robid, rodErr);
+                if (debug) msg() << "ROD structure check failed: " << rodErr
+                                     << endreq;
+                continue;
+            }
+        }
+
         // Loop over sub-blocks
 
         m_rodErr = L1CaloSubBlock::ERROR_NONE;
@@ -701,9 +846,75 @@ StatusCode CpByteStreamV2Tool::convertBs(
             m_errorTool->rodError(robid, m_rodErr);
         }
     }
+    createStaged(collection);
     return StatusCode::SUCCESS;
 }
 
+// Create objects from staged slices
+
+void CpByteStreamV2Tool::createStaged(const CollectionType collection)
+{
+    if (collection == CPM_TOWERS)
+    {
+        const int size = m_ttStage.size();
+        for (int index = 0; index < size; ++index)
+        {
+            const TowerInfo &info(m_ttStage.info(index));
+            m_ttStage.fieldVec(index, TowerInfo::EM, m_emVec);
+            m_ttStage.fieldVec(index, TowerInfo::EM_ERROR, m_emErrVec);
+            m_ttStage.fieldVec(index, TowerInfo::HAD, m_hadVec);
+            m_ttStage.fieldVec(index, TowerInfo::HAD_ERROR, m_hadErrVec);
+            LVL1::CPMTower *tt = m_ttPool.create(m_ttCollection,
+                                                 info.phi, info.eta, m_emVec, m_emErrVec,
+                                                 m_hadVec, m_hadErrVec,
+                                                 m_ttStage.peak(index));
+            m_ttMap.insert(std::make_pair(m_ttStage.key(index), tt));
+            m_ttCollection->push_back(tt);
+        }
+        m_ttStage.clear();
+    }
+    else if (collection == CMX_CP_TOBS)
+    {
+        const int size = m_tobStage.size();
+        for (int index = 0; index < size; ++index)
+        {
+            const CmxTobInfo &info(m_tobStage.info(index));
+            m_tobStage.fieldVec(index, CmxTobInfo::ENERGY, m_energyVec);
+            m_tobStage.fieldVec(index, CmxTobInfo::ISOLATION, m_isolVec);
+            m_tobStage.fieldVec(index, CmxTobInfo::TOB_ERROR, m_errorVec);
+            m_tobStage.fieldVec(index, CmxTobInfo::PRESENCE_MAP, m_presenceMapVec);
+            LVL1::CMXCPTob *tb = m_tobPool.create(m_tobCollection,
+                                                  info.crate, info.cmx, info.cpm,
+                                                  info.chip, info.loc,
+                                                  m_energyVec, m_isolVec, m_errorVec,
+                                                  m_presenceMapVec, m_tobStage.peak(index));
+            m_tobMap.insert(std::make_pair(m_tobStage.key(index), tb));
+            m_tobCollection->push_back(tb);
+        }
+        m_tobStage.clear();
+    }
+    else if (collection == CMX_CP_HITS)
+    {
+        const int size = m_hitsStage.size();
+        for (int index = 0; index < size; ++index)
+        {
+            const CmxHitsInfo &info(m_hitsStage.info(index));
+            m_hitsStage.fieldVec(index, CmxHitsInfo::HITS0, m_hitsVec0);
+            m_hitsStage.fieldVec(index, CmxHitsInfo::HITS1, m_hitsVec1);
+            m_hitsStage.fieldVec(index, CmxHitsInfo::ERROR0, m_errVec0);
+            m_hitsStage.fieldVec(index, CmxHitsInfo::ERROR1, m_errVec1);
+            LVL1::CMXCPHits *ch = m_hitsPool.create(m_hitCollection,
+                                                    info.crate, info.cmx, info.source,
+                                                    m_hitsVec0, m_hitsVec1,
+                                                    m_errVec0, m_errVec1,
+                                                    m_hitsStage.peak(index));
+            m_hitsMap.insert(std::make_pair(m_hitsStage.key(index), ch));
+            m_hitCollection->push_back(ch);
+        }
+        m_hitsStage.clear();
+    }
+}
+
 // Unpack CMX-CP sub-block
 
 void CpByteStreamV2Tool::decodeCmxCp(CmxCpSubBlock *subBlock, int trigCpm,
@@ -743,6 +954,14 @@ void CpByteStreamV2Tool::decodeCmxCp(CmxCpSubBlock *subBlock, int trigCpm,
         m_rodErr = L1CaloSubBlock::ERROR_SLICES;
         return;
     }
+    // Slices to keep, skipping sub-blocks outside the window
+    const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+    int firstSlice = 0;
+    int numSlices  = timeslices;
+    ModifySlices::window(trigCpm, timeslices, m_sliceWindow, firstSlice, numSlices);
+    if (!neutralFormat &&
+            (sliceNum < firstSlice || sliceNum >= firstSlice + numSlices)) return;
+    const int trigCpmOut = trigCpm - firstSlice;
     // Unpack sub-block
     if (subBlock->dataWords() && !subBlock->unpack())
     {
@@ -757,17 +976,17 @@ void CpByteStreamV2Tool::decodeCmxCp(CmxCpSubBlock *subBlock, int trigCpm,
 
     // Retrieve required data
 
-    const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
     LVL1::DataError dErr;
     dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
     const int subStatus = dErr.error();
     const int crate    = hwCrate - m_crateOffsetHw;
     const int swCrate  = crate   + m_crateOffsetSw;
     const int maxSid   = CmxCpSubBlock::MAX_SOURCE_ID;
-    const int sliceBeg = ( neutralFormat ) ? 0          : sliceNum;
-    const int sliceEnd = ( neutralFormat ) ? timeslices : sliceNum + 1;
+    const int sliceBeg = ( neutralFormat ) ? firstSlice             : sliceNum;
+    const int sliceEnd = ( neutralFormat ) ? firstSlice + numSlices : sliceNum + 1;
     for (int slice = sliceBeg; slice < sliceEnd; ++slice)
     {
+        const int sl = slice - firstSlice;
 
         if (collection == CMX_CP_TOBS)
         {
@@ -798,50 +1017,32 @@ void CpByteStreamV2Tool::decodeCmxCp(CmxCpSubBlock *subBlock, int trigCpm,
                     }
                     error = errBits.error();
                     const int key = tobKey(crate, cmx, cpm, chip, loc);
-                    LVL1::CMXCPTob *tb = findCmxCpTob(key);
-                    if ( ! tb )   // create new CMX TOB
+                    int tb = m_tobStage.find(key);
+                    if (tb < 0)   // stage new CMX TOB
                     {
-                        m_energyVec.assign(timeslices, 0);
-                        m_isolVec.assign(timeslices, 0);
-                        m_errorVec.assign(timeslices, 0);
-                        m_presenceMapVec.assign(timeslices, 0);
-                        m_energyVec[slice] = energy;
-                        m_isolVec[slice]   = isolation;
-                        m_errorVec[slice]  = error;
-                        m_presenceMapVec[slice] = presenceMap;
-                        tb = new LVL1::CMXCPTob(swCrate, cmx, cpm, chip, loc,
-                                                m_energyVec, m_isolVec, m_errorVec,
-                                                m_presenceMapVec, trigCpm);
-                        m_tobMap.insert(std::make_pair(key, tb));
-                        m_tobCollection->push_back(tb);
+                        const CmxTobInfo info = { swCrate, cmx, cpm, chip, loc };
+                        tb = m_tobStage.add(key, info, numSlices, trigCpmOut);
                     }
                     else
                     {
-                        m_energyVec = tb->energyVec();
-                        m_isolVec   = tb->isolationVec();
-                        m_errorVec  = tb->errorVec();
-                        m_presenceMapVec = tb->presenceMapVec();
-                        const int nsl = m_energyVec.size();
-                        if (timeslices != nsl)
+                        if (numSlices != m_tobStage.slices(tb))
                         {
                             if (debug) msg() << "Inconsistent number of slices in sub-blocks"
                                                  << endreq;
                             m_rodErr = L1CaloSubBlock::ERROR_SLICES;
                             return;
                         }
-                        if (m_energyVec[slice] != 0 || m_isolVec[slice] != 0 ||
-                                m_errorVec[slice]  != 0)
+                        if (m_tobStage.sliceSet(tb, sl, CmxTobInfo::PRESENCE_MAP))
                         {
                             if (debug) msg() << "Duplicate data for slice " << slice << endreq;
                             m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
                             return;
                         }
-                        m_energyVec[slice] = energy;
-                        m_isolVec[slice]   = isolation;
-                        m_errorVec[slice]  = error;
-                        m_presenceMapVec[slice] = presenceMap;
-                        tb->addTob(m_energyVec, m_isolVec, m_errorVec, m_presenceMapVec);
                     }
+                    m_tobStage.set(tb, CmxTobInfo::ENERGY, sl, energy);
+                    m_tobStage.set(tb, CmxTobInfo::ISOLATION, sl, isolation);
+                    m_tobStage.set(tb, CmxTobInfo::TOB_ERROR, sl, error);
+                    m_tobStage.set(tb, CmxTobInfo::PRESENCE_MAP, sl, presenceMap);
                 }
             }
 
@@ -874,50 +1075,32 @@ void CpByteStreamV2Tool::decodeCmxCp(CmxCpSubBlock *subBlock, int trigCpm,
                 if (hits0 || hits1 || err0 || err1)
                 {
                     const int key = hitsKey(crate, cmx, source);
-                    LVL1::CMXCPHits *ch = findCmxCpHits(key);
-                    if ( ! ch )     // create new CMX hits
+                    int ch = m_hitsStage.find(key);
+                    if (ch < 0)     // stage new CMX hits
                     {
-                        m_hitsVec0.assign(timeslices, 0);
-                        m_hitsVec1.assign(timeslices, 0);
-                        m_errVec0.assign(timeslices, 0);
-                        m_errVec1.assign(timeslices, 0);
-                        m_hitsVec0[slice] = hits0;
-                        m_hitsVec1[slice] = hits1;
-                        m_errVec0[slice]  = err0;
-                        m_errVec1[slice]  = err1;
-                        ch = new LVL1::CMXCPHits(swCrate, cmx, source,
-                                                 m_hitsVec0, m_hitsVec1,
-                                                 m_errVec0, m_errVec1, trigCpm);
-                        m_hitsMap.insert(std::make_pair(key, ch));
-                        m_hitCollection->push_back(ch);
+                        const CmxHitsInfo info = { swCrate, cmx, source };
+                        ch = m_hitsStage.add(key, info, numSlices, trigCpmOut);
                     }
                     else
                     {
-                        m_hitsVec0 = ch->hitsVec0();
-                        m_hitsVec1 = ch->hitsVec1();
-                        m_errVec0  = ch->errorVec0();
-                        m_errVec1  = ch->errorVec1();
-                        const int nsl = m_hitsVec0.size();
-                        if (timeslices != nsl)
+                        if (numSlices != m_hitsStage.slices(ch))
                         {
                             if (debug) msg() << "Inconsistent number of slices in sub-blocks"
                                                  << endreq;
                             m_rodErr = L1CaloSubBlock::ERROR_SLICES;
                             return;
                         }
-                        if (m_hitsVec0[slice] != 0 || m_hitsVec1[slice] != 0 ||
-                                m_errVec0[slice]  != 0 || m_errVec1[slice]  != 0)
+                        if (m_hitsStage.sliceSet(ch, sl))
                         {
                             if (debug) msg() << "Duplicate data for slice " << slice << endreq;
                             m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
                             return;
                         }
-                        m_hitsVec0[slice] = hits0;
-                        m_hitsVec1[slice] = hits1;
-                        m_errVec0[slice]  = err0;
-                        m_errVec1[slice]  = err1;
-                        ch->addHits(m_hitsVec0, m_hitsVec1, m_errVec0, m_errVec1);
                     }
+                    m_hitsStage.set(ch, CmxHitsInfo::HITS0, sl, hits0);
+                    m_hitsStage.set(ch, CmxHitsInfo::HITS1, sl, hits1);
+                    m_hitsStage.set(ch, CmxHitsInfo::ERROR0, sl, err0);
+                    m_hitsStage.set(ch, CmxHitsInfo::ERROR1, sl, err1);
                 }
             }
         }
@@ -966,6 +1149,14 @@ void CpByteStreamV2Tool::decodeCpm(CpmSubBlockV2 *subBlock, int trigCpm)
         m_rodErr = L1CaloSubBlock::ERROR_SLICES;
         return;
     }
+    // Slices to keep, skipping sub-blocks outside the window
+    const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+    int firstSlice = 0;
+    int numSlices  = timeslices;
+    ModifySlices::window(trigCpm, timeslices, m_sliceWindow, firstSlice, numSlices);
+    if (!neutralFormat &&
+            (sliceNum < firstSlice || sliceNum >= firstSlice + numSlices)) return;
+    const int trigCpmOut = trigCpm - firstSlice;
     // Unpack sub-block
     if (subBlock->dataWords() && !subBlock->unpack())
     {
@@ -979,15 +1170,15 @@ void CpByteStreamV2Tool::decodeCpm(CpmSubBlockV2 *subBlock, int trigCpm)
     }
 
     // Retrieve required data
-    const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
     LVL1::DataError dErr;
     dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
     const int subStatus = dErr.error();
     const int crate     = hwCrate - m_crateOffsetHw;
-    const int sliceBeg  = ( neutralFormat ) ? 0          : sliceNum;
-    const int sliceEnd  = ( neutralFormat ) ? timeslices : sliceNum + 1;
+    const int sliceBeg  = ( neutralFormat ) ? firstSlice             : sliceNum;
+    const int sliceEnd  = ( neutralFormat ) ? firstSlice + numSlices : sliceNum + 1;
     for (int slice = sliceBeg; slice < sliceEnd; ++slice)
     {
+        const int sl = slice - firstSlice;
 
         // Loop over tower channels and fill CPM towers
 
@@ -1024,30 +1215,15 @@ void CpByteStreamV2Tool::decodeCpm(CpmSubBlockV2 *subBlock, int trigCpm)
                     if (layer == m_coreOverlap)
                     {
                         const unsigned int key = m_towerKey->ttKey(phi, eta);
-                        LVL1::CPMTower *tt = findCpmTower(key);
-                        if ( ! tt )     // create new CPM tower
+                        int tt = m_ttStage.find(key);
+                        if (tt < 0)     // stage new CPM tower
                         {
-                            m_emVec.assign(timeslices, 0);
-                            m_hadVec.assign(timeslices, 0);
-                            m_emErrVec.assign(timeslices, 0);
-                            m_hadErrVec.assign(timeslices, 0);
-                            m_emVec[slice]     = em;
-                            m_hadVec[slice]    = had;
-                            m_emErrVec[slice]  = emErr1;
-                            m_hadErrVec[slice] = hadErr1;
-                            tt = new LVL1::CPMTower(phi, eta, m_emVec, m_emErrVec,
-                                                    m_hadVec, m_hadErrVec, trigCpm);
-                            m_ttMap.insert(std::make_pair(key, tt));
-                            m_ttCollection->push_back(tt);
+                            const TowerInfo info = { phi, eta };
+                            tt = m_ttStage.add(key, info, numSlices, trigCpmOut);
                         }
                         else
                         {
-                            m_emVec     = tt->emEnergyVec();
-                            m_hadVec    = tt->hadEnergyVec();
-                            m_emErrVec  = tt->emErrorVec();
-                            m_hadErrVec = tt->hadErrorVec();
-                            const int nsl = m_emVec.size();
-                            if (timeslices != nsl)
+                            if (numSlices != m_ttStage.slices(tt))
                             {
                                 if (debug)
                                 {
@@ -1057,20 +1233,18 @@ void CpByteStreamV2Tool::decodeCpm(CpmSubBlockV2 *subBlock, int trigCpm)
                                 m_rodErr = L1CaloSubBlock::ERROR_SLICES;
                                 return;
                             }
-                            if (m_emVec[slice]    != 0 || m_hadVec[slice]    != 0 ||
-                                    m_emErrVec[slice] != 0 || m_hadErrVec[slice] != 0)
+                            if (m_ttStage.sliceSet(tt, sl))
                             {
                                 if (debug) msg() << "Duplicate data for slice "
                                                      << slice << endreq;
                                 m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
                                 return;
                             }
-                            m_emVec[slice]     = em;
-                            m_hadVec[slice]    = had;
-                            m_emErrVec[slice]  = emErr1;
-                            m_hadErrVec[slice] = hadErr1;
-                            tt->fill(m_emVec, m_emErrVec, m_hadVec, m_hadErrVec, trigCpm);
                         }
+                        m_ttStage.set(tt, TowerInfo::EM, sl, em);
+                        m_ttStage.set(tt, TowerInfo::EM_ERROR, sl, emErr1);
+                        m_ttStage.set(tt, TowerInfo::HAD, sl, had);
+                        m_ttStage.set(tt, TowerInfo::HAD_ERROR, sl, hadErr1);
                     }
                 }
                 else if (verbose && (em || had || emErr || hadErr))
@@ -1205,6 +1379,45 @@ int CpByteStreamV2Tool::hitsKey(const int crate, const int cmx,
     return (((crate << 1) | cmx) << 3) | source;
 }
 
+// Set up the tower key table used when writing bytestream
+// (NB. This assumes mappings won't change during the course of a job)
+
+void CpByteStreamV2Tool::setupChannelKeys()
+{
+    m_chanKeys.assign(m_crates * m_modules * m_channels,
+                      std::make_pair(false, 0u));
+    for (int crate = 0; crate < m_crates; ++crate)
+    {
+        for (int module = 1; module <= m_modules; ++module)
+        {
+            for (int chan = 0; chan < m_channels; ++chan)
+            {
+                double eta = 0.;
+                double phi = 0.;
+                int layer = 0;
+                if (m_cpmMaps->mapping(crate, module, chan, eta, phi, layer))
+                {
+                    const int index = (crate * m_modules + module - 1) * m_channels
+                                      + chan;
+                    m_chanKeys[index] = std::make_pair(true,
+                                                       m_towerKey->ttKey(phi, eta));
+                }
+            }
+        }
+    }
+}
+
+// Return tower key for given crate/module/channel, false if not mapped
+
+bool CpByteStreamV2Tool::channelKey(const int crate, const int module,
+                                    const int chan, unsigned int &key) const
+{
+    const std::pair<bool, unsigned int> &entry =
+        m_chanKeys[(crate * m_modules + module - 1) * m_channels + chan];
+    key = entry.second;
+    return entry.first;
+}
+
 // Get number of slices and triggered slice offset for next slink
 
 bool CpByteStreamV2Tool::slinkSlices(const int crate, const int module,
@@ -1216,11 +1429,8 @@ bool CpByteStreamV2Tool::slinkSlices(const int crate, const int module,
     {
         for (int chan = 0; chan < m_channels; ++chan)
         {
-            double eta = 0.;
-            double phi = 0.;
-            int layer = 0;
-            if ( !m_cpmMaps->mapping(crate, mod, chan, eta, phi, layer)) continue;
-            const unsigned int key = m_towerKey->ttKey(phi, eta);
+            unsigned int key = 0;
+            if ( !channelKey(crate, mod, chan, key)) continue;
             const LVL1::CPMTower *const tt = findCpmTower(key);
             if ( !tt ) continue;
             const int numdat = 4;
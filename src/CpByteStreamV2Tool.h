@@ -5,6 +5,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "AthenaBaseComps/AthAlgTool.h"
@@ -12,10 +13,19 @@
 #include "ByteStreamData/RawEvent.h"
 #include "DataModel/DataVector.h"
 #include "eformat/SourceIdentifier.h"
+#include "GaudiKernel/IIncidentListener.h"
+#include "GaudiKernel/ServiceHandle.h"
 #include "GaudiKernel/ToolHandle.h"
 
+#include "L1CaloCrateRods.h"
+#include "L1CaloObjectPool.h"
+#include "L1CaloRodBuffers.h"
+#include "L1CaloSliceStage.h"
+
 class IInterface;
+class Incident;
 class InterfaceID;
+class SegMemSvc;
 class StatusCode;
 
 template <typename> class FullEventAssembler;
@@ -44,7 +54,8 @@ class L1CaloSrcIdMap;
  *  @author Peter Faulkner
  */
 
-class CpByteStreamV2Tool : public AthAlgTool {
+class CpByteStreamV2Tool : public AthAlgTool,
+                           virtual public IIncidentListener {
 
  public:
    CpByteStreamV2Tool(const std::string& type, const std::string& name,
@@ -57,6 +68,9 @@ class CpByteStreamV2Tool : public AthAlgTool {
    virtual StatusCode initialize();
    virtual StatusCode finalize();
 
+   /// Recycle the object pools at the start of each event
+   virtual void handle(const Incident& inc);
+
    /// Convert ROB fragments to CPM towers
    StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
                       DataVector<LVL1::CPMTower>* ttCollection);
@@ -67,6 +81,12 @@ class CpByteStreamV2Tool : public AthAlgTool {
    StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
                       DataVector<LVL1::CMXCPHits>* hitCollection);
 
+   /// Convert ROB fragments of several events, one collection per event
+   template <class Collection>
+   StatusCode convert(
+       const std::vector<const IROBDataProviderSvc::VROBFRAG*>& robFragsBatch,
+       const std::vector<Collection*>& collections);
+
    /// Convert CP Container to bytestream
    StatusCode convert(const LVL1::CPBSCollectionV2* cp, RawEventWrite* re);
 
@@ -87,14 +107,59 @@ class CpByteStreamV2Tool : public AthAlgTool {
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      ROBPointer;
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      RODPointer;
 
+   /// Staged CPM tower data
+   struct TowerInfo {
+     enum { EM, EM_ERROR, HAD, HAD_ERROR, FIELDS };
+     double phi;
+     double eta;
+   };
+   /// Staged CMX-CP TOB data
+   struct CmxTobInfo {
+     enum { ENERGY, ISOLATION, TOB_ERROR, PRESENCE_MAP, FIELDS };
+     int crate;
+     int cmx;
+     int cpm;
+     int chip;
+     int loc;
+   };
+   /// Staged CMX-CP hits data
+   struct CmxHitsInfo {
+     enum { HITS0, HITS1, ERROR0, ERROR1, FIELDS };
+     int crate;
+     int cmx;
+     int source;
+   };
+
+   /// Output RODs and sub-blocks for encoding one crate
+   struct CrateEncoder {
+     L1CaloCrateRods           rods;
+     DataVector<CpmSubBlockV2> cpmBlocks;
+     DataVector<CmxCpSubBlock> cmxBlocks;
+   };
+
+   /// Set up output collection and return its type
+   CollectionType setCollection(CpmTowerCollection* ttCollection);
+   CollectionType setCollection(CmxCpTobCollection* tobCollection);
+   CollectionType setCollection(CmxCpHitsCollection* hitCollection);
    /// Convert bytestream to given container type
    StatusCode convertBs(const IROBDataProviderSvc::VROBFRAG& robFrags,
                         CollectionType collection);
+   /// Check ROD source ID against ROB ID and configuration
+   bool validRodId(uint32_t sourceID, uint32_t robid);
    /// Unpack CMX-CP sub-block
    void decodeCmxCp(CmxCpSubBlock* subBlock, int trigCpm,
                                              CollectionType collection);
    /// Unpack CPM sub-block
    void decodeCpm(CpmSubBlockV2* subBlock, int trigCpm);
+   /// Create objects from staged slices once all sub-blocks are unpacked
+   void createStaged(CollectionType collection);
+
+   /// Encode the RODs of one crate
+   void encodeCrate(int crate, CrateEncoder& enc, bool debug);
+   /// Set up the tower key table used when writing bytestream
+   void setupChannelKeys();
+   /// Return tower key for given crate/module/channel, false if not mapped
+   bool channelKey(int crate, int module, int chan, unsigned int& key) const;
 
    /// Find a CPM tower for given key
    LVL1::CPMTower*  findCpmTower(unsigned int key);
@@ -119,6 +184,8 @@ class CpByteStreamV2Tool : public AthAlgTool {
    bool slinkSlices(int crate, int module, int modulesPerSlink,
                     int& timeslices, int& trigJem);
 
+   /// Memory service for the object pools
+   ServiceHandle<SegMemSvc> m_sms;
    /// Channel mapping tool
    ToolHandle<LVL1::IL1CaloMappingTool> m_cpmMaps;
    /// Error collection tool
@@ -152,16 +219,24 @@ class CpByteStreamV2Tool : public AthAlgTool {
    int m_dfltSlices;
    /// Force number of slices in bytestream
    int m_forceSlices;
+   /// Number of slices either side of triggered slice to read (-1 = all)
+   int m_sliceWindow;
    /// Minimum crate number when writing out bytestream
    int m_crateMin;
    /// Maximum crate number when writing out bytestream
    int m_crateMax;
+   /// Encode crates concurrently when writing bytestream
+   bool m_parallelCrates;
+   /// Check ROD structure before unpacking
+   bool m_validateRods;
    /// Tower channels to accept (1=Core, 2=Overlap)
    int m_coreOverlap;
    /// Unpacking error code
    unsigned int m_rodErr;
    /// ROB source IDs
    std::vector<uint32_t> m_sourceIDs;
+   /// ROB ID of each ROD source ID already found to be valid
+   std::map<uint32_t, uint32_t> m_validRodIds;
    /// Sub-detector type
    eformat::SubDetector m_subDetector;
    /// Source ID converter
@@ -196,10 +271,10 @@ class CpByteStreamV2Tool : public AthAlgTool {
    std::vector<int> m_emErrVec;
    /// Had error data vector for unpacking
    std::vector<int> m_hadErrVec;
-   /// Vector for current CPM sub-blocks
-   DataVector<CpmSubBlockV2> m_cpmBlocks;
-   /// Vector for current CMX-CP sub-blocks
-   DataVector<CmxCpSubBlock> m_cmxBlocks;
+   /// Per-crate encoders for writing bytestream
+   DataVector<CrateEncoder> m_crateEncoders;
+   /// Tower keys by crate/module/channel for writing bytestream
+   std::vector<std::pair<bool, unsigned int> > m_chanKeys;
    /// Current CPM tower collection
    CpmTowerCollection*  m_ttCollection;
    /// Current CMX-CP TOB collection
@@ -212,15 +287,54 @@ class CpByteStreamV2Tool : public AthAlgTool {
    CmxCpTobMap  m_tobMap;
    /// CMX-CP hits map
    CmxCpHitsMap m_hitsMap;
+   /// CPM tower slices staged for creation
+   L1CaloSliceStage<TowerInfo>   m_ttStage;
+   /// CMX-CP TOB slices staged for creation
+   L1CaloSliceStage<CmxTobInfo>  m_tobStage;
+   /// CMX-CP hits slices staged for creation
+   L1CaloSliceStage<CmxHitsInfo> m_hitsStage;
+   /// CPM tower pool
+   L1CaloObjectPool<LVL1::CPMTower>  m_ttPool;
+   /// CMX-CP TOB pool
+   L1CaloObjectPool<LVL1::CMXCPTob>  m_tobPool;
+   /// CMX-CP hits pool
+   L1CaloObjectPool<LVL1::CMXCPHits> m_hitsPool;
    /// ROD Status words
    std::vector<uint32_t>* m_rodStatus;
    /// ROD status map
    std::map<uint32_t, std::vector<uint32_t>* > m_rodStatusMap;
    /// Event assembler
    FullEventAssembler<L1CaloSrcIdMap>* m_fea;
+   /// ROD buffer sizes for writing
+   L1CaloRodBuffers m_rodBuffers;
 
 };
 
+// Decode the events back to back.  The ROB fragments are fetched by the
+// caller; here the ROD source IDs checked for one event are not looked
+// up again and the sub-blocks and staging areas are reused throughout.
+
+template <class Collection>
+StatusCode CpByteStreamV2Tool::convert(
+    const std::vector<const IROBDataProviderSvc::VROBFRAG*>& robFragsBatch,
+    const std::vector<Collection*>& collections)
+{
+    if (robFragsBatch.size() != collections.size())
+    {
+        msg(MSG::ERROR) << "Batch of " << robFragsBatch.size()
+                        << " events given " << collections.size()
+                        << " collections" << endreq;
+        return StatusCode::FAILURE;
+    }
+    for (size_t evt = 0; evt < robFragsBatch.size(); ++evt)
+    {
+        const CollectionType type = setCollection(collections[evt]);
+        const StatusCode sc = convertBs(*robFragsBatch[evt], type);
+        if (sc.isFailure()) return sc;
+    }
+    return StatusCode::SUCCESS;
+}
+
 } // end namespace
 
 #endif
@@ -13,6 +13,7 @@
 
 #include "CpmRoiSubBlock.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloUserHeader.h"
 
@@ -117,7 +118,7 @@ StatusCode CpmRoiByteStreamTool::convert(
   // Loop over ROB fragments
 
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
   std::set<uint32_t> dupRoiCheck;
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();
@@ -143,7 +144,7 @@ StatusCode CpmRoiByteStreamTool::convert(
 
     // Skip duplicate fragments
 
-    if (!dupCheck.insert(robid).second) {
+    if (!dupCheck.insert(robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
       if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
       continue;
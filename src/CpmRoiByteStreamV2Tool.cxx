@@ -13,6 +13,7 @@
 
 #include "CpmRoiSubBlockV2.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloUserHeader.h"
 
@@ -129,8 +130,10 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
     // Loop over ROB fragments
 
     int robCount = 0;
-    std::set<uint32_t> dupCheck;
+    L1CaloRobIdSet dupCheck;
     std::set<uint32_t> dupRoiCheck;
+    // Reserve for the maximum possible number of RoIs (2 per pin)
+    roiCollection->reserve(roiCollection->size() + m_crates * m_modules * 32);
     ROBIterator rob    = robFrags.begin();
     ROBIterator robEnd = robFrags.end();
     for (; rob != robEnd; ++rob)
@@ -159,7 +162,7 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
 
         // Skip duplicate fragments
 
-        if (!dupCheck.insert(robid).second)
+        if (!dupCheck.insert(robid))
         {
             m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
             if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
@@ -243,8 +246,8 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
                     msg() << "CPM RoI sub-block: Crate " << m_subBlock->crate()
                           << "  Module " << m_subBlock->module() << endreq;
                 }
-                // Unpack sub-block
-                if (m_subBlock->dataWords() && !m_subBlock->unpack())
+                // Unpack sub-block straight into the collection
+                if (m_subBlock->dataWords() && !m_subBlock->unpack(roiCollection))
                 {
                     if (debug)
                     {
@@ -254,23 +257,6 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
                     rodErr = m_subBlock->unpackErrorCode();
                     break;
                 }
-                const int numChips = 8;
-                const int numLocs  = 2;
-                const int numTypes = 2;
-                for (int chip = 0; chip < numChips; ++chip)
-                {
-                    for (int loc = 0; loc < numLocs; ++loc)
-                    {
-                        for (int type = 0; type < numTypes; ++type)
-                        {
-                            const LVL1::CPMTobRoI roi = m_subBlock->roi(chip, loc, type);
-                            if (roi.energy() || roi.isolation())
-                            {
-                                roiCollection->push_back(new LVL1::CPMTobRoI(roi));
-                            }
-                        }
-                    }
-                }
             }
             else
             {
@@ -348,6 +334,7 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
     const uint16_t minorVersion = m_srcIdMap->minorVersion();
     m_fea->setRodMinorVersion(minorVersion);
     m_rodStatusMap.clear();
+    m_rodBuffers.clear();
 
     // Pointer to ROD data vector
 
@@ -395,7 +382,7 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
                 }
                 const uint32_t rodIdCpm = m_srcIdMap->getRodID(hwCrate, slink, daqOrRoi,
                                           m_subDetector);
-                theROD = m_fea->getRodData(rodIdCpm);
+                theROD = m_rodBuffers.getRodData(m_fea, rodIdCpm, 1);
                 if (neutralFormat)
                 {
                     const L1CaloUserHeader userHeader;
@@ -455,6 +442,7 @@ StatusCode CpmRoiByteStreamV2Tool::convert(
 
     // Fill the raw event
 
+    m_rodBuffers.record();
     m_fea->fill(re, msg());
     if (debug) msg() << MSG::dec; // fill seems to leave it in hex
 
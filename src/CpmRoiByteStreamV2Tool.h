@@ -14,6 +14,8 @@
 #include "eformat/SourceIdentifier.h"
 #include "GaudiKernel/ToolHandle.h"
 
+#include "L1CaloRodBuffers.h"
+
 class IInterface;
 class InterfaceID;
 class StatusCode;
@@ -112,6 +114,8 @@ class CpmRoiByteStreamV2Tool : public AthAlgTool {
    std::map<uint32_t, std::vector<uint32_t>* > m_rodStatusMap;
    /// Event assembler
    FullEventAssembler<L1CaloSrcIdMap>* m_fea;
+   /// ROD buffer sizes for writing
+   L1CaloRodBuffers m_rodBuffers;
 
    // M7 format follows old specification, so we have two zeros 
    // as most significant bits instead of 0xa
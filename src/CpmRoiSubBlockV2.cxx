@@ -86,13 +86,18 @@ bool CpmRoiSubBlockV2::pack()
 }
 
 bool CpmRoiSubBlockV2::unpack()
+{
+  return unpack(0);
+}
+
+bool CpmRoiSubBlockV2::unpack(DataVector<LVL1::CPMTobRoI>* const roiCollection)
 {
   bool rc = false;
   switch (version()) {
     case 2:                                     // <<== CHECK
       switch (format()) {
         case NEUTRAL:
-	  rc = unpackNeutral();
+	  rc = unpackNeutral(roiCollection);
 	  break;
         default:
 	  setUnpackErrorCode(UNPACK_FORMAT);
@@ -135,10 +140,16 @@ bool CpmRoiSubBlockV2::packNeutral()
 }
 
 // Unpack neutral data
+// If a collection is given non-zero RoIs are created directly in it,
+// otherwise all RoIs are stored in m_roiData for access via roi().
 
-bool CpmRoiSubBlockV2::unpackNeutral()
+bool CpmRoiSubBlockV2::unpackNeutral(DataVector<LVL1::CPMTobRoI>* const
+                                                               roiCollection)
 {
-  m_roiData.resize(2*s_glinkPins);
+  const size_t oldSize = (roiCollection) ? roiCollection->size() : 0;
+  if (!roiCollection) m_roiData.resize(2*s_glinkPins);
+  const int crate  = this->crate();
+  const int module = this->module();
   int bunchCrossing = 0;
   for (int pin = 0; pin < s_glinkPins; ++pin) {
     // RoI data
@@ -152,11 +163,22 @@ bool CpmRoiSubBlockV2::unpackNeutral()
     const int loc = unpackerNeutral(pin, s_locationLen) |
                                            ((pin & 0x1) << s_locationLen);
     const int chip = pin >> 1;
-    const int idx = 2*pin;
-    m_roiData[idx] = LVL1::CPMTobRoI(crate(), module(), chip, loc, 0,
-                                                        energyEm, isolEm);
-    m_roiData[idx+1] = LVL1::CPMTobRoI(crate(), module(), chip, loc, 1,
-                                                      energyTau, isolTau);
+    if (roiCollection) {
+      if (energyEm || isolEm) {
+        roiCollection->push_back(new LVL1::CPMTobRoI(crate, module, chip, loc,
+                                                     0, energyEm, isolEm));
+      }
+      if (energyTau || isolTau) {
+        roiCollection->push_back(new LVL1::CPMTobRoI(crate, module, chip, loc,
+                                                     1, energyTau, isolTau));
+      }
+    } else {
+      const int idx = 2*pin;
+      m_roiData[idx] = LVL1::CPMTobRoI(crate, module, chip, loc, 0,
+                                                          energyEm, isolEm);
+      m_roiData[idx+1] = LVL1::CPMTobRoI(crate, module, chip, loc, 1,
+                                                        energyTau, isolTau);
+    }
     // Bunch Crossing number
     if (pin < s_bunchCrossingBits) {
       bunchCrossing |= unpackerNeutral(pin, 1) << pin;
@@ -166,7 +188,14 @@ bool CpmRoiSubBlockV2::unpackNeutral()
   }
   setBunchCrossing(bunchCrossing);
   const bool rc = unpackerSuccess();
-  if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+  if (!rc) {
+    setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+    // Don't leave RoIs from a truncated sub-block behind
+    if (roiCollection) {
+      roiCollection->erase(roiCollection->begin() + oldSize,
+                           roiCollection->end());
+    }
+  }
   return rc;
 }
 
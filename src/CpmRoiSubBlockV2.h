@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "DataModel/DataVector.h"
+
 #include "L1CaloSubBlock.h"
 
 namespace LVL1 {
@@ -40,6 +42,8 @@ class CpmRoiSubBlockV2 : public L1CaloSubBlock {
    bool pack();
    /// Unpack data
    bool unpack();
+   /// Unpack data directly into collection (non-zero RoIs only)
+   bool unpack(DataVector<LVL1::CPMTobRoI>* roiCollection);
 
  private:
    /// Header word ID
@@ -53,8 +57,8 @@ class CpmRoiSubBlockV2 : public L1CaloSubBlock {
 
    /// Pack neutral data
    bool packNeutral();
-   /// Unpack neutral data
-   bool unpackNeutral();
+   /// Unpack neutral data, into collection if given
+   bool unpackNeutral(DataVector<LVL1::CPMTobRoI>* roiCollection = 0);
 
    /// RoI words
    std::vector<LVL1::CPMTobRoI> m_roiData;
@@ -86,13 +86,18 @@ bool JemRoiSubBlockV2::pack()
 }
 
 bool JemRoiSubBlockV2::unpack()
+{
+  return unpack(0);
+}
+
+bool JemRoiSubBlockV2::unpack(DataVector<LVL1::JEMTobRoI>* const roiCollection)
 {
   bool rc = false;
   switch (version()) {
     case 2:                                               //<< CHECK
       switch (format()) {
         case NEUTRAL:
-	  rc = unpackNeutral();
+	  rc = unpackNeutral(roiCollection);
 	  break;
         default:
 	  setUnpackErrorCode(UNPACK_FORMAT);
@@ -133,10 +138,16 @@ bool JemRoiSubBlockV2::packNeutral()
 }
 
 // Unpack neutral data
+// If a collection is given non-zero RoIs are created directly in it,
+// otherwise all RoIs are stored in m_roiData for access via roi().
 
-bool JemRoiSubBlockV2::unpackNeutral()
+bool JemRoiSubBlockV2::unpackNeutral(DataVector<LVL1::JEMTobRoI>* const
+                                                               roiCollection)
 {
-  m_roiData.resize(s_frames);
+  const size_t oldSize = (roiCollection) ? roiCollection->size() : 0;
+  if (!roiCollection) m_roiData.resize(s_frames);
+  const int crate  = this->crate();
+  const int module = this->module();
   int maxPin  = 0;
   // RoI data
   for (int frame = 0; frame < s_frames; ++frame) {
@@ -146,8 +157,15 @@ bool JemRoiSubBlockV2::unpackNeutral()
                         unpackerNeutral(pin1, 1);
     const int enSmall = unpackerNeutral(pin2, s_energySmallBits);
     const int loc     = unpackerNeutral(pin2, s_locationBits);
-    m_roiData[frame] = LVL1::JEMTobRoI(crate(), module(),
+    if (roiCollection) {
+      if (enLarge || enSmall) {
+        roiCollection->push_back(new LVL1::JEMTobRoI(crate, module,
+                                               frame, loc, enLarge, enSmall));
+      }
+    } else {
+      m_roiData[frame] = LVL1::JEMTobRoI(crate, module,
                                                frame, loc, enLarge, enSmall);
+    }
     maxPin = pin2;
   }
   // Bunch Crossing number
@@ -156,7 +174,14 @@ bool JemRoiSubBlockV2::unpackNeutral()
   // G-Link parity
   for (int pin = 0; pin <= maxPin; ++pin) unpackerNeutralParityError(pin);
   const bool rc = unpackerSuccess();
-  if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+  if (!rc) {
+    setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+    // Don't leave RoIs from a truncated sub-block behind
+    if (roiCollection) {
+      roiCollection->erase(roiCollection->begin() + oldSize,
+                           roiCollection->end());
+    }
+  }
   return rc;
 }
 
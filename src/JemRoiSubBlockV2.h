@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "DataModel/DataVector.h"
+
 #include "L1CaloSubBlock.h"
 
 namespace LVL1 {
@@ -40,6 +42,8 @@ class JemRoiSubBlockV2 : public L1CaloSubBlock {
    bool pack();
    /// Unpack data
    bool unpack();
+   /// Unpack data directly into collection (non-zero RoIs only)
+   bool unpack(DataVector<LVL1::JEMTobRoI>* roiCollection);
 
  private:
    /// Header word ID
@@ -56,8 +60,8 @@ class JemRoiSubBlockV2 : public L1CaloSubBlock {
 
    /// Pack neutral data
    bool packNeutral();
-   /// Unpack neutral data
-   bool unpackNeutral();
+   /// Unpack neutral data, into collection if given
+   bool unpackNeutral(DataVector<LVL1::JEMTobRoI>* roiCollection = 0);
 
    /// RoIs
    std::vector<LVL1::JEMTobRoI> m_roiData;
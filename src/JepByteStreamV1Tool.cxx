@@ -1,6 +1,5 @@
 
 #include <numeric>
-#include <set>
 #include <utility>
 
 #include "GaudiKernel/IInterface.h"
@@ -25,6 +24,7 @@
 #include "JemJetElement.h"
 #include "JemSubBlockV1.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 #include "L1CaloUserHeader.h"
@@ -595,7 +595,7 @@ StatusCode JepByteStreamV1Tool::convertBs(
   // Loop over ROB fragments
 
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();
   for (; rob != robEnd; ++rob) {
@@ -620,7 +620,7 @@ StatusCode JepByteStreamV1Tool::convertBs(
 
     // Skip duplicate fragments
 
-    if (!dupCheck.insert(robid).second) {
+    if (!dupCheck.insert(robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
       if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
       continue;
@@ -1,13 +1,16 @@
 
 #include <numeric>
-#include <set>
+#include <sstream>
 #include <utility>
 
+#include "GaudiKernel/IIncidentSvc.h"
 #include "GaudiKernel/IInterface.h"
+#include "GaudiKernel/Incident.h"
 #include "GaudiKernel/MsgStream.h"
 #include "GaudiKernel/StatusCode.h"
 
 #include "ByteStreamCnvSvcBase/FullEventAssembler.h"
+#include "StoreGate/SegMemSvc.h"
 
 #include "TrigT1CaloEvent/CMXJetHits.h"
 #include "TrigT1CaloEvent/CMXJetTob.h"
@@ -24,7 +27,10 @@
 #include "CmxSubBlock.h"
 #include "JemJetElement.h"
 #include "JemSubBlockV2.h"
+#include "L1CaloCrateRods.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
+#include "L1CaloRodValidator.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 #include "L1CaloUserHeader.h"
@@ -49,6 +55,7 @@ JepByteStreamV2Tool::JepByteStreamV2Tool(const std::string& type,
                                      const std::string& name,
 				     const IInterface*  parent)
   : AthAlgTool(type, name, parent),
+    m_sms("SegMemSvc/SegMemSvc", name),
     m_jemMaps("LVL1::JemMappingTool/JemMappingTool"),
     m_errorTool("LVL1BS::L1CaloErrorByteStreamTool/L1CaloErrorByteStreamTool"),
     m_channels(44), m_crates(2), m_modules(16), m_frames(8), m_locations(4),
@@ -75,6 +82,8 @@ JepByteStreamV2Tool::JepByteStreamV2Tool(const std::string& type,
   // Properties for reading bytestream only
   declareProperty("ROBSourceIDs",       m_sourceIDs,
                   "ROB fragment source identifiers");
+  declareProperty("SliceWindow",        m_sliceWindow = -1,
+                  "If >=0, only read slices within this distance of triggered slice");
 
   // Properties for writing bytestream only
   declareProperty("DataVersion",    m_version     = 2,                      //<<== CHECK
@@ -89,6 +98,10 @@ JepByteStreamV2Tool::JepByteStreamV2Tool(const std::string& type,
                   "Minimum crate number, allows partial output");
   declareProperty("CrateMax",       m_crateMax = m_crates-1,
                   "Maximum crate number, allows partial output");
+  declareProperty("ParallelCrates", m_parallelCrates = false,
+                  "Encode each crate on its own thread");
+  declareProperty("ValidateRods",   m_validateRods = true,
+                  "Reject RODs with bad sub-block structure before unpacking");
 
 }
 
@@ -121,6 +134,26 @@ StatusCode JepByteStreamV2Tool::initialize()
     return sc;
   } else msg(MSG::INFO) << "Retrieved tool " << m_errorTool << endreq;
 
+  sc = m_sms.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve service " << m_sms << endreq;
+    return sc;
+  } else msg(MSG::INFO) << "Retrieved service " << m_sms << endreq;
+
+  ServiceHandle<IIncidentSvc> incSvc("IncidentSvc", name());
+  sc = incSvc.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve service " << incSvc << endreq;
+    return sc;
+  }
+  incSvc->addListener(this, IncidentType::BeginEvent);
+
+  m_jePool.setMemSvc(&*m_sms);
+  m_etPool.setMemSvc(&*m_sms);
+  m_cmxTobPool.setMemSvc(&*m_sms);
+  m_cmxHitsPool.setMemSvc(&*m_sms);
+  m_cmxEtPool.setMemSvc(&*m_sms);
+
   m_srcIdMap          = new L1CaloSrcIdMap();
   m_elementKey        = new LVL1::JetElementKey();
   m_jemSubBlock       = new JemSubBlockV2();
@@ -135,6 +168,19 @@ StatusCode JepByteStreamV2Tool::initialize()
 
 StatusCode JepByteStreamV2Tool::finalize()
 {
+  msg(MSG::INFO) << "Pool usage (peak objects/bytes): JetElement "
+                 << m_jePool.peak() << "/" << m_jePool.bytes()
+                 << "  JEMEtSums " << m_etPool.peak() << "/" << m_etPool.bytes()
+                 << "  CMXJetTob " << m_cmxTobPool.peak() << "/"
+                 << m_cmxTobPool.bytes() << "  CMXJetHits "
+                 << m_cmxHitsPool.peak() << "/" << m_cmxHitsPool.bytes()
+                 << "  CMXEtSums " << m_cmxEtPool.peak() << "/"
+                 << m_cmxEtPool.bytes() << endreq;
+  m_cmxEtPool.clear();
+  m_cmxHitsPool.clear();
+  m_cmxTobPool.clear();
+  m_etPool.clear();
+  m_jePool.clear();
   delete m_fea;
   delete m_rodStatus;
   delete m_cmxJetSubBlock;
@@ -145,15 +191,26 @@ StatusCode JepByteStreamV2Tool::finalize()
   return StatusCode::SUCCESS;
 }
 
+// Start of event - previous event's collections have been cleared
+
+void JepByteStreamV2Tool::handle(const Incident& inc)
+{
+  if (inc.type() == IncidentType::BeginEvent) {
+    m_jePool.clear();
+    m_etPool.clear();
+    m_cmxTobPool.clear();
+    m_cmxHitsPool.clear();
+    m_cmxEtPool.clear();
+  }
+}
+
 // Conversion bytestream to jet elements
 
 StatusCode JepByteStreamV2Tool::convert(
                             const IROBDataProviderSvc::VROBFRAG& robFrags,
                             DataVector<LVL1::JetElement>* const jeCollection)
 {
-  m_jeCollection = jeCollection;
-  m_jeMap.clear();
-  return convertBs(robFrags, JET_ELEMENTS);
+  return convertBs(robFrags, setCollection(jeCollection));
 }
 
 // Conversion bytestream to energy sums
@@ -162,9 +219,7 @@ StatusCode JepByteStreamV2Tool::convert(
                             const IROBDataProviderSvc::VROBFRAG& robFrags,
                             DataVector<LVL1::JEMEtSums>* const etCollection)
 {
-  m_etCollection = etCollection;
-  m_etMap.clear();
-  return convertBs(robFrags, ENERGY_SUMS);
+  return convertBs(robFrags, setCollection(etCollection));
 }
 
 // Conversion bytestream to CMX TOBs
@@ -173,9 +228,7 @@ StatusCode JepByteStreamV2Tool::convert(
                             const IROBDataProviderSvc::VROBFRAG& robFrags,
                             DataVector<LVL1::CMXJetTob>* const tobCollection)
 {
-  m_cmxTobCollection = tobCollection;
-  m_cmxTobMap.clear();
-  return convertBs(robFrags, CMX_TOBS);
+  return convertBs(robFrags, setCollection(tobCollection));
 }
 
 // Conversion bytestream to CMX hits
@@ -184,9 +237,7 @@ StatusCode JepByteStreamV2Tool::convert(
                             const IROBDataProviderSvc::VROBFRAG& robFrags,
                             DataVector<LVL1::CMXJetHits>* const hitCollection)
 {
-  m_cmxHitCollection = hitCollection;
-  m_cmxHitsMap.clear();
-  return convertBs(robFrags, CMX_HITS);
+  return convertBs(robFrags, setCollection(hitCollection));
 }
 
 // Conversion bytestream to CMX energy sums
@@ -195,9 +246,7 @@ StatusCode JepByteStreamV2Tool::convert(
                             const IROBDataProviderSvc::VROBFRAG& robFrags,
                             DataVector<LVL1::CMXEtSums>* const etCollection)
 {
-  m_cmxEtCollection = etCollection;
-  m_cmxEtMap.clear();
-  return convertBs(robFrags, CMX_SUMS);
+  return convertBs(robFrags, setCollection(etCollection));
 }
 
 // Conversion of JEP container to bytestream
@@ -214,10 +263,7 @@ StatusCode JepByteStreamV2Tool::convert(const LVL1::JEPBSCollectionV2* const jep
   const uint16_t minorVersion = m_srcIdMap->minorVersion();
   m_fea->setRodMinorVersion(minorVersion);
   m_rodStatusMap.clear();
-
-  // Pointer to ROD data vector
-
-  FullEventAssembler<L1CaloSrcIdMap>::RODDATA* theROD = 0;
+  m_rodBuffers.clear();
 
   // Set up the container maps
 
@@ -227,7 +273,53 @@ StatusCode JepByteStreamV2Tool::convert(const LVL1::JEPBSCollectionV2* const jep
   setupCmxHitsMap(jep->CmxHits());
   setupCmxEtMap(jep->CmxSums());
 
-  // Loop over data
+  // Encode the crates, concurrently if requested, then add their RODs
+  // to the event in crate order so the output is always the same
+
+  if (m_chanKeys.empty()) setupChannelKeys();
+  const bool parallel = m_parallelCrates && m_crateMax > m_crateMin;
+  const bool crateDebug = debug && !parallel;
+  encodeCrates(m_crateEncoders, m_crateMin, m_crateMax, parallel,
+               [this, crateDebug](int crate, CrateEncoder& enc)
+               { encodeCrate(crate, enc, crateDebug); });
+  std::vector<uint32_t> rodIds;
+  for (int crate = m_crateMin; crate <= m_crateMax; ++crate) {
+    const CrateEncoder* const enc = m_crateEncoders[crate - m_crateMin];
+    if (enc->rods.failed()) {
+      msg(MSG::ERROR) << enc->rods.error() << endreq;
+      return StatusCode::FAILURE;
+    }
+    enc->rods.merge(m_fea, m_rodBuffers);
+    enc->rods.rodIds(rodIds);
+    for (size_t i = 0; i < rodIds.size(); ++i) {
+      m_rodStatusMap.insert(make_pair(rodIds[i], m_rodStatus));
+    }
+  }
+
+  // Fill the raw event
+
+  m_rodBuffers.record();
+  m_fea->fill(re, msg());
+
+  // Set ROD status words
+
+  //L1CaloRodStatus::setStatus(re, m_rodStatusMap, m_srcIdMap);
+
+  return StatusCode::SUCCESS;
+}
+
+// Encode the RODs of one crate.  Uses no tool state which changes during
+// encoding, so crates can be done on separate threads.
+
+void JepByteStreamV2Tool::encodeCrate(const int crate, CrateEncoder& enc,
+                                      const bool debug)
+{
+  if (debug) msg(MSG::DEBUG);
+  enc.rods.clear();
+
+  // Pointer to ROD data vector
+
+  FullEventAssembler<L1CaloSrcIdMap>::RODDATA* theROD = 0;
 
   const bool neutralFormat = m_dataFormat == L1CaloSubBlock::NEUTRAL;
   const int modulesPerSlink = m_modules / m_slinks;
@@ -235,344 +327,331 @@ StatusCode JepByteStreamV2Tool::convert(const LVL1::JEPBSCollectionV2* const jep
   int trigJem          = 0;
   int timeslicesNew    = 1;
   int trigJemNew       = 0;
-  for (int crate = m_crateMin; crate <= m_crateMax; ++crate) {
-    const int hwCrate = crate + m_crateOffsetHw;
+  const int hwCrate = crate + m_crateOffsetHw;
 
-    for (int module=0; module < m_modules; ++module) {
+  for (int module=0; module < m_modules; ++module) {
 
-      // Pack required number of modules per slink
+    // Pack required number of modules per slink
 
-      if (module%modulesPerSlink == 0) {
-	const int daqOrRoi = 0;
-	const int slink = module/modulesPerSlink;
-        if (debug) {
-          msg() << "Treating crate " << hwCrate
-                << " slink " << slink << endreq;
-        }
-	// Get number of JEM slices and triggered slice offset
-	// for this slink
-	if ( ! slinkSlices(crate, module, modulesPerSlink,
-	                                  timeslices, trigJem)) {
-	  msg(MSG::ERROR) << "Inconsistent number of slices or "
-	                  << "triggered slice offsets in data for crate "
-	                  << hwCrate << " slink " << slink << endreq;
-	  return StatusCode::FAILURE;
-        }
-	timeslicesNew = (m_forceSlices) ? m_forceSlices : timeslices;
-	trigJemNew    = ModifySlices::peak(trigJem, timeslices, timeslicesNew);
-        if (debug) {
-	  msg() << "Data Version/Format: " << m_version
-	        << " " << m_dataFormat << endreq
-                << "Slices/offset: " << timeslices << " " << trigJem;
-	  if (timeslices != timeslicesNew) {
-	    msg() << " modified to " << timeslicesNew << " " << trigJemNew;
-          }
-	  msg() << endreq;
-        }
-        L1CaloUserHeader userHeader;
-        userHeader.setJem(trigJemNew);
-	const uint32_t rodIdJem = m_srcIdMap->getRodID(hwCrate, slink, daqOrRoi,
-	                                                        m_subDetector);
-	theROD = m_fea->getRodData(rodIdJem);
-	theROD->push_back(userHeader.header());
-	m_rodStatusMap.insert(make_pair(rodIdJem, m_rodStatus));
+    if (module%modulesPerSlink == 0) {
+      const int daqOrRoi = 0;
+      const int slink = module/modulesPerSlink;
+      if (debug) {
+        msg() << "Treating crate " << hwCrate
+              << " slink " << slink << endreq;
       }
-      if (debug) msg() << "Module " << module << endreq;
-
-      // Create a sub-block for each slice (except Neutral format)
-
-      m_jemBlocks.clear();
-      for (int slice = 0; slice < timeslicesNew; ++slice) {
-        JemSubBlockV2* const subBlock = new JemSubBlockV2();
-	subBlock->setJemHeader(m_version, m_dataFormat, slice,
-	                       hwCrate, module, timeslicesNew);
-        m_jemBlocks.push_back(subBlock);
-	if (neutralFormat) break;
+      // Get number of JEM slices and triggered slice offset
+      // for this slink
+      if ( ! slinkSlices(crate, module, modulesPerSlink,
+                                        timeslices, trigJem)) {
+        std::ostringstream error;
+        error << "Inconsistent number of slices or "
+              << "triggered slice offsets in data for crate "
+              << hwCrate << " slink " << slink;
+        enc.rods.setError(error.str());
+        return;
       }
-
-      // Find jet elements corresponding to each eta/phi pair and fill
-      // sub-blocks
-
-      for (int chan=0; chan < m_channels; ++chan) {
-	double eta = 0.;
-	double phi = 0.;
-	int layer = 0;
-	if (m_jemMaps->mapping(crate, module, chan, eta, phi, layer)) {
-          const LVL1::JetElement* const je = findJetElement(eta, phi);
-	  if (je ) {
-	    std::vector<int> emData;
-	    std::vector<int> hadData;
-	    std::vector<int> emErrors;
-	    std::vector<int> hadErrors;
-	    ModifySlices::data(je->emEnergyVec(),  emData,    timeslicesNew);
-	    ModifySlices::data(je->hadEnergyVec(), hadData,   timeslicesNew);
-	    ModifySlices::data(je->emErrorVec(),   emErrors,  timeslicesNew);
-	    ModifySlices::data(je->hadErrorVec(),  hadErrors, timeslicesNew);
-            for (int slice = 0; slice < timeslicesNew; ++slice) {
-	      const LVL1::DataError emErrBits(emErrors[slice]);
-	      const LVL1::DataError hadErrBits(hadErrors[slice]);
-	      const int index = ( neutralFormat ) ? 0 : slice;
-              JemSubBlockV2* const subBlock = m_jemBlocks[index];
-	      const JemJetElement jetEle(chan, emData[slice], hadData[slice],
-	                  emErrBits.get(LVL1::DataError::Parity),
-	                  hadErrBits.get(LVL1::DataError::Parity),
-			  emErrBits.get(LVL1::DataError::LinkDown) +
-			 (hadErrBits.get(LVL1::DataError::LinkDown) << 1));
-              subBlock->fillJetElement(slice, jetEle);
-	      if ((emErrBits.error() >> LVL1::DataError::GLinkParity)) {
-	        int gLinkParity   = emErrBits.get(LVL1::DataError::GLinkParity);
-		int gLinkProtocol = emErrBits.get(LVL1::DataError::GLinkProtocol);
-		int bCNMismatch   = emErrBits.get(LVL1::DataError::BCNMismatch);
-		int fIFOOverflow  = emErrBits.get(LVL1::DataError::FIFOOverflow);
-		int moduleError   = emErrBits.get(LVL1::DataError::ModuleError);
-		int gLinkDown     = emErrBits.get(LVL1::DataError::GLinkDown);
-		int gLinkTimeout  = emErrBits.get(LVL1::DataError::GLinkTimeout);
-		uint32_t failingBCN = emErrBits.get(LVL1::DataError::FailingBCN);
-		subBlock->setStatus(failingBCN, gLinkTimeout, gLinkDown,
-		                    moduleError, fIFOOverflow, bCNMismatch,
-				    gLinkProtocol, gLinkParity);
-	      }
-	    }
-          }
+      timeslicesNew = (m_forceSlices) ? m_forceSlices : timeslices;
+      trigJemNew    = ModifySlices::peak(trigJem, timeslices, timeslicesNew);
+      if (debug) {
+        msg() << "Data Version/Format: " << m_version
+              << " " << m_dataFormat << endreq
+              << "Slices/offset: " << timeslices << " " << trigJem;
+        if (timeslices != timeslicesNew) {
+          msg() << " modified to " << timeslicesNew << " " << trigJemNew;
         }
+        msg() << endreq;
       }
+      L1CaloUserHeader userHeader;
+      userHeader.setJem(trigJemNew);
+      const uint32_t rodIdJem = m_srcIdMap->getRodID(hwCrate, slink, daqOrRoi,
+                                                              m_subDetector);
+      theROD = enc.rods.newRod(rodIdJem, timeslicesNew);
+      theROD->push_back(userHeader.header());
+    }
+    if (debug) msg() << "Module " << module << endreq;
 
-      // Add energy subsums
+    // Set up a sub-block for each slice (except Neutral format),
+    // reusing the blocks and their buffers from previous modules
 
-      const LVL1::JEMEtSums* const et = findEnergySums(crate, module);
-      if (et) {
-        std::vector<unsigned int> exVec;
-        std::vector<unsigned int> eyVec;
-        std::vector<unsigned int> etVec;
-	ModifySlices::data(et->ExVec(), exVec, timeslicesNew);
-	ModifySlices::data(et->EyVec(), eyVec, timeslicesNew);
-	ModifySlices::data(et->EtVec(), etVec, timeslicesNew);
-	for (int slice = 0; slice < timeslicesNew; ++slice) {
-	  const int index = ( neutralFormat ) ? 0 : slice;
-	  JemSubBlockV2* const subBlock = m_jemBlocks[index];
-	  subBlock->setEnergySubsums(slice, exVec[slice], eyVec[slice],
-	                                                  etVec[slice]);
-        }
-      }
-      
-      // Pack and write the sub-blocks
-
-      DataVector<JemSubBlockV2>::const_iterator pos;
-      for (pos = m_jemBlocks.begin(); pos != m_jemBlocks.end(); ++pos) {
-        JemSubBlockV2* const subBlock = *pos;
-	if ( !subBlock->pack()) {
-	  msg(MSG::ERROR) << "JEM sub-block packing failed" << endreq;
-	  return StatusCode::FAILURE;
-	}
-	if (debug) {
-	  msg() << "JEM sub-block data words: "
-	        << subBlock->dataWords() << endreq;
-	}
-	subBlock->write(theROD);
-      }
+    const int jemBlocks = (neutralFormat) ? 1 : timeslicesNew;
+    while (static_cast<int>(enc.jemBlocks.size()) < jemBlocks) {
+      enc.jemBlocks.push_back(new JemSubBlockV2());
     }
-
-    // Append CMXs to last S-Link of the crate
-
-    // Create a sub-block for each slice (except Neutral format)
-
-    m_cmxEnergyBlocks.clear();
-    m_cmxJetBlocks.clear();
-    const int summing = (crate == m_crates - 1) ? CmxSubBlock::SYSTEM
-                                                : CmxSubBlock::CRATE;
-    for (int slice = 0; slice < timeslicesNew; ++slice) {
-      CmxEnergySubBlock* const enBlock = new CmxEnergySubBlock();
-      const int cmxEnergyVersion = 3;                             // <<== CHECK  Make jo property for each sub-block?
-      enBlock->setCmxHeader(cmxEnergyVersion, m_dataFormat, slice, hwCrate,
-                            summing, CmxSubBlock::CMX_ENERGY,
-			    CmxSubBlock::LEFT, timeslicesNew);
-      m_cmxEnergyBlocks.push_back(enBlock);
-      CmxJetSubBlock* const jetBlock = new CmxJetSubBlock();
-      jetBlock->setCmxHeader(m_version, m_dataFormat, slice, hwCrate,
-                             summing, CmxSubBlock::CMX_JET,
-			     CmxSubBlock::RIGHT, timeslicesNew);
-      m_cmxJetBlocks.push_back(jetBlock);
-      if (neutralFormat) break;
+    for (int slice = 0; slice < jemBlocks; ++slice) {
+      JemSubBlockV2* const subBlock = enc.jemBlocks[slice];
+      subBlock->clear();
+      subBlock->setJemHeader(m_version, m_dataFormat, slice,
+                             hwCrate, module, timeslicesNew);
     }
 
-    // CMX-Energy
-
-    int maxSource = static_cast<int>(LVL1::CMXEtSums::MAX_SOURCE);
-    for (int source = 0; source < maxSource; ++source) {
-      if (source >= m_modules) {
-        if (summing == CmxSubBlock::CRATE && 
-	    source != LVL1::CMXEtSums::LOCAL_STANDARD &&
-	    source != LVL1::CMXEtSums::LOCAL_RESTRICTED) continue;
-      }
-      const LVL1::CMXEtSums* const sums = findCmxSums(crate, source);
-      if ( sums ) {
-        std::vector<unsigned int> ex;
-        std::vector<unsigned int> ey;
-        std::vector<unsigned int> et;
-        std::vector<int> exErr;
-        std::vector<int> eyErr;
-        std::vector<int> etErr;
-	ModifySlices::data(sums->ExVec(), ex, timeslicesNew);
-	ModifySlices::data(sums->EyVec(), ey, timeslicesNew);
-	ModifySlices::data(sums->EtVec(), et, timeslicesNew);
-	ModifySlices::data(sums->ExErrorVec(), exErr, timeslicesNew);
-	ModifySlices::data(sums->EyErrorVec(), eyErr, timeslicesNew);
-	ModifySlices::data(sums->EtErrorVec(), etErr, timeslicesNew);
-	for (int slice = 0; slice < timeslicesNew; ++slice) {
-	  const LVL1::DataError exErrBits(exErr[slice]);
-	  const LVL1::DataError eyErrBits(eyErr[slice]);
-	  const LVL1::DataError etErrBits(etErr[slice]);
-	  int exError = exErrBits.get(LVL1::DataError::Parity) << 1;
-	  int eyError = eyErrBits.get(LVL1::DataError::Parity) << 1;
-	  int etError = etErrBits.get(LVL1::DataError::Parity) << 1;
-	  if (source >= m_modules) {
-	    exError += exErrBits.get(LVL1::DataError::Overflow);
-	    eyError += eyErrBits.get(LVL1::DataError::Overflow);
-	    etError += etErrBits.get(LVL1::DataError::Overflow);
-	  }
-	  const int index = ( neutralFormat ) ? 0 : slice;
-	  CmxEnergySubBlock* const subBlock = m_cmxEnergyBlocks[index];
-	  if (source < m_modules) {
-	    subBlock->setSubsums(slice, source,
-	                         ex[slice], ey[slice], et[slice],
-				 exError, eyError, etError);
-          } else {
-	    CmxEnergySubBlock::SourceType srcType = CmxEnergySubBlock::MAX_SOURCE_TYPE;
-	    CmxEnergySubBlock::SumType    sumType = CmxEnergySubBlock::MAX_SUM_TYPE;
-	    CmxEnergySubBlock::HitsType   hitType = CmxEnergySubBlock::MAX_HITS_TYPE;
-	    energySubBlockTypes(source, srcType, sumType, hitType);
-	    if (srcType != CmxEnergySubBlock::MAX_SOURCE_TYPE) {
-	      subBlock->setSubsums(slice, srcType, sumType,
-	                           ex[slice], ey[slice], et[slice],
-				   exError, eyError, etError);
-            } else if (hitType != CmxEnergySubBlock::MAX_HITS_TYPE) {
-	      subBlock->setEtHits(slice, hitType, sumType, et[slice]);
+    // Find jet elements corresponding to each eta/phi pair and fill
+    // sub-blocks
+
+    for (int chan=0; chan < m_channels; ++chan) {
+      unsigned int key = 0;
+      if (channelKey(crate, module, chan, key)) {
+        const LVL1::JetElement* const je = findJetElement(key);
+        if (je ) {
+          std::vector<int> emData;
+          std::vector<int> hadData;
+          std::vector<int> emErrors;
+          std::vector<int> hadErrors;
+          ModifySlices::data(je->emEnergyVec(),  emData,    timeslicesNew);
+          ModifySlices::data(je->hadEnergyVec(), hadData,   timeslicesNew);
+          ModifySlices::data(je->emErrorVec(),   emErrors,  timeslicesNew);
+          ModifySlices::data(je->hadErrorVec(),  hadErrors, timeslicesNew);
+          for (int slice = 0; slice < timeslicesNew; ++slice) {
+            const LVL1::DataError emErrBits(emErrors[slice]);
+            const LVL1::DataError hadErrBits(hadErrors[slice]);
+            const int index = ( neutralFormat ) ? 0 : slice;
+            JemSubBlockV2* const subBlock = enc.jemBlocks[index];
+            const JemJetElement jetEle(chan, emData[slice], hadData[slice],
+                        emErrBits.get(LVL1::DataError::Parity),
+                        hadErrBits.get(LVL1::DataError::Parity),
+                        emErrBits.get(LVL1::DataError::LinkDown) +
+                       (hadErrBits.get(LVL1::DataError::LinkDown) << 1));
+            subBlock->fillJetElement(slice, jetEle);
+            if ((emErrBits.error() >> LVL1::DataError::GLinkParity)) {
+              int gLinkParity   = emErrBits.get(LVL1::DataError::GLinkParity);
+              int gLinkProtocol = emErrBits.get(LVL1::DataError::GLinkProtocol);
+              int bCNMismatch   = emErrBits.get(LVL1::DataError::BCNMismatch);
+              int fIFOOverflow  = emErrBits.get(LVL1::DataError::FIFOOverflow);
+              int moduleError   = emErrBits.get(LVL1::DataError::ModuleError);
+              int gLinkDown     = emErrBits.get(LVL1::DataError::GLinkDown);
+              int gLinkTimeout  = emErrBits.get(LVL1::DataError::GLinkTimeout);
+              uint32_t failingBCN = emErrBits.get(LVL1::DataError::FailingBCN);
+              subBlock->setStatus(failingBCN, gLinkTimeout, gLinkDown,
+                                  moduleError, fIFOOverflow, bCNMismatch,
+                                  gLinkProtocol, gLinkParity);
             }
           }
         }
       }
     }
-    DataVector<CmxEnergySubBlock>::const_iterator pos;
-    pos = m_cmxEnergyBlocks.begin();
-    for (; pos != m_cmxEnergyBlocks.end(); ++pos) {
-      CmxEnergySubBlock* const subBlock = *pos;
+
+    // Add energy subsums
+
+    const LVL1::JEMEtSums* const et = findEnergySums(crate, module);
+    if (et) {
+      std::vector<unsigned int> exVec;
+      std::vector<unsigned int> eyVec;
+      std::vector<unsigned int> etVec;
+      ModifySlices::data(et->ExVec(), exVec, timeslicesNew);
+      ModifySlices::data(et->EyVec(), eyVec, timeslicesNew);
+      ModifySlices::data(et->EtVec(), etVec, timeslicesNew);
+      for (int slice = 0; slice < timeslicesNew; ++slice) {
+        const int index = ( neutralFormat ) ? 0 : slice;
+        JemSubBlockV2* const subBlock = enc.jemBlocks[index];
+        subBlock->setEnergySubsums(slice, exVec[slice], eyVec[slice],
+                                                        etVec[slice]);
+      }
+    }
+
+    // Pack and write the sub-blocks
+
+    for (int index = 0; index < jemBlocks; ++index) {
+      JemSubBlockV2* const subBlock = enc.jemBlocks[index];
       if ( !subBlock->pack()) {
-        msg(MSG::ERROR) << "CMX-Energy sub-block packing failed" << endreq;
-	return StatusCode::FAILURE;
+        enc.rods.setError("JEM sub-block packing failed");
+        return;
       }
       if (debug) {
-	msg() << "CMX-Energy sub-block data words: "
-	      << subBlock->dataWords() << endreq;
+        msg() << "JEM sub-block data words: "
+              << subBlock->dataWords() << endreq;
       }
       subBlock->write(theROD);
     }
+  }
 
-    // CMX-Jet TOBs
+  // Append CMXs to last S-Link of the crate
 
-    for (int jem = 0; jem < m_modules; ++jem) {
-      for (int frame = 0; frame < m_frames; ++frame) {
-        for (int loc = 0; loc < m_locations; ++loc) {
-	  const int key = tobKey(crate, jem, frame, loc);
-          const LVL1::CMXJetTob* const ct = findCmxTob(key);
-          if ( ct ) {
-            std::vector<int> energyLarge;
-            std::vector<int> energySmall;
-            std::vector<int> error;
-            std::vector<unsigned int> presence;
-            ModifySlices::data(ct->energyLgVec(),    energyLarge, timeslicesNew);
-            ModifySlices::data(ct->energySmVec(),    energySmall, timeslicesNew);
-            ModifySlices::data(ct->errorVec(),       error,       timeslicesNew);
-            ModifySlices::data(ct->presenceMapVec(), presence,    timeslicesNew);
-            for (int slice = 0; slice < timeslicesNew; ++slice) {
-              const LVL1::DataError errBits(error[slice]);
-	      int err0 = errBits.get(LVL1::DataError::Parity);
-              int err1 = errBits.get(LVL1::DataError::ParityPhase0);
-              err1 |= (errBits.get(LVL1::DataError::ParityPhase1))<<1;
-              err1 |= (errBits.get(LVL1::DataError::ParityPhase2))<<2;
-              err1 |= (errBits.get(LVL1::DataError::ParityPhase3))<<3;
-              const int index = ( neutralFormat ) ? 0 : slice;
-              CmxJetSubBlock* const subBlock = m_cmxJetBlocks[index];
-              subBlock->setTob(slice, jem, frame, loc, energyLarge[slice],
-                                                  energySmall[slice], err0);
-	      subBlock->setParityBits(slice, jem, err1); // for neutral format
-              subBlock->setPresenceMap(slice, jem, presence[slice]);
-            }
+  // Set up a sub-block for each slice (except Neutral format)
+
+  const int summing = (crate == m_crates - 1) ? CmxSubBlock::SYSTEM
+                                              : CmxSubBlock::CRATE;
+  const int cmxBlocks = (neutralFormat) ? 1 : timeslicesNew;
+  while (static_cast<int>(enc.cmxEnergyBlocks.size()) < cmxBlocks) {
+    enc.cmxEnergyBlocks.push_back(new CmxEnergySubBlock());
+    enc.cmxJetBlocks.push_back(new CmxJetSubBlock());
+  }
+  for (int slice = 0; slice < cmxBlocks; ++slice) {
+    CmxEnergySubBlock* const enBlock = enc.cmxEnergyBlocks[slice];
+    enBlock->clear();
+    const int cmxEnergyVersion = 3;                             // <<== CHECK  Make jo property for each sub-block?
+    enBlock->setCmxHeader(cmxEnergyVersion, m_dataFormat, slice, hwCrate,
+                          summing, CmxSubBlock::CMX_ENERGY,
+                          CmxSubBlock::LEFT, timeslicesNew);
+    CmxJetSubBlock* const jetBlock = enc.cmxJetBlocks[slice];
+    jetBlock->clear();
+    jetBlock->setCmxHeader(m_version, m_dataFormat, slice, hwCrate,
+                           summing, CmxSubBlock::CMX_JET,
+                           CmxSubBlock::RIGHT, timeslicesNew);
+  }
+
+  // CMX-Energy
+
+  int maxSource = static_cast<int>(LVL1::CMXEtSums::MAX_SOURCE);
+  for (int source = 0; source < maxSource; ++source) {
+    if (source >= m_modules) {
+      if (summing == CmxSubBlock::CRATE && 
+          source != LVL1::CMXEtSums::LOCAL_STANDARD &&
+          source != LVL1::CMXEtSums::LOCAL_RESTRICTED) continue;
+    }
+    const LVL1::CMXEtSums* const sums = findCmxSums(crate, source);
+    if ( sums ) {
+      std::vector<unsigned int> ex;
+      std::vector<unsigned int> ey;
+      std::vector<unsigned int> et;
+      std::vector<int> exErr;
+      std::vector<int> eyErr;
+      std::vector<int> etErr;
+      ModifySlices::data(sums->ExVec(), ex, timeslicesNew);
+      ModifySlices::data(sums->EyVec(), ey, timeslicesNew);
+      ModifySlices::data(sums->EtVec(), et, timeslicesNew);
+      ModifySlices::data(sums->ExErrorVec(), exErr, timeslicesNew);
+      ModifySlices::data(sums->EyErrorVec(), eyErr, timeslicesNew);
+      ModifySlices::data(sums->EtErrorVec(), etErr, timeslicesNew);
+      for (int slice = 0; slice < timeslicesNew; ++slice) {
+        const LVL1::DataError exErrBits(exErr[slice]);
+        const LVL1::DataError eyErrBits(eyErr[slice]);
+        const LVL1::DataError etErrBits(etErr[slice]);
+        int exError = exErrBits.get(LVL1::DataError::Parity) << 1;
+        int eyError = eyErrBits.get(LVL1::DataError::Parity) << 1;
+        int etError = etErrBits.get(LVL1::DataError::Parity) << 1;
+        if (source >= m_modules) {
+          exError += exErrBits.get(LVL1::DataError::Overflow);
+          eyError += eyErrBits.get(LVL1::DataError::Overflow);
+          etError += etErrBits.get(LVL1::DataError::Overflow);
+        }
+        const int index = ( neutralFormat ) ? 0 : slice;
+        CmxEnergySubBlock* const subBlock = enc.cmxEnergyBlocks[index];
+        if (source < m_modules) {
+          subBlock->setSubsums(slice, source,
+                               ex[slice], ey[slice], et[slice],
+                               exError, eyError, etError);
+        } else {
+          CmxEnergySubBlock::SourceType srcType = CmxEnergySubBlock::MAX_SOURCE_TYPE;
+          CmxEnergySubBlock::SumType    sumType = CmxEnergySubBlock::MAX_SUM_TYPE;
+          CmxEnergySubBlock::HitsType   hitType = CmxEnergySubBlock::MAX_HITS_TYPE;
+          energySubBlockTypes(source, srcType, sumType, hitType);
+          if (srcType != CmxEnergySubBlock::MAX_SOURCE_TYPE) {
+            subBlock->setSubsums(slice, srcType, sumType,
+                                 ex[slice], ey[slice], et[slice],
+                                 exError, eyError, etError);
+          } else if (hitType != CmxEnergySubBlock::MAX_HITS_TYPE) {
+            subBlock->setEtHits(slice, hitType, sumType, et[slice]);
           }
         }
       }
     }
+  }
+  for (int index = 0; index < cmxBlocks; ++index) {
+    CmxEnergySubBlock* const subBlock = enc.cmxEnergyBlocks[index];
+    if ( !subBlock->pack()) {
+      enc.rods.setError("CMX-Energy sub-block packing failed");
+      return;
+    }
+    if (debug) {
+      msg() << "CMX-Energy sub-block data words: "
+            << subBlock->dataWords() << endreq;
+    }
+    subBlock->write(theROD);
+  }
 
-    // CMX-Jet Hits
-
-    maxSource = static_cast<int>(LVL1::CMXJetHits::MAX_SOURCE);
-    for (int source = 0; source < maxSource; ++source) {
-      if (summing == CmxSubBlock::CRATE && 
-          (source == LVL1::CMXJetHits::REMOTE_MAIN    ||
-	   source == LVL1::CMXJetHits::TOTAL_MAIN     ||
-	   source == LVL1::CMXJetHits::REMOTE_FORWARD ||
-	   source == LVL1::CMXJetHits::TOTAL_FORWARD)) continue;
-      int sourceId = jetSubBlockSourceId(source);
-      if (sourceId == CmxJetSubBlock::MAX_SOURCE_ID) continue;
-      const LVL1::CMXJetHits* const ch = findCmxHits(crate, source);
-      if ( ch ) {
-        std::vector<unsigned int> hits0;
-        std::vector<unsigned int> hits1;
-        std::vector<int> err0;
-        std::vector<int> err1;
-	ModifySlices::data(ch->hitsVec0(),  hits0, timeslicesNew);
-	ModifySlices::data(ch->hitsVec1(),  hits1, timeslicesNew);
-	ModifySlices::data(ch->errorVec0(), err0,  timeslicesNew);
-	ModifySlices::data(ch->errorVec1(), err1,  timeslicesNew);
-	for (int slice = 0; slice < timeslicesNew; ++slice) {
-	  int error = 0;
-	  if (source != LVL1::CMXJetHits::TOPO_CHECKSUM &&
-	      source != LVL1::CMXJetHits::TOPO_OCCUPANCY_MAP &&
-	      source != LVL1::CMXJetHits::TOPO_OCCUPANCY_COUNTS) {
-	    const LVL1::DataError errBits0(err0[slice]);
-	    const LVL1::DataError errBits1(err1[slice]);
-	    error = (errBits0.get(LVL1::DataError::Overflow) |
-	             errBits1.get(LVL1::DataError::Overflow)) << 2;
-	    if (source == LVL1::CMXJetHits::REMOTE_MAIN ||
-	        source == LVL1::CMXJetHits::REMOTE_FORWARD) {
-	      error += (errBits0.get(LVL1::DataError::Parity) +
-	               (errBits1.get(LVL1::DataError::Parity) << 1));
-	    }
-	  }
-	  const int index = ( neutralFormat ) ? 0 : slice;
-	  CmxJetSubBlock* const subBlock = m_cmxJetBlocks[index];
-	  subBlock->setHits(slice, sourceId, 0, hits0[slice], error);
-	  if (source != LVL1::CMXJetHits::TOPO_CHECKSUM &&
-	      source != LVL1::CMXJetHits::TOPO_OCCUPANCY_MAP) {
-	    subBlock->setHits(slice, sourceId, 1, hits1[slice], error);
+  // CMX-Jet TOBs
+
+  for (int jem = 0; jem < m_modules; ++jem) {
+    for (int frame = 0; frame < m_frames; ++frame) {
+      for (int loc = 0; loc < m_locations; ++loc) {
+        const int key = tobKey(crate, jem, frame, loc);
+        const LVL1::CMXJetTob* const ct = findCmxTob(key);
+        if ( ct ) {
+          std::vector<int> energyLarge;
+          std::vector<int> energySmall;
+          std::vector<int> error;
+          std::vector<unsigned int> presence;
+          ModifySlices::data(ct->energyLgVec(),    energyLarge, timeslicesNew);
+          ModifySlices::data(ct->energySmVec(),    energySmall, timeslicesNew);
+          ModifySlices::data(ct->errorVec(),       error,       timeslicesNew);
+          ModifySlices::data(ct->presenceMapVec(), presence,    timeslicesNew);
+          for (int slice = 0; slice < timeslicesNew; ++slice) {
+            const LVL1::DataError errBits(error[slice]);
+            int err0 = errBits.get(LVL1::DataError::Parity);
+            int err1 = errBits.get(LVL1::DataError::ParityPhase0);
+            err1 |= (errBits.get(LVL1::DataError::ParityPhase1))<<1;
+            err1 |= (errBits.get(LVL1::DataError::ParityPhase2))<<2;
+            err1 |= (errBits.get(LVL1::DataError::ParityPhase3))<<3;
+            const int index = ( neutralFormat ) ? 0 : slice;
+            CmxJetSubBlock* const subBlock = enc.cmxJetBlocks[index];
+            subBlock->setTob(slice, jem, frame, loc, energyLarge[slice],
+                                                energySmall[slice], err0);
+            subBlock->setParityBits(slice, jem, err1); // for neutral format
+            subBlock->setPresenceMap(slice, jem, presence[slice]);
           }
         }
       }
     }
-    DataVector<CmxJetSubBlock>::const_iterator jos;
-    jos = m_cmxJetBlocks.begin();
-    for (; jos != m_cmxJetBlocks.end(); ++jos) {
-      CmxJetSubBlock* const subBlock = *jos;
-      if ( !subBlock->pack()) {
-        msg(MSG::ERROR) << "CMX-Jet sub-block packing failed" << endreq;
-	return StatusCode::FAILURE;
-      }
-      if (debug) {
-	msg() << "CMX-Jet sub-block data words: "
-	      << subBlock->dataWords() << endreq;
+  }
+
+  // CMX-Jet Hits
+
+  maxSource = static_cast<int>(LVL1::CMXJetHits::MAX_SOURCE);
+  for (int source = 0; source < maxSource; ++source) {
+    if (summing == CmxSubBlock::CRATE && 
+        (source == LVL1::CMXJetHits::REMOTE_MAIN    ||
+         source == LVL1::CMXJetHits::TOTAL_MAIN     ||
+         source == LVL1::CMXJetHits::REMOTE_FORWARD ||
+         source == LVL1::CMXJetHits::TOTAL_FORWARD)) continue;
+    int sourceId = jetSubBlockSourceId(source);
+    if (sourceId == CmxJetSubBlock::MAX_SOURCE_ID) continue;
+    const LVL1::CMXJetHits* const ch = findCmxHits(crate, source);
+    if ( ch ) {
+      std::vector<unsigned int> hits0;
+      std::vector<unsigned int> hits1;
+      std::vector<int> err0;
+      std::vector<int> err1;
+      ModifySlices::data(ch->hitsVec0(),  hits0, timeslicesNew);
+      ModifySlices::data(ch->hitsVec1(),  hits1, timeslicesNew);
+      ModifySlices::data(ch->errorVec0(), err0,  timeslicesNew);
+      ModifySlices::data(ch->errorVec1(), err1,  timeslicesNew);
+      for (int slice = 0; slice < timeslicesNew; ++slice) {
+        int error = 0;
+        if (source != LVL1::CMXJetHits::TOPO_CHECKSUM &&
+            source != LVL1::CMXJetHits::TOPO_OCCUPANCY_MAP &&
+            source != LVL1::CMXJetHits::TOPO_OCCUPANCY_COUNTS) {
+          const LVL1::DataError errBits0(err0[slice]);
+          const LVL1::DataError errBits1(err1[slice]);
+          error = (errBits0.get(LVL1::DataError::Overflow) |
+                   errBits1.get(LVL1::DataError::Overflow)) << 2;
+          if (source == LVL1::CMXJetHits::REMOTE_MAIN ||
+              source == LVL1::CMXJetHits::REMOTE_FORWARD) {
+            error += (errBits0.get(LVL1::DataError::Parity) +
+                     (errBits1.get(LVL1::DataError::Parity) << 1));
+          }
+        }
+        const int index = ( neutralFormat ) ? 0 : slice;
+        CmxJetSubBlock* const subBlock = enc.cmxJetBlocks[index];
+        subBlock->setHits(slice, sourceId, 0, hits0[slice], error);
+        if (source != LVL1::CMXJetHits::TOPO_CHECKSUM &&
+            source != LVL1::CMXJetHits::TOPO_OCCUPANCY_MAP) {
+          subBlock->setHits(slice, sourceId, 1, hits1[slice], error);
+        }
       }
-      subBlock->write(theROD);
     }
   }
-
-  // Fill the raw event
-
-  m_fea->fill(re, msg());
-
-  // Set ROD status words
-
-  //L1CaloRodStatus::setStatus(re, m_rodStatusMap, m_srcIdMap);
-
-  return StatusCode::SUCCESS;
+  for (int index = 0; index < cmxBlocks; ++index) {
+    CmxJetSubBlock* const subBlock = enc.cmxJetBlocks[index];
+    if ( !subBlock->pack()) {
+      enc.rods.setError("CMX-Jet sub-block packing failed");
+      return;
+    }
+    if (debug) {
+      msg() << "CMX-Jet sub-block data words: "
+            << subBlock->dataWords() << endreq;
+    }
+    subBlock->write(theROD);
+  }
 }
 
 // Return reference to vector with all possible Source Identifiers
@@ -602,6 +681,68 @@ const std::vector<uint32_t>& JepByteStreamV2Tool::sourceIDs(
   return m_sourceIDs;
 }
 
+// Set up output collection for conversion
+
+JepByteStreamV2Tool::CollectionType JepByteStreamV2Tool::setCollection(
+                                            JetElementCollection* const jeCollection)
+{
+  m_jeCollection = jeCollection;
+  m_jeMap.clear();
+  return JET_ELEMENTS;
+}
+
+JepByteStreamV2Tool::CollectionType JepByteStreamV2Tool::setCollection(
+                                            EnergySumsCollection* const etCollection)
+{
+  m_etCollection = etCollection;
+  m_etMap.clear();
+  return ENERGY_SUMS;
+}
+
+JepByteStreamV2Tool::CollectionType JepByteStreamV2Tool::setCollection(
+                                            CmxTobCollection* const tobCollection)
+{
+  m_cmxTobCollection = tobCollection;
+  m_cmxTobMap.clear();
+  return CMX_TOBS;
+}
+
+JepByteStreamV2Tool::CollectionType JepByteStreamV2Tool::setCollection(
+                                            CmxHitsCollection* const hitCollection)
+{
+  m_cmxHitCollection = hitCollection;
+  m_cmxHitsMap.clear();
+  return CMX_HITS;
+}
+
+JepByteStreamV2Tool::CollectionType JepByteStreamV2Tool::setCollection(
+                                            CmxSumsCollection* const etCollection)
+{
+  m_cmxEtCollection = etCollection;
+  m_cmxEtMap.clear();
+  return CMX_SUMS;
+}
+
+// Check ROD source ID, remembering those already found valid
+
+bool JepByteStreamV2Tool::validRodId(const uint32_t sourceID,
+                                     const uint32_t robid)
+{
+  std::map<uint32_t, uint32_t>::const_iterator iter =
+                                                m_validRodIds.find(sourceID);
+  if (iter != m_validRodIds.end()) return iter->second == robid;
+  if (m_srcIdMap->getRobID(sourceID) != robid           ||
+      m_srcIdMap->subDet(sourceID)   != m_subDetector   ||
+      m_srcIdMap->daqOrRoi(sourceID) != 0               ||
+      m_srcIdMap->slink(sourceID)    >= m_slinks        ||
+      m_srcIdMap->crate(sourceID)    <  m_crateOffsetHw ||
+      m_srcIdMap->crate(sourceID)    >= m_crateOffsetHw + m_crates) {
+    return false;
+  }
+  m_validRodIds.insert(std::make_pair(sourceID, robid));
+  return true;
+}
+
 // Convert bytestream to given container type
 
 StatusCode JepByteStreamV2Tool::convertBs(
@@ -611,10 +752,15 @@ StatusCode JepByteStreamV2Tool::convertBs(
   const bool debug = msgLvl(MSG::DEBUG);
   if (debug) msg(MSG::DEBUG);
 
+  m_etStage.clear();
+  m_cmxTobStage.clear();
+  m_cmxHitsStage.clear();
+  m_cmxEtStage.clear();
+
   // Loop over ROB fragments
 
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();
   for (; rob != robEnd; ++rob) {
@@ -639,7 +785,7 @@ StatusCode JepByteStreamV2Tool::convertBs(
 
     // Skip duplicate fragments
 
-    if (!dupCheck.insert(robid).second) {
+    if (!dupCheck.insert(robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
       if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
       continue;
@@ -660,12 +806,7 @@ StatusCode JepByteStreamV2Tool::convertBs(
 
     // Check identifier
     const uint32_t sourceID = (*rob)->rod_source_id();
-    if (m_srcIdMap->getRobID(sourceID) != robid           ||
-        m_srcIdMap->subDet(sourceID)   != m_subDetector   ||
-	m_srcIdMap->daqOrRoi(sourceID) != 0               ||
-	m_srcIdMap->slink(sourceID)    >= m_slinks        ||
-	m_srcIdMap->crate(sourceID)    <  m_crateOffsetHw ||
-	m_srcIdMap->crate(sourceID)    >= m_crateOffsetHw + m_crates) {
+    if (!validRodId(sourceID, robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_ROD_ID);
       if (debug) {
         msg() << "Wrong source identifier in data: ROD "
@@ -711,6 +852,18 @@ StatusCode JepByteStreamV2Tool::convertBs(
             << "JEM triggered slice offset: " << trigJem << endreq;
     }
 
+    // Check sub-block structure before creating any objects
+
+    if (m_validateRods) {
+      const int rodErr = L1CaloRodValidator::checkCpJep(payload, payloadEnd,
+                                               false, rodCrate, trigJem);
+      if (rodErr != L1CaloSubBlock::ERROR_NONE) {
+        m_errorTool->rodError(robid, rodErr);
+        if (debug) msg() << "ROD structure check failed: " << rodErr << endreq;
+        continue;
+      }
+    }
+
     // Loop over sub-blocks
 
     m_rodErr = L1CaloSubBlock::ERROR_NONE;
@@ -782,10 +935,98 @@ StatusCode JepByteStreamV2Tool::convertBs(
     if (m_rodErr != L1CaloSubBlock::ERROR_NONE)
                                        m_errorTool->rodError(robid, m_rodErr);
   }
+  createStaged(collection);
 
   return StatusCode::SUCCESS;
 }
 
+// Create objects from staged slices
+
+void JepByteStreamV2Tool::createStaged(const CollectionType collection)
+{
+  if (collection == ENERGY_SUMS) {
+    std::vector<unsigned int>& exVec(m_uintVec0);
+    std::vector<unsigned int>& eyVec(m_uintVec1);
+    std::vector<unsigned int>& etVec(m_uintVec2);
+    const int size = m_etStage.size();
+    for (int index = 0; index < size; ++index) {
+      const EnergySumsInfo& info(m_etStage.info(index));
+      m_etStage.fieldVec(index, EnergySumsInfo::EX, exVec);
+      m_etStage.fieldVec(index, EnergySumsInfo::EY, eyVec);
+      m_etStage.fieldVec(index, EnergySumsInfo::ET, etVec);
+      LVL1::JEMEtSums* sums = m_etPool.create(m_etCollection,
+                                  info.crate, info.module, etVec, exVec, eyVec,
+                                  m_etStage.peak(index));
+      m_etMap.insert(std::make_pair(m_etStage.key(index), sums));
+      m_etCollection->push_back(sums);
+    }
+    m_etStage.clear();
+  } else if (collection == CMX_TOBS) {
+    std::vector<int>& energyLgVec(m_intVec0);
+    std::vector<int>& energySmVec(m_intVec1);
+    std::vector<int>& errorVec(m_intVec2);
+    std::vector<unsigned int>& presenceMapVec(m_uintVec0);
+    const int size = m_cmxTobStage.size();
+    for (int index = 0; index < size; ++index) {
+      const CmxTobInfo& info(m_cmxTobStage.info(index));
+      m_cmxTobStage.fieldVec(index, CmxTobInfo::ENERGY_LARGE, energyLgVec);
+      m_cmxTobStage.fieldVec(index, CmxTobInfo::ENERGY_SMALL, energySmVec);
+      m_cmxTobStage.fieldVec(index, CmxTobInfo::TOB_ERROR, errorVec);
+      m_cmxTobStage.fieldVec(index, CmxTobInfo::PRESENCE_MAP, presenceMapVec);
+      LVL1::CMXJetTob* tb = m_cmxTobPool.create(m_cmxTobCollection,
+                                  info.crate, info.jem, info.frame, info.loc,
+                                  energyLgVec, energySmVec, errorVec,
+                                  presenceMapVec, m_cmxTobStage.peak(index));
+      m_cmxTobMap.insert(std::make_pair(m_cmxTobStage.key(index), tb));
+      m_cmxTobCollection->push_back(tb);
+    }
+    m_cmxTobStage.clear();
+  } else if (collection == CMX_HITS) {
+    std::vector<unsigned int>& hit0Vec(m_uintVec0);
+    std::vector<unsigned int>& hit1Vec(m_uintVec1);
+    std::vector<int>& err0Vec(m_intVec0);
+    std::vector<int>& err1Vec(m_intVec1);
+    const int size = m_cmxHitsStage.size();
+    for (int index = 0; index < size; ++index) {
+      const CmxHitsInfo& info(m_cmxHitsStage.info(index));
+      m_cmxHitsStage.fieldVec(index, CmxHitsInfo::HITS0, hit0Vec);
+      m_cmxHitsStage.fieldVec(index, CmxHitsInfo::HITS1, hit1Vec);
+      m_cmxHitsStage.fieldVec(index, CmxHitsInfo::ERROR0, err0Vec);
+      m_cmxHitsStage.fieldVec(index, CmxHitsInfo::ERROR1, err1Vec);
+      LVL1::CMXJetHits* jh = m_cmxHitsPool.create(m_cmxHitCollection,
+                                  info.crate, info.source, hit0Vec, hit1Vec,
+                                  err0Vec, err1Vec, m_cmxHitsStage.peak(index));
+      m_cmxHitsMap.insert(std::make_pair(m_cmxHitsStage.key(index), jh));
+      m_cmxHitCollection->push_back(jh);
+    }
+    m_cmxHitsStage.clear();
+  } else if (collection == CMX_SUMS) {
+    std::vector<unsigned int>& exVec(m_uintVec0);
+    std::vector<unsigned int>& eyVec(m_uintVec1);
+    std::vector<unsigned int>& etVec(m_uintVec2);
+    std::vector<int>& exErrVec(m_intVec0);
+    std::vector<int>& eyErrVec(m_intVec1);
+    std::vector<int>& etErrVec(m_intVec2);
+    const int size = m_cmxEtStage.size();
+    for (int index = 0; index < size; ++index) {
+      const CmxSumsInfo& info(m_cmxEtStage.info(index));
+      m_cmxEtStage.fieldVec(index, CmxSumsInfo::EX, exVec);
+      m_cmxEtStage.fieldVec(index, CmxSumsInfo::EY, eyVec);
+      m_cmxEtStage.fieldVec(index, CmxSumsInfo::ET, etVec);
+      m_cmxEtStage.fieldVec(index, CmxSumsInfo::EX_ERROR, exErrVec);
+      m_cmxEtStage.fieldVec(index, CmxSumsInfo::EY_ERROR, eyErrVec);
+      m_cmxEtStage.fieldVec(index, CmxSumsInfo::ET_ERROR, etErrVec);
+      LVL1::CMXEtSums* sums = m_cmxEtPool.create(m_cmxEtCollection,
+                                  info.crate, info.source, etVec, exVec, eyVec,
+                                  etErrVec, exErrVec, eyErrVec,
+                                  m_cmxEtStage.peak(index));
+      m_cmxEtMap.insert(std::make_pair(m_cmxEtStage.key(index), sums));
+      m_cmxEtCollection->push_back(sums);
+    }
+    m_cmxEtStage.clear();
+  }
+}
+
 // Unpack CMX-Energy sub-block
 
 void JepByteStreamV2Tool::decodeCmxEnergy(CmxEnergySubBlock* subBlock,
@@ -821,6 +1062,15 @@ void JepByteStreamV2Tool::decodeCmxEnergy(CmxEnergySubBlock* subBlock,
     m_rodErr = L1CaloSubBlock::ERROR_SLICES;
     return;
   }
+  // Slices to keep, skipping sub-blocks outside the window
+  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+  int firstSlice = 0;
+  int numSlices  = timeslices;
+  ModifySlices::window(trigJem, timeslices, m_sliceWindow, firstSlice,
+                                                           numSlices);
+  if (!neutralFormat &&
+      (sliceNum < firstSlice || sliceNum >= firstSlice + numSlices)) return;
+  const int trigJemOut = trigJem - firstSlice;
   // Unpack sub-block
   if (subBlock->dataWords() && !subBlock->unpack()) {
     if (debug) {
@@ -833,22 +1083,16 @@ void JepByteStreamV2Tool::decodeCmxEnergy(CmxEnergySubBlock* subBlock,
 
   // Retrieve required data
 
-  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
   const int crate     = hwCrate - m_crateOffsetHw;
   const int swCrate   = crate   + m_crateOffsetSw;
   const int maxSource = static_cast<int>(LVL1::CMXEtSums::MAX_SOURCE);
-  std::vector<unsigned int>& exVec(m_uintVec0);
-  std::vector<unsigned int>& eyVec(m_uintVec1);
-  std::vector<unsigned int>& etVec(m_uintVec2);
-  std::vector<int>& exErrVec(m_intVec0);
-  std::vector<int>& eyErrVec(m_intVec1);
-  std::vector<int>& etErrVec(m_intVec2);
   LVL1::DataError derr;
   derr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
   const int ssError = derr.error();
-  const int sliceBeg = ( neutralFormat ) ? 0          : sliceNum;
-  const int sliceEnd = ( neutralFormat ) ? timeslices : sliceNum + 1;
+  const int sliceBeg = ( neutralFormat ) ? firstSlice             : sliceNum;
+  const int sliceEnd = ( neutralFormat ) ? firstSlice + numSlices : sliceNum + 1;
   for (int slice = sliceBeg; slice < sliceEnd; ++slice) {
+    const int sl = slice - firstSlice;
 
     // Energy sums
 
@@ -908,56 +1152,30 @@ void JepByteStreamV2Tool::decodeCmxEnergy(CmxEnergySubBlock* subBlock,
       eyErr = eyErrBits.error();
       etErr = etErrBits.error();
       if (ex || ey || et || exErr || eyErr || etErr) {
-        LVL1::CMXEtSums* sums = findCmxSums(crate, source);
-	if ( ! sums ) {   // create new CMX energy sums
-	  exVec.assign(timeslices, 0);
-	  eyVec.assign(timeslices, 0);
-	  etVec.assign(timeslices, 0);
-	  exErrVec.assign(timeslices, 0);
-	  eyErrVec.assign(timeslices, 0);
-	  etErrVec.assign(timeslices, 0);
-	  exVec[slice] = ex;
-	  eyVec[slice] = ey;
-	  etVec[slice] = et;
-	  exErrVec[slice] = exErr;
-	  eyErrVec[slice] = eyErr;
-	  etErrVec[slice] = etErr;
-	  sums = new LVL1::CMXEtSums(swCrate, source, etVec, exVec, eyVec,
-				     etErrVec, exErrVec, eyErrVec, trigJem);
-          const int key = crate*100 + source;
-	  m_cmxEtMap.insert(std::make_pair(key, sums));
-	  m_cmxEtCollection->push_back(sums);
+        const int key = crate*100 + source;
+        int sums = m_cmxEtStage.find(key);
+	if (sums < 0) {   // stage new CMX energy sums
+	  const CmxSumsInfo info = { swCrate, source };
+	  sums = m_cmxEtStage.add(key, info, numSlices, trigJemOut);
         } else {
-	  exVec = sums->ExVec();
-	  eyVec = sums->EyVec();
-	  etVec = sums->EtVec();
-	  exErrVec = sums->ExErrorVec();
-	  eyErrVec = sums->EyErrorVec();
-	  etErrVec = sums->EtErrorVec();
-	  const int nsl = exVec.size();
-	  if (timeslices != nsl) {
+	  if (numSlices != m_cmxEtStage.slices(sums)) {
 	    if (debug) msg() << "Inconsistent number of slices in sub-blocks"
 	                     << endreq;
             m_rodErr = L1CaloSubBlock::ERROR_SLICES;
 	    return;
           }
-	  if (exVec[slice] != 0 || eyVec[slice] != 0 || etVec[slice] != 0 ||
-	      exErrVec[slice] != 0 || eyErrVec[slice] != 0 ||
-              etErrVec[slice] != 0) {
+	  if (m_cmxEtStage.sliceSet(sums, sl)) {
             if (debug) msg() << "Duplicate data for slice " << slice << endreq;
 	    m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
 	    return;
           }
-	  exVec[slice] = ex;
-	  eyVec[slice] = ey;
-	  etVec[slice] = et;
-	  exErrVec[slice] = exErr;
-	  eyErrVec[slice] = eyErr;
-	  etErrVec[slice] = etErr;
-	  sums->addEx(exVec, exErrVec);
-	  sums->addEy(eyVec, eyErrVec);
-	  sums->addEt(etVec, etErrVec);
         }
+	m_cmxEtStage.set(sums, CmxSumsInfo::EX, sl, ex);
+	m_cmxEtStage.set(sums, CmxSumsInfo::EY, sl, ey);
+	m_cmxEtStage.set(sums, CmxSumsInfo::ET, sl, et);
+	m_cmxEtStage.set(sums, CmxSumsInfo::EX_ERROR, sl, exErr);
+	m_cmxEtStage.set(sums, CmxSumsInfo::EY_ERROR, sl, eyErr);
+	m_cmxEtStage.set(sums, CmxSumsInfo::ET_ERROR, sl, etErr);
       }
     }
   }
@@ -1000,6 +1218,15 @@ void JepByteStreamV2Tool::decodeCmxJet(CmxJetSubBlock* subBlock, int trigJem,
     m_rodErr = L1CaloSubBlock::ERROR_SLICES;
     return;
   }
+  // Slices to keep, skipping sub-blocks outside the window
+  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+  int firstSlice = 0;
+  int numSlices  = timeslices;
+  ModifySlices::window(trigJem, timeslices, m_sliceWindow, firstSlice,
+                                                           numSlices);
+  if (!neutralFormat &&
+      (sliceNum < firstSlice || sliceNum >= firstSlice + numSlices)) return;
+  const int trigJemOut = trigJem - firstSlice;
   // Unpack sub-block
   if (subBlock->dataWords() && !subBlock->unpack()) {
     if (debug) {
@@ -1012,24 +1239,16 @@ void JepByteStreamV2Tool::decodeCmxJet(CmxJetSubBlock* subBlock, int trigJem,
 
   // Retrieve required data
 
-  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
   const int crate     = hwCrate - m_crateOffsetHw;
   const int swCrate   = crate   + m_crateOffsetSw;
   const int maxSource = static_cast<int>(LVL1::CMXJetHits::MAX_SOURCE);
-  std::vector<int>& energyLgVec(m_intVec0);
-  std::vector<int>& energySmVec(m_intVec1);
-  std::vector<int>& errorVec(m_intVec2);
-  std::vector<unsigned int>& presenceMapVec(m_uintVec0);
-  std::vector<unsigned int>& hit0Vec(m_uintVec0);
-  std::vector<unsigned int>& hit1Vec(m_uintVec1);
-  std::vector<int>& err0Vec(m_intVec0);
-  std::vector<int>& err1Vec(m_intVec1);
   LVL1::DataError derr;
   derr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
   const int ssError = derr.error();
-  const int sliceBeg = ( neutralFormat ) ? 0          : sliceNum;
-  const int sliceEnd = ( neutralFormat ) ? timeslices : sliceNum + 1;
+  const int sliceBeg = ( neutralFormat ) ? firstSlice             : sliceNum;
+  const int sliceEnd = ( neutralFormat ) ? firstSlice + numSlices : sliceNum + 1;
   for (int slice = sliceBeg; slice < sliceEnd; ++slice) {
+    const int sl = slice - firstSlice;
 
     // Jet TOBs
 
@@ -1057,45 +1276,27 @@ void JepByteStreamV2Tool::decodeCmxJet(CmxJetSubBlock* subBlock, int trigJem,
           }
 	  error = errBits.error();
 	  const int key = tobKey(crate, jem, frame, loc);
-	  LVL1::CMXJetTob* tb = findCmxTob(key);
-	  if ( ! tb ) { // create new CMX TOB
-	    energyLgVec.assign(timeslices, 0);
-	    energySmVec.assign(timeslices, 0);
-	    errorVec.assign(timeslices, 0);
-	    presenceMapVec.assign(timeslices, 0);
-	    energyLgVec[slice] = energyLarge;
-	    energySmVec[slice] = energySmall;
-	    errorVec[slice]    = error;
-	    presenceMapVec[slice] = presenceMap;
-	    tb = new LVL1::CMXJetTob(swCrate, jem, frame, loc,
-	                             energyLgVec, energySmVec, errorVec,
-				     presenceMapVec, trigJem);
-	    m_cmxTobMap.insert(std::make_pair(key, tb));
-	    m_cmxTobCollection->push_back(tb);
+	  int tb = m_cmxTobStage.find(key);
+	  if (tb < 0) { // stage new CMX TOB
+	    const CmxTobInfo info = { swCrate, jem, frame, loc };
+	    tb = m_cmxTobStage.add(key, info, numSlices, trigJemOut);
           } else {
-	    energyLgVec = tb->energyLgVec();
-	    energySmVec = tb->energySmVec();
-	    errorVec    = tb->errorVec();
-	    presenceMapVec = tb->presenceMapVec();
-	    const int nsl = energyLgVec.size();
-	    if (timeslices != nsl) {
+	    if (numSlices != m_cmxTobStage.slices(tb)) {
 	      if (debug) msg() << "Inconsistent number of slices in sub-blocks"
 	                       << endreq;
               m_rodErr = L1CaloSubBlock::ERROR_SLICES;
 	      return;
             }
-	    if (energyLgVec[slice] != 0 || energySmVec[slice] != 0 ||
-	        errorVec[slice]  != 0 || presenceMapVec[slice] != 0) {
+	    if (m_cmxTobStage.sliceSet(tb, sl)) {
               if (debug) msg() << "Duplicate data for slice " << slice << endreq;
 	      m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
 	      return;
             }
-	    energyLgVec[slice] = energyLarge;
-	    energySmVec[slice] = energySmall;
-	    errorVec[slice]    = error;
-	    presenceMapVec[slice] = presenceMap;
-	    tb->addTob(energyLgVec, energySmVec, errorVec, presenceMapVec);
           }
+	  m_cmxTobStage.set(tb, CmxTobInfo::ENERGY_LARGE, sl, energyLarge);
+	  m_cmxTobStage.set(tb, CmxTobInfo::ENERGY_SMALL, sl, energySmall);
+	  m_cmxTobStage.set(tb, CmxTobInfo::TOB_ERROR, sl, error);
+	  m_cmxTobStage.set(tb, CmxTobInfo::PRESENCE_MAP, sl, presenceMap);
         }
       }
     }
@@ -1125,45 +1326,28 @@ void JepByteStreamV2Tool::decodeCmxJet(CmxJetSubBlock* subBlock, int trigJem,
 	err0 = err0Bits.error();
 	err1 = err1Bits.error();
 	if (hit0 || hit1 || err0 || err1) {
-          LVL1::CMXJetHits* jh = findCmxHits(crate, source);
-	  if ( ! jh ) {   // create new CMX hits
-	    hit0Vec.assign(timeslices, 0);
-	    hit1Vec.assign(timeslices, 0);
-	    err0Vec.assign(timeslices, 0);
-	    err1Vec.assign(timeslices, 0);
-	    hit0Vec[slice] = hit0;
-	    hit1Vec[slice] = hit1;
-	    err0Vec[slice] = err0;
-	    err1Vec[slice] = err1;
-	    jh = new LVL1::CMXJetHits(swCrate, source, hit0Vec, hit1Vec,
-	                              err0Vec, err1Vec, trigJem);
-            const int key = crate*100 + source;
-	    m_cmxHitsMap.insert(std::make_pair(key, jh));
-	    m_cmxHitCollection->push_back(jh);
+          const int key = crate*100 + source;
+          int jh = m_cmxHitsStage.find(key);
+	  if (jh < 0) {   // stage new CMX hits
+	    const CmxHitsInfo info = { swCrate, source };
+	    jh = m_cmxHitsStage.add(key, info, numSlices, trigJemOut);
           } else {
-	    hit0Vec = jh->hitsVec0();
-	    hit1Vec = jh->hitsVec1();
-	    err0Vec = jh->errorVec0();
-	    err1Vec = jh->errorVec1();
-	    const int nsl = hit0Vec.size();
-	    if (timeslices != nsl) {
+	    if (numSlices != m_cmxHitsStage.slices(jh)) {
 	      if (debug) msg() << "Inconsistent number of slices in sub-blocks"
 	                       << endreq;
               m_rodErr = L1CaloSubBlock::ERROR_SLICES;
 	      return;
             }
-	    if (hit0Vec[slice] != 0 || hit1Vec[slice] != 0 ||
-	        err0Vec[slice] != 0 || err1Vec[slice] != 0) {
+	    if (m_cmxHitsStage.sliceSet(jh, sl)) {
 	      if (debug) msg() << "Duplicate data for slice " << slice << endreq;
 	      m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
 	      return;
             }
-	    hit0Vec[slice] = hit0;
-	    hit1Vec[slice] = hit1;
-	    err0Vec[slice] = err0;
-	    err1Vec[slice] = err1;
-	    jh->addHits(hit0Vec, hit1Vec, err0Vec, err1Vec);
           }
+	  m_cmxHitsStage.set(jh, CmxHitsInfo::HITS0, sl, hit0);
+	  m_cmxHitsStage.set(jh, CmxHitsInfo::HITS1, sl, hit1);
+	  m_cmxHitsStage.set(jh, CmxHitsInfo::ERROR0, sl, err0);
+	  m_cmxHitsStage.set(jh, CmxHitsInfo::ERROR1, sl, err1);
         }
       }
     }
@@ -1204,6 +1388,15 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
     m_rodErr = L1CaloSubBlock::ERROR_SLICES;
     return;
   }
+  // Slices to keep, skipping sub-blocks outside the window
+  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+  int firstSlice = 0;
+  int numSlices  = timeslices;
+  ModifySlices::window(trigJem, timeslices, m_sliceWindow, firstSlice,
+                                                           numSlices);
+  if (!neutralFormat &&
+      (sliceNum < firstSlice || sliceNum >= firstSlice + numSlices)) return;
+  const int trigJemOut = trigJem - firstSlice;
   // Unpack sub-block
   if (subBlock->dataWords() && !subBlock->unpack()) {
     if (debug) {
@@ -1216,19 +1409,16 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
 
   // Retrieve required data
 
-  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
   const int crate    = hwCrate - m_crateOffsetHw;
   const int swCrate  = crate   + m_crateOffsetSw;
-  std::vector<unsigned int>& exVec(m_uintVec0);
-  std::vector<unsigned int>& eyVec(m_uintVec1);
-  std::vector<unsigned int>& etVec(m_uintVec2);
   LVL1::DataError derr;
   derr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
   const int ssError = derr.error();
-  std::vector<int> dummy(timeslices);
-  const int sliceBeg = ( neutralFormat ) ? 0          : sliceNum;
-  const int sliceEnd = ( neutralFormat ) ? timeslices : sliceNum + 1;
+  std::vector<int> dummy(numSlices);
+  const int sliceBeg = ( neutralFormat ) ? firstSlice             : sliceNum;
+  const int sliceEnd = ( neutralFormat ) ? firstSlice + numSlices : sliceNum + 1;
   for (int slice = sliceBeg; slice < sliceEnd; ++slice) {
+    const int sl = slice - firstSlice;
 
     if (collection == JET_ELEMENTS) {
 
@@ -1245,8 +1435,8 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
 	      LVL1::JetElement* je = findJetElement(eta, phi);
 	      if ( ! je ) {   // create new jet element
 	        const unsigned int key = m_elementKey->jeKey(phi, eta);
-	        je = new LVL1::JetElement(phi, eta, dummy, dummy, key,
-	                                  dummy, dummy, dummy, trigJem);
+	        je = m_jePool.create(m_jeCollection, phi, eta, dummy, dummy,
+	                             key, dummy, dummy, dummy, trigJemOut);
 	        m_jeMap.insert(std::make_pair(key, je));
 	        m_jeCollection->push_back(je);
               } else {
@@ -1255,7 +1445,7 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
 		const std::vector<int>& emError(je->emErrorVec());
 		const std::vector<int>& hadError(je->hadErrorVec());
 		const int nsl = emEnergy.size();
-		if (timeslices != nsl) {
+		if (numSlices != nsl) {
 		  if (debug) {
 		    msg() << "Inconsistent number of slices in sub-blocks"
 		          << endreq;
@@ -1263,8 +1453,8 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
 		  m_rodErr = L1CaloSubBlock::ERROR_SLICES;
 		  return;
                 }
-		if (emEnergy[slice] != 0 || hadEnergy[slice] != 0 ||
-		    emError[slice]  != 0 || hadError[slice]  != 0) {
+		if (emEnergy[sl] != 0 || hadEnergy[sl] != 0 ||
+		    emError[sl]  != 0 || hadError[sl]  != 0) {
                   if (debug) msg() << "Duplicate data for slice "
 		                   << slice << endreq;
                   m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
@@ -1278,7 +1468,7 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
 	      emErrBits.set(LVL1::DataError::LinkDown, linkError);
 	      hadErrBits.set(LVL1::DataError::Parity, jetEle.hadParity());
 	      hadErrBits.set(LVL1::DataError::LinkDown, linkError >> 1);
-	      je->addSlice(slice, jetEle.emData(), jetEle.hadData(),
+	      je->addSlice(sl, jetEle.emData(), jetEle.hadData(),
 	                          emErrBits.error(), hadErrBits.error(),
 	           	          linkError);
 	    }
@@ -1301,24 +1491,13 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
       const unsigned int ey = subBlock->ey(slice);
       const unsigned int et = subBlock->et(slice);
       if (ex | ey | et) {
-	LVL1::JEMEtSums* sums = findEnergySums(crate, module);
-	if ( ! sums ) {   // create new energy sums
-	  exVec.assign(timeslices, 0);
-	  eyVec.assign(timeslices, 0);
-	  etVec.assign(timeslices, 0);
-	  exVec[slice] = ex;
-	  eyVec[slice] = ey;
-	  etVec[slice] = et;
-	  sums = new LVL1::JEMEtSums(swCrate, module, etVec, exVec, eyVec,
-	                                                          trigJem);
-          m_etMap.insert(std::make_pair(crate*m_modules+module, sums));
-	  m_etCollection->push_back(sums);
+	const int key = crate*m_modules + module;
+	int sums = m_etStage.find(key);
+	if (sums < 0) {   // stage new energy sums
+	  const EnergySumsInfo info = { swCrate, module };
+	  sums = m_etStage.add(key, info, numSlices, trigJemOut);
         } else {
-	  exVec = sums->ExVec();
-	  eyVec = sums->EyVec();
-	  etVec = sums->EtVec();
-	  const int nsl = exVec.size();
-	  if (timeslices != nsl) {
+	  if (numSlices != m_etStage.slices(sums)) {
 	    if (debug) {
 	      msg() << "Inconsistent number of slices in sub-blocks"
 	            << endreq;
@@ -1326,19 +1505,16 @@ void JepByteStreamV2Tool::decodeJem(JemSubBlockV2* subBlock, int trigJem,
             m_rodErr = L1CaloSubBlock::ERROR_SLICES;
 	    return;
           }
-	  if (exVec[slice] != 0 || eyVec[slice] != 0 || etVec[slice] != 0) {
+	  if (m_etStage.sliceSet(sums, sl)) {
 	    if (debug) msg() << "Duplicate data for slice "
 	                     << slice << endreq;
             m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
 	    return;
           }
-	  exVec[slice] = ex;
-	  eyVec[slice] = ey;
-	  etVec[slice] = et;
-	  sums->addEx(exVec);
-	  sums->addEy(eyVec);
-	  sums->addEt(etVec);
         }
+	m_etStage.set(sums, EnergySumsInfo::EX, sl, ex);
+	m_etStage.set(sums, EnergySumsInfo::EY, sl, ey);
+	m_etStage.set(sums, EnergySumsInfo::ET, sl, et);
       } else if (verbose) {
         msg(MSG::VERBOSE) << "No energy sums data for crate/module/slice "
                           << hwCrate << "/" << module << "/" << slice
@@ -1362,9 +1538,15 @@ int JepByteStreamV2Tool::tobKey(const int crate, const int jem,
 
 LVL1::JetElement* JepByteStreamV2Tool::findJetElement(const double eta,
                                                       const double phi)
+{
+  return findJetElement(m_elementKey->jeKey(phi, eta));
+}
+
+// Find a jet element given key
+
+LVL1::JetElement* JepByteStreamV2Tool::findJetElement(const unsigned int key)
 {
   LVL1::JetElement* tt = 0;
-  const unsigned int key = m_elementKey->jeKey(phi, eta);
   JetElementMap::const_iterator mapIter;
   mapIter = m_jeMap.find(key);
   if (mapIter != m_jeMap.end()) tt = mapIter->second;
@@ -1510,6 +1692,40 @@ void JepByteStreamV2Tool::setupCmxEtMap(const CmxSumsCollection*
   }
 }
 
+// Set up the jet element key table used when writing bytestream
+// (NB. This assumes mappings won't change during the course of a job)
+
+void JepByteStreamV2Tool::setupChannelKeys()
+{
+  m_chanKeys.assign(m_crates * m_modules * m_channels,
+                    std::make_pair(false, 0u));
+  for (int crate = 0; crate < m_crates; ++crate) {
+    for (int module = 0; module < m_modules; ++module) {
+      for (int chan = 0; chan < m_channels; ++chan) {
+        double eta = 0.;
+        double phi = 0.;
+        int layer = 0;
+        if (m_jemMaps->mapping(crate, module, chan, eta, phi, layer)) {
+          const int index = (crate * m_modules + module) * m_channels + chan;
+          m_chanKeys[index] = std::make_pair(true,
+                                             m_elementKey->jeKey(phi, eta));
+        }
+      }
+    }
+  }
+}
+
+// Return jet element key for given crate/module/channel, false if not mapped
+
+bool JepByteStreamV2Tool::channelKey(const int crate, const int module,
+                                     const int chan, unsigned int& key) const
+{
+  const std::pair<bool, unsigned int>& entry =
+                        m_chanKeys[(crate * m_modules + module) * m_channels + chan];
+  key = entry.second;
+  return entry.first;
+}
+
 // Get number of slices and triggered slice offset for next slink
 
 bool JepByteStreamV2Tool::slinkSlices(const int crate, const int module,
@@ -1519,11 +1735,9 @@ bool JepByteStreamV2Tool::slinkSlices(const int crate, const int module,
   int trigJ  = m_dfltSlices/2;
   for (int mod = module; mod < module + modulesPerSlink; ++mod) {
     for (int chan = 0; chan < m_channels; ++chan) {
-      double eta = 0.;
-      double phi = 0.;
-      int layer = 0;
-      if ( !m_jemMaps->mapping(crate, mod, chan, eta, phi, layer)) continue;
-      const LVL1::JetElement* const je = findJetElement(eta, phi);
+      unsigned int key = 0;
+      if ( !channelKey(crate, mod, chan, key)) continue;
+      const LVL1::JetElement* const je = findJetElement(key);
       if ( !je ) continue;
       const int numdat = 5;
       std::vector<int> sums(numdat);
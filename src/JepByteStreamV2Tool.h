@@ -5,6 +5,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "AthenaBaseComps/AthAlgTool.h"
@@ -12,12 +13,20 @@
 #include "ByteStreamData/RawEvent.h"
 #include "DataModel/DataVector.h"
 #include "eformat/SourceIdentifier.h"
+#include "GaudiKernel/IIncidentListener.h"
+#include "GaudiKernel/ServiceHandle.h"
 #include "GaudiKernel/ToolHandle.h"
 
 #include "CmxEnergySubBlock.h"
+#include "L1CaloCrateRods.h"
+#include "L1CaloObjectPool.h"
+#include "L1CaloRodBuffers.h"
+#include "L1CaloSliceStage.h"
 
 class IInterface;
+class Incident;
 class InterfaceID;
+class SegMemSvc;
 class StatusCode;
 
 template <class T> class FullEventAssembler;
@@ -48,7 +57,8 @@ class L1CaloSrcIdMap;
  *  @author Peter Faulkner
  */
 
-class JepByteStreamV2Tool : public AthAlgTool {
+class JepByteStreamV2Tool : public AthAlgTool,
+                            virtual public IIncidentListener {
 
  public:
    JepByteStreamV2Tool(const std::string& type, const std::string& name,
@@ -61,6 +71,9 @@ class JepByteStreamV2Tool : public AthAlgTool {
    virtual StatusCode initialize();
    virtual StatusCode finalize();
 
+   /// Recycle the object pools at the start of each event
+   virtual void handle(const Incident& inc);
+
    /// Convert ROB fragments to jet elements
    StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
                       DataVector<LVL1::JetElement>* jeCollection);
@@ -77,12 +90,26 @@ class JepByteStreamV2Tool : public AthAlgTool {
    StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
                       DataVector<LVL1::CMXEtSums>* etCollection);
 
+   /// Convert ROB fragments of several events, one collection per event
+   template <class Collection>
+   StatusCode convert(
+       const std::vector<const IROBDataProviderSvc::VROBFRAG*>& robFragsBatch,
+       const std::vector<Collection*>& collections);
+
    /// Convert JEP Container to bytestream
    StatusCode convert(const LVL1::JEPBSCollectionV2* jep, RawEventWrite* re);
 
    /// Return reference to vector with all possible Source Identifiers
    const std::vector<uint32_t>& sourceIDs(const std::string& sgKey);
 
+   /// Get energy subBlock types from CMXEtSums source type
+   static void energySubBlockTypes(int source,
+                            CmxEnergySubBlock::SourceType& srcType,
+			    CmxEnergySubBlock::SumType&    sumType,
+			    CmxEnergySubBlock::HitsType&   hitType);
+   /// Get jet hits subBlock source ID from CMXJetHits source type
+   static int jetSubBlockSourceId(int source);
+
  private:
    enum CollectionType { JET_ELEMENTS, ENERGY_SUMS, CMX_TOBS,
                                        CMX_HITS, CMX_SUMS };
@@ -101,9 +128,52 @@ class JepByteStreamV2Tool : public AthAlgTool {
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      ROBPointer;
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      RODPointer;
 
+   /// Staged energy sums data
+   struct EnergySumsInfo {
+     enum { ET, EX, EY, FIELDS };
+     int crate;
+     int module;
+   };
+   /// Staged CMX TOB data
+   struct CmxTobInfo {
+     enum { ENERGY_LARGE, ENERGY_SMALL, TOB_ERROR, PRESENCE_MAP, FIELDS };
+     int crate;
+     int jem;
+     int frame;
+     int loc;
+   };
+   /// Staged CMX hits data
+   struct CmxHitsInfo {
+     enum { HITS0, HITS1, ERROR0, ERROR1, FIELDS };
+     int crate;
+     int source;
+   };
+   /// Staged CMX energy sums data
+   struct CmxSumsInfo {
+     enum { ET, EX, EY, ET_ERROR, EX_ERROR, EY_ERROR, FIELDS };
+     int crate;
+     int source;
+   };
+
+   /// Output RODs and sub-blocks for encoding one crate
+   struct CrateEncoder {
+     L1CaloCrateRods               rods;
+     DataVector<JemSubBlockV2>     jemBlocks;
+     DataVector<CmxEnergySubBlock> cmxEnergyBlocks;
+     DataVector<CmxJetSubBlock>    cmxJetBlocks;
+   };
+
+   /// Set up output collection and return its type
+   CollectionType setCollection(JetElementCollection* jeCollection);
+   CollectionType setCollection(EnergySumsCollection* etCollection);
+   CollectionType setCollection(CmxTobCollection* tobCollection);
+   CollectionType setCollection(CmxHitsCollection* hitCollection);
+   CollectionType setCollection(CmxSumsCollection* etCollection);
    /// Convert bytestream to given container type
    StatusCode convertBs(const IROBDataProviderSvc::VROBFRAG& robFrags,
                         CollectionType collection);
+   /// Check ROD source ID against ROB ID and configuration
+   bool validRodId(uint32_t sourceID, uint32_t robid);
    /// Unpack CMX-Energy sub-block
    void decodeCmxEnergy(CmxEnergySubBlock* subBlock, int trigJem);
    /// Unpack CMX-Jet sub-block
@@ -112,11 +182,22 @@ class JepByteStreamV2Tool : public AthAlgTool {
    /// Unpack JEM sub-block
    void decodeJem(JemSubBlockV2* subBlock, int trigJem,
                                          CollectionType collection);
+   /// Create objects from staged slices once all sub-blocks are unpacked
+   void createStaged(CollectionType collection);
 
    /// Find TOB map key for given crate, jem, frame, loc
    int tobKey(int crate, int jem, int frame, int loc);
+   /// Encode the RODs of one crate
+   void encodeCrate(int crate, CrateEncoder& enc, bool debug);
+   /// Set up the jet element key table used when writing bytestream
+   void setupChannelKeys();
+   /// Return jet element key for given crate/module/channel, false if not mapped
+   bool channelKey(int crate, int module, int chan, unsigned int& key) const;
+
    /// Find a jet element given eta, phi
    LVL1::JetElement* findJetElement(double eta, double phi);
+   /// Find a jet element given key
+   LVL1::JetElement* findJetElement(unsigned int key);
    /// Find energy sums for given crate, module
    LVL1::JEMEtSums*  findEnergySums(int crate, int module);
    /// Find CMX TOB for given key
@@ -140,14 +221,9 @@ class JepByteStreamV2Tool : public AthAlgTool {
    /// Get number of slices and triggered slice offset for next slink
    bool slinkSlices(int crate, int module, int modulesPerSlink,
                     int& timeslices, int& trigJem);
-   /// Get energy subBlock types from CMXEtSums source type
-   void energySubBlockTypes(int source,
-                            CmxEnergySubBlock::SourceType& srcType,
-			    CmxEnergySubBlock::SumType&    sumType,
-			    CmxEnergySubBlock::HitsType&   hitType);
-   /// Get jet hits subBlock source ID from CMXJetHits source type
-   int jetSubBlockSourceId(int source);
 
+   /// Memory service for the object pools
+   ServiceHandle<SegMemSvc> m_sms;
    /// Channel mapping tool
    ToolHandle<LVL1::IL1CaloMappingTool> m_jemMaps;
    /// Error collection tool
@@ -179,16 +255,24 @@ class JepByteStreamV2Tool : public AthAlgTool {
    int m_dfltSlices;
    /// Force number of slices in bytestream
    int m_forceSlices;
+   /// Number of slices either side of triggered slice to read (-1 = all)
+   int m_sliceWindow;
    /// Minimum crate number when writing out bytestream
    int m_crateMin;
    /// Maximum crate number when writing out bytestream
    int m_crateMax;
+   /// Encode crates concurrently when writing bytestream
+   bool m_parallelCrates;
+   /// Check ROD structure before unpacking
+   bool m_validateRods;
    /// Jet elements to accept (0=Core, 1=Overlap)
    int m_coreOverlap;
    /// Unpacking error code
    unsigned int m_rodErr;
    /// ROB source IDs
    std::vector<uint32_t> m_sourceIDs;
+   /// ROB ID of each ROD source ID already found to be valid
+   std::map<uint32_t, uint32_t> m_validRodIds;
    /// Sub-detector type
    eformat::SubDetector m_subDetector;
    /// Source ID converter
@@ -213,12 +297,10 @@ class JepByteStreamV2Tool : public AthAlgTool {
    std::vector<int> m_intVec1;
    /// Int unpacking vector 2
    std::vector<int> m_intVec2;
-   /// Vector for current JEM sub-blocks
-   DataVector<JemSubBlockV2> m_jemBlocks;
-   /// Vector for current CMX-Energy sub-blocks
-   DataVector<CmxEnergySubBlock> m_cmxEnergyBlocks;
-   /// Vector for current CMX-Jet sub-blocks
-   DataVector<CmxJetSubBlock> m_cmxJetBlocks;
+   /// Per-crate encoders for writing bytestream
+   DataVector<CrateEncoder> m_crateEncoders;
+   /// Jet element keys by crate/module/channel for writing bytestream
+   std::vector<std::pair<bool, unsigned int> > m_chanKeys;
    /// Current jet elements collection
    JetElementCollection* m_jeCollection;
    /// Current energy sums collection
@@ -239,15 +321,58 @@ class JepByteStreamV2Tool : public AthAlgTool {
    CmxHitsMap    m_cmxHitsMap;
    /// CMX energy sums map
    CmxSumsMap    m_cmxEtMap;
+   /// Energy sums slices staged for creation
+   L1CaloSliceStage<EnergySumsInfo> m_etStage;
+   /// CMX TOB slices staged for creation
+   L1CaloSliceStage<CmxTobInfo>     m_cmxTobStage;
+   /// CMX hits slices staged for creation
+   L1CaloSliceStage<CmxHitsInfo>    m_cmxHitsStage;
+   /// CMX energy sums slices staged for creation
+   L1CaloSliceStage<CmxSumsInfo>    m_cmxEtStage;
+   /// Jet element pool
+   L1CaloObjectPool<LVL1::JetElement> m_jePool;
+   /// Energy sums pool
+   L1CaloObjectPool<LVL1::JEMEtSums>  m_etPool;
+   /// CMX TOB pool
+   L1CaloObjectPool<LVL1::CMXJetTob>  m_cmxTobPool;
+   /// CMX hits pool
+   L1CaloObjectPool<LVL1::CMXJetHits> m_cmxHitsPool;
+   /// CMX energy sums pool
+   L1CaloObjectPool<LVL1::CMXEtSums>  m_cmxEtPool;
    /// ROD Status words
    std::vector<uint32_t>* m_rodStatus;
    /// ROD status map
    std::map<uint32_t, std::vector<uint32_t>* > m_rodStatusMap;
    /// Event assembler
    FullEventAssembler<L1CaloSrcIdMap>* m_fea;
+   /// ROD buffer sizes for writing
+   L1CaloRodBuffers m_rodBuffers;
 
 };
 
+// Decode the events back to back.  The ROB fragments are fetched by the
+// caller; here the ROD source IDs checked for one event are not looked
+// up again and the sub-blocks and staging areas are reused throughout.
+
+template <class Collection>
+StatusCode JepByteStreamV2Tool::convert(
+    const std::vector<const IROBDataProviderSvc::VROBFRAG*>& robFragsBatch,
+    const std::vector<Collection*>& collections)
+{
+  if (robFragsBatch.size() != collections.size()) {
+    msg(MSG::ERROR) << "Batch of " << robFragsBatch.size()
+                    << " events given " << collections.size()
+                    << " collections" << endreq;
+    return StatusCode::FAILURE;
+  }
+  for (size_t evt = 0; evt < robFragsBatch.size(); ++evt) {
+    const CollectionType type = setCollection(collections[evt]);
+    const StatusCode sc = convertBs(*robFragsBatch[evt], type);
+    if (sc.isFailure()) return sc;
+  }
+  return StatusCode::SUCCESS;
+}
+
 } // end namespace
 
 #endif
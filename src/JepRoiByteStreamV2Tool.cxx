@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <bitset>
+#include <chrono>
 #include <numeric>
 #include <set>
 #include <utility>
@@ -17,6 +20,7 @@
 #include "CmxSubBlock.h"
 #include "JemRoiSubBlockV2.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 #include "L1CaloUserHeader.h"
@@ -43,6 +47,7 @@ JepRoiByteStreamV2Tool::JepRoiByteStreamV2Tool(const std::string& type,
   : AthAlgTool(type, name, parent),
     m_errorTool("LVL1BS::L1CaloErrorByteStreamTool/L1CaloErrorByteStreamTool"),
     m_crates(2), m_modules(16), m_frames(8), m_maxRoiWords(6),
+    m_roibCalls(0), m_roibTotalNs(0), m_roibMaxNs(0),
     m_srcIdMap(0), m_subBlock(0), m_rodStatus(0), m_fea(0)
 {
   declareInterface<JepRoiByteStreamV2Tool>(this);
@@ -59,6 +64,8 @@ JepRoiByteStreamV2Tool::JepRoiByteStreamV2Tool(const std::string& type,
                   "ROB fragment source identifiers");
   declareProperty("ROBSourceIDsRoIB",   m_sourceIDsRoIB,
                   "ROB fragment source identifiers");
+  declareProperty("FastRoIB",           m_fastRoIB = true,
+                  "Use fast decoder for RoIB fragments");
 
   // Properties for writing bytestream only
   declareProperty("DataVersion",    m_version       = 2,                   //<<== CHECK
@@ -109,6 +116,11 @@ StatusCode JepRoiByteStreamV2Tool::initialize()
 
 StatusCode JepRoiByteStreamV2Tool::finalize()
 {
+  if (m_roibCalls) {
+    msg(MSG::INFO) << "Fast RoIB decoder: " << m_roibCalls << " calls, mean "
+                   << m_roibTotalNs/m_roibCalls << " ns, max "
+		   << m_roibMaxNs << " ns" << endreq;
+  }
   delete m_fea;
   delete m_rodStatus;
   delete m_subBlock;
@@ -123,6 +135,16 @@ StatusCode JepRoiByteStreamV2Tool::convert(
                             DataVector<LVL1::JEMTobRoI>* const jeCollection)
 {
   m_jeCollection = jeCollection;
+  if (m_fastRoIB && isRoIB(robFrags)) {
+    RoIBResult result;
+    if (decodeRoIB(robFrags, result, true, false)) {
+      jeCollection->reserve(jeCollection->size() + result.nJemRois);
+      for (int i = 0; i < result.nJemRois; ++i) {
+        jeCollection->push_back(new LVL1::JEMTobRoI(result.jemRoiWords[i]));
+      }
+      return StatusCode::SUCCESS;
+    }
+  }
   return convertBs(robFrags, JEM_ROI);
 }
 
@@ -133,9 +155,32 @@ StatusCode JepRoiByteStreamV2Tool::convert(
                             LVL1::CMXRoI* const cmCollection)
 {
   m_cmCollection = cmCollection;
+  if (m_fastRoIB && isRoIB(robFrags)) {
+    RoIBResult result;
+    if (decodeRoIB(robFrags, result, false, true)) {
+      for (int i = 0; i < result.nCmxRoiWords; ++i) {
+        cmCollection->setRoiWord(result.cmxRoiWords[i]);
+      }
+      return StatusCode::SUCCESS;
+    }
+  }
   return convertBs(robFrags, CMX_ROI);
 }
 
+// Fast conversion of RoIB fragments to fixed-size result
+
+StatusCode JepRoiByteStreamV2Tool::convertRoIB(
+                            const IROBDataProviderSvc::VROBFRAG& robFrags,
+                            RoIBResult& result)
+{
+  if (!decodeRoIB(robFrags, result, true, true)) {
+    msg(MSG::ERROR) << "Unexpected sub-block data or DAQ fragments "
+                    << "in RoIB input" << endreq;
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
 // Conversion of JEP container to bytestream
 
 StatusCode JepRoiByteStreamV2Tool::convert(
@@ -151,6 +196,7 @@ StatusCode JepRoiByteStreamV2Tool::convert(
   const uint16_t minorVersion = m_srcIdMap->minorVersion();
   m_fea->setRodMinorVersion(minorVersion);
   m_rodStatusMap.clear();
+  m_rodBuffers.clear();
 
   // Pointer to ROD data vector
 
@@ -187,7 +233,7 @@ StatusCode JepRoiByteStreamV2Tool::convert(
         }
 	const uint32_t rodIdJem = m_srcIdMap->getRodID(hwCrate, slink, daqOrRoi,
 	                                                        m_subDetector);
-	theROD = m_fea->getRodData(rodIdJem);
+	theROD = m_rodBuffers.getRodData(m_fea, rodIdJem, 1);
         if (neutralFormat) {
           const L1CaloUserHeader userHeader;
 	  theROD->push_back(userHeader.header());
@@ -303,6 +349,7 @@ StatusCode JepRoiByteStreamV2Tool::convert(
 
   // Fill the raw event
 
+  m_rodBuffers.record();
   m_fea->fill(re, msg());
 
   // Set ROD status words
@@ -352,8 +399,13 @@ StatusCode JepRoiByteStreamV2Tool::convertBs(
   // Loop over ROB fragments
 
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
   std::set<uint32_t> dupRoiCheck;
+  // Reserve for the maximum possible number of JEM RoIs
+  if (collection == JEM_ROI) {
+    m_jeCollection->reserve(m_jeCollection->size() +
+                            m_crates * m_modules * m_frames);
+  }
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();
   for (; rob != robEnd; ++rob) {
@@ -378,7 +430,7 @@ StatusCode JepRoiByteStreamV2Tool::convertBs(
 
     // Skip duplicate fragments
 
-    if (!dupCheck.insert(robid).second) {
+    if (!dupCheck.insert(robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
       if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
       continue;
@@ -518,7 +570,8 @@ StatusCode JepRoiByteStreamV2Tool::convertBs(
           JemRoiSubBlockV2 subBlock;
           payload = subBlock.read(payload, payloadEnd);
 	  if (collection == JEM_ROI) {
-	    if (subBlock.dataWords() && !subBlock.unpack()) {
+	    // Unpack straight into the collection
+	    if (subBlock.dataWords() && !subBlock.unpack(m_jeCollection)) {
 	      if (debug) {
 		std::string errMsg(subBlock.unpackErrorMsg());
 	        msg() << "JEM RoI sub-block unpacking failed: "
@@ -527,12 +580,6 @@ StatusCode JepRoiByteStreamV2Tool::convertBs(
               rodErr = m_subBlock->unpackErrorCode();
               break;
             }
-	    for (int frame = 0; frame < m_frames; ++frame) {
-	      const LVL1::JEMTobRoI roi = subBlock.roi(frame);
-	      if (roi.energyLarge() || roi.energySmall()) {
-		m_jeCollection->push_back(new LVL1::JEMTobRoI(roi));
-	      }
-	    }
           }
         }
       } else {
@@ -587,6 +634,177 @@ StatusCode JepRoiByteStreamV2Tool::convertBs(
   return StatusCode::SUCCESS;
 }
 
+// Return true if all fragments are from the RoIB slinks
+
+bool JepRoiByteStreamV2Tool::isRoIB(
+                            const IROBDataProviderSvc::VROBFRAG& robFrags)
+{
+  if (robFrags.empty()) return false;
+  ROBIterator rob    = robFrags.begin();
+  ROBIterator robEnd = robFrags.end();
+  for (; rob != robEnd; ++rob) {
+    if (m_srcIdMap->slink((*rob)->rod_source_id()) < 2) return false;
+  }
+  return true;
+}
+
+// Fast decoding of RoIB fragments.
+// These contain RoI words only, so the sub-block machinery, maps and debug
+// printout of convertBs are bypassed.  Errors are reported as in convertBs
+// but only once the whole event has been scanned, so that if sub-block data
+// are found we can return false and leave it to convertBs without double
+// counting.
+
+bool JepRoiByteStreamV2Tool::decodeRoIB(
+                            const IROBDataProviderSvc::VROBFRAG& robFrags,
+                            RoIBResult& result, const bool jemRois,
+                            const bool cmxRois)
+{
+  const std::chrono::steady_clock::time_point start =
+                                         std::chrono::steady_clock::now();
+  result.nJemRois     = 0;
+  result.nCmxRoiWords = 0;
+  result.latencyNs    = 0;
+
+  std::vector<std::pair<uint32_t, unsigned int> > robErrors;
+  std::vector<std::pair<uint32_t, unsigned int> > rodErrors;
+  std::bitset<8192> jemLocations;   // JEM RoI word bits 19-31
+  uint32_t cmxTypes = 0;            // CMX RoI word bits 27-31
+  const int maxRobs = 8;
+  uint32_t robids[maxRobs];
+  int nRobs = 0;
+  LVL1::JEMTobRoI jroi;
+  LVL1::CMXRoI    croi;
+
+  ROBIterator rob    = robFrags.begin();
+  ROBIterator robEnd = robFrags.end();
+  for (; rob != robEnd; ++rob) {
+
+    // DAQ slink fragments need the general decoder
+    if (m_srcIdMap->slink((*rob)->rod_source_id()) < 2) return false;
+
+    // Skip fragments with ROB status errors or duplicates.
+    // There is only one RoIB fragment per crate so a linear search is fine.
+    const uint32_t robid = (*rob)->source_id();
+    if ((*rob)->nstatus() > 0) {
+      ROBPointer robData;
+      (*rob)->status(robData);
+      if (*robData != 0) {
+        robErrors.push_back(std::make_pair(robid, *robData));
+	continue;
+      }
+    }
+    if (std::find(robids, robids + nRobs, robid) != robids + nRobs) {
+      rodErrors.push_back(std::make_pair(robid,
+                          (unsigned int)L1CaloSubBlock::ERROR_DUPLICATE_ROB));
+      continue;
+    }
+    if (nRobs < maxRobs) robids[nRobs++] = robid;
+
+    RODPointer payload;
+    (*rob)->rod_data(payload);
+    const RODPointer payloadEnd = payload + (*rob)->rod_ndata();
+    if (payload == payloadEnd) continue;
+
+    // Validate source identifier and version once per fragment
+    const uint32_t sourceID = (*rob)->rod_source_id();
+    const int rodCrate = m_srcIdMap->crate(sourceID);
+    if (m_srcIdMap->getRobID(sourceID) != robid         ||
+        m_srcIdMap->subDet(sourceID)   != m_subDetector ||
+        m_srcIdMap->daqOrRoi(sourceID) != 1             ||
+        m_srcIdMap->slink(sourceID)    != 2             ||
+        rodCrate < m_crateOffsetHw || rodCrate >= m_crateOffsetHw + m_crates) {
+      rodErrors.push_back(std::make_pair(robid,
+                          (unsigned int)L1CaloSubBlock::ERROR_ROD_ID));
+      continue;
+    }
+    const int minorVersion = (*rob)->rod_version() & 0xffff;
+    if (minorVersion <= m_srcIdMap->minorVersionPreLS1()) continue;
+    if (L1CaloUserHeader::isValid(*payload)) {
+      L1CaloUserHeader userHeader(*payload);
+      userHeader.setVersion(minorVersion);
+      if (userHeader.words() != 1) {
+        rodErrors.push_back(std::make_pair(robid,
+                            (unsigned int)L1CaloSubBlock::ERROR_USER_HEADER));
+        continue;
+      }
+      ++payload;
+    }
+    const int crate = rodCrate - m_crateOffsetHw;
+
+    // RoI words
+    unsigned int rodErr = L1CaloSubBlock::ERROR_NONE;
+    for (; payload != payloadEnd; ++payload) {
+      const uint32_t word = *payload;
+      if (L1CaloSubBlock::wordType(word) == L1CaloSubBlock::HEADER) {
+        return false;
+      }
+      if (jroi.setRoiWord(word)) {
+        if (!jemRois) continue;
+	const uint32_t location = word >> 19;
+	if (jroi.crate() != crate) {
+	  rodErr = L1CaloSubBlock::ERROR_CRATE_NUMBER;
+	  break;
+        }
+	if (jemLocations.test(location)) {
+	  rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
+	  break;
+        }
+	jemLocations.set(location);
+	if (jroi.energyLarge() || jroi.energySmall()) {
+	  if (result.nJemRois >= RoIBResult::MAX_JEM_ROIS) {
+	    rodErr = L1CaloSubBlock::UNPACK_EXCESS_ROIS;
+	    break;
+          }
+	  result.jemRoiWords[result.nJemRois++] = word;
+        }
+      } else if (croi.setRoiWord(word)) {
+        if (!cmxRois) continue;
+	const uint32_t typeBit = 1u << (word >> 27);
+	if (cmxTypes & typeBit) {
+	  rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
+	  break;
+        }
+	if (result.nCmxRoiWords >= RoIBResult::MAX_CMX_ROI_WORDS) {
+	  rodErr = L1CaloSubBlock::UNPACK_EXCESS_ROIS;
+	  break;
+        }
+	cmxTypes |= typeBit;
+	result.cmxRoiWords[result.nCmxRoiWords++] = word;
+      } else {
+        rodErr = L1CaloSubBlock::ERROR_ROI_TYPE;
+	break;
+      }
+    }
+    if (rodErr != L1CaloSubBlock::ERROR_NONE) {
+      rodErrors.push_back(std::make_pair(robid, rodErr));
+    }
+  }
+
+  // Report any errors
+  std::vector<std::pair<uint32_t, unsigned int> >::const_iterator iter;
+  for (iter = robErrors.begin(); iter != robErrors.end(); ++iter) {
+    m_errorTool->robError(iter->first, iter->second);
+  }
+  for (iter = rodErrors.begin(); iter != rodErrors.end(); ++iter) {
+    m_errorTool->rodError(iter->first, iter->second);
+  }
+
+  // Latency
+  result.latencyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - start).count();
+  ++m_roibCalls;
+  m_roibTotalNs += result.latencyNs;
+  if (result.latencyNs > m_roibMaxNs) m_roibMaxNs = result.latencyNs;
+  if (msgLvl(MSG::DEBUG)) {
+    msg(MSG::DEBUG) << "Fast RoIB decoder: " << result.nJemRois
+                    << " JEM RoIs, " << result.nCmxRoiWords
+		    << " CMX RoI words in " << result.latencyNs << " ns"
+		    << endreq;
+  }
+  return true;
+}
+
 // Find CMX energy sums for given crate, source
 
 const LVL1::CMXEtSums* JepRoiByteStreamV2Tool::findCmxSums(const int crate,
@@ -14,6 +14,7 @@
 #include "eformat/SourceIdentifier.h"
 #include "GaudiKernel/ToolHandle.h"
 #include "CmxEnergySubBlock.h"
+#include "L1CaloRodBuffers.h"
 
 class IInterface;
 class InterfaceID;
@@ -62,6 +63,23 @@ class JepRoiByteStreamV2Tool : public AthAlgTool {
    StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
                       LVL1::CMXRoI* cmCollection);
 
+   /// Fixed-size result of the fast RoIB decoder
+   struct RoIBResult {
+     enum { MAX_JEM_ROIS = 256, MAX_CMX_ROI_WORDS = 8 };
+     /// Non-zero JEM TOB RoI words
+     uint32_t jemRoiWords[MAX_JEM_ROIS];
+     /// CMX energy RoI words (sums and threshold hits)
+     uint32_t cmxRoiWords[MAX_CMX_ROI_WORDS];
+     int      nJemRois;
+     int      nCmxRoiWords;
+     /// Decoding time for this call
+     uint64_t latencyNs;
+   };
+
+   /// Fast decoding of RoIB ROB fragments into fixed-size result
+   StatusCode convertRoIB(const IROBDataProviderSvc::VROBFRAG& robFrags,
+                          RoIBResult& result);
+
    /// Convert JEP RoI Container to bytestream
    StatusCode convert(const LVL1::JEPRoIBSCollectionV2* jep, RawEventWrite* re);
 
@@ -82,6 +100,11 @@ class JepRoiByteStreamV2Tool : public AthAlgTool {
    /// Convert bytestream to given container type
    StatusCode convertBs(const IROBDataProviderSvc::VROBFRAG& robFrags,
                         CollectionType collection);
+   /// Return true if all fragments are from the RoIB slinks
+   bool isRoIB(const IROBDataProviderSvc::VROBFRAG& robFrags);
+   /// Fast decoding of RoIB fragments, false if general path is needed
+   bool decodeRoIB(const IROBDataProviderSvc::VROBFRAG& robFrags,
+                   RoIBResult& result, bool jemRois, bool cmxRois);
 
    /// Error collection tool
    ToolHandle<LVL1BS::L1CaloErrorByteStreamTool> m_errorTool;
@@ -116,6 +139,14 @@ class JepRoiByteStreamV2Tool : public AthAlgTool {
    int m_frames;
    /// Number of CMX energy RoI words
    int m_maxRoiWords;
+   /// Use fast decoder for RoIB fragments
+   bool m_fastRoIB;
+   /// Fast RoIB decoder calls
+   uint64_t m_roibCalls;
+   /// Fast RoIB decoder total time
+   uint64_t m_roibTotalNs;
+   /// Fast RoIB decoder maximum time
+   uint64_t m_roibMaxNs;
    /// Number of slinks per crate when writing out bytestream
    int m_slinks;
    /// Minimum crate number when writing out bytestream
@@ -146,6 +177,8 @@ class JepRoiByteStreamV2Tool : public AthAlgTool {
    std::map<uint32_t, std::vector<uint32_t>* > m_rodStatusMap;
    /// Event assembler
    FullEventAssembler<L1CaloSrcIdMap>* m_fea;
+   /// ROD buffer sizes for writing
+   L1CaloRodBuffers m_rodBuffers;
 
 };
 
@@ -0,0 +1,58 @@
+
+#include "L1CaloCrateRods.h"
+
+namespace LVL1BS {
+
+L1CaloCrateRods::L1CaloCrateRods() : m_used(0)
+{
+}
+
+// Start a new event, keeping the buffers
+
+void L1CaloCrateRods::clear()
+{
+  m_used = 0;
+  m_error.clear();
+}
+
+// Start a new ROD and return its data vector
+
+L1CaloCrateRods::RODDATA* L1CaloCrateRods::newRod(const uint32_t rodId,
+                                                  const int slices)
+{
+  if (m_used == m_rods.size()) m_rods.push_back(Rod());
+  Rod& rod(m_rods[m_used++]);
+  rod.rodId  = rodId;
+  rod.slices = slices;
+  rod.data.clear();
+  return &rod.data;
+}
+
+// Record an encoding failure
+
+void L1CaloCrateRods::setError(const std::string& error)
+{
+  m_error = error;
+}
+
+// Return the source IDs of the RODs encoded
+
+void L1CaloCrateRods::rodIds(std::vector<uint32_t>& ids) const
+{
+  ids.clear();
+  for (size_t i = 0; i < m_used; ++i) ids.push_back(m_rods[i].rodId);
+}
+
+// Append the RODs, in the order they were started, to the event
+
+void L1CaloCrateRods::merge(FullEventAssembler<L1CaloSrcIdMap>* const fea,
+                            L1CaloRodBuffers& rodBuffers) const
+{
+  for (size_t i = 0; i < m_used; ++i) {
+    const Rod& rod(m_rods[i]);
+    RODDATA* const theROD = rodBuffers.getRodData(fea, rod.rodId, rod.slices);
+    theROD->insert(theROD->end(), rod.data.begin(), rod.data.end());
+  }
+}
+
+} // end namespace
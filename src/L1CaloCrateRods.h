@@ -0,0 +1,102 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOCRATERODS_H
+#define TRIGT1CALOBYTESTREAM_L1CALOCRATERODS_H
+
+#include <stdint.h>
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "ByteStreamCnvSvcBase/FullEventAssembler.h"
+#include "DataModel/DataVector.h"
+
+#include "L1CaloRodBuffers.h"
+#include "L1CaloSrcIdMap.h"
+
+namespace LVL1BS {
+
+/** RODs encoded for one crate when writing bytestream.
+ *
+ *  Lets crates be packed independently, possibly concurrently, and then
+ *  added to the FullEventAssembler in a fixed order so that the output
+ *  does not depend on how the work was scheduled.
+ */
+
+class L1CaloCrateRods {
+
+ public:
+   typedef FullEventAssembler<L1CaloSrcIdMap>::RODDATA RODDATA;
+
+   L1CaloCrateRods();
+
+   /// Start a new event, keeping the buffers
+   void clear();
+   /// Start a new ROD and return its data vector
+   RODDATA* newRod(uint32_t rodId, int slices);
+   /// Record an encoding failure
+   void setError(const std::string& error);
+   /// Return true if encoding failed
+   bool failed() const;
+   /// Return the failure message
+   const std::string& error() const;
+   /// Return the source IDs of the RODs encoded
+   void rodIds(std::vector<uint32_t>& ids) const;
+   /// Append the RODs, in the order they were started, to the event
+   void merge(FullEventAssembler<L1CaloSrcIdMap>* fea,
+              L1CaloRodBuffers& rodBuffers) const;
+
+ private:
+   struct Rod {
+     uint32_t rodId;
+     int      slices;
+     RODDATA  data;
+   };
+
+   std::vector<Rod> m_rods;
+   size_t           m_used;
+   std::string      m_error;
+
+};
+
+inline bool L1CaloCrateRods::failed() const
+{
+  return !m_error.empty();
+}
+
+inline const std::string& L1CaloCrateRods::error() const
+{
+  return m_error;
+}
+
+/// Call encode(crate, encoder) for each crate in [crateMin, crateMax],
+/// one thread per crate if parallel is set.  encoders are created as
+/// needed and indexed from crateMin.
+
+template <class Encoder, class Func>
+void encodeCrates(DataVector<Encoder>& encoders, int crateMin, int crateMax,
+                  bool parallel, Func encode)
+{
+  const int ncrates = crateMax - crateMin + 1;
+  while (static_cast<int>(encoders.size()) < ncrates) {
+    encoders.push_back(new Encoder);
+  }
+  if (!parallel || ncrates < 2) {
+    for (int crate = crateMin; crate <= crateMax; ++crate) {
+      encode(crate, *encoders[crate - crateMin]);
+    }
+    return;
+  }
+  std::vector<std::future<void> > results;
+  results.reserve(ncrates);
+  for (int crate = crateMin; crate <= crateMax; ++crate) {
+    Encoder* const encoder = encoders[crate - crateMin];
+    results.push_back(std::async(std::launch::async,
+                      [&encode, crate, encoder]() { encode(crate, *encoder); }));
+  }
+  // get() rethrows any exception from the encoding thread
+  for (size_t i = 0; i < results.size(); ++i) results[i].get();
+}
+
+} // end namespace
+
+#endif
@@ -0,0 +1,495 @@
+
+#include <future>
+
+#include "GaudiKernel/ISvcLocator.h"
+#include "GaudiKernel/MsgStream.h"
+#include "GaudiKernel/StatusCode.h"
+#include "StoreGate/StoreGateSvc.h"
+
+#include "EventInfo/EventID.h"
+#include "EventInfo/EventInfo.h"
+
+#include "TrigT1CaloEvent/CMXCPHits.h"
+#include "TrigT1CaloEvent/CMXCPTob.h"
+#include "TrigT1CaloEvent/CMXEtSums.h"
+#include "TrigT1CaloEvent/CMXJetHits.h"
+#include "TrigT1CaloEvent/CMXJetTob.h"
+#include "TrigT1CaloEvent/CMXRoI.h"
+#include "TrigT1CaloEvent/CPMTobRoI.h"
+#include "TrigT1CaloEvent/CPMTower.h"
+#include "TrigT1CaloEvent/JEMEtSums.h"
+#include "TrigT1CaloEvent/JEMTobRoI.h"
+#include "TrigT1CaloEvent/JetElement.h"
+#include "TrigT1CaloEvent/RODHeader.h"
+#include "TrigT1Interfaces/TrigT1CaloDefs.h"
+
+#include "xAODTrigL1Calo/TriggerTowerAuxContainer.h"
+#include "xAODTrigL1Calo/TriggerTowerContainer.h"
+
+#include "CpByteStreamV2Tool.h"
+#include "CpmRoiByteStreamV2Tool.h"
+#include "JepByteStreamV2Tool.h"
+#include "JepRoiByteStreamV2Tool.h"
+#include "RodHeaderByteStreamTool.h"
+#include "xaod/L1CaloByteStreamReadTool.h"
+
+#include "L1CaloDecodeAlg.h"
+
+namespace LVL1BS {
+
+L1CaloDecodeAlg::L1CaloDecodeAlg(const std::string& name,
+                                 ISvcLocator* pSvcLocator)
+                 : AthAlgorithm(name, pSvcLocator),
+  m_ppmTool("LVL1BS::L1CaloByteStreamReadTool/L1CaloByteStreamReadTool"),
+  m_cpTool("LVL1BS::CpByteStreamV2Tool/CpByteStreamV2Tool"),
+  m_jepTool("LVL1BS::JepByteStreamV2Tool/JepByteStreamV2Tool"),
+  m_cpRoiTool("LVL1BS::CpmRoiByteStreamV2Tool/CpmRoiByteStreamV2Tool"),
+  m_jepRoiTool("LVL1BS::JepRoiByteStreamV2Tool/JepRoiByteStreamV2Tool"),
+  m_rodTool("LVL1BS::RodHeaderByteStreamTool/RodHeaderByteStreamTool"),
+  m_robDataProvider("ROBDataProviderSvc", name),
+  m_ppmCacheEvent(0), m_triggerTowers(0)
+{
+  declareProperty("L1CaloByteStreamReadTool", m_ppmTool);
+  declareProperty("CpByteStreamV2Tool",       m_cpTool);
+  declareProperty("JepByteStreamV2Tool",      m_jepTool);
+  declareProperty("CpmRoiByteStreamV2Tool",   m_cpRoiTool);
+  declareProperty("JepRoiByteStreamV2Tool",   m_jepRoiTool);
+  declareProperty("RodHeaderByteStreamTool",  m_rodTool);
+
+  declareProperty("xAODTriggerTowerLocation", m_triggerTowerLocation =
+                   LVL1::TrigT1CaloDefs::xAODTriggerTowerLocation);
+  declareProperty("CPMTowerLocation",   m_cpmTowerLocation =
+                   LVL1::TrigT1CaloDefs::CPMTowerLocation);
+  declareProperty("CMXCPTobLocation",   m_cmxCpTobLocation =
+                   LVL1::TrigT1CaloDefs::CMXCPTobLocation);
+  declareProperty("CMXCPHitsLocation",  m_cmxCpHitsLocation =
+                   LVL1::TrigT1CaloDefs::CMXCPHitsLocation);
+  declareProperty("JetElementLocation", m_jetElementLocation =
+                   LVL1::TrigT1CaloDefs::JetElementLocation);
+  declareProperty("JEMEtSumsLocation",  m_jemEtSumsLocation =
+                   LVL1::TrigT1CaloDefs::JEMEtSumsLocation);
+  declareProperty("CMXJetTobLocation",  m_cmxJetTobLocation =
+                   LVL1::TrigT1CaloDefs::CMXJetTobLocation);
+  declareProperty("CMXJetHitsLocation", m_cmxJetHitsLocation =
+                   LVL1::TrigT1CaloDefs::CMXJetHitsLocation);
+  declareProperty("CMXEtSumsLocation",  m_cmxEtSumsLocation =
+                   LVL1::TrigT1CaloDefs::CMXEtSumsLocation);
+  declareProperty("CPMTobRoILocation",  m_cpmTobRoiLocation =
+                   LVL1::TrigT1CaloDefs::CPMTobRoILocation);
+  declareProperty("JEMTobRoILocation",  m_jemTobRoiLocation =
+                   LVL1::TrigT1CaloDefs::JEMTobRoILocation);
+  declareProperty("CMXRoILocation",     m_cmxRoiLocation =
+                   LVL1::TrigT1CaloDefs::CMXRoILocation);
+  declareProperty("RODHeaderLocation",  m_rodHeaderLocation =
+                   LVL1::TrigT1CaloDefs::RODHeaderLocation);
+  declareProperty("Parallel",           m_parallel = false,
+                  "Decode the subsystems concurrently - the decoding tools "
+                  "must then not write to the message service");
+  declareProperty("PpmCacheOutput",     m_ppmCacheOutput = "",
+                  "Write trigger towers to this PPM column cache file");
+  declareProperty("PpmCacheInput",      m_ppmCacheInput = "",
+                  "Read trigger towers from this PPM column cache file");
+  declareProperty("PpmCacheEventsPerBlock", m_ppmCacheEventsPerBlock = 100);
+}
+
+L1CaloDecodeAlg::~L1CaloDecodeAlg()
+{
+}
+
+// Initialize
+
+#ifndef PACKAGE_VERSION
+#define PACKAGE_VERSION "unknown"
+#endif
+
+StatusCode L1CaloDecodeAlg::initialize()
+{
+  msg(MSG::INFO) << "Initializing " << name() << " - package version "
+                 << PACKAGE_VERSION << endreq;
+
+  StatusCode sc = m_ppmTool.retrieve();
+  if (sc.isSuccess()) sc = m_cpTool.retrieve();
+  if (sc.isSuccess()) sc = m_jepTool.retrieve();
+  if (sc.isSuccess()) sc = m_cpRoiTool.retrieve();
+  if (sc.isSuccess()) sc = m_jepRoiTool.retrieve();
+  if (sc.isSuccess()) sc = m_rodTool.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve decoding tools" << endreq;
+    return sc;
+  }
+  sc = m_robDataProvider.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve service "
+                    << m_robDataProvider << endreq;
+    return sc;
+  }
+
+  // The message service can't take output from several threads at once,
+  // and the tools report bad data at WARNING and ERROR level.
+  if (m_parallel && (m_ppmTool->msgLvl(MSG::ERROR)    ||
+                     m_cpTool->msgLvl(MSG::ERROR)     ||
+                     m_jepTool->msgLvl(MSG::ERROR)    ||
+                     m_cpRoiTool->msgLvl(MSG::ERROR)  ||
+                     m_jepRoiTool->msgLvl(MSG::ERROR) ||
+                     m_rodTool->msgLvl(MSG::ERROR))) {
+    msg(MSG::WARNING) << "Parallel decoding with tool messages enabled - "
+                      << "set the decoding tools' OutputLevel to FATAL"
+                      << endreq;
+  }
+
+  if (!m_ppmCacheInput.empty()) {
+    if (!m_ppmCacheReader.open(m_ppmCacheInput)) {
+      msg(MSG::ERROR) << "Failed to open PPM cache " << m_ppmCacheInput
+                      << endreq;
+      return StatusCode::FAILURE;
+    }
+    msg(MSG::INFO) << "Reading trigger towers for "
+                   << m_ppmCacheReader.events() << " events from "
+                   << m_ppmCacheInput << endreq;
+  }
+  if (!m_ppmCacheOutput.empty()) {
+    if (!m_ppmCacheWriter.open(m_ppmCacheOutput, m_ppmCacheEventsPerBlock)) {
+      msg(MSG::ERROR) << "Failed to create PPM cache " << m_ppmCacheOutput
+                      << endreq;
+      return StatusCode::FAILURE;
+    }
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+// Execute
+
+StatusCode L1CaloDecodeAlg::execute()
+{
+  std::vector<Task> tasks;
+  StatusCode sc = addPpmTask(tasks);
+  if (sc.isSuccess()) sc = addCpTask(tasks);
+  if (sc.isSuccess()) sc = addJepTask(tasks);
+  if (sc.isSuccess()) sc = addCpRoiTask(tasks);
+  if (sc.isSuccess()) sc = addJepRoiTask(tasks);
+  if (sc.isSuccess()) sc = addRodHeaderTask(tasks);
+  if (sc.isFailure()) return sc;
+
+  sc = runTasks(tasks);
+  if (sc.isSuccess() && m_triggerTowers && m_ppmCacheWriter.isOpen()) {
+    uint32_t run = 0;
+    uint64_t event = 0;
+    sc = eventId(run, event);
+    // Towers read with LazyFadc would be cached without their FADC data
+    for (xAOD::TriggerTower* tt : *m_triggerTowers) {
+      if (sc.isFailure()) break;
+      sc = m_ppmTool->decodeFadc(tt);
+    }
+    if (sc.isSuccess() &&
+        !m_ppmCacheWriter.add(run, event, *m_triggerTowers)) {
+      msg(MSG::ERROR) << "Failed to write PPM cache " << m_ppmCacheOutput
+                      << endreq;
+      sc = StatusCode::FAILURE;
+    }
+  }
+  m_triggerTowers = 0;
+  return sc;
+}
+
+// Finalize
+
+StatusCode L1CaloDecodeAlg::finalize()
+{
+  m_ppmCacheReader.close();
+  if (!m_ppmCacheWriter.close()) {
+    msg(MSG::ERROR) << "Failed to write PPM cache " << m_ppmCacheOutput
+                    << endreq;
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
+// Fetch ROB fragments for given source IDs
+
+void L1CaloDecodeAlg::getRobs(const std::vector<uint32_t>& ids,
+                              ROBFrags& robFrags)
+{
+  robFrags.clear();
+  m_robDataProvider->getROBData(ids, robFrags);
+  if (msgLvl(MSG::DEBUG)) {
+    msg(MSG::DEBUG) << "Number of ROB fragments is " << robFrags.size()
+                    << endreq;
+  }
+}
+
+// Get run and event number of the current event
+
+StatusCode L1CaloDecodeAlg::eventId(uint32_t& run, uint64_t& event)
+{
+  const EventInfo* evInfo = 0;
+  if (evtStore()->retrieve(evInfo).isFailure() || !evInfo->event_ID()) {
+    msg(MSG::ERROR) << "No EventInfo found" << endreq;
+    return StatusCode::FAILURE;
+  }
+  run   = evInfo->event_ID()->run_number();
+  event = evInfo->event_ID()->event_number();
+  return StatusCode::SUCCESS;
+}
+
+// Fill trigger towers from the PPM cache
+
+StatusCode L1CaloDecodeAlg::readPpmCache(
+                                  xAOD::TriggerTowerContainer* ttCollection)
+{
+  if (m_ppmCacheEvent >= m_ppmCacheReader.events()) {
+    msg(MSG::ERROR) << "PPM cache " << m_ppmCacheInput
+                    << " has no more events" << endreq;
+    return StatusCode::FAILURE;
+  }
+  uint32_t run = 0;
+  uint64_t event = 0;
+  if (eventId(run, event).isFailure()) return StatusCode::FAILURE;
+  const size_t index = m_ppmCacheEvent++;
+  if (m_ppmCacheReader.runNumber(index)   != run ||
+      m_ppmCacheReader.eventNumber(index) != event) {
+    msg(MSG::ERROR) << "PPM cache event " << m_ppmCacheReader.runNumber(index)
+                    << "/" << m_ppmCacheReader.eventNumber(index)
+                    << " does not match current event " << run << "/"
+                    << event << endreq;
+    return StatusCode::FAILURE;
+  }
+  m_ppmCacheReader.fill(index, ttCollection);
+  return StatusCode::SUCCESS;
+}
+
+// Record an empty collection and return it, 0 if key empty or failure
+
+template <class Collection>
+Collection* L1CaloDecodeAlg::record(const std::string& key,
+                                    SG::OwnershipPolicy policy, bool& ok)
+{
+  if (key.empty()) return 0;
+  Collection* const collection = new Collection(policy);
+  if (evtStore()->record(collection, key).isFailure()) {
+    msg(MSG::ERROR) << "Failed to record " << key << endreq;
+    ok = false;
+    return 0;
+  }
+  return collection;
+}
+
+// PPM trigger towers
+
+StatusCode L1CaloDecodeAlg::addPpmTask(std::vector<Task>& tasks)
+{
+  const std::string& key(m_triggerTowerLocation);
+  if (key.empty()) return StatusCode::SUCCESS;
+  xAOD::TriggerTowerAuxContainer* const aux =
+                                  new xAOD::TriggerTowerAuxContainer();
+  xAOD::TriggerTowerContainer* const ttCollection =
+                                  new xAOD::TriggerTowerContainer();
+  ttCollection->setStore(aux);
+  if (evtStore()->record(aux, key + "Aux.").isFailure()) {
+    msg(MSG::ERROR) << "Failed to record " << key << "Aux." << endreq;
+    delete ttCollection;
+    return StatusCode::FAILURE;
+  }
+  if (evtStore()->record(ttCollection, key).isFailure()) {
+    msg(MSG::ERROR) << "Failed to record " << key << endreq;
+    return StatusCode::FAILURE;
+  }
+  if (m_ppmCacheReader.isOpen()) return readPpmCache(ttCollection);
+  m_triggerTowers = ttCollection;
+  getRobs(m_ppmTool->ppmSourceIDs(key), m_ppmRobs);
+  if (m_ppmRobs.empty()) return StatusCode::SUCCESS;
+  L1CaloByteStreamReadTool* const tool = &*m_ppmTool;
+  const ROBFrags& robs(m_ppmRobs);
+  tasks.push_back([tool, &robs, ttCollection]() {
+    return tool->convert(robs, ttCollection);
+  });
+  return StatusCode::SUCCESS;
+}
+
+// CPM towers, CMX-CP TOBs and hits
+
+StatusCode L1CaloDecodeAlg::addCpTask(std::vector<Task>& tasks)
+{
+  // Elements come from the tool's object pool
+  bool ok = true;
+  DataVector<LVL1::CPMTower>* const ttCollection =
+    record<DataVector<LVL1::CPMTower> >(m_cpmTowerLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  DataVector<LVL1::CMXCPTob>* const tobCollection =
+    record<DataVector<LVL1::CMXCPTob> >(m_cmxCpTobLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  DataVector<LVL1::CMXCPHits>* const hitCollection =
+    record<DataVector<LVL1::CMXCPHits> >(m_cmxCpHitsLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  if (!ok) return StatusCode::FAILURE;
+  if (!ttCollection && !tobCollection && !hitCollection) {
+    return StatusCode::SUCCESS;
+  }
+  // All CP collections come from the same ROBs
+  CpByteStreamV2Tool* const tool = &*m_cpTool;
+  getRobs(tool->sourceIDs(m_cpmTowerLocation), m_cpRobs);
+  if (m_cpRobs.empty()) return StatusCode::SUCCESS;
+  const ROBFrags& robs(m_cpRobs);
+  const std::string& ttKey(m_cpmTowerLocation);
+  tasks.push_back([tool, &robs, &ttKey, ttCollection, tobCollection,
+                   hitCollection]() {
+    StatusCode sc = StatusCode::SUCCESS;
+    if (ttCollection) {
+      tool->sourceIDs(ttKey);   // sets core or overlap towers
+      sc = tool->convert(robs, ttCollection);
+    }
+    if (sc.isSuccess() && tobCollection) sc = tool->convert(robs, tobCollection);
+    if (sc.isSuccess() && hitCollection) sc = tool->convert(robs, hitCollection);
+    return sc;
+  });
+  return StatusCode::SUCCESS;
+}
+
+// Jet elements, JEM energy sums, CMX-Jet TOBs and hits, CMX energy sums
+
+StatusCode L1CaloDecodeAlg::addJepTask(std::vector<Task>& tasks)
+{
+  // Elements come from the tool's object pool
+  bool ok = true;
+  DataVector<LVL1::JetElement>* const jeCollection =
+    record<DataVector<LVL1::JetElement> >(m_jetElementLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  DataVector<LVL1::JEMEtSums>* const etCollection =
+    record<DataVector<LVL1::JEMEtSums> >(m_jemEtSumsLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  DataVector<LVL1::CMXJetTob>* const tobCollection =
+    record<DataVector<LVL1::CMXJetTob> >(m_cmxJetTobLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  DataVector<LVL1::CMXJetHits>* const hitCollection =
+    record<DataVector<LVL1::CMXJetHits> >(m_cmxJetHitsLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  DataVector<LVL1::CMXEtSums>* const sumsCollection =
+    record<DataVector<LVL1::CMXEtSums> >(m_cmxEtSumsLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  if (!ok) return StatusCode::FAILURE;
+  if (!jeCollection && !etCollection && !tobCollection && !hitCollection &&
+      !sumsCollection) return StatusCode::SUCCESS;
+  JepByteStreamV2Tool* const tool = &*m_jepTool;
+  getRobs(tool->sourceIDs(m_jetElementLocation), m_jepRobs);
+  if (m_jepRobs.empty()) return StatusCode::SUCCESS;
+  const ROBFrags& robs(m_jepRobs);
+  const std::string& jeKey(m_jetElementLocation);
+  tasks.push_back([tool, &robs, &jeKey, jeCollection, etCollection,
+                   tobCollection, hitCollection, sumsCollection]() {
+    StatusCode sc = StatusCode::SUCCESS;
+    if (jeCollection) {
+      tool->sourceIDs(jeKey);   // sets core or overlap jet elements
+      sc = tool->convert(robs, jeCollection);
+    }
+    if (sc.isSuccess() && etCollection)   sc = tool->convert(robs, etCollection);
+    if (sc.isSuccess() && tobCollection)  sc = tool->convert(robs, tobCollection);
+    if (sc.isSuccess() && hitCollection)  sc = tool->convert(robs, hitCollection);
+    if (sc.isSuccess() && sumsCollection) sc = tool->convert(robs, sumsCollection);
+    return sc;
+  });
+  return StatusCode::SUCCESS;
+}
+
+// CPM TOB RoIs
+
+StatusCode L1CaloDecodeAlg::addCpRoiTask(std::vector<Task>& tasks)
+{
+  // RoIs are not pooled, the collection owns them
+  bool ok = true;
+  DataVector<LVL1::CPMTobRoI>* const roiCollection =
+    record<DataVector<LVL1::CPMTobRoI> >(m_cpmTobRoiLocation,
+                                        SG::OWN_ELEMENTS, ok);
+  if (!ok) return StatusCode::FAILURE;
+  if (!roiCollection) return StatusCode::SUCCESS;
+  CpmRoiByteStreamV2Tool* const tool = &*m_cpRoiTool;
+  getRobs(tool->sourceIDs(m_cpmTobRoiLocation), m_cpRoiRobs);
+  if (m_cpRoiRobs.empty()) return StatusCode::SUCCESS;
+  const ROBFrags& robs(m_cpRoiRobs);
+  tasks.push_back([tool, &robs, roiCollection]() {
+    return tool->convert(robs, roiCollection);
+  });
+  return StatusCode::SUCCESS;
+}
+
+// JEM TOB RoIs and CMX RoIs
+
+StatusCode L1CaloDecodeAlg::addJepRoiTask(std::vector<Task>& tasks)
+{
+  // RoIs are not pooled, the collection owns them
+  bool ok = true;
+  DataVector<LVL1::JEMTobRoI>* const roiCollection =
+    record<DataVector<LVL1::JEMTobRoI> >(m_jemTobRoiLocation,
+                                        SG::OWN_ELEMENTS, ok);
+  if (!ok) return StatusCode::FAILURE;
+  LVL1::CMXRoI* cmxRoi = 0;
+  if (!m_cmxRoiLocation.empty()) {
+    cmxRoi = new LVL1::CMXRoI;
+    if (evtStore()->record(cmxRoi, m_cmxRoiLocation).isFailure()) {
+      msg(MSG::ERROR) << "Failed to record " << m_cmxRoiLocation << endreq;
+      return StatusCode::FAILURE;
+    }
+  }
+  if (!roiCollection && !cmxRoi) return StatusCode::SUCCESS;
+  JepRoiByteStreamV2Tool* const tool = &*m_jepRoiTool;
+  const std::string& key(roiCollection ? m_jemTobRoiLocation
+                                       : m_cmxRoiLocation);
+  getRobs(tool->sourceIDs(key), m_jepRoiRobs);
+  if (m_jepRoiRobs.empty()) return StatusCode::SUCCESS;
+  const ROBFrags& robs(m_jepRoiRobs);
+  tasks.push_back([tool, &robs, roiCollection, cmxRoi]() {
+    StatusCode sc = StatusCode::SUCCESS;
+    if (roiCollection) sc = tool->convert(robs, roiCollection);
+    if (sc.isSuccess() && cmxRoi) sc = tool->convert(robs, cmxRoi);
+    return sc;
+  });
+  return StatusCode::SUCCESS;
+}
+
+// ROD headers
+
+StatusCode L1CaloDecodeAlg::addRodHeaderTask(std::vector<Task>& tasks)
+{
+  // Elements come from the tool's object pool
+  bool ok = true;
+  DataVector<LVL1::RODHeader>* const rhCollection =
+    record<DataVector<LVL1::RODHeader> >(m_rodHeaderLocation,
+                                        SG::VIEW_ELEMENTS, ok);
+  if (!ok) return StatusCode::FAILURE;
+  if (!rhCollection) return StatusCode::SUCCESS;
+  RodHeaderByteStreamTool* const tool = &*m_rodTool;
+  getRobs(tool->sourceIDs(m_rodHeaderLocation), m_rodRobs);
+  if (m_rodRobs.empty()) return StatusCode::SUCCESS;
+  const ROBFrags& robs(m_rodRobs);
+  tasks.push_back([tool, &robs, rhCollection]() {
+    return tool->convert(robs, rhCollection);
+  });
+  return StatusCode::SUCCESS;
+}
+
+// Run the tasks, return failure if any failed
+
+StatusCode L1CaloDecodeAlg::runTasks(std::vector<Task>& tasks)
+{
+  StatusCode sc = StatusCode::SUCCESS;
+  if (!m_parallel || tasks.size() < 2) {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      if (tasks[i]().isFailure()) sc = StatusCode::FAILURE;
+    }
+  } else {
+    std::vector<std::future<StatusCode> > results;
+    results.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      results.push_back(std::async(std::launch::async, tasks[i]));
+    }
+    // get() rethrows any exception from the decoding thread
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (results[i].get().isFailure()) sc = StatusCode::FAILURE;
+    }
+  }
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "L1Calo bytestream decoding failed" << endreq;
+  }
+  return sc;
+}
+
+} // end namespace
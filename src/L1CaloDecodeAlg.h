@@ -0,0 +1,135 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALODECODEALG_H
+#define TRIGT1CALOBYTESTREAM_L1CALODECODEALG_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "AthenaBaseComps/AthAlgorithm.h"
+#include "ByteStreamCnvSvcBase/IROBDataProviderSvc.h"
+#include "DataModel/OwnershipPolicy.h"
+#include "GaudiKernel/ServiceHandle.h"
+#include "GaudiKernel/ToolHandle.h"
+
+#include "xaod/PpmColumnCache.h"
+
+class ISvcLocator;
+class StatusCode;
+
+namespace LVL1BS {
+
+class CpByteStreamV2Tool;
+class CpmRoiByteStreamV2Tool;
+class JepByteStreamV2Tool;
+class JepRoiByteStreamV2Tool;
+class L1CaloByteStreamReadTool;
+class RodHeaderByteStreamTool;
+
+/** Algorithm to decode all Run 2 L1Calo bytestream of an event up front.
+ *
+ *  The ROB fragments of every subsystem are fetched first, then PPM, CP,
+ *  JEP, CP RoI, JEP RoI and ROD headers are decoded as separate tasks,
+ *  concurrently if Parallel is set.  Each task uses its own decoding
+ *  tool.  All output collections are recorded in StoreGate before any
+ *  decoding starts, so they are complete when downstream algorithms run.
+ *  An empty key disables that collection.  The same keys must not also
+ *  be provided by ByteStreamAddressProviderSvc.
+ *
+ *  The message service is not thread-safe, so Parallel is off by default
+ *  and should only be set with the decoding tools at OutputLevel FATAL.
+ *  Unpacking errors are still collected by L1CaloErrorByteStreamTool.
+ *
+ *  Trigger towers can be written to a PPM column cache file and read
+ *  back from it in a later job instead of being decoded.  Events must be
+ *  read in the same order as they were written.
+ */
+
+class L1CaloDecodeAlg : public AthAlgorithm {
+
+ public:
+   L1CaloDecodeAlg(const std::string& name, ISvcLocator* pSvcLocator);
+   virtual ~L1CaloDecodeAlg();
+
+   virtual StatusCode initialize();
+   virtual StatusCode execute();
+   virtual StatusCode finalize();
+
+ private:
+   typedef IROBDataProviderSvc::VROBFRAG ROBFrags;
+   typedef std::function<StatusCode()>   Task;
+
+   /// Fetch ROB fragments for given source IDs
+   void getRobs(const std::vector<uint32_t>& ids, ROBFrags& robFrags);
+   /// Get run and event number of the current event
+   StatusCode eventId(uint32_t& run, uint64_t& event);
+   /// Fill trigger towers from the PPM cache
+   StatusCode readPpmCache(xAOD::TriggerTowerContainer* ttCollection);
+   /// Record an empty collection and return it, 0 if key empty or failure.
+   /// Collections filled from the tools' object pools must not own them.
+   template <class Collection>
+   Collection* record(const std::string& key, SG::OwnershipPolicy policy,
+                      bool& ok);
+
+   /// Set up the tasks for each subsystem
+   StatusCode addPpmTask(std::vector<Task>& tasks);
+   StatusCode addCpTask(std::vector<Task>& tasks);
+   StatusCode addJepTask(std::vector<Task>& tasks);
+   StatusCode addCpRoiTask(std::vector<Task>& tasks);
+   StatusCode addJepRoiTask(std::vector<Task>& tasks);
+   StatusCode addRodHeaderTask(std::vector<Task>& tasks);
+   /// Run the tasks, return failure if any failed
+   StatusCode runTasks(std::vector<Task>& tasks);
+
+   /// Decoding tools
+   ToolHandle<L1CaloByteStreamReadTool> m_ppmTool;
+   ToolHandle<CpByteStreamV2Tool>       m_cpTool;
+   ToolHandle<JepByteStreamV2Tool>      m_jepTool;
+   ToolHandle<CpmRoiByteStreamV2Tool>   m_cpRoiTool;
+   ToolHandle<JepRoiByteStreamV2Tool>   m_jepRoiTool;
+   ToolHandle<RodHeaderByteStreamTool>  m_rodTool;
+   /// ROB data provider
+   ServiceHandle<IROBDataProviderSvc>   m_robDataProvider;
+
+   /// Output keys, empty to skip
+   std::string m_triggerTowerLocation;
+   std::string m_cpmTowerLocation;
+   std::string m_cmxCpTobLocation;
+   std::string m_cmxCpHitsLocation;
+   std::string m_jetElementLocation;
+   std::string m_jemEtSumsLocation;
+   std::string m_cmxJetTobLocation;
+   std::string m_cmxJetHitsLocation;
+   std::string m_cmxEtSumsLocation;
+   std::string m_cpmTobRoiLocation;
+   std::string m_jemTobRoiLocation;
+   std::string m_cmxRoiLocation;
+   std::string m_rodHeaderLocation;
+   /// Decode the subsystems concurrently
+   bool        m_parallel;
+   /// PPM column cache files to write or read, empty for none
+   std::string m_ppmCacheOutput;
+   std::string m_ppmCacheInput;
+   int         m_ppmCacheEventsPerBlock;
+
+   /// PPM column cache
+   PpmColumnCacheWriter m_ppmCacheWriter;
+   PpmColumnCacheReader m_ppmCacheReader;
+   size_t               m_ppmCacheEvent;
+   /// Trigger towers of the current event, for the cache
+   xAOD::TriggerTowerContainer* m_triggerTowers;
+
+   /// ROB fragments of the current event by subsystem
+   ROBFrags m_ppmRobs;
+   ROBFrags m_cpRobs;
+   ROBFrags m_jepRobs;
+   ROBFrags m_cpRoiRobs;
+   ROBFrags m_jepRoiRobs;
+   ROBFrags m_rodRobs;
+
+};
+
+} // end namespace
+
+#endif
@@ -61,6 +61,7 @@ StatusCode L1CaloErrorByteStreamTool::finalize()
 void L1CaloErrorByteStreamTool::robError(const uint32_t robid,
                                          const unsigned int err)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (err && robMap.find(robid) == robMap.end()) {
     robMap.insert(std::make_pair(robid, err));
   }
@@ -72,6 +73,7 @@ void L1CaloErrorByteStreamTool::robError(const uint32_t robid,
 void L1CaloErrorByteStreamTool::rodError(const uint32_t robid,
                                          const unsigned int err)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (err && rodMap.find(robid) == rodMap.end()) {
     rodMap.insert(std::make_pair(robid, err));
   }
@@ -83,6 +85,7 @@ void L1CaloErrorByteStreamTool::rodError(const uint32_t robid,
 StatusCode L1CaloErrorByteStreamTool::errors(std::vector<unsigned int>*
                                                                  const errColl)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (!robMap.empty() || !rodMap.empty()) {
     errColl->push_back(robMap.size());
     ErrorMap::const_iterator iter  = robMap.begin();
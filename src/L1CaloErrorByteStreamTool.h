@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -46,6 +47,8 @@ class L1CaloErrorByteStreamTool : public AthAlgTool {
    typedef std::map<uint32_t, unsigned int> ErrorMap;
    ErrorMap robMap;
    ErrorMap rodMap;
+   /// Errors may be set from concurrent decoding tasks
+   std::mutex m_mutex;
 
 };
 
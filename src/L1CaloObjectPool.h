@@ -0,0 +1,93 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOOBJECTPOOL_H
+#define TRIGT1CALOBYTESTREAM_L1CALOOBJECTPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "DataModel/DataVector.h"
+#include "StoreGate/SegMemSvc.h"
+
+namespace LVL1BS {
+
+/// Serializes SegMemSvc allocation between concurrently decoding tools
+inline std::mutex& l1caloPoolMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+/** Pool of decoded objects with storage from SegMemSvc.
+ *
+ *  Slots are allocated once in the job segment and reused every event.
+ *  clear() runs the destructors of the objects handed out since the last
+ *  clear, which the SegMemSvc event segment would not do.
+ *  Only collections which don't own their elements (SG::VIEW_ELEMENTS)
+ *  are filled from the pool, owning collections get heap objects as before.
+ */
+
+template <class T>
+class L1CaloObjectPool {
+
+ public:
+   L1CaloObjectPool() : m_sms(0), m_used(0), m_peak(0) {}
+
+   /// Set the memory service, must be called before create()
+   void setMemSvc(SegMemSvc* sms) { m_sms = sms; }
+
+   /// Construct a new object for the given collection
+   template <typename... Args>
+   T* create(const DataVector<T>* coll, Args&&... args);
+
+   /// Destroy all pooled objects, keeping their storage.
+   /// Owners must call this before SegMemSvc is finalized.
+   void clear();
+
+   /// Number of objects currently in use
+   size_t size()     const { return m_used; }
+   /// Maximum number of objects in use at once
+   size_t peak()     const { return m_peak; }
+   /// Number of slots allocated
+   size_t capacity() const { return m_slots.size(); }
+   /// Bytes allocated from SegMemSvc
+   size_t bytes()    const { return m_slots.size() * sizeof(T); }
+
+ private:
+   L1CaloObjectPool(const L1CaloObjectPool&);
+   L1CaloObjectPool& operator=(const L1CaloObjectPool&);
+
+   SegMemSvc*      m_sms;
+   std::vector<T*> m_slots;
+   size_t          m_used;
+   size_t          m_peak;
+
+};
+
+template <class T>
+template <typename... Args>
+T* L1CaloObjectPool<T>::create(const DataVector<T>* coll, Args&&... args)
+{
+  if (!m_sms || coll->ownPolicy() != SG::VIEW_ELEMENTS) {
+    return new T(std::forward<Args>(args)...);
+  }
+  if (m_used == m_slots.size()) {
+    std::lock_guard<std::mutex> lock(l1caloPoolMutex());
+    m_slots.push_back(m_sms->allocate<T>(SegMemSvc::JOB));
+  }
+  T* const obj = new (m_slots[m_used]) T(std::forward<Args>(args)...);
+  if (++m_used > m_peak) m_peak = m_used;
+  return obj;
+}
+
+template <class T>
+void L1CaloObjectPool<T>::clear()
+{
+  for (size_t i = 0; i < m_used; ++i) m_slots[i]->~T();
+  m_used = 0;
+}
+
+} // end namespace
+
+#endif
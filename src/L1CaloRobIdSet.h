@@ -0,0 +1,49 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOROBIDSET_H
+#define TRIGT1CALOBYTESTREAM_L1CALOROBIDSET_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <bitset>
+#include <vector>
+
+#include "L1CaloSrcIdMap.h"
+
+namespace LVL1BS {
+
+/** Set of ROB source IDs seen in one event, for duplicate checks.
+ *
+ *  L1Calo ROB IDs are kept as bits by their compact index, anything else
+ *  goes in a short list which is normally empty.
+ */
+
+class L1CaloRobIdSet {
+
+ public:
+   /// Add a ROB ID, returning false if it was already there
+   bool insert(uint32_t robid);
+
+ private:
+   std::bitset<L1CaloSrcIdMap::s_maxRobIndex> m_seen;
+   std::vector<uint32_t>                      m_other;
+
+};
+
+inline bool L1CaloRobIdSet::insert(const uint32_t robid)
+{
+  const int index = L1CaloSrcIdMap::robIndex(robid);
+  if (index >= 0) {
+    if (m_seen.test(index)) return false;
+    m_seen.set(index);
+    return true;
+  }
+  if (std::find(m_other.begin(), m_other.end(), robid) != m_other.end()) {
+    return false;
+  }
+  m_other.push_back(robid);
+  return true;
+}
+
+} // end namespace
+
+#endif
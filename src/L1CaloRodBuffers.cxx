@@ -0,0 +1,44 @@
+
+#include "L1CaloRodBuffers.h"
+
+namespace LVL1BS {
+
+// Forget the RODs of the previous event
+
+void L1CaloRodBuffers::clear()
+{
+  m_current.clear();
+}
+
+// Return ROD data vector reserved for the expected size
+
+L1CaloRodBuffers::RODDATA* L1CaloRodBuffers::getRodData(
+                           FullEventAssembler<L1CaloSrcIdMap>* const fea,
+                           const uint32_t rodId, int slices)
+{
+  if (slices < 1) slices = 1;
+  RODDATA* const theROD = fea->getRodData(rodId);
+  std::map<uint32_t, size_t>::const_iterator iter = m_wordsPerSlice.find(rodId);
+  if (iter != m_wordsPerSlice.end()) {
+    theROD->reserve(theROD->size() + iter->second * slices);
+  }
+  CurrentRod current = { rodId, theROD, slices };
+  m_current.push_back(current);
+  return theROD;
+}
+
+// Update the expected sizes from the RODs of this event
+
+void L1CaloRodBuffers::record()
+{
+  std::vector<CurrentRod>::const_iterator pos  = m_current.begin();
+  std::vector<CurrentRod>::const_iterator pose = m_current.end();
+  for (; pos != pose; ++pos) {
+    const size_t words = (pos->rod->size() + pos->slices - 1) / pos->slices;
+    size_t& peak = m_wordsPerSlice[pos->rodId];
+    if (words > peak) peak = words;
+  }
+  m_current.clear();
+}
+
+} // end namespace
@@ -0,0 +1,52 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALORODBUFFERS_H
+#define TRIGT1CALOBYTESTREAM_L1CALORODBUFFERS_H
+
+#include <stdint.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "ByteStreamCnvSvcBase/FullEventAssembler.h"
+
+#include "L1CaloSrcIdMap.h"
+
+namespace LVL1BS {
+
+/** Pre-sizes the ROD data vectors of a FullEventAssembler when writing
+ *  bytestream.
+ *
+ *  Remembers the largest number of words per slice seen for each ROD
+ *  so that later events pack into a buffer which is already big enough.
+ */
+
+class L1CaloRodBuffers {
+
+ public:
+   typedef FullEventAssembler<L1CaloSrcIdMap>::RODDATA RODDATA;
+
+   /// Forget the RODs of the previous event
+   void clear();
+   /// Return ROD data vector reserved for the expected size
+   RODDATA* getRodData(FullEventAssembler<L1CaloSrcIdMap>* fea,
+                       uint32_t rodId, int slices);
+   /// Update the expected sizes from the RODs of this event
+   void record();
+
+ private:
+   struct CurrentRod {
+     uint32_t rodId;
+     RODDATA* rod;
+     int      slices;
+   };
+
+   /// Largest words per slice seen for each ROD
+   std::map<uint32_t, size_t> m_wordsPerSlice;
+   /// RODs of the current event
+   std::vector<CurrentRod> m_current;
+
+};
+
+} // end namespace
+
+#endif
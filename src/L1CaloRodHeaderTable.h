@@ -0,0 +1,97 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALORODHEADERTABLE_H
+#define TRIGT1CALOBYTESTREAM_L1CALORODHEADERTABLE_H
+
+#include <stdint.h>
+
+#include "L1CaloSrcIdMap.h"
+
+namespace LVL1BS {
+
+/** Fixed-size table of the ROD headers of one event.
+ *
+ *  One plain entry per L1Calo ROB, status words included, located by the
+ *  compact ROB index.  The owner must clear it at the start of each event.
+ *  Each entry remembers the ROB fragment it came from, so a different
+ *  fragment with the same ID is not mistaken for it.
+ */
+
+class L1CaloRodHeaderTable {
+
+ public:
+   /// At most two status words are expected, more means corruption
+   static const int s_maxStatus = 2;
+
+   /// ROD header fields of one ROB
+   struct Entry {
+     const void* fragment;
+     uint32_t    robId;
+     uint32_t    version;
+     uint32_t    sourceId;
+     uint32_t    run;
+     uint32_t    lvl1Id;
+     uint32_t    bcId;
+     uint32_t    trigType;
+     uint32_t    detType;
+     uint32_t    nData;
+     uint32_t    nStatus;
+     uint32_t    status[s_maxStatus];
+   };
+
+   L1CaloRodHeaderTable();
+
+   /// Forget all entries
+   void clear();
+   /// Number of entries added since clear
+   int size() const { return m_size; }
+   /// Entry by order of addition
+   const Entry& entry(int i) const { return m_entries[m_order[i]]; }
+
+   /// Entry for given ROB fragment, 0 if not decoded
+   const Entry* find(uint32_t robid, const void* fragment) const;
+   /// Slot for given ROB fragment, 0 if not an L1Calo ROB
+   Entry* add(uint32_t robid, const void* fragment);
+
+ private:
+   Entry    m_entries[L1CaloSrcIdMap::s_maxRobIndex];
+   uint16_t m_order[L1CaloSrcIdMap::s_maxRobIndex];
+   int      m_size;
+
+};
+
+inline L1CaloRodHeaderTable::L1CaloRodHeaderTable() : m_size(0)
+{
+  for (int i = 0; i < L1CaloSrcIdMap::s_maxRobIndex; ++i) {
+    m_entries[i].fragment = 0;
+  }
+}
+
+inline void L1CaloRodHeaderTable::clear()
+{
+  for (int i = 0; i < m_size; ++i) m_entries[m_order[i]].fragment = 0;
+  m_size = 0;
+}
+
+inline const L1CaloRodHeaderTable::Entry* L1CaloRodHeaderTable::find(
+                            const uint32_t robid, const void* fragment) const
+{
+  const int index = L1CaloSrcIdMap::robIndex(robid);
+  if (index < 0 || !fragment) return 0;
+  const Entry& entry(m_entries[index]);
+  return (entry.fragment == fragment) ? &entry : 0;
+}
+
+inline L1CaloRodHeaderTable::Entry* L1CaloRodHeaderTable::add(
+                                  const uint32_t robid, const void* fragment)
+{
+  const int index = L1CaloSrcIdMap::robIndex(robid);
+  if (index < 0) return 0;
+  Entry& entry(m_entries[index]);
+  if (!entry.fragment) m_order[m_size++] = index;
+  entry.fragment = fragment;
+  entry.robId    = robid;
+  return &entry;
+}
+
+} // end namespace
+
+#endif
@@ -0,0 +1,78 @@
+
+#include "CmxSubBlock.h"
+#include "L1CaloSubBlock.h"
+
+#include "L1CaloRodValidator.h"
+
+namespace LVL1BS {
+
+// Check sub-blocks of a CP or JEP ROD
+
+int L1CaloRodValidator::checkCpJep(const RODPointer beg, const RODPointer end,
+                                   const bool isCp, const int rodCrate,
+                                   const int trigSlice)
+{
+  RODPointer pos = beg;
+  while (pos != end) {
+    const uint32_t header = *pos;
+    if (L1CaloSubBlock::wordType(header) != L1CaloSubBlock::HEADER) {
+      return L1CaloSubBlock::ERROR_MISSING_HEADER;
+    }
+    int wordsPerSlice = (isCp) ? s_cpmWordsPerSlice : s_jemWordsPerSlice;
+    if (CmxSubBlock::cmxBlock(header)) {
+      const CmxSubBlock::CmxFirmwareCode type = CmxSubBlock::cmxType(header);
+      const bool typeOk = (isCp) ? type == CmxSubBlock::CMX_CP
+                                 : (type == CmxSubBlock::CMX_JET ||
+                                    type == CmxSubBlock::CMX_ENERGY);
+      if (!typeOk) return L1CaloSubBlock::ERROR_MODULE_NUMBER;
+      wordsPerSlice = s_cmxWordsPerSlice;
+    }
+    if (L1CaloSubBlock::crate(header) != rodCrate) {
+      return L1CaloSubBlock::ERROR_CRATE_NUMBER;
+    }
+
+    // Data words up to the status trailer or next header
+    int dataWords = 0;
+    for (++pos; pos != end; ++pos) {
+      const uint32_t word = *pos;
+      const L1CaloSubBlock::SubBlockWordType type =
+                                          L1CaloSubBlock::wordType(word);
+      if (type == L1CaloSubBlock::HEADER) break;
+      if (type == L1CaloSubBlock::STATUS) {
+        // Trailer must match the header and end the sub-block
+        if (L1CaloSubBlock::wordId(word) != L1CaloSubBlock::wordId(header) + 1) {
+          return L1CaloSubBlock::ERROR_MISSING_HEADER;
+        }
+        ++pos;
+        if (pos != end &&
+            L1CaloSubBlock::wordType(*pos) != L1CaloSubBlock::HEADER) {
+          return L1CaloSubBlock::ERROR_MISSING_HEADER;
+        }
+        break;
+      }
+      if (!L1CaloSubBlock::dataWordIdValid(header, word)) {
+        return L1CaloSubBlock::UNPACK_DATA_ID;
+      }
+      ++dataWords;
+    }
+
+    // Slice count as the sub-block timeslices() would give it
+    int slices = L1CaloSubBlock::slices1(header);
+    if (L1CaloSubBlock::format(header) == L1CaloSubBlock::NEUTRAL) {
+      if (dataWords < wordsPerSlice) {
+        return L1CaloSubBlock::UNPACK_DATA_TRUNCATED;
+      }
+      if (dataWords % wordsPerSlice) {
+        return L1CaloSubBlock::UNPACK_EXCESS_DATA;
+      }
+      if (slices == 0) slices = dataWords / wordsPerSlice;
+    }
+    if (slices == 0) slices = 1;
+    if (slices <= trigSlice || slices <= L1CaloSubBlock::seqno(header)) {
+      return L1CaloSubBlock::ERROR_SLICES;
+    }
+  }
+  return L1CaloSubBlock::ERROR_NONE;
+}
+
+} // end namespace
@@ -0,0 +1,39 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALORODVALIDATOR_H
+#define TRIGT1CALOBYTESTREAM_L1CALORODVALIDATOR_H
+
+#include <stdint.h>
+
+#include "ByteStreamData/RawEvent.h"
+
+namespace LVL1BS {
+
+/** Structural check of CP and JEP ROD payloads before unpacking.
+ *
+ *  Walks the sub-blocks following the user header using header words
+ *  only: header/trailer pairing, data word IDs, crate and CMX type,
+ *  neutral format word counts and slice numbers against the triggered
+ *  slice from the user header.  Nothing is unpacked, so a corrupt
+ *  fragment can be rejected before any object is created from it.
+ */
+
+class L1CaloRodValidator {
+
+ public:
+   typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType RODPointer;
+
+   /// Check sub-blocks of a CP (isCp) or JEP ROD, payload after user header.
+   /// Returns an L1CaloSubBlock error code, ERROR_NONE if the ROD is sound.
+   static int checkCpJep(RODPointer beg, RODPointer end, bool isCp,
+                         int rodCrate, int trigSlice);
+
+ private:
+   /// Neutral format words per slice
+   static const int s_cpmWordsPerSlice = 84;
+   static const int s_jemWordsPerSlice = 67;
+   static const int s_cmxWordsPerSlice = 97;
+
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOSLICESTAGE_H
+#define TRIGT1CALOBYTESTREAM_L1CALOSLICESTAGE_H
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace LVL1BS {
+
+/** Staging area for multi-slice data arriving in separate sub-blocks.
+ *
+ *  Collects all slices of each object in flat arrays, one run of
+ *  slices per field, so that the object can be created once with its
+ *  final vectors instead of being copied and refilled for every slice.
+ *  Info holds whatever else is needed to create the object and defines
+ *  the number of fields as Info::FIELDS.
+ *  Storage is kept across clear() for reuse in the next event.
+ */
+
+template <class Info>
+class L1CaloSliceStage {
+
+ public:
+   /// Remove all staged objects
+   void clear();
+
+   /// Number of staged objects
+   int size() const { return m_keys.size(); }
+   /// Return index of object with given key, -1 if not staged
+   int find(unsigned int key) const;
+   /// Stage a new object with all slices zero, returning its index
+   int add(unsigned int key, const Info& info, int slices, int peak);
+
+   //  Return object data
+   unsigned int key(int index)   const { return m_keys[index]; }
+   const Info&  info(int index)  const { return m_info[index]; }
+   int          slices(int index) const { return m_slices[index]; }
+   int          peak(int index)   const { return m_peaks[index]; }
+
+   /// Return true if any of the first nfields fields is set for given slice
+   bool sliceSet(int index, int slice, int nfields = Info::FIELDS) const;
+   /// Set one field for given slice
+   void set(int index, int field, int slice, unsigned int value);
+   /// Copy all slices of one field into a vector
+   template <typename T>
+   void fieldVec(int index, int field, std::vector<T>& vec) const;
+
+ private:
+   std::map<unsigned int, int> m_index;
+   std::vector<unsigned int>   m_keys;
+   std::vector<Info>           m_info;
+   std::vector<int>            m_slices;
+   std::vector<int>            m_peaks;
+   std::vector<int>            m_offsets;
+   std::vector<unsigned int>   m_data;
+
+};
+
+template <class Info>
+void L1CaloSliceStage<Info>::clear()
+{
+  m_index.clear();
+  m_keys.clear();
+  m_info.clear();
+  m_slices.clear();
+  m_peaks.clear();
+  m_offsets.clear();
+  m_data.clear();
+}
+
+template <class Info>
+int L1CaloSliceStage<Info>::find(const unsigned int key) const
+{
+  std::map<unsigned int, int>::const_iterator iter = m_index.find(key);
+  return (iter != m_index.end()) ? iter->second : -1;
+}
+
+template <class Info>
+int L1CaloSliceStage<Info>::add(const unsigned int key, const Info& info,
+                                const int slices, const int peak)
+{
+  const int index = m_keys.size();
+  m_index.insert(std::make_pair(key, index));
+  m_keys.push_back(key);
+  m_info.push_back(info);
+  m_slices.push_back(slices);
+  m_peaks.push_back(peak);
+  m_offsets.push_back(m_data.size());
+  m_data.resize(m_data.size() + Info::FIELDS * slices);
+  return index;
+}
+
+template <class Info>
+bool L1CaloSliceStage<Info>::sliceSet(const int index, const int slice,
+                                      const int nfields) const
+{
+  const int slices = m_slices[index];
+  const unsigned int* data = &m_data[m_offsets[index] + slice];
+  for (int field = 0; field < nfields; ++field) {
+    if (data[field * slices]) return true;
+  }
+  return false;
+}
+
+template <class Info>
+void L1CaloSliceStage<Info>::set(const int index, const int field,
+                                 const int slice, const unsigned int value)
+{
+  m_data[m_offsets[index] + field * m_slices[index] + slice] = value;
+}
+
+template <class Info>
+template <typename T>
+void L1CaloSliceStage<Info>::fieldVec(const int index, const int field,
+                                      std::vector<T>& vec) const
+{
+  std::vector<unsigned int>::const_iterator beg =
+                  m_data.begin() + m_offsets[index] + field * m_slices[index];
+  vec.assign(beg, beg + m_slices[index]);
+}
+
+} // end namespace
+
+#endif
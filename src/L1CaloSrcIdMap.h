@@ -12,6 +12,10 @@ namespace LVL1BS {
  *
  *  This is to be used in assembling the fragments from ROD fragments
  *
+ *  Source IDs are packed and unpacked directly with the eformat bit
+ *  layout (subdetector << 16 | module ID) as these are called several
+ *  times for every ROB fragment.
+ *
  *  @author Peter Faulkner
  */
 
@@ -22,40 +26,74 @@ public:
 
   /// Make a ROD Source ID
   uint32_t getRodID (int crate, int slink, int daqOrRoi,
-                                eformat::SubDetector subdet);
+                                eformat::SubDetector subdet) const;
 
   /// Make a ROB Source ID from a ROD source ID
-  uint32_t getRobID (uint32_t rod_id);
+  uint32_t getRobID (uint32_t rod_id) const { return rod_id; }
 
   /// Make a ROS Source ID from a ROB source ID
-  uint32_t getRosID (uint32_t rob_id);
+  uint32_t getRosID (uint32_t rob_id) const { return rob_id & s_subDetMask; }
 
   /// Make a SubDetector ID from ROS source ID
-  uint32_t getDetID (uint32_t ros_id);
+  uint32_t getDetID (uint32_t ros_id) const { return ros_id & s_subDetMask; }
 
   /// Return crate from unpacked moduleID
-  int      crate(uint32_t code);
+  int      crate(uint32_t code) const { return code & 0xf; }
 
   /// Return daqOrRoi from unpacked moduleID
-  int      daqOrRoi(uint32_t code);
+  int      daqOrRoi(uint32_t code) const { return (code >> 7) & 0x1; }
 
   /// Return slink from unpacked moduleID
-  int      slink(uint32_t code);
+  int      slink(uint32_t code) const { return (code >> 4) & 0x3; }
 
   /// Return the maximum possible number of slinks
-  int      maxSlinks();
+  int      maxSlinks() const { return 4; }
 
   /// Return sub-detector for given ID
-  eformat::SubDetector subDet(uint32_t code);
+  eformat::SubDetector subDet(uint32_t code) const;
 
   /// Return ROD header minor version to use when writing BS
-  uint16_t minorVersion() {return 0x1004;}                     // Or may go up to 0x2000, CHECK
+  uint16_t minorVersion() const {return 0x1004;}               // Or may go up to 0x2000, CHECK
 
   /// Return last ROD header minor version for pre-LS1 data
-  uint16_t minorVersionPreLS1() {return 0x1003;}
+  uint16_t minorVersionPreLS1() const {return 0x1003;}
+
+  /// Return compact index of an L1Calo ROB source ID, -1 if not L1Calo
+  static int robIndex(uint32_t code);
+
+  /// Number of compact ROB indices
+  static const int s_maxRobIndex = 5 * 128;
+
+private:
+  /// Source ID bits giving the sub-detector
+  static const uint32_t s_subDetMask = 0x00ff0000;
 
 };
 
+inline uint32_t L1CaloSrcIdMap::getRodID(const int crate, const int slink,
+                                         const int daqOrRoi,
+                                         const eformat::SubDetector subdet) const
+{
+  // module ID = r0sscccc (ROD-spec-version1_06d, P33)
+  const uint32_t moduleId = (daqOrRoi << 7) | (slink << 4) | crate;
+  return (static_cast<uint32_t>(subdet) << 16) | moduleId;
+}
+
+inline eformat::SubDetector L1CaloSrcIdMap::subDet(const uint32_t code) const
+{
+  return static_cast<eformat::SubDetector>((code & s_subDetMask) >> 16);
+}
+
+// The five L1Calo sub-detectors are consecutive and only the low eight
+// bits of the module ID are used, with bit 6 always zero.
+
+inline int L1CaloSrcIdMap::robIndex(const uint32_t code)
+{
+  const uint32_t det = (code >> 16) - eformat::TDAQ_CALO_PREPROC;
+  if (det >= 5 || (code & 0xff40)) return -1;
+  return det * 128 + ((code & 0x80) >> 1) + (code & 0x3f);
+}
+
 } // end namespace
 
 #endif
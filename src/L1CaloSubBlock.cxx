@@ -1,9 +1,111 @@
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define L1CALOSUBBLOCK_AVX2 1
+#endif
+
 #include "L1CaloSubBlock.h"
 
 namespace LVL1BS
 {
 
+namespace
+{
+
+// Fixed width field extraction for unpackerFixed.
+// Field i starts at bit firstBit + i*nbits of the data taken as a stream
+// of maxBits-bit words.  Callers guarantee the data are long enough.
+
+void unpackFixedScalar(const uint32_t* const data, const int maxBits,
+                       const int nbits, const int firstBit, const int count,
+                       uint32_t* const out)
+{
+    const uint32_t wordMask = (maxBits < 32) ? (1u << maxBits) - 1 : 0xffffffff;
+    const uint64_t mask     = (uint64_t(1) << nbits) - 1;
+    int word = firstBit / maxBits;
+    const int bit = firstBit - word * maxBits;
+    uint64_t acc = (data[word++] & wordMask) >> bit;
+    int have = maxBits - bit;
+    for (int i = 0; i < count; ++i)
+    {
+        if (have < nbits)
+        {
+            acc |= uint64_t(data[word++] & wordMask) << have;
+            have += maxBits;
+        }
+        out[i] = acc & mask;
+        acc >>= nbits;
+        have -= nbits;
+    }
+}
+
+#ifdef L1CALOSUBBLOCK_AVX2
+
+// Eight fields per iteration, each gathered from the two words it may span.
+// Returns the number of fields done, the rest are left to the scalar loop.
+
+__attribute__((target("avx2")))
+int unpackFixedAvx2(const uint32_t* const data, const int words,
+                    const int maxBits, const int nbits, const int firstBit,
+                    const int count, uint32_t* const out)
+{
+    const int lanes = 8;
+    const int step  = lanes * nbits;
+    // Last lane must not read beyond the final data word
+    const int limit = (words - 1) * maxBits;
+    int done = 0;
+    if (count < lanes || firstBit + (lanes - 1) * nbits >= limit) return done;
+    const uint32_t wordMask = (maxBits < 32) ? (1u << maxBits) - 1 : 0xffffffff;
+    const __m256i vWordMask = _mm256_set1_epi32(wordMask);
+    const __m256i vMask     = _mm256_set1_epi32((1u << nbits) - 1);
+    const __m256i vMaxBits  = _mm256_set1_epi32(maxBits);
+    const __m256i vMaxBits1 = _mm256_set1_epi32(maxBits - 1);
+    const __m256i vOne      = _mm256_set1_epi32(1);
+    const __m256i vStepWord = _mm256_set1_epi32(step / maxBits);
+    const __m256i vStepBit  = _mm256_set1_epi32(step % maxBits);
+    // Word and bit offset of the first field in each lane
+    int laneWord[lanes];
+    int laneBit[lanes];
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        const int bit  = firstBit + lane * nbits;
+        laneWord[lane] = bit / maxBits;
+        laneBit[lane]  = bit - laneWord[lane] * maxBits;
+    }
+    __m256i vWord = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(laneWord));
+    __m256i vBit  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(laneBit));
+    const int* const base = reinterpret_cast<const int*>(data);
+    for (; done + lanes <= count &&
+           firstBit + done * nbits + (lanes - 1) * nbits < limit; done += lanes)
+    {
+        __m256i lo = _mm256_i32gather_epi32(base, vWord, 4);
+        __m256i hi = _mm256_i32gather_epi32(base, _mm256_add_epi32(vWord, vOne), 4);
+        lo = _mm256_and_si256(lo, vWordMask);
+        hi = _mm256_and_si256(hi, vWordMask);
+        __m256i field = _mm256_or_si256(_mm256_srlv_epi32(lo, vBit),
+                        _mm256_sllv_epi32(hi, _mm256_sub_epi32(vMaxBits, vBit)));
+        field = _mm256_and_si256(field, vMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + done), field);
+        // Advance all lanes by eight fields
+        vWord = _mm256_add_epi32(vWord, vStepWord);
+        vBit  = _mm256_add_epi32(vBit, vStepBit);
+        const __m256i carry = _mm256_cmpgt_epi32(vBit, vMaxBits1);
+        vWord = _mm256_sub_epi32(vWord, carry);
+        vBit  = _mm256_sub_epi32(vBit, _mm256_and_si256(carry, vMaxBits));
+    }
+    return done;
+}
+
+bool haveAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+#endif
+
+} // end anonymous namespace
+
 // Static constant definitions
 
 const int      L1CaloSubBlock::s_headerBit;
@@ -137,18 +239,7 @@ OFFLINE_FRAGMENTS_NAMESPACE::PointerType L1CaloSubBlock::read(
         else
         {
             // Check data word IDs
-            const int id = wordId(word);
-            bool badId = false;
-            // All neutral format '0000'
-            if (format() == NEUTRAL)        badId = (id != 0);
-            // Other PPM '0xxx'
-            else if (crate() < s_ppmCrates) badId = ((id & 0x8) != 0);
-            // Other CPM/JEM '01xx' or '10xx'
-            else if (wordId() == 0xc)       badId = (((id & 0xc) != 0x4) &&
-                                                        ((id & 0xc) != 0x8));
-            // Other CMM/CMX '00xx'
-            else                            badId = ((id & 0xc) != 0);
-            if (m_trailer || badId) return pos;
+            if (m_trailer || !dataWordIdValid(m_header, word)) return pos;
             m_data.push_back(word);
             ++m_dataWords;
         }
@@ -162,11 +253,7 @@ void L1CaloSubBlock::write(
     FullEventAssembler<L1CaloSrcIdMap>::RODDATA *const theROD) const
 {
     theROD->push_back(m_header);
-    std::vector<uint32_t>::const_iterator pos;
-    for (pos = m_data.begin(); pos != m_data.end(); ++pos)
-    {
-        theROD->push_back(*pos);
-    }
+    theROD->insert(theROD->end(), m_data.begin(), m_data.end());
     if (m_trailer) theROD->push_back(m_trailer);
 }
 
@@ -256,6 +343,9 @@ std::string L1CaloSubBlock::unpackErrorMsg() const
     case UNPACK_DATA_ID:
         msg = "Invalid word ID in Sub-block Data";
         break;
+    case UNPACK_EXCESS_ROIS:
+        msg = "Excess RoIs in ROD Data";
+        break;
     default:
         msg = "Unknown Error Code";
         break;
@@ -404,6 +494,46 @@ void L1CaloSubBlock::unpackerInit()
     if (m_dataPos != m_dataPosEnd) m_bitword = *m_dataPos;
 }
 
+// Unpack fixed width fields in bulk
+
+bool L1CaloSubBlock::unpackerFixed(const int nbits, const int firstBit,
+                                   const int count, uint32_t* const out) const
+{
+    if (count <= 0) return true;
+    if (nbits <= 0 || nbits > s_maxWordBits || firstBit < 0) return false;
+    const int words = m_data.size();
+    if (firstBit + int64_t(count) * nbits > int64_t(words) * m_maxBits)
+    {
+        return false;
+    }
+    int done = 0;
+#ifdef L1CALOSUBBLOCK_AVX2
+    if (nbits < s_maxWordBits && haveAvx2())
+    {
+        done = unpackFixedAvx2(&m_data[0], words, m_maxBits, nbits, firstBit,
+                               count, out);
+    }
+#endif
+    if (done < count)
+    {
+        unpackFixedScalar(&m_data[0], m_maxBits, nbits, firstBit + done * nbits,
+                          count - done, out + done);
+    }
+    return true;
+}
+
+// Check for non-zero data beyond given bit
+
+bool L1CaloSubBlock::unpackerZeroFrom(const int firstBit) const
+{
+    const int words = m_data.size();
+    int word = firstBit / m_maxBits;
+    if (word >= words) return true;
+    uint32_t bits = (m_data[word] & m_maxMask) >> (firstBit - word * m_maxBits);
+    for (++word; word < words; ++word) bits |= m_data[word] & m_maxMask;
+    return bits == 0;
+}
+
 // Pack given neutral data from given pin
 
 void L1CaloSubBlock::packerNeutral(const int pin, const uint32_t datum,
@@ -518,4 +648,36 @@ int L1CaloSubBlock::module(const uint32_t word)
     return (word >> s_moduleBit) & s_moduleMask;
 }
 
+// Return crate field from given header word
+
+int L1CaloSubBlock::crate(const uint32_t word)
+{
+    return (word >> s_crateBit) & s_crateMask;
+}
+
+// Return slices1 field from given header word
+
+int L1CaloSubBlock::slices1(const uint32_t word)
+{
+    return (word >> s_slices1Bit) & s_slices1Mask;
+}
+
+// Check data word ID against sub-block header
+
+bool L1CaloSubBlock::dataWordIdValid(const uint32_t header, const uint32_t word)
+{
+    const int id = wordId(word);
+    bool badId = false;
+    // All neutral format '0000'
+    if (format(header) == NEUTRAL)        badId = (id != 0);
+    // Other PPM '0xxx'
+    else if (crate(header) < s_ppmCrates) badId = ((id & 0x8) != 0);
+    // Other CPM/JEM '01xx' or '10xx'
+    else if (wordId(header) == 0xc)       badId = (((id & 0xc) != 0x4) &&
+                                                    ((id & 0xc) != 0x8));
+    // Other CMM/CMX '00xx'
+    else                                  badId = ((id & 0xc) != 0);
+    return !badId;
+}
+
 } // end namespace
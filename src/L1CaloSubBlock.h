@@ -35,7 +35,8 @@ class L1CaloSubBlock {
                            UNPACK_FORMAT, UNPACK_COMPRESSION_VERSION,
 			   UNPACK_COMPRESSION_SLICES, UNPACK_DATA_TRUNCATED,
 			   UNPACK_EXCESS_DATA, UNPACK_SOURCE_ID,
-			   UNPACK_EXCESS_TOBS, UNPACK_DATA_ID };
+			   UNPACK_EXCESS_TOBS, UNPACK_DATA_ID,
+			   UNPACK_EXCESS_ROIS };
 
    L1CaloSubBlock();
    ~L1CaloSubBlock();
@@ -111,6 +112,12 @@ class L1CaloSubBlock {
    static int seqno(uint32_t word);
    /// Return module field from given header word
    static int module(uint32_t word);
+   /// Return crate field from given header word
+   static int crate(uint32_t word);
+   /// Return slices1 field from given header word
+   static int slices1(uint32_t word);
+   /// Return true if data word ID is allowed in sub-block with given header
+   static bool dataWordIdValid(uint32_t header, uint32_t word);
 
    //  Unpacking error code.  Set by derived classes
    /// Set the unpacking error code
@@ -138,6 +145,14 @@ class L1CaloSubBlock {
    void     unpackerInit();
    /// Return unpacker success flag
    bool     unpackerSuccess() const;
+   /// Unpack count fields of nbits each starting at given data bit.
+   /// Independent of the unpacker position; false if data too short
+   bool     unpackerFixed(int nbits, int firstBit, int count,
+                          uint32_t* out) const;
+   /// Return true if all data bits from given bit onwards are zero
+   bool     unpackerZeroFrom(int firstBit) const;
+   /// Return the number of data bits available to the unpacker
+   int      unpackerBits() const;
 
    //  Neutral format packing utilities
    /// Pack given neutral data from given pin
@@ -352,6 +367,11 @@ inline bool L1CaloSubBlock::unpackerSuccess() const
   return m_unpackerFlag;
 }
 
+inline int L1CaloSubBlock::unpackerBits() const
+{
+  return m_data.size() * m_maxBits;
+}
+
 inline int L1CaloSubBlock::currentPinBit(int pin) const
 {
   return m_currentPinBit[pin];
@@ -44,4 +44,20 @@ void ModifySlices::data(const std::vector<unsigned int>& oldVec,
   }
 }
 
+// Return first slice and number of slices in window around triggered slice
+
+void ModifySlices::window(const int peak, const int slices,
+                          const int halfWidth, int& firstSlice, int& newSlices)
+{
+  if (halfWidth < 0) {
+    firstSlice = 0;
+    newSlices  = slices;
+    return;
+  }
+  firstSlice = (peak > halfWidth) ? peak - halfWidth : 0;
+  const int lastSlice = (peak + halfWidth < slices) ? peak + halfWidth
+                                                    : slices - 1;
+  newSlices = (lastSlice >= firstSlice) ? lastSlice - firstSlice + 1 : 0;
+}
+
 } // end namespace
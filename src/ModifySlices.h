@@ -24,6 +24,10 @@ class ModifySlices {
    /// Return modified data vector<unsigned int>
    static void data(const std::vector<unsigned int>& oldVec,
                           std::vector<unsigned int>& newVec, int newSlices);
+   /// Return first slice and number of slices in window of +/- halfWidth
+   /// around the triggered slice (all slices if halfWidth negative)
+   static void window(int peak, int slices, int halfWidth,
+                      int& firstSlice, int& newSlices);
 
 };
 
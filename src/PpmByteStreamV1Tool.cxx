@@ -1,6 +1,6 @@
 
 #include <numeric>
-#include <set>
+#include <sstream>
 #include <utility>
 
 #include "GaudiKernel/IInterface.h"
@@ -16,7 +16,9 @@
 #include "TrigT1CaloMappingToolInterfaces/IL1CaloMappingTool.h"
 
 #include "CmmSubBlock.h"
+#include "L1CaloCrateRods.h"
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 #include "L1CaloUserHeader.h"
@@ -95,6 +97,8 @@ PpmByteStreamV1Tool::PpmByteStreamV1Tool(const std::string &type,
                     "Minimum crate number, allows partial output");
     declareProperty("CrateMax",       m_crateMax = s_crates - 1,
                     "Maximum crate number, allows partial output");
+    declareProperty("ParallelCrates", m_parallelCrates = false,
+                    "Encode each crate on its own thread");
 
 }
 
@@ -304,7 +308,7 @@ StatusCode PpmByteStreamV1Tool::convert(
     // Loop over ROB fragments
 
     int robCount = 0;
-    std::set<uint32_t> dupCheck;
+    L1CaloRobIdSet dupCheck;
     ROBIterator rob    = robFrags.begin();
     ROBIterator robEnd = robFrags.end();
     for (; rob != robEnd; ++rob)
@@ -333,7 +337,7 @@ StatusCode PpmByteStreamV1Tool::convert(
 
         // Skip duplicate fragments
 
-        if (!dupCheck.insert(robid).second)
+        if (!dupCheck.insert(robid))
         {
             m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
             if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
@@ -811,16 +815,13 @@ StatusCode PpmByteStreamV1Tool::convert(
     const uint16_t minorVersion = m_srcIdMap->minorVersionPreLS1();
     m_fea->setRodMinorVersion(minorVersion);
     m_rodStatusMap.clear();
-
-    // Pointer to ROD data vector
-
-    FullEventAssembler<L1CaloSrcIdMap>::RODDATA *theROD = 0;
+    m_rodBuffers.clear();
 
     // Set up trigger tower maps
 
     setupTTMaps(ttCollection);
 
-    // Create the sub-blocks to do the packing
+    // Check the sub-block format
 
     PpmSubBlockV1 subBlock;
     const int chanPerSubBlock = subBlock.channelsPerSubBlock(m_version,
@@ -831,7 +832,68 @@ StatusCode PpmByteStreamV1Tool::convert(
                         << m_version << "/" << m_dataFormat << endreq;
         return StatusCode::FAILURE;
     }
-    PpmSubBlockV1 errorBlock;
+
+    // Encode the crates, concurrently if requested, then add their RODs
+    // to the event in crate order so the output is always the same
+
+    if (m_chanKeys.empty()) setupChannelKeys();
+    const bool parallel = m_parallelCrates && m_crateMax > m_crateMin;
+    const bool crateDebug = debug && !parallel;
+    encodeCrates(m_crateEncoders, m_crateMin, m_crateMax, parallel,
+                 [this, chanPerSubBlock, crateDebug](int crate, CrateEncoder& enc)
+                 { encodeCrate(crate, enc, chanPerSubBlock, crateDebug); });
+    std::vector<uint32_t> rodIds;
+    for (int crate = m_crateMin; crate <= m_crateMax; ++crate)
+    {
+        CrateEncoder *const enc = m_crateEncoders[crate - m_crateMin];
+        if (enc->rods.failed())
+        {
+            msg(MSG::ERROR) << enc->rods.error() << endreq;
+            return StatusCode::FAILURE;
+        }
+        enc->rods.merge(m_fea, m_rodBuffers);
+        enc->rods.rodIds(rodIds);
+        for (size_t i = 0; i < rodIds.size(); ++i)
+        {
+            m_rodStatusMap.insert(make_pair(rodIds[i], m_rodStatus));
+        }
+        if (m_printCompStats)
+        {
+            addCompStats(m_compStats, enc->compStats);
+            enc->compStats.clear();
+        }
+    }
+
+    // Fill the raw event
+
+    m_rodBuffers.record();
+    m_fea->fill(re, msg());
+
+    // Set ROD status words
+
+    //L1CaloRodStatus::setStatus(re, m_rodStatusMap, m_srcIdMap);
+
+    return StatusCode::SUCCESS;
+}
+
+// Encode the RODs of one crate.  Uses no tool state which changes during
+// encoding, so crates can be done on separate threads.
+
+void PpmByteStreamV1Tool::encodeCrate(const int crate, CrateEncoder &enc,
+                                      const int chanPerSubBlock,
+                                      const bool debug)
+{
+    if (debug) msg(MSG::DEBUG);
+    enc.rods.clear();
+
+    // Pointer to ROD data vector
+
+    FullEventAssembler<L1CaloSrcIdMap>::RODDATA *theROD = 0;
+
+    // Sub-blocks to do the packing
+
+    PpmSubBlockV1 &subBlock(enc.subBlock);
+    PpmSubBlockV1 &errorBlock(enc.errorBlock);
 
     int slicesLut  = 1;
     int slicesFadc = 1;
@@ -842,237 +904,232 @@ StatusCode PpmByteStreamV1Tool::convert(
     int trigLutNew    = 0;
     int trigFadcNew   = 0;
     const int modulesPerSlink = s_modules / m_slinks;
-    for (int crate = m_crateMin; crate <= m_crateMax; ++crate)
+    for (int module = 0; module < s_modules; ++module)
     {
-        for (int module = 0; module < s_modules; ++module)
-        {
 
-            // Pack required number of modules per slink
+        // Pack required number of modules per slink
 
-            if (module % modulesPerSlink == 0)
+        if (module % modulesPerSlink == 0)
+        {
+            const int daqOrRoi = 0;
+            const int slink = module / modulesPerSlink;
+            if (debug)
             {
-                const int daqOrRoi = 0;
-                const int slink = module / modulesPerSlink;
-                if (debug)
-                {
-                    msg() << "Treating crate " << crate << " slink " << slink << endreq;
-                }
-                // Get number of slices and triggered slice offsets
-                // for this slink
-                if ( ! slinkSlices(crate, module, modulesPerSlink,
-                                   slicesLut, slicesFadc, trigLut, trigFadc))
+                msg() << "Treating crate " << crate << " slink " << slink << endreq;
+            }
+            // Get number of slices and triggered slice offsets
+            // for this slink
+            if ( ! slinkSlices(crate, module, modulesPerSlink,
+                               slicesLut, slicesFadc, trigLut, trigFadc))
+            {
+                std::ostringstream error;
+                error << "Inconsistent number of slices or "
+                      << "triggered slice offsets in data for crate "
+                      << crate << " slink " << slink;
+                enc.rods.setError(error.str());
+                return;
+            }
+            slicesLutNew  = (m_forceSlicesLut)  ? m_forceSlicesLut  : slicesLut;
+            slicesFadcNew = (m_forceSlicesFadc) ? m_forceSlicesFadc : slicesFadc;
+            trigLutNew    = ModifySlices::peak(trigLut,  slicesLut,  slicesLutNew);
+            trigFadcNew   = ModifySlices::peak(trigFadc, slicesFadc, slicesFadcNew);
+            if (debug)
+            {
+                msg() << "Data Version/Format: " << m_version
+                      << " " << m_dataFormat << endreq
+                      << "LUT slices/offset: " << slicesLut << " " << trigLut;
+                if (slicesLut != slicesLutNew)
                 {
-                    msg(MSG::ERROR) << "Inconsistent number of slices or "
-                                    << "triggered slice offsets in data for crate "
-                                    << crate << " slink " << slink << endreq;
-                    return StatusCode::FAILURE;
+                    msg() << " modified to " << slicesLutNew << " " << trigLutNew;
                 }
-                slicesLutNew  = (m_forceSlicesLut)  ? m_forceSlicesLut  : slicesLut;
-                slicesFadcNew = (m_forceSlicesFadc) ? m_forceSlicesFadc : slicesFadc;
-                trigLutNew    = ModifySlices::peak(trigLut,  slicesLut,  slicesLutNew);
-                trigFadcNew   = ModifySlices::peak(trigFadc, slicesFadc, slicesFadcNew);
-                if (debug)
+                msg() << endreq
+                      << "FADC slices/offset: " << slicesFadc << " " << trigFadc;
+                if (slicesFadc != slicesFadcNew)
                 {
-                    msg() << "Data Version/Format: " << m_version
-                          << " " << m_dataFormat << endreq
-                          << "LUT slices/offset: " << slicesLut << " " << trigLut;
-                    if (slicesLut != slicesLutNew)
-                    {
-                        msg() << " modified to " << slicesLutNew << " " << trigLutNew;
-                    }
-                    msg() << endreq
-                          << "FADC slices/offset: " << slicesFadc << " " << trigFadc;
-                    if (slicesFadc != slicesFadcNew)
-                    {
-                        msg() << " modified to " << slicesFadcNew << " " << trigFadcNew;
-                    }
-                    msg() << endreq;
+                    msg() << " modified to " << slicesFadcNew << " " << trigFadcNew;
                 }
-                L1CaloUserHeader userHeader;
-                userHeader.setPpmLut(trigLutNew);
-                userHeader.setPpmFadc(trigFadcNew);
-                userHeader.setLowerBound(m_fadcBaseline);
-                const uint32_t rodIdPpm = m_srcIdMap->getRodID(crate, slink, daqOrRoi,
-                                          m_subDetector);
-                theROD = m_fea->getRodData(rodIdPpm);
-                theROD->push_back(userHeader.header());
-                m_rodStatusMap.insert(make_pair(rodIdPpm, m_rodStatus));
+                msg() << endreq;
             }
-            if (debug) msg() << "Module " << module << endreq;
+            L1CaloUserHeader userHeader;
+            userHeader.setPpmLut(trigLutNew);
+            userHeader.setPpmFadc(trigFadcNew);
+            userHeader.setLowerBound(m_fadcBaseline);
+            const uint32_t rodIdPpm = m_srcIdMap->getRodID(crate, slink, daqOrRoi,
+                                      m_subDetector);
+            theROD = enc.rods.newRod(rodIdPpm, slicesLutNew + slicesFadcNew);
+            theROD->push_back(userHeader.header());
+        }
+        if (debug) msg() << "Module " << module << endreq;
 
-            // Find trigger towers corresponding to each eta/phi pair and fill
-            // sub-blocks
+        // Find trigger towers corresponding to each eta/phi pair and fill
+        // sub-blocks
 
-            bool upstreamError = false;
-            for (int channel = 0; channel < s_channels; ++channel)
+        bool upstreamError = false;
+        for (int channel = 0; channel < s_channels; ++channel)
+        {
+            const int chan = channel % chanPerSubBlock;
+            if (channel == 0 && m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
             {
-                const int chan = channel % chanPerSubBlock;
-                if (channel == 0 && m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
+                errorBlock.clear();
+                errorBlock.setPpmErrorHeader(m_version, m_dataFormat, crate,
+                                             module, slicesFadcNew, slicesLutNew);
+            }
+            if (chan == 0)
+            {
+                subBlock.clear();
+                if (m_dataFormat >= L1CaloSubBlock::COMPRESSED)
                 {
-                    errorBlock.clear();
-                    errorBlock.setPpmErrorHeader(m_version, m_dataFormat, crate,
-                                                 module, slicesFadcNew, slicesLutNew);
+                    subBlock.setPpmHeader(m_version, m_dataFormat, m_compVers, crate,
+                                          module, slicesFadcNew, slicesLutNew);
                 }
-                if (chan == 0)
+                else
                 {
-                    subBlock.clear();
-                    if (m_dataFormat >= L1CaloSubBlock::COMPRESSED)
-                    {
-                        subBlock.setPpmHeader(m_version, m_dataFormat, m_compVers, crate,
-                                              module, slicesFadcNew, slicesLutNew);
-                    }
-                    else
-                    {
-                        subBlock.setPpmHeader(m_version, m_dataFormat, channel, crate,
-                                              module, slicesFadcNew, slicesLutNew);
-                    }
-                    subBlock.setLutOffset(trigLutNew);
-                    subBlock.setFadcOffset(trigFadcNew);
-                    subBlock.setFadcBaseline(m_fadcBaseline);
-                    subBlock.setFadcThreshold(m_fadcThreshold);
+                    subBlock.setPpmHeader(m_version, m_dataFormat, channel, crate,
+                                          module, slicesFadcNew, slicesLutNew);
                 }
-                const LVL1::TriggerTower *tt = 0;
-                double eta = 0.;
-                double phi = 0.;
-                int layer = 0;
-                if (m_ppmMaps->mapping(crate, module, channel, eta, phi, layer))
+                subBlock.setLutOffset(trigLutNew);
+                subBlock.setFadcOffset(trigFadcNew);
+                subBlock.setFadcBaseline(m_fadcBaseline);
+                subBlock.setFadcThreshold(m_fadcThreshold);
+            }
+            const LVL1::TriggerTower *tt = 0;
+            unsigned int key = 0;
+            int layer = 0;
+            if (channelKey(crate, module, channel, key, layer))
+            {
+                tt = findLayerTriggerTower(key, layer);
+            }
+            if (tt )
+            {
+                int err = 0;
+                std::vector<int> lut;
+                std::vector<int> fadc;
+                std::vector<int> bcidLut;
+                std::vector<int> bcidFadc;
+                if (layer == 0)    // em
                 {
-                    tt = findLayerTriggerTower(eta, phi, layer);
+                    ModifySlices::data(tt->emLUT(),     lut,      slicesLutNew);
+                    ModifySlices::data(tt->emADC(),     fadc,     slicesFadcNew);
+                    ModifySlices::data(tt->emBCIDvec(), bcidLut,  slicesLutNew);
+                    ModifySlices::data(tt->emBCIDext(), bcidFadc, slicesFadcNew);
+                    err = tt->emError();
                 }
-                if (tt )
+                else               // had
                 {
-                    int err = 0;
-                    std::vector<int> lut;
-                    std::vector<int> fadc;
-                    std::vector<int> bcidLut;
-                    std::vector<int> bcidFadc;
-                    if (layer == 0)    // em
-                    {
-                        ModifySlices::data(tt->emLUT(),     lut,      slicesLutNew);
-                        ModifySlices::data(tt->emADC(),     fadc,     slicesFadcNew);
-                        ModifySlices::data(tt->emBCIDvec(), bcidLut,  slicesLutNew);
-                        ModifySlices::data(tt->emBCIDext(), bcidFadc, slicesFadcNew);
-                        err = tt->emError();
-                    }
-                    else               // had
+                    ModifySlices::data(tt->hadLUT(),     lut,      slicesLutNew);
+                    ModifySlices::data(tt->hadADC(),     fadc,     slicesFadcNew);
+                    ModifySlices::data(tt->hadBCIDvec(), bcidLut,  slicesLutNew);
+                    ModifySlices::data(tt->hadBCIDext(), bcidFadc, slicesFadcNew);
+                    err = tt->hadError();
+                }
+                subBlock.fillPpmData(channel, lut, fadc, bcidLut, bcidFadc);
+                if (err)
+                {
+                    const LVL1::DataError errorBits(err);
+                    const int errpp = errorBits.get(LVL1::DataError::PPMErrorWord);
+                    if (m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
                     {
-                        ModifySlices::data(tt->hadLUT(),     lut,      slicesLutNew);
-                        ModifySlices::data(tt->hadADC(),     fadc,     slicesFadcNew);
-                        ModifySlices::data(tt->hadBCIDvec(), bcidLut,  slicesLutNew);
-                        ModifySlices::data(tt->hadBCIDext(), bcidFadc, slicesFadcNew);
-                        err = tt->hadError();
+                        errorBlock.fillPpmError(channel, errpp);
                     }
-                    subBlock.fillPpmData(channel, lut, fadc, bcidLut, bcidFadc);
-                    if (err)
+                    else subBlock.fillPpmError(channel, errpp);
+                    if (errpp >> 2) upstreamError = true;
+                }
+            }
+            if (chan == chanPerSubBlock - 1)
+            {
+                // output the packed sub-block
+                if ( !subBlock.pack())
+                {
+                    enc.rods.setError("PPM sub-block packing failed");
+                    return;
+                }
+                if (m_printCompStats) addCompStats(enc.compStats, subBlock.compStats());
+                if (channel != s_channels - 1)
+                {
+                    // Only put errors in last sub-block
+                    subBlock.setStatus(0, false, false, false, false,
+                                       false, false, false);
+                    if (debug)
                     {
-                        const LVL1::DataError errorBits(err);
-                        const int errpp = errorBits.get(LVL1::DataError::PPMErrorWord);
-                        if (m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
-                        {
-                            errorBlock.fillPpmError(channel, errpp);
-                        }
-                        else subBlock.fillPpmError(channel, errpp);
-                        if (errpp >> 2) upstreamError = true;
+                        msg() << "PPM sub-block data words: "
+                              << subBlock.dataWords() << endreq;
                     }
+                    subBlock.write(theROD);
                 }
-                if (chan == chanPerSubBlock - 1)
+                else
                 {
-                    // output the packed sub-block
-                    if ( !subBlock.pack())
+                    // Last sub-block - write error block
+                    bool glinkTimeout = false;
+                    bool daqOverflow  = false;
+                    bool bcnMismatch  = false;
+                    bool glinkParity  = false;
+                    if (m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
+                    {
+                        glinkTimeout = errorBlock.mcmAbsent() ||
+                                       errorBlock.timeout();
+                        daqOverflow  = errorBlock.asicFull() ||
+                                       errorBlock.fpgaCorrupt();
+                        bcnMismatch  = errorBlock.eventMismatch() ||
+                                       errorBlock.bunchMismatch();
+                        glinkParity  = errorBlock.glinkPinParity();
+                    }
+                    else
                     {
-                        msg(MSG::ERROR) << "PPM sub-block packing failed" << endreq;
-                        return StatusCode::FAILURE;
+                        glinkTimeout = subBlock.mcmAbsent() ||
+                                       subBlock.timeout();
+                        daqOverflow  = subBlock.asicFull() ||
+                                       subBlock.fpgaCorrupt();
+                        bcnMismatch  = subBlock.eventMismatch() ||
+                                       subBlock.bunchMismatch();
+                        glinkParity  = subBlock.glinkPinParity();
                     }
-                    if (m_printCompStats) addCompStats(subBlock.compStats());
-                    if (channel != s_channels - 1)
+                    subBlock.setStatus(0, glinkTimeout, false, upstreamError,
+                                       daqOverflow, bcnMismatch, false, glinkParity);
+                    if (debug)
                     {
-                        // Only put errors in last sub-block
-                        subBlock.setStatus(0, false, false, false, false,
-                                           false, false, false);
-                        if (debug)
-                        {
-                            msg() << "PPM sub-block data words: "
-                                  << subBlock.dataWords() << endreq;
-                        }
-                        subBlock.write(theROD);
+                        msg() << "PPM sub-block data words: "
+                              << subBlock.dataWords() << endreq;
                     }
-                    else
+                    subBlock.write(theROD);
+                    // Only uncompressed format has a separate error block
+                    if (m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
                     {
-                        // Last sub-block - write error block
-                        bool glinkTimeout = false;
-                        bool daqOverflow  = false;
-                        bool bcnMismatch  = false;
-                        bool glinkParity  = false;
-                        if (m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
-                        {
-                            glinkTimeout = errorBlock.mcmAbsent() ||
-                                           errorBlock.timeout();
-                            daqOverflow  = errorBlock.asicFull() ||
-                                           errorBlock.fpgaCorrupt();
-                            bcnMismatch  = errorBlock.eventMismatch() ||
-                                           errorBlock.bunchMismatch();
-                            glinkParity  = errorBlock.glinkPinParity();
-                        }
-                        else
+                        if ( ! errorBlock.pack())
                         {
-                            glinkTimeout = subBlock.mcmAbsent() ||
-                                           subBlock.timeout();
-                            daqOverflow  = subBlock.asicFull() ||
-                                           subBlock.fpgaCorrupt();
-                            bcnMismatch  = subBlock.eventMismatch() ||
-                                           subBlock.bunchMismatch();
-                            glinkParity  = subBlock.glinkPinParity();
+                            enc.rods.setError("PPM error block packing failed");
+                            return;
                         }
-                        subBlock.setStatus(0, glinkTimeout, false, upstreamError,
-                                           daqOverflow, bcnMismatch, false, glinkParity);
+                        errorBlock.setStatus(0, glinkTimeout, false, upstreamError,
+                                             daqOverflow, bcnMismatch, false, glinkParity);
+                        errorBlock.write(theROD);
                         if (debug)
                         {
-                            msg() << "PPM sub-block data words: "
-                                  << subBlock.dataWords() << endreq;
-                        }
-                        subBlock.write(theROD);
-                        // Only uncompressed format has a separate error block
-                        if (m_dataFormat == L1CaloSubBlock::UNCOMPRESSED)
-                        {
-                            if ( ! errorBlock.pack())
-                            {
-                                msg(MSG::ERROR) << "PPM error block packing failed" << endreq;
-                                return StatusCode::FAILURE;
-                            }
-                            errorBlock.setStatus(0, glinkTimeout, false, upstreamError,
-                                                 daqOverflow, bcnMismatch, false, glinkParity);
-                            errorBlock.write(theROD);
-                            if (debug)
-                            {
-                                msg() << "PPM error block data words: "
-                                      << errorBlock.dataWords() << endreq;
-                            }
+                            msg() << "PPM error block data words: "
+                                  << errorBlock.dataWords() << endreq;
                         }
                     }
                 }
             }
         }
     }
-
-    // Fill the raw event
-
-    m_fea->fill(re, msg());
-
-    // Set ROD status words
-
-    //L1CaloRodStatus::setStatus(re, m_rodStatusMap, m_srcIdMap);
-
-    return StatusCode::SUCCESS;
 }
 
 // Add compression stats to totals
 
 void PpmByteStreamV1Tool::addCompStats(const std::vector<uint32_t> &stats)
+{
+    addCompStats(m_compStats, stats);
+}
+
+// Add compression stats to given totals
+
+void PpmByteStreamV1Tool::addCompStats(std::vector<uint32_t> &totals,
+                                       const std::vector<uint32_t> &stats) const
 {
     if (stats.empty()) return;
     const int n = stats.size();
-    if (m_compStats.empty()) m_compStats.resize(n);
-    for (int i = 0; i < n; ++i) m_compStats[i] += stats[i];
+    if (totals.empty()) totals.resize(n);
+    for (int i = 0; i < n; ++i) totals[i] += stats[i];
 }
 
 // Print compression stats
@@ -1092,9 +1149,16 @@ void PpmByteStreamV1Tool::printCompStats() const
 
 const LVL1::TriggerTower *PpmByteStreamV1Tool::findLayerTriggerTower(
     const double eta, const double phi, const int layer)
+{
+    return findLayerTriggerTower(m_towerKey->ttKey(phi, eta), layer);
+}
+
+// Find a trigger tower given key and layer
+
+const LVL1::TriggerTower *PpmByteStreamV1Tool::findLayerTriggerTower(
+    const unsigned int key, const int layer) const
 {
     const LVL1::TriggerTower *tt = 0;
-    const unsigned int key = m_towerKey->ttKey(phi, eta);
     TriggerTowerMapConst::const_iterator mapIter;
     if (layer == 0)
     {
@@ -1146,6 +1210,49 @@ void PpmByteStreamV1Tool::setupTTMaps(const TriggerTowerCollection *
     }
 }
 
+// Set up the tower key table used when writing bytestream
+// (NB. This assumes mappings won't change during the course of a job)
+
+void PpmByteStreamV1Tool::setupChannelKeys()
+{
+    m_chanKeys.assign(s_crates * s_modules * s_channels,
+                      std::make_pair(false, 0u));
+    m_chanLayers.assign(s_crates * s_modules * s_channels, 0);
+    for (int crate = 0; crate < s_crates; ++crate)
+    {
+        for (int module = 0; module < s_modules; ++module)
+        {
+            for (int channel = 0; channel < s_channels; ++channel)
+            {
+                double eta = 0.;
+                double phi = 0.;
+                int layer = 0;
+                if (m_ppmMaps->mapping(crate, module, channel, eta, phi, layer))
+                {
+                    const int index = (crate * s_modules + module) * s_channels
+                                      + channel;
+                    m_chanKeys[index]   = std::make_pair(true,
+                                              m_towerKey->ttKey(phi, eta));
+                    m_chanLayers[index] = layer;
+                }
+            }
+        }
+    }
+}
+
+// Return tower key and layer for given crate/module/channel,
+// false if not mapped
+
+bool PpmByteStreamV1Tool::channelKey(const int crate, const int module,
+                                     const int channel, unsigned int &key,
+                                     int &layer) const
+{
+    const int index = (crate * s_modules + module) * s_channels + channel;
+    key   = m_chanKeys[index].second;
+    layer = m_chanLayers[index];
+    return m_chanKeys[index].first;
+}
+
 // Get number of slices and triggered slice offsets for next slink
 
 bool PpmByteStreamV1Tool::slinkSlices(const int crate, const int module,
@@ -1160,13 +1267,10 @@ bool PpmByteStreamV1Tool::slinkSlices(const int crate, const int module,
     {
         for (int chan = 0; chan < s_channels; ++chan)
         {
-            double eta = 0.;
-            double phi = 0.;
+            unsigned int key = 0;
             int layer = 0;
-            if (!m_ppmMaps->mapping(crate, mod, chan,
-                                    eta, phi, layer)) continue;
-            const LVL1::TriggerTower *const tt = findLayerTriggerTower(
-                    eta, phi, layer);
+            if (!channelKey(crate, mod, chan, key, layer)) continue;
+            const LVL1::TriggerTower *const tt = findLayerTriggerTower(key, layer);
             if ( !tt ) continue;
             if (layer == 0)
             {
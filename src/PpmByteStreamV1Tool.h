@@ -5,6 +5,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "AthenaBaseComps/AthAlgTool.h"
@@ -15,6 +16,10 @@
 #include "GaudiKernel/ServiceHandle.h"
 #include "GaudiKernel/ToolHandle.h"
 
+#include "L1CaloCrateRods.h"
+#include "L1CaloRodBuffers.h"
+#include "PpmSubBlockV1.h"
+
 class IInterface;
 class InterfaceID;
 class StatusCode;
@@ -78,14 +83,39 @@ class PpmByteStreamV1Tool : public AthAlgTool {
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      ROBPointer;
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      RODPointer;
 
+   /// Output RODs, sub-blocks and compression statistics for encoding
+   /// one crate
+   struct CrateEncoder {
+     L1CaloCrateRods       rods;
+     PpmSubBlockV1         subBlock;
+     PpmSubBlockV1         errorBlock;
+     std::vector<uint32_t> compStats;
+   };
+
+   /// Encode the RODs of one crate
+   void encodeCrate(int crate, CrateEncoder& enc, int chanPerSubBlock,
+                                                  bool debug);
+   /// Set up the tower key table used when writing bytestream
+   void setupChannelKeys();
+   /// Return tower key and layer for given crate/module/channel,
+   /// false if not mapped
+   bool channelKey(int crate, int module, int channel, unsigned int& key,
+                                                       int& layer) const;
+
    /// Add compression stats to totals
    void addCompStats(const std::vector<uint32_t>& stats);
+   /// Add compression stats to given totals
+   void addCompStats(std::vector<uint32_t>& totals,
+                     const std::vector<uint32_t>& stats) const;
    /// Print compression stats
    void printCompStats() const;
 
    /// Find a trigger tower using separate layer maps
    const LVL1::TriggerTower* findLayerTriggerTower(double eta, double phi,
                                                                int layer);
+   /// Find a trigger tower given key and layer
+   const LVL1::TriggerTower* findLayerTriggerTower(unsigned int key,
+                                                   int layer) const;
    /// Set up separate Em and Had trigger tower maps
    void setupTTMaps(const TriggerTowerCollection* ttCollection);
 
@@ -125,6 +155,8 @@ class PpmByteStreamV1Tool : public AthAlgTool {
    int m_crateMin;
    /// Maximum crate number when writing out bytestream
    int m_crateMax;
+   /// Encode crates concurrently when writing bytestream
+   bool m_parallelCrates;
    /// Pedestal value
    int m_pedestal;
    /// FADC baseline lower bound
@@ -167,6 +199,13 @@ class PpmByteStreamV1Tool : public AthAlgTool {
    std::map<uint32_t, std::vector<uint32_t>* > m_rodStatusMap;
    /// Event assembler
    FullEventAssembler<L1CaloSrcIdMap>* m_fea;
+   /// ROD buffer sizes for writing
+   L1CaloRodBuffers m_rodBuffers;
+   /// Per-crate encoders for writing bytestream
+   DataVector<CrateEncoder> m_crateEncoders;
+   /// Tower keys and layers by crate/module/channel for writing bytestream
+   std::vector<std::pair<bool, unsigned int> > m_chanKeys;
+   std::vector<int> m_chanLayers;
    /// TriggerTower pool vectors
    TriggerTowerVector m_ttData;
    TriggerTowerVector m_ttSpare;
@@ -4,7 +4,6 @@
 // STD:
 // ===========================================================================
 #include <numeric>
-#include <set>
 #include <utility>
 // ===========================================================================
 // Athena
@@ -22,6 +21,7 @@
 
 #include "TrigT1CaloUtils/DataError.h"
 
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "TrigT1CaloMappingToolInterfaces/IL1CaloMappingTool.h"
 #include "L1CaloErrorByteStreamTool.h"
@@ -68,6 +68,8 @@ PpmByteStreamV2Tool::PpmByteStreamV2Tool(const std::string& type,
                   "Print compressed format statistics");
   declareProperty("FADCBaseline", m_fadcBaseline = 0,
                   "FADC baseline lower bound for compressed formats");
+  declareProperty("LutOnly", m_lutOnly = false,
+                  "Unpack LUT data only, FADC and pedestal correction skipped");
 
   // Properties for writing bytestream only
   declareProperty("DataFormat", m_dataFormat = 1,
@@ -120,15 +122,16 @@ void PpmByteStreamV2Tool::reserveMemory( xAOD::TriggerTowerContainer* const ttCo
   // TriggerTowerMap ttMap;
   // TriggerTowerMap::iterator itt;
 
-  int dataCount = 0;
+  // Channel mapping doesn't change between events, so only look it up once
+  if (m_ttEta.empty()) {
+     int dataCount = 0;
 
-  if (ttCollection->empty()) {
-	  ttCollection->reserve(m_dataSize);
-     
-     m_dataChan.resize(chanBitVecSize);
-     m_chanLayer.resize(chanBitVecSize);
-     m_dataMod.resize(modBitVecSize);
+     m_dataChan.assign(chanBitVecSize, 0);
+     m_chanLayer.assign(chanBitVecSize, 0);
+     m_dataMod.assign(modBitVecSize, 0);
      m_ttPos.resize(maxChannels);
+     m_ttEta.reserve(m_dataSize);
+     m_ttPhi.reserve(m_dataSize);
 
      for (int crate = 0; crate < m_crates; ++crate) {
         for (int module = 0; module < m_modules; ++module) {
@@ -144,49 +147,8 @@ void PpmByteStreamV2Tool::reserveMemory( xAOD::TriggerTowerContainer* const ttCo
             int layer = 0;
             // unsigned int key = 0;
             if (m_ppmMaps->mapping(crate, module, channel, eta, phi, layer)) {
-              xAOD::TriggerTower* tt =  new xAOD::TriggerTower();
-              ttCollection->push_back(tt);
-
-              // tt->initialize(
-              //         const uint_least32_t& coolId,
-              //         const uint_least8_t& layer,
-              //         const float& eta,
-              //         const float& phi,
-              //         const std::vector<uint_least8_t>& lut_cp,
-              //         const std::vector<uint_least8_t>& lut_jep,
-              //         const std::vector<int_least16_t>& correction,
-              //         const std::vector<uint_least8_t>& correctionEnabled,
-              //         const std::vector<uint_least8_t>& bcidVec,
-              //         const std::vector<uint_least16_t>& adc,
-              //         const std::vector<uint_least8_t>& bcidExt,
-              //          const std::vector<uint_least8_t>& Sat80Vec,
-              //         const uint_least16_t& error,
-              //         const uint_least8_t& peak,
-              //         const uint_least8_t& adcPeak
-              // );
-              const std::vector<uint_least32_t> dummy_vector32 {0};
-              const std::vector<int_least16_t> dummy_svector16 {0};
-              const std::vector<uint_least16_t> dummy_vector16 {0};
-              const std::vector<uint_least8_t> dummy_vector8 {0};
-              tt->initialize(
-                0,
-                eta,
-                phi,
-                dummy_vector8,
-                dummy_vector8,
-                dummy_svector16,
-                dummy_vector8,
-                dummy_vector8,
-                dummy_vector16,
-                dummy_vector8,
-                dummy_vector8,
-                0,
-                0,
-                0
-              );
-
-
-
+              m_ttEta.push_back(eta);
+              m_ttPhi.push_back(phi);
               m_ttPos[index] = dataCount++;
               // ttMap.insert(std::make_pair(key,count));
               m_chanLayer[word] |= (layer << bit);
@@ -196,6 +158,53 @@ void PpmByteStreamV2Tool::reserveMemory( xAOD::TriggerTowerContainer* const ttCo
           }
         }
       }
+  }
+
+  if (ttCollection->empty()) {
+	  ttCollection->reserve(m_dataSize);
+
+     // tt->initialize(
+     //         const uint_least32_t& coolId,
+     //         const uint_least8_t& layer,
+     //         const float& eta,
+     //         const float& phi,
+     //         const std::vector<uint_least8_t>& lut_cp,
+     //         const std::vector<uint_least8_t>& lut_jep,
+     //         const std::vector<int_least16_t>& correction,
+     //         const std::vector<uint_least8_t>& correctionEnabled,
+     //         const std::vector<uint_least8_t>& bcidVec,
+     //         const std::vector<uint_least16_t>& adc,
+     //         const std::vector<uint_least8_t>& bcidExt,
+     //          const std::vector<uint_least8_t>& Sat80Vec,
+     //         const uint_least16_t& error,
+     //         const uint_least8_t& peak,
+     //         const uint_least8_t& adcPeak
+     // );
+     const std::vector<uint_least32_t> dummy_vector32 {0};
+     const std::vector<int_least16_t> dummy_svector16 {0};
+     const std::vector<uint_least16_t> dummy_vector16 {0};
+     const std::vector<uint_least8_t> dummy_vector8 {0};
+     const size_t numTowers = m_ttEta.size();
+     for (size_t pos = 0; pos < numTowers; ++pos) {
+       xAOD::TriggerTower* tt =  new xAOD::TriggerTower();
+       ttCollection->push_back(tt);
+       tt->initialize(
+         0,
+         m_ttEta[pos],
+         m_ttPhi[pos],
+         dummy_vector8,
+         dummy_vector8,
+         dummy_svector16,
+         dummy_vector8,
+         dummy_vector8,
+         dummy_vector16,
+         dummy_vector8,
+         dummy_vector8,
+         0,
+         0,
+         0
+       );
+     }
   } 
 }
 
@@ -233,7 +242,7 @@ void PpmByteStreamV2Tool::collectTriggerTowers(
   // Loop over ROB fragments
   // =========================================================================
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();  
 
@@ -290,7 +299,7 @@ void PpmByteStreamV2Tool::collectTriggerTowers(
     //     continue;
     // }
     // Skip duplicate fragments
-    if (!dupCheck.insert(robid).second) {
+    if (!dupCheck.insert(robid)) {
       m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
       ATH_MSG_DEBUG("Skipping duplicate ROB fragment");
       continue;
@@ -534,6 +543,7 @@ void PpmByteStreamV2Tool::collectTriggerTowers(
         subBlock->setFadcBaseline(m_fadcBaseline);
         subBlock->setRunNumber(runNumber);
         subBlock->setRodVersion((*rob)->rod_version());
+        subBlock->setLutOnly(m_lutOnly);
         
         msg(MSG::DEBUG) << "Unpacking sub-block version/format/seqno: "
           << subBlock->version() << "/" << subBlock->format() << "/"
@@ -562,26 +572,41 @@ void PpmByteStreamV2Tool::collectTriggerTowers(
             rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
             break;
           }
-         // Get data
-          subBlock->ppmData(channel, lutCp, lutJep, fadc, bcidLutCp, satLutJep,
-            bcidFadc, correction, correctionEnabled);
+          // Get data, checking slices before extracting anything
+          const PpmSubBlockV2::ChannelView view(subBlock->channelView(channel));
           
-          if (lutCp.size() < size_t(trigLut + 1)) {
+          if (view.lutCpSlices() < trigLut + 1) {
             ATH_MSG_DEBUG("Triggered LUT slice from header "
                     << "inconsistent with number of slices: "
-              << trigLut << ", " << lutCp.size());
+              << trigLut << ", " << view.lutCpSlices());
 
             rodErr = L1CaloSubBlock::ERROR_SLICES;
             break;
           }
       
-          if (fadc.size() < size_t(trigFadc + 1)) {
+          const bool fadcSkipped = subBlock->lutOnly() && subBlock->isRun2();
+          if (!fadcSkipped && view.fadcSlices() < trigFadc + 1) {
             ATH_MSG_DEBUG("Triggered FADC slice from header "
                     << "inconsistent with number of slices: "
-              << trigFadc << ", " << fadc.size());
+              << trigFadc << ", " << view.fadcSlices());
             rodErr = L1CaloSubBlock::ERROR_SLICES;
             break;
           }
+
+          // Sizes only change with the sub-block format, so after the
+          // first channel these resizes do nothing
+          lutCp.resize(view.lutCpSlices());
+          bcidLutCp.resize(view.lutCpSlices());
+          view.lutCp(lutCp.data(), bcidLutCp.data());
+          lutJep.resize(view.lutJepSlices());
+          satLutJep.resize(view.lutJepSlices());
+          view.lutJep(lutJep.data(), satLutJep.data());
+          fadc.resize(view.fadcSlices());
+          bcidFadc.resize(view.fadcSlices());
+          view.fadc(fadc.data(), bcidFadc.data());
+          correction.resize(view.correctionSlices());
+          correctionEnabled.resize(view.correctionSlices());
+          view.correction(correction.data(), correctionEnabled.data());
           
           LVL1::DataError errorBits(0);
           if (isErrBlock) {
@@ -712,6 +737,31 @@ StatusCode PpmByteStreamV2Tool::convert(
 
   return StatusCode::SUCCESS;
 }
+
+// Conversion bytestream to trigger towers for a batch of events
+
+StatusCode PpmByteStreamV2Tool::convert(
+    const std::vector<const IROBDataProviderSvc::VROBFRAG*>& robFragsBatch,
+    const std::vector<xAOD::TriggerTowerContainer*>& ttCollections) {
+
+  if (robFragsBatch.size() != ttCollections.size()) {
+    ATH_MSG_ERROR("Batch of " << robFragsBatch.size() << " events given "
+      << ttCollections.size() << " trigger tower containers");
+    return StatusCode::FAILURE;
+  }
+  // Allocate every event's towers up front so they are laid out together,
+  // then decode the events back to back with the same channel maps and
+  // sub-block pool
+  for (auto ttCollection : ttCollections) {
+    reserveMemory(ttCollection);
+  }
+  for (size_t evt = 0; evt < robFragsBatch.size(); ++evt) {
+    xAOD::TriggerTowerContainer* const ttCollection = ttCollections[evt];
+    collectTriggerTowers(*robFragsBatch[evt], ttCollection);
+  }
+
+  return StatusCode::SUCCESS;
+}
 // ===========================================================================
 // Conversion of trigger towers to bytestream
 
@@ -75,6 +75,12 @@ public:
   StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
        xAOD::TriggerTowerContainer* const ttCollection);
 
+  /// Convert ROB fragments of several events to trigger towers,
+  /// one container per event
+  StatusCode convert(
+      const std::vector<const IROBDataProviderSvc::VROBFRAG*>& robFragsBatch,
+      const std::vector<xAOD::TriggerTowerContainer*>& ttCollections);
+
   /// Convert trigger towers to bytestream
   StatusCode convert(const xAOD::TriggerTowerContainer* ttCollection,
       RawEventWrite* re);
@@ -154,6 +160,9 @@ private:
   // TriggerTowerVector m_ttSpare;
   // TriggerTowerVector m_ttMuon;
   std::vector<int> m_ttPos;
+  /// Eta and phi of each mapped channel, by pool position
+  std::vector<float> m_ttEta;
+  std::vector<float> m_ttPhi;
 
 
   /// Compression statistics print flag
@@ -162,6 +171,8 @@ private:
   int m_pedestal;
   /// FADC baseline lower bound
   int m_fadcBaseline;
+  /// Unpack LUT data only
+  bool m_lutOnly;
 
 private:
   // For writing to bytestream
@@ -0,0 +1,42 @@
+
+#include "PpmDataArrays.h"
+
+namespace LVL1BS {
+
+PpmDataArrays::PpmDataArrays() : m_channels(0), m_slicesLut(0),
+                                 m_slicesFadc(0), m_empty(true)
+{
+}
+
+// Size for given channels and slices, all fields zero
+
+void PpmDataArrays::reset(const int channels, const int slicesLut,
+                                              const int slicesFadc)
+{
+  m_channels   = channels;
+  m_slicesLut  = slicesLut;
+  m_slicesFadc = slicesFadc;
+  m_empty      = false;
+  const int lutSize  = channels * slicesLut;
+  const int fadcSize = channels * slicesFadc;
+  m_lutCp.assign(lutSize, 0);
+  m_bcidLutCp.assign(lutSize, 0);
+  m_lutJep.assign(lutSize, 0);
+  m_satLutJep.assign(lutSize, 0);
+  m_correction.assign(lutSize, 0);
+  m_correctionEnabled.assign(lutSize, 0);
+  m_fadc.assign(fadcSize, 0);
+  m_bcidFadc.assign(fadcSize, 0);
+}
+
+// Mark empty, keeping the storage
+
+void PpmDataArrays::clear()
+{
+  m_channels   = 0;
+  m_slicesLut  = 0;
+  m_slicesFadc = 0;
+  m_empty      = true;
+}
+
+} // end namespace
@@ -0,0 +1,180 @@
+#ifndef TRIGT1CALOBYTESTREAM_PPMDATAARRAYS_H
+#define TRIGT1CALOBYTESTREAM_PPMDATAARRAYS_H
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace LVL1BS {
+
+/** PPM sub-block data stored field by field.
+ *
+ *  One contiguous array per field, covering all channels of the
+ *  sub-block slice by slice: element index(chan, slice) is
+ *  slice * channels() + chan.  Filled once, by unpacking or by
+ *  fillPpmData, so loops over channels for a given slice and field
+ *  run through contiguous memory.
+ *
+ *  Run 1 data use the LUT-CP, LUT-CP BCID, FADC and FADC BCID fields.
+ */
+
+class PpmDataArrays {
+
+ public:
+   PpmDataArrays();
+
+   /// Size for given channels and slices, all fields zero
+   void reset(int channels, int slicesLut, int slicesFadc);
+   /// Mark empty, keeping the storage
+   void clear();
+
+   bool empty()      const;
+   int  channels()   const;
+   int  slicesLut()  const;
+   int  slicesFadc() const;
+   /// Return array index of given channel and slice
+   int  index(int chan, int slice) const;
+
+   //  LUT fields, slicesLut() x channels()
+   uint_least8_t*        lutCp();
+   const uint_least8_t*  lutCp()             const;
+   uint_least8_t*        bcidLutCp();
+   const uint_least8_t*  bcidLutCp()         const;
+   uint_least8_t*        lutJep();
+   const uint_least8_t*  lutJep()            const;
+   uint_least8_t*        satLutJep();
+   const uint_least8_t*  satLutJep()         const;
+   int_least16_t*        correction();
+   const int_least16_t*  correction()        const;
+   uint_least8_t*        correctionEnabled();
+   const uint_least8_t*  correctionEnabled() const;
+   //  FADC fields, slicesFadc() x channels()
+   uint_least16_t*       fadc();
+   const uint_least16_t* fadc()              const;
+   uint_least8_t*        bcidFadc();
+   const uint_least8_t*  bcidFadc()          const;
+
+ private:
+   int  m_channels;
+   int  m_slicesLut;
+   int  m_slicesFadc;
+   bool m_empty;
+   std::vector<uint_least8_t>  m_lutCp;
+   std::vector<uint_least8_t>  m_bcidLutCp;
+   std::vector<uint_least8_t>  m_lutJep;
+   std::vector<uint_least8_t>  m_satLutJep;
+   std::vector<int_least16_t>  m_correction;
+   std::vector<uint_least8_t>  m_correctionEnabled;
+   std::vector<uint_least16_t> m_fadc;
+   std::vector<uint_least8_t>  m_bcidFadc;
+
+};
+
+inline bool PpmDataArrays::empty() const
+{
+  return m_empty;
+}
+
+inline int PpmDataArrays::channels() const
+{
+  return m_channels;
+}
+
+inline int PpmDataArrays::slicesLut() const
+{
+  return m_slicesLut;
+}
+
+inline int PpmDataArrays::slicesFadc() const
+{
+  return m_slicesFadc;
+}
+
+inline int PpmDataArrays::index(const int chan, const int slice) const
+{
+  return slice * m_channels + chan;
+}
+
+inline uint_least8_t* PpmDataArrays::lutCp()
+{
+  return m_lutCp.data();
+}
+
+inline const uint_least8_t* PpmDataArrays::lutCp() const
+{
+  return m_lutCp.data();
+}
+
+inline uint_least8_t* PpmDataArrays::bcidLutCp()
+{
+  return m_bcidLutCp.data();
+}
+
+inline const uint_least8_t* PpmDataArrays::bcidLutCp() const
+{
+  return m_bcidLutCp.data();
+}
+
+inline uint_least8_t* PpmDataArrays::lutJep()
+{
+  return m_lutJep.data();
+}
+
+inline const uint_least8_t* PpmDataArrays::lutJep() const
+{
+  return m_lutJep.data();
+}
+
+inline uint_least8_t* PpmDataArrays::satLutJep()
+{
+  return m_satLutJep.data();
+}
+
+inline const uint_least8_t* PpmDataArrays::satLutJep() const
+{
+  return m_satLutJep.data();
+}
+
+inline int_least16_t* PpmDataArrays::correction()
+{
+  return m_correction.data();
+}
+
+inline const int_least16_t* PpmDataArrays::correction() const
+{
+  return m_correction.data();
+}
+
+inline uint_least8_t* PpmDataArrays::correctionEnabled()
+{
+  return m_correctionEnabled.data();
+}
+
+inline const uint_least8_t* PpmDataArrays::correctionEnabled() const
+{
+  return m_correctionEnabled.data();
+}
+
+inline uint_least16_t* PpmDataArrays::fadc()
+{
+  return m_fadc.data();
+}
+
+inline const uint_least16_t* PpmDataArrays::fadc() const
+{
+  return m_fadc.data();
+}
+
+inline uint_least8_t* PpmDataArrays::bcidFadc()
+{
+  return m_bcidFadc.data();
+}
+
+inline const uint_least8_t* PpmDataArrays::bcidFadc() const
+{
+  return m_bcidFadc.data();
+}
+
+} // end namespace
+
+#endif
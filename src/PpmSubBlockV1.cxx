@@ -1,3 +1,5 @@
+#include <algorithm>
+
 
 #include "PpmCompressionV1.h"
 #include "PpmSubBlockV1.h"
@@ -57,6 +59,7 @@ void PpmSubBlockV1::clear()
   m_lutOffset     = -1;
   m_fadcOffset    = -1;
   m_datamap.clear();
+  m_arrays.clear();
   m_errormap.clear();
 }
 
@@ -109,29 +112,24 @@ void PpmSubBlockV1::fillPpmData(const int chan, const std::vector<int>& lut,
 				              const std::vector<int>& bcidLut,
 				              const std::vector<int>& bcidFadc)
 {
-  const int sliceL = slicesLut();
-  const int sliceF = slicesFadc();
-  const int slices = sliceL + sliceF;
   const int chanPerSubBlock = channelsPerSubBlock();
-  int dataSize = m_datamap.size();
-  if (dataSize == 0) {
-    dataSize = slices * chanPerSubBlock;
-    m_datamap.resize(dataSize);
+  if (m_arrays.empty()) {
+    m_arrays.reset(chanPerSubBlock, slicesLut(), slicesFadc());
   }
-  int offset = (chan % chanPerSubBlock) * slices;
-  if (offset + slices <= dataSize) {
-    for (int pos = 0; pos < sliceL; ++pos) {
-      uint32_t datum = (lut[pos] & s_lutMask) << s_lutBit;
-      datum |= (bcidLut[pos] & s_bcidLutMask) << s_bcidLutBit;
-      m_datamap[offset + pos] = datum;
-    }
-    offset += sliceL;
-    for (int pos = 0; pos < sliceF; ++pos) {
-      const int adc = (fadc[pos] > 0) ? fadc[pos] : 0;
-      uint32_t datum = (adc & s_fadcMask) << s_fadcBit;
-      datum |= (bcidFadc[pos] & s_bcidFadcMask) << s_bcidFadcBit;
-      m_datamap[offset + pos] = datum;
-    }
+  const int channel = chan % chanPerSubBlock;
+  if (channel >= m_arrays.channels()) return;
+  const int sliceL = m_arrays.slicesLut();
+  const int sliceF = m_arrays.slicesFadc();
+  for (int sl = 0; sl < sliceL; ++sl) {
+    const int idx = m_arrays.index(channel, sl);
+    m_arrays.lutCp()[idx]     = lut[sl] & s_lutMask;
+    m_arrays.bcidLutCp()[idx] = bcidLut[sl] & s_bcidLutMask;
+  }
+  for (int sl = 0; sl < sliceF; ++sl) {
+    const int idx = m_arrays.index(channel, sl);
+    const int adc = (fadc[sl] > 0) ? fadc[sl] : 0;
+    m_arrays.fadc()[idx]     = adc & s_fadcMask;
+    m_arrays.bcidFadc()[idx] = bcidFadc[sl] & s_bcidFadcMask;
   }
 }
 
@@ -142,32 +140,24 @@ void PpmSubBlockV1::ppmData(const int chan, std::vector<int>& lut,
 				          std::vector<int>& bcidLut,
 				          std::vector<int>& bcidFadc)
 {
-  lut.clear();
-  fadc.clear();
-  bcidLut.clear();
-  bcidFadc.clear();
   const int sliceL = slicesLut();
   const int sliceF = slicesFadc();
-  int beg = (chan % channelsPerSubBlock()) * (sliceL + sliceF);
-  int end = beg + sliceL;
-  if (size_t(end + sliceF) <= m_datamap.size()) {
-    for (int pos = beg; pos < end; ++pos) {
-      const uint32_t word = m_datamap[pos];
-      lut.push_back((word >> s_lutBit) & s_lutMask);
-      bcidLut.push_back((word >> s_bcidLutBit) & s_bcidLutMask);
-    }
-    beg += sliceL;
-    end += sliceF;
-    for (int pos = beg; pos < end; ++pos) {
-      const uint32_t word = m_datamap[pos];
-      fadc.push_back((word >> s_fadcBit) & s_fadcMask);
-      bcidFadc.push_back((word >> s_bcidFadcBit) & s_bcidFadcMask);
-    }
-  } else {
-    lut.resize(sliceL);
-    fadc.resize(sliceF);
-    bcidLut.resize(sliceL);
-    bcidFadc.resize(sliceF);
+  lut.assign(sliceL, 0);
+  fadc.assign(sliceF, 0);
+  bcidLut.assign(sliceL, 0);
+  bcidFadc.assign(sliceF, 0);
+  const int channel = chan % channelsPerSubBlock();
+  if (m_arrays.empty() || channel >= m_arrays.channels() ||
+      sliceL != m_arrays.slicesLut() || sliceF != m_arrays.slicesFadc()) return;
+  for (int sl = 0; sl < sliceL; ++sl) {
+    const int idx = m_arrays.index(channel, sl);
+    lut[sl]     = m_arrays.lutCp()[idx];
+    bcidLut[sl] = m_arrays.bcidLutCp()[idx];
+  }
+  for (int sl = 0; sl < sliceF; ++sl) {
+    const int idx = m_arrays.index(channel, sl);
+    fadc[sl]     = m_arrays.fadc()[idx];
+    bcidFadc[sl] = m_arrays.bcidFadc()[idx];
   }
 }
 
@@ -302,8 +292,7 @@ bool PpmSubBlockV1::unpack()
 bool PpmSubBlockV1::packNeutral()
 {
   const int slices   = slicesLut() + slicesFadc();
-  const int channels = channelsPerSubBlock();
-  if (m_datamap.empty()) m_datamap.resize(slices * channels);
+  mergeData();
   // Bunch crossing number
   for (int pin = 0; pin < s_glinkPins; ++pin) {
     uint32_t bc = 0;
@@ -337,7 +326,7 @@ bool PpmSubBlockV1::packUncompressedData()
 {
   const int slices   = slicesLut() + slicesFadc();
   const int channels = channelsPerSubBlock();
-  if (m_datamap.empty()) m_datamap.resize(slices * channels);
+  mergeData();
   for (int sl = 0; sl < slices; ++sl) {
     for (int chan = 0; chan < channels; ++chan) {
       packer(m_datamap[sl + chan*slices], s_wordLen);
@@ -382,6 +371,7 @@ bool PpmSubBlockV1::unpackNeutral()
   }
   const bool rc = unpackerSuccess();
   if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+  splitData();
   // Errors
   m_errormap.clear();
   for (int pin = 0; pin < s_glinkPins; ++pin) {
@@ -405,6 +395,7 @@ bool PpmSubBlockV1::unpackUncompressedData()
       m_datamap[sl + chan*slices] = unpacker(s_wordLen);
     }
   }
+  splitData();
   bool rc = unpackerSuccess();
   if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
   else {
@@ -443,6 +434,60 @@ bool PpmSubBlockV1::unpackUncompressedErrors()
   return rc;
 }
 
+// Fill field arrays from unpacked data words
+
+void PpmSubBlockV1::splitData()
+{
+  const int sliceL   = slicesLut();
+  const int sliceF   = slicesFadc();
+  const int slices   = sliceL + sliceF;
+  const int channels = channelsPerSubBlock();
+  m_arrays.reset(channels, sliceL, sliceF);
+  const int filled = std::min(channels, int(m_datamap.size()) / slices);
+  for (int chan = 0; chan < filled; ++chan) {
+    const uint32_t* const word = m_datamap.data() + chan * slices;
+    for (int sl = 0; sl < sliceL; ++sl) {
+      const int idx = m_arrays.index(chan, sl);
+      m_arrays.lutCp()[idx]     = (word[sl] >> s_lutBit) & s_lutMask;
+      m_arrays.bcidLutCp()[idx] = (word[sl] >> s_bcidLutBit) & s_bcidLutMask;
+    }
+    for (int sl = 0; sl < sliceF; ++sl) {
+      const int idx = m_arrays.index(chan, sl);
+      const uint32_t datum = word[sliceL + sl];
+      m_arrays.fadc()[idx]     = (datum >> s_fadcBit) & s_fadcMask;
+      m_arrays.bcidFadc()[idx] = (datum >> s_bcidFadcBit) & s_bcidFadcMask;
+    }
+  }
+}
+
+// Fill data words for packing from field arrays
+
+void PpmSubBlockV1::mergeData()
+{
+  const int sliceL   = slicesLut();
+  const int sliceF   = slicesFadc();
+  const int slices   = sliceL + sliceF;
+  const int channels = channelsPerSubBlock();
+  m_datamap.assign(slices * channels, 0);
+  if (m_arrays.empty()) return;
+  const int nchan = std::min(channels, m_arrays.channels());
+  const int nlut  = std::min(sliceL, m_arrays.slicesLut());
+  const int nfadc = std::min(sliceF, m_arrays.slicesFadc());
+  for (int chan = 0; chan < nchan; ++chan) {
+    uint32_t* const word = m_datamap.data() + chan * slices;
+    for (int sl = 0; sl < nlut; ++sl) {
+      const int idx = m_arrays.index(chan, sl);
+      word[sl] = (uint32_t(m_arrays.lutCp()[idx]) << s_lutBit) |
+                 (uint32_t(m_arrays.bcidLutCp()[idx]) << s_bcidLutBit);
+    }
+    for (int sl = 0; sl < nfadc; ++sl) {
+      const int idx = m_arrays.index(chan, sl);
+      word[sliceL + sl] = (uint32_t(m_arrays.fadc()[idx]) << s_fadcBit) |
+                          (uint32_t(m_arrays.bcidFadc()[idx]) << s_bcidFadcBit);
+    }
+  }
+}
+
 // Return the number of channels per sub-block
 
 int PpmSubBlockV1::channelsPerSubBlock(const int version, const int format)
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "L1CaloSubBlock.h"
+#include "PpmDataArrays.h"
 
 namespace LVL1BS {
 
@@ -43,6 +44,8 @@ class PpmSubBlockV1 : public L1CaloSubBlock {
                           std::vector<int>& fadc,
 			  std::vector<int>& bcidLut,
 			  std::vector<int>& bcidFadc);
+   /// Return unpacked data for all channels by field
+   const PpmDataArrays& dataArrays() const;
 
    /// Store an error word corresponding to a data channel
    void fillPpmError(int chan, int errorWord);
@@ -168,6 +171,11 @@ class PpmSubBlockV1 : public L1CaloSubBlock {
    /// Unpack uncompressed error data
    bool unpackUncompressedErrors();
 
+   /// Fill field arrays from unpacked data words
+   void splitData();
+   /// Fill data words for packing from field arrays
+   void mergeData();
+
    //  Global error flags
    mutable uint32_t m_globalError;
    mutable bool     m_globalDone;
@@ -183,14 +191,22 @@ class PpmSubBlockV1 : public L1CaloSubBlock {
    /// Vector for compression statistics
    std::vector<uint32_t> m_compStats;
 
-   /// Vector for intermediate data
+   /// Data words as packed, channel by channel
    std::vector<uint32_t> m_datamap;
 
+   /// Data by field
+   PpmDataArrays m_arrays;
+
    /// Vector for intermediate error data
    std::vector<uint32_t> m_errormap;
 
 };
 
+inline const PpmDataArrays& PpmSubBlockV1::dataArrays() const
+{
+  return m_arrays;
+}
+
 inline bool PpmSubBlockV1::glinkPinParity(const int chan) const
 {
   return errorBit(pin(chan), s_glinkPinParityBit);
@@ -1,3 +1,4 @@
+#include <algorithm>
 
 #include "PpmCompressionV2.h"
 #include "PpmSubBlockV2.h"
@@ -44,7 +45,7 @@ const uint16_t PpmSubBlockV2::s_run2minorVersion;
 PpmSubBlockV2::PpmSubBlockV2() : m_globalError(0), m_globalDone(false),
     m_lutOffset(-1), m_fadcOffset(-1),
     m_pedestal(10), m_fadcBaseline(0),
-    m_fadcThreshold(0), m_runNumber(0)
+    m_fadcThreshold(0), m_runNumber(0), m_lutOnly(false)
 {
 }
 
@@ -61,7 +62,9 @@ void PpmSubBlockV2::clear()
     m_globalDone    = false;
     m_lutOffset     = -1;
     m_fadcOffset    = -1;
+    m_lutOnly       = false;
     m_datamap.clear();
+    m_arrays.clear();
     m_errormap.clear();
 }
 
@@ -116,33 +119,27 @@ void PpmSubBlockV2::fillPpmData(const int chan,
                                 const std::vector<int> &bcidLut,
                                 const std::vector<int> &bcidFadc)
 {
-    const int sliceL = slicesLut();
-    const int sliceF = slicesFadc();
-    const int slices = sliceL + sliceF;
     const int chanPerSubBlock = channelsPerSubBlock();
-    int dataSize = m_datamap.size();
-    if (dataSize == 0)
+    if (m_arrays.empty())
     {
-        dataSize = slices * chanPerSubBlock;
-        m_datamap.resize(dataSize);
+        m_arrays.reset(chanPerSubBlock, slicesLut(), slicesFadc());
     }
-    int offset = (chan % chanPerSubBlock) * slices;
-    if (offset + slices <= dataSize)
+    const int channel = chan % chanPerSubBlock;
+    if (channel >= m_arrays.channels()) return;
+    const int sliceL = m_arrays.slicesLut();
+    const int sliceF = m_arrays.slicesFadc();
+    for (int sl = 0; sl < sliceL; ++sl)
     {
-        for (int pos = 0; pos < sliceL; ++pos)
-        {
-            uint32_t datum = (lut[pos] & s_lutMask) << s_lutBit;
-            datum |= (bcidLut[pos] & s_bcidLutMask) << s_bcidLutBit;
-            m_datamap[offset + pos] = datum;
-        }
-        offset += sliceL;
-        for (int pos = 0; pos < sliceF; ++pos)
-        {
-            const int adc = (fadc[pos] > 0) ? fadc[pos] : 0;
-            uint32_t datum = (adc & s_fadcMask) << s_fadcBit;
-            datum |= (bcidFadc[pos] & s_bcidFadcMask) << s_bcidFadcBit;
-            m_datamap[offset + pos] = datum;
-        }
+        const int idx = m_arrays.index(channel, sl);
+        m_arrays.lutCp()[idx]     = lut[sl] & s_lutMask;
+        m_arrays.bcidLutCp()[idx] = bcidLut[sl] & s_bcidLutMask;
+    }
+    for (int sl = 0; sl < sliceF; ++sl)
+    {
+        const int idx = m_arrays.index(channel, sl);
+        const int adc = (fadc[sl] > 0) ? fadc[sl] : 0;
+        m_arrays.fadc()[idx]     = adc & s_fadcMask;
+        m_arrays.bcidFadc()[idx] = bcidFadc[sl] & s_bcidFadcMask;
     }
 }
 
@@ -161,102 +158,98 @@ void PpmSubBlockV2::ppmData(
 
 )
 {
-    lutCp.clear();
-    lutJep.clear();
-    fadc.clear();
+    const ChannelView view(channelView(chan));
 
-    bcidLutCp.clear();
-    satLutJep.clear();
-    bcidFadc.clear();
+    lutCp.resize(view.lutCpSlices());
+    bcidLutCp.resize(view.lutCpSlices());
+    view.lutCp(lutCp.data(), bcidLutCp.data());
 
-    correction.clear();
-    correctionEnabled.clear();
+    lutJep.resize(view.lutJepSlices());
+    satLutJep.resize(view.lutJepSlices());
+    view.lutJep(lutJep.data(), satLutJep.data());
 
-    if (isRun2())
-    {
-        ppmDataRun2(chan, lutCp, lutJep, fadc, bcidLutCp, satLutJep,
-                    bcidFadc, correction, correctionEnabled);
-    }
-    else     // MCM
-    {
-        ppmDataRun1(chan, lutCp, fadc, bcidLutCp, bcidFadc);
-    }
-}
+    fadc.resize(view.fadcSlices());
+    bcidFadc.resize(view.fadcSlices());
+    view.fadc(fadc.data(), bcidFadc.data());
 
+    correction.resize(view.correctionSlices());
+    correctionEnabled.resize(view.correctionSlices());
+    view.correction(correction.data(), correctionEnabled.data());
+}
 
-void PpmSubBlockV2::ppmDataRun2(
-    const int chan,
-    std::vector<uint_least8_t> &lutCp,
-    std::vector<uint_least8_t> &lutJep,
-    std::vector<uint_least16_t> &fadc,
-    std::vector<uint_least8_t> &bcidLutCp,
-    std::vector<uint_least8_t> &satLutJep,
-    std::vector<uint_least8_t> &bcidFadc,
-    std::vector<int_least16_t> &correction,
-    std::vector<uint_least8_t> &correctionEnabled
+// Return a view of the unpacked data for given channel
 
-)
+PpmSubBlockV2::ChannelView PpmSubBlockV2::channelView(const int chan)
 {
-    const int sliceL = slicesLut();
-    const int sliceF = slicesFadc();
-
-    int pos = (chan % channelsPerSubBlock()) * (3 * sliceL + sliceF);
-
-    uint_least32_t word;
-    for (int i = 0; i < sliceL; ++i)
+    const int chanPerSubBlock = channelsPerSubBlock();
+    if (m_arrays.empty())
     {
-        word = m_datamap[pos++];
-        lutCp.push_back((word >> s_lutBit) & s_lutMask);
-        bcidLutCp.push_back((word >> s_bcidLutBit) & s_bcidLutMask);
+        m_arrays.reset(chanPerSubBlock, slicesLut(), slicesFadc());
     }
+    return ChannelView(m_arrays, chan % chanPerSubBlock, isRun2(), m_lutOnly);
+}
 
-    for (int i = 0; i < sliceL; ++i)
-    {
-        word = m_datamap[pos++];
-        lutJep.push_back((word >> s_lutBit) & s_lutMask);
-        satLutJep.push_back((word >> s_bcidLutBit) & s_bcidLutMask);
-    }
+// Extract LUT-CP data and BCID bits, Run 1 LUT data
 
-    for (int i = 0; i < sliceF; i++)
+void PpmSubBlockV2::ChannelView::lutCp(uint_least8_t* const lut,
+                                       uint_least8_t* const bcid) const
+{
+    const int stride = m_arrays->channels();
+    const uint_least8_t* const lutIn  = m_arrays->lutCp() + m_chan;
+    const uint_least8_t* const bcidIn = m_arrays->bcidLutCp() + m_chan;
+    const int slices = lutCpSlices();
+    for (int i = 0; i < slices; ++i)
     {
-        word = m_datamap[pos++];
-        fadc.push_back((word >> s_fadcBitV2) & s_fadcMask);
-        bcidFadc.push_back((word >> s_bcidFadcBitV2) & s_bcidFadcMask);
+        lut[i]  = lutIn[i * stride];
+        bcid[i] = bcidIn[i * stride];
     }
+}
+
+// Extract LUT-JEP data and saturation bits
 
-    for (int i = 0; i < sliceL; i++)
+void PpmSubBlockV2::ChannelView::lutJep(uint_least8_t* const lut,
+                                        uint_least8_t* const sat) const
+{
+    const int stride = m_arrays->channels();
+    const uint_least8_t* const lutIn = m_arrays->lutJep() + m_chan;
+    const uint_least8_t* const satIn = m_arrays->satLutJep() + m_chan;
+    const int slices = lutJepSlices();
+    for (int i = 0; i < slices; ++i)
     {
-        word = m_datamap[pos++];
-        correction.push_back((word >> s_fadcBitV2) & s_fadcMask);
-        correctionEnabled.push_back((word >> s_bcidFadcBitV2) & s_bcidFadcMask);
+        lut[i] = lutIn[i * stride];
+        sat[i] = satIn[i * stride];
     }
 }
 
-void PpmSubBlockV2::ppmDataRun1(int chan,
-                                std::vector<uint_least8_t> &lut,
-                                std::vector<uint_least16_t> &fadc,
-                                std::vector<uint_least8_t> &bcidLut,
-                                std::vector<uint_least8_t> &bcidFadc
-                               )
-{
-    const int sliceL = slicesLut();
-    const int sliceF = slicesFadc();
+// Extract FADC data and BCID bits
 
-    int pos = (chan % channelsPerSubBlock()) * (sliceL + sliceF);
-
-    uint32_t word;
-    for (int i = 0; i < sliceL; ++i)
+void PpmSubBlockV2::ChannelView::fadc(uint_least16_t* const fadc,
+                                      uint_least8_t* const bcid) const
+{
+    const int stride = m_arrays->channels();
+    const uint_least16_t* const fadcIn = m_arrays->fadc() + m_chan;
+    const uint_least8_t* const  bcidIn = m_arrays->bcidFadc() + m_chan;
+    const int slices = fadcSlices();
+    for (int i = 0; i < slices; ++i)
     {
-        word = m_datamap[pos++];
-        lut.push_back((word >> s_lutBit) & s_lutMask);
-        bcidLut.push_back((word >> s_bcidLutBit) & s_bcidLutMask);
+        fadc[i] = fadcIn[i * stride];
+        bcid[i] = bcidIn[i * stride];
     }
+}
 
-    for (int i = 0; i < sliceF; i++)
+// Extract pedestal correction and enabled bits
+
+void PpmSubBlockV2::ChannelView::correction(int_least16_t* const correction,
+                                            uint_least8_t* const enabled) const
+{
+    const int stride = m_arrays->channels();
+    const int_least16_t* const corrIn    = m_arrays->correction() + m_chan;
+    const uint_least8_t* const enabledIn = m_arrays->correctionEnabled() + m_chan;
+    const int slices = correctionSlices();
+    for (int i = 0; i < slices; ++i)
     {
-        word = m_datamap[pos++];
-        fadc.push_back((word >> s_fadcBit) & s_fadcMask);
-        bcidFadc.push_back((word >> s_bcidFadcBit) & s_bcidFadcMask);
+        correction[i] = corrIn[i * stride];
+        enabled[i]    = enabledIn[i * stride];
     }
 }
 
@@ -395,8 +388,7 @@ bool PpmSubBlockV2::unpack()
 bool PpmSubBlockV2::packNeutral()
 {
     const int slices   = slicesLut() + slicesFadc();
-    const int channels = channelsPerSubBlock();
-    if (m_datamap.empty()) m_datamap.resize(slices * channels);
+    mergeData();
     // Bunch crossing number
     for (int pin = 0; pin < s_glinkPins; ++pin)
     {
@@ -435,7 +427,7 @@ bool PpmSubBlockV2::packUncompressedData()
 {
     const int slices   = slicesLut() + slicesFadc();
     const int channels = channelsPerSubBlock();
-    if (m_datamap.empty()) m_datamap.resize(slices * channels);
+    mergeData();
     for (int sl = 0; sl < slices; ++sl)
     {
         for (int chan = 0; chan < channels; ++chan)
@@ -489,6 +481,7 @@ bool PpmSubBlockV2::unpackNeutral()
     }
     const bool rc = unpackerSuccess();
     if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+    splitData();
     // Errors
     m_errormap.clear();
     for (int pin = 0; pin < s_glinkPins; ++pin)
@@ -512,67 +505,144 @@ bool PpmSubBlockV2::unpackUncompressedData()
         setStreamed();
     }
 
+    // Fixed width words in channel order, so unpack in bulk
+    const int nbits = wordLen();
+    const int totalBits = slices * channels * nbits;
     m_datamap.resize(slices * channels);
-    unpackerInit();
-    // for (int sl = 0; sl < slices; ++sl)
-    // {
-    //     for (int chan = 0; chan < channels; ++chan)
-    //     {
-    //         m_datamap[sl + chan * slices] = unpacker(wordLen());
-    //         std::cout << "SASHA3 wordLen=" << wordLen() << " slice=" << sl << " channel=" << chan << " OK?=" << unpackerSuccess() << " value=" << std::hex << (m_datamap[sl + chan * slices]) << std::endl;
-    //     }
-    // }
-    for (int chan = 0; chan < channels; ++chan)
+    if (totalBits > unpackerBits())
+    {
+        setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+        return false;
+    }
+    if (isRun2() && m_lutOnly)
     {
-        for (int sl = 0; sl < slices; ++sl)
+        // Read LUT-CP and LUT-JEP words, step over FADC and correction
+        const int lutWords = 2 * slicesLut();
+        for (int chan = 0; chan < channels; ++chan)
         {
-            m_datamap[sl + chan * slices] = unpacker(wordLen());
-            // std::cout << "SASHA3 wordLen=" << wordLen() << " slice=" << sl << " channel=" << chan << " OK?=" << unpackerSuccess() << " value=" << std::hex << (m_datamap[sl + chan * slices]) << std::endl;
+            unpackerFixed(nbits, chan * slices * nbits, lutWords,
+                          m_datamap.data() + chan * slices);
         }
     }
-    bool rc = unpackerSuccess();
-    if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
     else
     {
-        // Check no more non-zero data
-        while (unpackerSuccess())
-        {
-            if (unpacker(wordLen()))
-            {
-                setUnpackErrorCode(UNPACK_EXCESS_DATA);
-                rc = false;
-                break;
-            }
-        }
+        unpackerFixed(nbits, 0, slices * channels, m_datamap.data());
     }
-    return rc;
+    splitData();
+    // Check no more non-zero data
+    if (!unpackerZeroFrom(totalBits))
+    {
+        setUnpackErrorCode(UNPACK_EXCESS_DATA);
+        return false;
+    }
+    return true;
 }
 
 // Unpack uncompressed error data
 
 bool PpmSubBlockV2::unpackUncompressedErrors()
 {
-    unpackerInit();
-    m_errormap.clear();
-    for (int pin = 0; pin < s_glinkPins; ++pin)
+    const int nbits = wordLen();
+    const int totalBits = s_glinkPins * nbits;
+    m_errormap.resize(s_glinkPins);
+    if (totalBits > unpackerBits())
     {
-        m_errormap.push_back(unpacker(wordLen()));
+        setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
+        return false;
     }
-    bool rc = unpackerSuccess();
-    if (!rc) setUnpackErrorCode(UNPACK_DATA_TRUNCATED);
-    else
+    unpackerFixed(nbits, 0, s_glinkPins, m_errormap.data());
+    if (!unpackerZeroFrom(totalBits))
+    {
+        setUnpackErrorCode(UNPACK_EXCESS_DATA);
+        return false;
+    }
+    return true;
+}
+
+// Fill field arrays from unpacked data words
+
+void PpmSubBlockV2::splitData()
+{
+    const int sliceL = slicesLut();
+    const int sliceF = slicesFadc();
+    const bool run2  = isRun2();
+    const int words  = (run2) ? 3 * sliceL + sliceF : sliceL + sliceF;
+    const int channels = channelsPerSubBlock();
+    m_arrays.reset(channels, sliceL, sliceF);
+    const int filled = std::min(channels, int(m_datamap.size()) / words);
+    const bool fadcToo = !(run2 && m_lutOnly);
+    const int fadcBit  = (run2) ? s_fadcBitV2 : s_fadcBit;
+    const int bcidBit  = (run2) ? s_bcidFadcBitV2 : s_bcidFadcBit;
+    for (int chan = 0; chan < filled; ++chan)
     {
-        while (unpackerSuccess())
+        const uint32_t* word = m_datamap.data() + chan * words;
+        for (int sl = 0; sl < sliceL; ++sl)
+        {
+            const int idx = m_arrays.index(chan, sl);
+            m_arrays.lutCp()[idx]     = (word[sl] >> s_lutBit) & s_lutMask;
+            m_arrays.bcidLutCp()[idx] = (word[sl] >> s_bcidLutBit) & s_bcidLutMask;
+        }
+        word += sliceL;
+        if (run2)
         {
-            if (unpacker(wordLen()))
+            for (int sl = 0; sl < sliceL; ++sl)
             {
-                setUnpackErrorCode(UNPACK_EXCESS_DATA);
-                rc = false;
-                break;
+                const int idx = m_arrays.index(chan, sl);
+                m_arrays.lutJep()[idx]    = (word[sl] >> s_lutBit) & s_lutMask;
+                m_arrays.satLutJep()[idx] = (word[sl] >> s_bcidLutBit) & s_bcidLutMask;
+            }
+            word += sliceL;
+        }
+        if (!fadcToo) continue;
+        for (int sl = 0; sl < sliceF; ++sl)
+        {
+            const int idx = m_arrays.index(chan, sl);
+            m_arrays.fadc()[idx]     = (word[sl] >> fadcBit) & s_fadcMask;
+            m_arrays.bcidFadc()[idx] = (word[sl] >> bcidBit) & s_bcidFadcMask;
+        }
+        word += sliceF;
+        if (run2)
+        {
+            for (int sl = 0; sl < sliceL; ++sl)
+            {
+                const int idx = m_arrays.index(chan, sl);
+                m_arrays.correction()[idx] = (word[sl] >> s_fadcBitV2) & s_fadcMask;
+                m_arrays.correctionEnabled()[idx] =
+                                   (word[sl] >> s_bcidFadcBitV2) & s_bcidFadcMask;
             }
         }
     }
-    return rc;
+}
+
+// Fill data words for packing from field arrays, Run 1 layout
+
+void PpmSubBlockV2::mergeData()
+{
+    const int sliceL   = slicesLut();
+    const int sliceF   = slicesFadc();
+    const int slices   = sliceL + sliceF;
+    const int channels = channelsPerSubBlock();
+    m_datamap.assign(slices * channels, 0);
+    if (m_arrays.empty()) return;
+    const int nchan = std::min(channels, m_arrays.channels());
+    const int nlut  = std::min(sliceL, m_arrays.slicesLut());
+    const int nfadc = std::min(sliceF, m_arrays.slicesFadc());
+    for (int chan = 0; chan < nchan; ++chan)
+    {
+        uint32_t* const word = m_datamap.data() + chan * slices;
+        for (int sl = 0; sl < nlut; ++sl)
+        {
+            const int idx = m_arrays.index(chan, sl);
+            word[sl] = (uint32_t(m_arrays.lutCp()[idx]) << s_lutBit) |
+                       (uint32_t(m_arrays.bcidLutCp()[idx]) << s_bcidLutBit);
+        }
+        for (int sl = 0; sl < nfadc; ++sl)
+        {
+            const int idx = m_arrays.index(chan, sl);
+            word[sliceL + sl] = (uint32_t(m_arrays.fadc()[idx]) << s_fadcBit) |
+                                (uint32_t(m_arrays.bcidFadc()[idx]) << s_bcidFadcBit);
+        }
+    }
 }
 
 // Return the number of channels per sub-block
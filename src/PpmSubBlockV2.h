@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "L1CaloSubBlock.h"
+#include "PpmDataArrays.h"
 
 namespace LVL1BS {
 
@@ -16,6 +17,45 @@ namespace LVL1BS {
 class PpmSubBlockV2 : public L1CaloSubBlock {
 
  public:
+   /// Read-only view of the unpacked data of one channel, strided
+   /// over the field arrays.
+   /// Valid until the sub-block is cleared or unpacked again.
+   class ChannelView {
+    public:
+      ChannelView(const PpmDataArrays& arrays, int chan, bool run2,
+                  bool lutOnly);
+
+      //  Number of slices of each type, zero if not present
+      int lutCpSlices()      const;
+      int lutJepSlices()     const;
+      int fadcSlices()       const;
+      int correctionSlices() const;
+
+      //  Field values for given slice
+      int lutCpAt(int slice)             const;
+      int bcidLutCpAt(int slice)         const;
+      int lutJepAt(int slice)            const;
+      int satLutJepAt(int slice)         const;
+      int fadcAt(int slice)              const;
+      int bcidFadcAt(int slice)          const;
+      int correctionAt(int slice)        const;
+      int correctionEnabledAt(int slice) const;
+
+      //  Extract all slices of a field pair into contiguous buffers
+      //  sized for the corresponding number of slices
+      void lutCp(uint_least8_t* lut, uint_least8_t* bcid) const;
+      void lutJep(uint_least8_t* lut, uint_least8_t* sat) const;
+      void fadc(uint_least16_t* fadc, uint_least8_t* bcid) const;
+      void correction(int_least16_t* correction,
+                      uint_least8_t* enabled) const;
+
+    private:
+      const PpmDataArrays* m_arrays;
+      int  m_chan;
+      bool m_run2;
+      bool m_lutOnly;
+   };
+
    PpmSubBlockV2();
    ~PpmSubBlockV2();
 
@@ -50,6 +90,11 @@ class PpmSubBlockV2 : public L1CaloSubBlock {
         std::vector<uint_least8_t>& correctionEnabled
     );
 
+   /// Return a view of the unpacked data for given channel
+   ChannelView channelView(int chan);
+   /// Return the field arrays, for operations over all channels
+   const PpmDataArrays& dataArrays() const;
+
    /// Store an error word corresponding to a data channel
    void fillPpmError(int chan, int errorWord);
    /// Store an error word corresponding to a G-Link pin
@@ -94,6 +139,8 @@ class PpmSubBlockV2 : public L1CaloSubBlock {
    void setFadcThreshold(int threshold);
    void setRunNumber(int run);
    void setRodVersion(uint32_t rodVersion);
+   /// Unpack LUT data only (Run 2), FADC and correction are skipped
+   void setLutOnly(bool lutOnly);
 
    //  Return triggered slice offsets, pedestal value
    int  lutOffset()               const;
@@ -103,6 +150,7 @@ class PpmSubBlockV2 : public L1CaloSubBlock {
    int  fadcThreshold()           const;
    int  runNumber()               const;
    uint16_t rodMinorVersion()     const;
+   bool lutOnly()                 const;
    bool isRun2() const;
 
    /// Pack data
@@ -191,6 +239,10 @@ class PpmSubBlockV2 : public L1CaloSubBlock {
    bool unpackUncompressedData();
    /// Unpack uncompressed error data
    bool unpackUncompressedErrors();
+   /// Fill field arrays from unpacked data words
+   void splitData();
+   /// Fill data words for packing from field arrays
+   void mergeData();
 
    //  Global error flags
    mutable uint32_t m_globalError;
@@ -204,35 +256,20 @@ class PpmSubBlockV2 : public L1CaloSubBlock {
    int m_fadcThreshold;
    int m_runNumber;
    uint32_t m_rodVersion;
+   bool m_lutOnly;
 
    /// Vector for compression statistics
    std::vector<uint32_t> m_compStats;
 
-   /// Vector for intermediate data
+   /// Data words as packed, channel by channel
    std::vector<uint32_t> m_datamap;
 
+   /// Data by field
+   PpmDataArrays m_arrays;
+
    /// Vector for intermediate error data
    std::vector<uint32_t> m_errormap;
 
-  /// Return unpacked data for given channel
- void ppmDataRun1(int chan,
-      std::vector<uint_least8_t>& lut,
-      std::vector<uint_least16_t>& fadc,
-      std::vector<uint_least8_t>& bcidLut,
-      std::vector<uint_least8_t>& bcidFadc
-  );
-
-  void ppmDataRun2(
-    const int chan, 
-    std::vector<uint_least8_t>& lutCp,
-    std::vector<uint_least8_t>& lutJep,
-    std::vector<uint_least16_t>& fadc,
-    std::vector<uint_least8_t>& bcidLutCp,
-    std::vector<uint_least8_t>& satLutJep,
-    std::vector<uint_least8_t>& bcidFadc,
-    std::vector<int_least16_t>& correction,
-    std::vector<uint_least8_t>& correctionEnabled
-   );
 };
 
 inline bool PpmSubBlockV2::glinkPinParity(const int chan) const
@@ -385,6 +422,16 @@ inline void PpmSubBlockV2::setRodVersion(const uint32_t rodVersion)
   m_rodVersion = rodVersion;
 }
 
+inline void PpmSubBlockV2::setLutOnly(const bool lutOnly)
+{
+  m_lutOnly = lutOnly;
+}
+
+inline bool PpmSubBlockV2::lutOnly() const
+{
+  return m_lutOnly;
+}
+
 inline uint16_t PpmSubBlockV2::rodMinorVersion() const
 {
   return m_rodVersion & 0xffff;
@@ -455,6 +502,78 @@ inline bool PpmSubBlockV2::errorBit(const int pin, const int bit) const
   return m_errormap[pin] & (0x1 << bit);
 }
 
+inline PpmSubBlockV2::ChannelView::ChannelView(const PpmDataArrays& arrays,
+                                      int chan, bool run2, bool lutOnly)
+  : m_arrays(&arrays), m_chan(chan), m_run2(run2),
+    m_lutOnly(run2 && lutOnly)
+{
+}
+
+inline int PpmSubBlockV2::ChannelView::lutCpSlices() const
+{
+  return m_arrays->slicesLut();
+}
+
+inline int PpmSubBlockV2::ChannelView::lutJepSlices() const
+{
+  return (m_run2) ? m_arrays->slicesLut() : 0;
+}
+
+inline int PpmSubBlockV2::ChannelView::fadcSlices() const
+{
+  return (m_lutOnly) ? 0 : m_arrays->slicesFadc();
+}
+
+inline int PpmSubBlockV2::ChannelView::correctionSlices() const
+{
+  return (m_run2 && !m_lutOnly) ? m_arrays->slicesLut() : 0;
+}
+
+inline int PpmSubBlockV2::ChannelView::lutCpAt(int slice) const
+{
+  return m_arrays->lutCp()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::bcidLutCpAt(int slice) const
+{
+  return m_arrays->bcidLutCp()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::lutJepAt(int slice) const
+{
+  return m_arrays->lutJep()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::satLutJepAt(int slice) const
+{
+  return m_arrays->satLutJep()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::fadcAt(int slice) const
+{
+  return m_arrays->fadc()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::bcidFadcAt(int slice) const
+{
+  return m_arrays->bcidFadc()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::correctionAt(int slice) const
+{
+  return m_arrays->correction()[m_arrays->index(m_chan, slice)];
+}
+
+inline int PpmSubBlockV2::ChannelView::correctionEnabledAt(int slice) const
+{
+  return m_arrays->correctionEnabled()[m_arrays->index(m_chan, slice)];
+}
+
+inline const PpmDataArrays& PpmSubBlockV2::dataArrays() const
+{
+  return m_arrays;
+}
+
 } // end namespace
 
 #endif
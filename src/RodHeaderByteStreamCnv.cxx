@@ -111,7 +111,7 @@ StatusCode RodHeaderByteStreamCnv::createObj( IOpaqueAddress* pAddr,
 
   // size check
   DataVector<LVL1::RODHeader>* const rhCollection =
-                                           new DataVector<LVL1::RODHeader>;
+                       new DataVector<LVL1::RODHeader>(SG::VIEW_ELEMENTS);
   if (m_debug) {
     m_log << MSG::DEBUG << " Number of ROB fragments is " << robFrags.size()
           << endreq;
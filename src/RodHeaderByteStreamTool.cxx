@@ -1,14 +1,18 @@
 
 #include <algorithm>
-#include <set>
+#include <utility>
 
+#include "GaudiKernel/IIncidentSvc.h"
 #include "GaudiKernel/IInterface.h"
+#include "GaudiKernel/Incident.h"
 #include "GaudiKernel/MsgStream.h"
 #include "GaudiKernel/StatusCode.h"
 
+#include "StoreGate/SegMemSvc.h"
 #include "TrigT1CaloEvent/RODHeader.h"
 
 #include "L1CaloErrorByteStreamTool.h"
+#include "L1CaloRobIdSet.h"
 #include "L1CaloSrcIdMap.h"
 #include "L1CaloSubBlock.h"
 
@@ -31,6 +35,7 @@ RodHeaderByteStreamTool::RodHeaderByteStreamTool(const std::string& type,
                                                  const std::string& name,
 	    			                 const IInterface*  parent)
   : AthAlgTool(type, name, parent),
+    m_sms("SegMemSvc/SegMemSvc", name),
     m_errorTool("LVL1BS::L1CaloErrorByteStreamTool/L1CaloErrorByteStreamTool"),
     m_srcIdMap(0)
 {
@@ -80,6 +85,21 @@ StatusCode RodHeaderByteStreamTool::initialize()
     return sc;
   } else msg(MSG::INFO) << "Retrieved tool " << m_errorTool << endreq;
 
+  sc = m_sms.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve service " << m_sms << endreq;
+    return sc;
+  } else msg(MSG::INFO) << "Retrieved service " << m_sms << endreq;
+
+  ServiceHandle<IIncidentSvc> incSvc("IncidentSvc", name());
+  sc = incSvc.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve service " << incSvc << endreq;
+    return sc;
+  }
+  incSvc->addListener(this, IncidentType::BeginEvent);
+  m_rhPool.setMemSvc(&*m_sms);
+
   m_srcIdMap = new L1CaloSrcIdMap();
   return StatusCode::SUCCESS;
 }
@@ -88,10 +108,23 @@ StatusCode RodHeaderByteStreamTool::initialize()
 
 StatusCode RodHeaderByteStreamTool::finalize()
 {
+  msg(MSG::INFO) << "Pool usage (peak objects/bytes): RODHeader "
+                 << m_rhPool.peak() << "/" << m_rhPool.bytes() << endreq;
+  m_rhPool.clear();
   delete m_srcIdMap;
   return StatusCode::SUCCESS;
 }
 
+// Start of event - previous event's collections have been cleared
+
+void RodHeaderByteStreamTool::handle(const Incident& inc)
+{
+  if (inc.type() == IncidentType::BeginEvent) {
+    m_rhPool.clear();
+    m_table.clear();
+  }
+}
+
 // Conversion bytestream to RODHeaders
 
 StatusCode RodHeaderByteStreamTool::convert(
@@ -104,7 +137,8 @@ StatusCode RodHeaderByteStreamTool::convert(
   // Loop over ROB fragments
 
   int robCount = 0;
-  std::set<uint32_t> dupCheck;
+  L1CaloRobIdSet dupCheck;
+  RodHeaderEntry scratch;
   ROBIterator rob    = robFrags.begin();
   ROBIterator robEnd = robFrags.end();
   for (; rob != robEnd; ++rob) {
@@ -114,66 +148,24 @@ StatusCode RodHeaderByteStreamTool::convert(
       msg() << "Treating ROB fragment " << robCount << endreq;
     }
 
-    // Skip fragments with ROB status errors
-
-    uint32_t robid = (*rob)->source_id();
-    if ((*rob)->nstatus() > 0) {
-      ROBPointer robData;
-      (*rob)->status(robData);
-      if (*robData != 0) {
-        m_errorTool->robError(robid, *robData);
-	if (debug) msg() << "ROB status error - skipping fragment" << endreq;
-	continue;
-      }
-    }
-
-    // Skip duplicate fragments
-
-    if (!dupCheck.insert(robid).second) {
-      m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
-      if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
-      continue;
-    }
-
-    // Unpack ROD header info
-
-    const uint32_t version  = (*rob)->rod_version();
-    const uint32_t sourceId = (*rob)->rod_source_id();
-    const uint32_t run      = (*rob)->rod_run_no();
-    const uint32_t lvl1Id   = (*rob)->rod_lvl1_id();
-    const uint32_t bcId     = (*rob)->rod_bc_id();
-    const uint32_t trigType = (*rob)->rod_lvl1_trigger_type();
-    const uint32_t detType  = (*rob)->rod_detev_type();
-    const uint32_t nData    = (*rob)->rod_ndata();
-
-    // Unpack status words
-
-    std::vector<uint32_t> statusWords;
-    unsigned int nstatus = (*rob)->rod_nstatus();
-    if (nstatus <= 2) {
-      RODPointer status;
-      RODPointer statusEnd;
-      (*rob)->rod_status(status);
-      statusEnd = status + nstatus;
-      for (; status != statusEnd; ++status) statusWords.push_back(*status);
-    } else { // Likely corruption
-      m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_ROD_NSTATUS);
-      continue;
-    }
+    const RodHeaderEntry* const rh = decodeRob(rob, dupCheck, scratch, debug);
+    if (!rh) continue;
 
     // Save
 
-    rhCollection->push_back(new LVL1::RODHeader(version, sourceId, run, lvl1Id,
-                                bcId, trigType, detType, statusWords, nData));
+    m_statusWords.assign(rh->status, rh->status + rh->nStatus);
+    rhCollection->push_back(m_rhPool.create(rhCollection, rh->version,
+                                rh->sourceId, rh->run, rh->lvl1Id, rh->bcId,
+                                rh->trigType, rh->detType, m_statusWords,
+                                rh->nData));
     if (debug) {
       msg() << MSG::hex
             << "ROD Header version/sourceId/run/lvl1Id/bcId/trigType/detType/nData: "
-	    << version << "/" << sourceId << "/" << run << "/" << lvl1Id << "/"
-	    << bcId << "/" << trigType << "/" << detType << "/" << nData
+	    << rh->version << "/" << rh->sourceId << "/" << rh->run << "/"
+	    << rh->lvl1Id << "/" << rh->bcId << "/" << rh->trigType << "/"
+	    << rh->detType << "/" << rh->nData
 	    << endreq << "ROD Status Words:";
-      std::vector<uint32_t>::const_iterator pos  = statusWords.begin();
-      std::vector<uint32_t>::const_iterator pose = statusWords.end();
-      for (; pos != pose; ++pos) msg() << " " << *pos;
+      for (uint32_t i = 0; i < rh->nStatus; ++i) msg() << " " << rh->status[i];
       msg() << MSG::dec << endreq;
     }
   }
@@ -181,10 +173,101 @@ StatusCode RodHeaderByteStreamTool::convert(
   return StatusCode::SUCCESS;
 }
 
+// Decode ROD headers into the table only
+
+StatusCode RodHeaderByteStreamTool::decode(
+                            const IROBDataProviderSvc::VROBFRAG& robFrags)
+{
+  const bool debug = msgLvl(MSG::DEBUG);
+  if (debug) msg(MSG::DEBUG);
+  L1CaloRobIdSet dupCheck;
+  RodHeaderEntry scratch;
+  ROBIterator rob    = robFrags.begin();
+  ROBIterator robEnd = robFrags.end();
+  for (; rob != robEnd; ++rob) decodeRob(rob, dupCheck, scratch, debug);
+  return StatusCode::SUCCESS;
+}
+
+// Check and decode one ROB fragment
+
+const RodHeaderByteStreamTool::RodHeaderEntry*
+RodHeaderByteStreamTool::decodeRob(const ROBIterator rob,
+                                   L1CaloRobIdSet& dupCheck,
+                                   RodHeaderEntry& scratch, const bool debug)
+{
+  // Skip fragments with ROB status errors
+
+  const uint32_t robid = (*rob)->source_id();
+  if ((*rob)->nstatus() > 0) {
+    ROBPointer robData;
+    (*rob)->status(robData);
+    if (*robData != 0) {
+      m_errorTool->robError(robid, *robData);
+      if (debug) msg() << "ROB status error - skipping fragment" << endreq;
+      return 0;
+    }
+  }
+
+  // Skip duplicate fragments
+
+  if (!dupCheck.insert(robid)) {
+    m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
+    if (debug) msg() << "Skipping duplicate ROB fragment" << endreq;
+    return 0;
+  }
+
+  // Already decoded for another collection this event
+
+  const RodHeaderEntry* const found = m_table.find(robid, *rob);
+  if (found) return found;
+
+  // Check status words, more than two is likely corruption
+
+  const unsigned int nstatus = (*rob)->rod_nstatus();
+  if (nstatus > unsigned(L1CaloRodHeaderTable::s_maxStatus)) {
+    m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_ROD_NSTATUS);
+    return 0;
+  }
+
+  // Unpack ROD header info
+
+  RodHeaderEntry* rh = m_table.add(robid, *rob);
+  if (!rh) {
+    rh = &scratch;
+    rh->robId = robid;
+  }
+  rh->version  = (*rob)->rod_version();
+  rh->sourceId = (*rob)->rod_source_id();
+  rh->run      = (*rob)->rod_run_no();
+  rh->lvl1Id   = (*rob)->rod_lvl1_id();
+  rh->bcId     = (*rob)->rod_bc_id();
+  rh->trigType = (*rob)->rod_lvl1_trigger_type();
+  rh->detType  = (*rob)->rod_detev_type();
+  rh->nData    = (*rob)->rod_ndata();
+  rh->nStatus  = nstatus;
+  RODPointer status;
+  (*rob)->rod_status(status);
+  for (unsigned int i = 0; i < nstatus; ++i) rh->status[i] = status[i];
+  return rh;
+}
+
 // Return reference to vector with all possible Source Identifiers
 
 const std::vector<uint32_t>& RodHeaderByteStreamTool::sourceIDs(
                                                       const std::string& sgKey)
+{
+  std::map<std::string, const std::vector<uint32_t>*>::const_iterator iter =
+                                                   m_keySourceIDs.find(sgKey);
+  if (iter != m_keySourceIDs.end()) return *iter->second;
+  const std::vector<uint32_t>& ids(findSourceIDs(sgKey));
+  m_keySourceIDs.insert(std::make_pair(sgKey, &ids));
+  return ids;
+}
+
+// Work out Source Identifiers for given StoreGate key
+
+const std::vector<uint32_t>& RodHeaderByteStreamTool::findSourceIDs(
+                                                      const std::string& sgKey)
 {
   const bool pp      = isAppended(sgKey, "PP");
   const bool cp      = isAppended(sgKey, "CP");
@@ -3,10 +3,13 @@
 
 #include <stdint.h>
 
+#include <map>
 #include <string>
 #include <vector>
 
 #include "eformat/SourceIdentifier.h"
+#include "GaudiKernel/IIncidentListener.h"
+#include "GaudiKernel/ServiceHandle.h"
 #include "GaudiKernel/ToolHandle.h"
 
 #include "AthenaBaseComps/AthAlgTool.h"
@@ -14,8 +17,13 @@
 #include "ByteStreamData/RawEvent.h"
 #include "DataModel/DataVector.h"
 
+#include "L1CaloObjectPool.h"
+#include "L1CaloRodHeaderTable.h"
+
 class IInterface;
+class Incident;
 class InterfaceID;
+class SegMemSvc;
 class StatusCode;
 
 namespace LVL1 {
@@ -25,6 +33,7 @@ namespace LVL1 {
 namespace LVL1BS {
 
 class L1CaloErrorByteStreamTool;
+class L1CaloRobIdSet;
 class L1CaloSrcIdMap;
 
 /** Tool to perform ROB fragments to ROD Header conversions.
@@ -34,7 +43,8 @@ class L1CaloSrcIdMap;
  *  @author Peter Faulkner
  */
 
-class RodHeaderByteStreamTool : public AthAlgTool {
+class RodHeaderByteStreamTool : public AthAlgTool,
+                                virtual public IIncidentListener {
 
  public:
    RodHeaderByteStreamTool(const std::string& type, const std::string& name,
@@ -47,10 +57,18 @@ class RodHeaderByteStreamTool : public AthAlgTool {
    virtual StatusCode initialize();
    virtual StatusCode finalize();
 
+   /// Recycle the RODHeader pool and table at the start of each event
+   virtual void handle(const Incident& inc);
+
    /// Convert ROB fragments to RODHeaders
    StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
                       DataVector<LVL1::RODHeader>* rhCollection);
 
+   /// Decode ROD headers of ROB fragments into the table only
+   StatusCode decode(const IROBDataProviderSvc::VROBFRAG& robFrags);
+   /// ROD headers decoded so far this event
+   const L1CaloRodHeaderTable& table() const { return m_table; }
+
    /// Return reference to vector with all possible Source Identifiers
    const std::vector<uint32_t>& sourceIDs(const std::string& sgKey);
 
@@ -60,6 +78,14 @@ class RodHeaderByteStreamTool : public AthAlgTool {
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      ROBPointer;
    typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      RODPointer;
 
+   typedef L1CaloRodHeaderTable::Entry                   RodHeaderEntry;
+
+   /// Check and decode one ROB, 0 if skipped.
+   /// Non-L1Calo ROBs are decoded into scratch.
+   const RodHeaderEntry* decodeRob(ROBIterator rob, L1CaloRobIdSet& dupCheck,
+                                   RodHeaderEntry& scratch, bool debug);
+   /// Work out Source Identifiers for given StoreGate key
+   const std::vector<uint32_t>& findSourceIDs(const std::string& sgKey);
    /// Fill vector with ROB IDs for given sub-detector
    void fillRobIds(bool all, int numCrates, int crateOffset,
                    const std::vector<int>& slinks, int daqOrRoi,
@@ -69,6 +95,8 @@ class RodHeaderByteStreamTool : public AthAlgTool {
    /// Return true if StoreGate key ends in given string
    bool isAppended(const std::string& sgKey, const std::string& flag) const;
 
+   /// Memory service for the RODHeader pool
+   ServiceHandle<SegMemSvc> m_sms;
    /// Error collection tool
    ToolHandle<LVL1BS::L1CaloErrorByteStreamTool> m_errorTool;
 
@@ -83,6 +111,14 @@ class RodHeaderByteStreamTool : public AthAlgTool {
    std::vector<uint32_t> m_sourceIDsJEPRoIB;
    /// Source ID converter
    L1CaloSrcIdMap* m_srcIdMap;
+   /// RODHeader pool, shared by all the RODHeader collections of an event
+   L1CaloObjectPool<LVL1::RODHeader> m_rhPool;
+   /// ROD headers of the current event, shared by all collections
+   L1CaloRodHeaderTable m_table;
+   /// Status words for the RODHeader constructor, reused
+   std::vector<uint32_t> m_statusWords;
+   /// Source Identifiers of each StoreGate key already seen
+   std::map<std::string, const std::vector<uint32_t>*> m_keySourceIDs;
 
 };
 
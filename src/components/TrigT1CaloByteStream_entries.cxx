@@ -58,12 +58,27 @@
 // ============================================================================
 #include "xAODTrigL1Calo/TriggerTower.h"
 #include "xAODTrigL1Calo/TriggerTowerContainer.h"
-#include "xAODTrigL1Calo/CPMTower.h"
 #include "xAODTrigL1Calo/CPMTowerContainer.h"
 #include "xAODTrigL1Calo/CPMTowerAuxContainer.h"
+#include "xAODTrigL1Calo/CMXCPTobContainer.h"
+#include "xAODTrigL1Calo/CMXCPTobAuxContainer.h"
+#include "xAODTrigL1Calo/CMXCPHitsContainer.h"
+#include "xAODTrigL1Calo/CMXCPHitsAuxContainer.h"
+#include "xAODTrigL1Calo/JetElementContainer.h"
+#include "xAODTrigL1Calo/JetElementAuxContainer.h"
+#include "xAODTrigL1Calo/JEMEtSumsContainer.h"
+#include "xAODTrigL1Calo/JEMEtSumsAuxContainer.h"
+#include "xAODTrigL1Calo/CMXJetTobContainer.h"
+#include "xAODTrigL1Calo/CMXJetTobAuxContainer.h"
+#include "xAODTrigL1Calo/CMXJetHitsContainer.h"
+#include "xAODTrigL1Calo/CMXJetHitsAuxContainer.h"
+#include "xAODTrigL1Calo/CMXEtSumsContainer.h"
+#include "xAODTrigL1Calo/CMXEtSumsAuxContainer.h"
 
 #include "../xaod/PpmByteStreamAuxCnv.h"
 #include "../xaod/PpmByteStreamxAODCnv.h"
+#include "../xaod/L1CaloByteStreamAuxCnv.h"
+#include "../xaod/L1CaloByteStreamxAODCnv.h"
 
 #include "../xaod/L1CaloByteStreamReadTool.h"
 // ============================================================================
@@ -90,6 +105,7 @@
 #include "../TriggerTowerSelectionTool.h"
 #include "../TrigT1CaloDataAccess.h"
 #include "../TrigT1CaloDataAccessV2.h"
+#include "../L1CaloDecodeAlg.h"
 
 
 namespace LVL1BS {
@@ -137,8 +153,39 @@ typedef JepReadByteStreamV1V2Cnv<JetElementCollection> JepReadJEByteStreamV1V2Cn
 typedef JepReadByteStreamV1V2Cnv<JEMEtSumsCollection>  JepReadESByteStreamV1V2CnvT;
 
 
-// typedef L1CaloByteStreamAuxCnv<xAOD::CPMTowerContainer, xAOD::CPMTowerAuxContainer>  L1CaloByteStreamxAODCPMTowerCnvT;
-// typedef L1CaloByteStreamAuxCnv<xAOD::TriggerTowerContainer, xAOD::TriggerTowerAuxContainer> L1CaloByteStreamxAODTriggerTowerCnvT;
+// xAOD CP and JEP
+typedef L1CaloByteStreamxAODCnv<xAOD::CPMTowerContainer, xAOD::CPMTowerAuxContainer>
+  CPMTowerxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::CPMTowerContainer, xAOD::CPMTowerAuxContainer>
+  CPMTowerAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::CMXCPTobContainer, xAOD::CMXCPTobAuxContainer>
+  CMXCPTobxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::CMXCPTobContainer, xAOD::CMXCPTobAuxContainer>
+  CMXCPTobAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::CMXCPHitsContainer, xAOD::CMXCPHitsAuxContainer>
+  CMXCPHitsxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::CMXCPHitsContainer, xAOD::CMXCPHitsAuxContainer>
+  CMXCPHitsAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::JetElementContainer, xAOD::JetElementAuxContainer>
+  JetElementxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::JetElementContainer, xAOD::JetElementAuxContainer>
+  JetElementAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::JEMEtSumsContainer, xAOD::JEMEtSumsAuxContainer>
+  JEMEtSumsxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::JEMEtSumsContainer, xAOD::JEMEtSumsAuxContainer>
+  JEMEtSumsAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::CMXJetTobContainer, xAOD::CMXJetTobAuxContainer>
+  CMXJetTobxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::CMXJetTobContainer, xAOD::CMXJetTobAuxContainer>
+  CMXJetTobAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::CMXJetHitsContainer, xAOD::CMXJetHitsAuxContainer>
+  CMXJetHitsxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::CMXJetHitsContainer, xAOD::CMXJetHitsAuxContainer>
+  CMXJetHitsAuxCnvT;
+typedef L1CaloByteStreamxAODCnv<xAOD::CMXEtSumsContainer, xAOD::CMXEtSumsAuxContainer>
+  CMXEtSumsxAODCnvT;
+typedef L1CaloByteStreamAuxCnv<xAOD::CMXEtSumsContainer, xAOD::CMXEtSumsAuxContainer>
+  CMXEtSumsAuxCnvT;
 
 }
 
@@ -182,6 +229,23 @@ DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, L1CaloByteStreamReadTool )
 DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, PpmByteStreamV1Cnv )
 DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, PpmByteStreamxAODCnv)
 DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, PpmByteStreamAuxCnv)
+// xAOD CP and JEP
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CPMTowerxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CPMTowerAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXCPTobxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXCPTobAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXCPHitsxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXCPHitsAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, JetElementxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, JetElementAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, JEMEtSumsxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, JEMEtSumsAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXJetTobxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXJetTobAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXJetHitsxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXJetHitsAuxCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXEtSumsxAODCnvT )
+DECLARE_NAMESPACE_CONVERTER_FACTORY( LVL1BS, CMXEtSumsAuxCnvT )
 // ============================================================================
 // Post-LS1
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, CpByteStreamV2Tool )
@@ -202,6 +266,7 @@ DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, L1CaloErrorByteStreamTool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, TriggerTowerSelectionTool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, TrigT1CaloDataAccess )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, TrigT1CaloDataAccessV2 )
+DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, L1CaloDecodeAlg )
 
 DECLARE_FACTORY_ENTRIES( TrigT1CaloByteStream )
 {
@@ -239,6 +304,23 @@ DECLARE_FACTORY_ENTRIES( TrigT1CaloByteStream )
   // V2 is named xAOD
   DECLARE_NAMESPACE_CONVERTER( LVL1BS, PpmByteStreamxAODCnv )
   DECLARE_NAMESPACE_CONVERTER( LVL1BS, PpmByteStreamAuxCnv)
+  // xAOD CP and JEP
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CPMTowerxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CPMTowerAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXCPTobxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXCPTobAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXCPHitsxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXCPHitsAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, JetElementxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, JetElementAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, JEMEtSumsxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, JEMEtSumsAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXJetTobxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXJetTobAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXJetHitsxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXJetHitsAuxCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXEtSumsxAODCnvT )
+  DECLARE_NAMESPACE_CONVERTER( LVL1BS, CMXEtSumsAuxCnvT )
   DECLARE_NAMESPACE_TOOL(LVL1BS, L1CaloByteStreamReadTool)
   // ==========================================================================
   DECLARE_NAMESPACE_CONVERTER( LVL1BS, RodHeaderByteStreamCnv )
@@ -262,5 +344,6 @@ DECLARE_FACTORY_ENTRIES( TrigT1CaloByteStream )
   DECLARE_NAMESPACE_TOOL( LVL1BS, TriggerTowerSelectionTool )
   DECLARE_NAMESPACE_TOOL( LVL1BS, TrigT1CaloDataAccess )
   DECLARE_NAMESPACE_TOOL( LVL1BS, TrigT1CaloDataAccessV2 )
+  DECLARE_NAMESPACE_ALGORITHM( LVL1BS, L1CaloDecodeAlg )
 }
 
@@ -1,5 +1,5 @@
-#ifndef TRIGT1CALOBYTESTREAM_L1CALOBYTESTREAMXAODCNV_H
-#define TRIGT1CALOBYTESTREAM_L1CALOBYTESTREAMXAODCNV_H
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOBYTESTREAMAUXCNV_H
+#define TRIGT1CALOBYTESTREAM_L1CALOBYTESTREAMAUXCNV_H
 
 #include <string>
 
@@ -27,7 +27,10 @@ extern long ByteStream_StorageType;
 namespace LVL1BS {
 class L1CaloByteStreamReadTool;
 
-/** ByteStream converter for Pre-processor Module DAQ data / TriggerTowers.
+/** ByteStream converter for the aux store of L1Calo xAOD containers.
+ *
+ *  The interface container decoded along with it is handed on to
+ *  L1CaloByteStreamxAODCnv.
  *
  *  @author alexander.mazurov@cern.ch
  */
@@ -46,9 +49,9 @@ public:
   virtual ~L1CaloByteStreamAuxCnv(){};
 
   virtual StatusCode initialize();
-  /// Create TriggerTowers from ByteStream
+  /// Create aux store from ByteStream
   virtual StatusCode createObj(IOpaqueAddress* pAddr, DataObject*& pObj);
-  /// Create ByteStream from TriggerTowers
+  /// Create ByteStream from aux store
   virtual StatusCode createRep(DataObject* pObj, IOpaqueAddress*& pAddr);
 
   //  Storage type and class ID
@@ -62,7 +65,7 @@ private:
   /// Converter name
   std::string m_name;
 
-  /// Do the main job - retrieve xAOD TriggerTowers from robs
+  /// Do the main job - retrieve xAOD objects from robs
   ToolHandle<L1CaloByteStreamReadTool> m_readTool;
 };
 
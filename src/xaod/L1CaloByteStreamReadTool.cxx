@@ -3,19 +3,41 @@
 // ===========================================================================
 // STD:
 // ===========================================================================
+#include <algorithm>
+#include <cstdlib>
+#include <set>
 #include <stdexcept>
 // ===========================================================================
 #include "eformat/SourceIdentifier.h"
+#include "GaudiKernel/IIncidentSvc.h"
+#include "GaudiKernel/Incident.h"
 #include "TrigT1Interfaces/TrigT1CaloDefs.h"
+#include "TrigT1CaloEvent/CMXEtSums.h"
+#include "TrigT1CaloEvent/CMXJetHits.h"
+#include "TrigT1CaloUtils/DataError.h"
+#include "TrigT1CaloUtils/JetElementKey.h"
 
 #include "CaloUserHeader.h"
 #include "SubBlockHeader.h"
 #include "SubBlockStatus.h"
 #include "WordDecoder.h"
-#include "CpmWord.h"
+#include "../CmxCpSubBlock.h"
+#include "../CmxEnergySubBlock.h"
+#include "../CmxJetSubBlock.h"
+#include "../CmxSubBlock.h"
+#include "../CpmSubBlockV2.h"
+#include "../JemJetElement.h"
+#include "../JemSubBlockV2.h"
+#include "../JepByteStreamV2Tool.h"
+#include "../L1CaloRobIdSet.h"
+#include "../L1CaloRodValidator.h"
 #include "../L1CaloSrcIdMap.h"
+#include "../L1CaloSubBlock.h"
+#include "../L1CaloUserHeader.h"
+#include "../ModifySlices.h"
 
 #include "L1CaloByteStreamReadTool.h"
+#include "L1CaloPpmVisitor.h"
 // ===========================================================================
 
 namespace {
@@ -28,6 +50,122 @@ uint32_t coolId(uint8_t crate, uint8_t module, uint8_t channel) {
   const uint8_t asic = channel / 16;
   return (crate << 24) | (1 << 20) | (module << 16) | (pin << 8) | asic;
 } 
+
+// Field of a PPM compressed block, packed 31 bits per word.
+// Callers check the field ends within maxBit; only a field running
+// into the next word is checked again here.
+uint32_t ppmField(const uint32_t* data, uint32_t maxBit, uint32_t bit,
+    uint8_t numBits) {
+  const uint32_t iWord = bit / 31;
+  const uint8_t iBit = bit % 31;
+  if ((iBit + numBits) <= 31) {
+    return bitFieldSize(data[iWord], iBit, numBits);
+  }
+  if (31 * (iWord + 1) >= maxBit) {
+    throw std::out_of_range("Ppm field runs past end of block");
+  }
+  const uint8_t nb1 = 31 - iBit;
+  const uint8_t nb2 = numBits - nb1;
+  const uint32_t field1 = bitFieldSize(data[iWord], iBit, nb1);
+  const uint32_t field2 = bitFieldSize(data[iWord + 1], 0, nb2);
+  return field1 | (field2 << nb1);
+}
+
+// Run-2 compressed channel header: what one value of the leading
+// header field means for a given number of ADC slices
+struct PpmR4Header {
+  int8_t encoding;    // -1 if given by a following selector field
+  int8_t minIndex;
+  uint8_t selectBase; // encoding for selector value 0
+  bool selectEscape;  // selector value 3 means 3 + a further two bits
+};
+
+struct PpmR4HeaderTable {
+  uint8_t headerBits; // 0 if the number of ADC slices is unsupported
+  PpmR4Header entries[16];
+};
+
+const uint8_t s_ppmR4MaxAdc = 15;
+
+// Header tables for 0-14 ADC slices, filled once at library load
+class PpmR4HeaderTables {
+ public:
+  PpmR4HeaderTables();
+  const PpmR4HeaderTable& operator[](uint8_t numAdc) const {
+    return m_tables[std::min(numAdc, s_ppmR4MaxAdc)];
+  }
+ private:
+  PpmR4HeaderTable m_tables[s_ppmR4MaxAdc + 1];
+};
+
+PpmR4HeaderTables::PpmR4HeaderTables() {
+  for (uint8_t numAdc = 0; numAdc < s_ppmR4MaxAdc; ++numAdc) {
+    PpmR4HeaderTable& table = m_tables[numAdc];
+    if (numAdc == 5) {
+      // Minimum index and encodings 0-1 in one field, 2-5 selected, 6 alone
+      table.headerBits = 4;
+      for (uint8_t value = 0; value < 16; ++value) {
+        PpmR4Header& entry = table.entries[value];
+        entry.minIndex = value % 5;
+        entry.encoding = value < 10? value / 5: (value < 15? -1: 6);
+        entry.selectBase = 2;
+        entry.selectEscape = false;
+      }
+    } else {
+      // Minimum index alone, all ones for encoding 6, else selector
+      table.headerBits = numAdc == 3? 2: (numAdc == 7? 3: 4);
+      const uint8_t fieldSize = 1 << table.headerBits;
+      for (uint8_t value = 0; value < fieldSize; ++value) {
+        PpmR4Header& entry = table.entries[value];
+        const bool allOnes = value == fieldSize - 1;
+        entry.minIndex = allOnes? 0: value;
+        entry.encoding = allOnes? 6: -1;
+        entry.selectBase = 0;
+        entry.selectEscape = true;
+      }
+    }
+  }
+  m_tables[s_ppmR4MaxAdc].headerBits = 0;
+}
+
+const PpmR4HeaderTables s_ppmR4Headers;
+
+// Run-2 compressed field widths for each encoding
+struct PpmR4Encoding {
+  uint8_t minBits;   // minimum (or constant value) short field
+  uint8_t diffBits;  // other samples, if no long field flags
+  uint8_t longBits;  // long fields, 0 if the encoding has no flags
+  uint8_t corrBits;  // pedestal correction
+  uint8_t enabledBits;
+  bool constant;     // one value for all samples
+};
+
+const PpmR4Encoding s_ppmR4Encodings[] = {
+  {5, 2, 0, 6, 0, false},
+  {5, 3, 0, 6, 0, false},
+  {5, 4, 0, 6, 0, false},
+  {5, 0, 6, 10, 1, false},
+  {5, 0, 8, 10, 1, false},
+  {5, 0, 10, 10, 1, false},
+  {6, 0, 0, 6, 0, true}
+};
+
+const PpmR4Encoding& ppmR4Encoding(uint8_t encoding) {
+  if (encoding > 6) {
+    throw std::out_of_range("Unknown ppm compression encoding");
+  }
+  return s_ppmR4Encodings[encoding];
+}
+
+// Keep only slices [first, first + num) of a full readout vector
+template <typename T>
+std::vector<T> windowSlices(const std::vector<T>& vec, uint8_t numSlices,
+    int first, int num) {
+  if (vec.size() != numSlices || (first == 0 && num == numSlices)) {
+    return vec;
+  }
+  return std::vector<T>(vec.begin() + first, vec.begin() + first + num);
+}
 }
 // ===========================================================================
 namespace LVL1BS {
@@ -39,12 +177,40 @@ L1CaloByteStreamReadTool::L1CaloByteStreamReadTool(const std::string& name =
     m_errorTool("LVL1BS::L1CaloErrorByteStreamTool/L1CaloErrorByteStreamTool"),
     m_ppmMaps("LVL1::PpmMappingTool/PpmMappingTool"),
     m_cpmMaps("LVL1::CpmMappingTool/CpmMappingTool"),
-    m_robDataProvider("ROBDataProviderSvc", name) {
+    m_jemMaps("LVL1::JemMappingTool/JemMappingTool"),
+    m_robDataProvider("ROBDataProviderSvc", name),
+    m_cpmSubBlock(0), m_cmxCpSubBlock(0), m_jemSubBlock(0),
+    m_cmxJetSubBlock(0), m_cmxEnergySubBlock(0), m_elementKey(0),
+    m_cpJepCrateOffsetHw(0), m_rodErr(0) {
   declareInterface<L1CaloByteStreamReadTool>(this);
   declareProperty("PpmMappingTool", m_ppmMaps,
       "Crate/Module/Channel to Eta/Phi/Layer mapping tool");
   declareProperty("ROBDataProviderSvc", m_robDataProvider,
         "Get ROB source IDs service");
+  declareProperty("ZeroSuppress", m_zeroSuppress = false,
+      "Only make trigger towers with non-zero LUT or ADC outside pedestal band"
+      " (no suppression where ADC is not decoded, LutOnly or LazyFadc)");
+  declareProperty("ZeroSuppressPedestal", m_zeroSuppressPedestal = 32,
+      "ADC pedestal for zero suppression");
+  declareProperty("ZeroSuppressBand", m_zeroSuppressBand = 3,
+      "Maximum ADC deviation from pedestal of suppressed towers");
+  declareProperty("PedestalValue", m_pedestal = 10,
+      "Pedestal value - needed for Run-1 compression versions 1.00, 1.01");
+  declareProperty("ChannelPresence", m_fillChannelPresence = false,
+      "Fill bitmap of PPM channels present in bytestream");
+  declareProperty("SliceWindow", m_sliceWindow = -1,
+      "If >=0, only read slices within this distance of triggered slice");
+  declareProperty("LutOnly", m_lutOnly = false,
+      "Decode LUT data only, FADC and pedestal correction are skipped");
+  declareProperty("LazyFadc", m_lazyFadc = false,
+      "Decode FADC and pedestal correction only when decodeFadc is called");
+  declareProperty("ValidateRods", m_validateRods = true,
+      "Reject CP and JEP RODs with bad sub-block structure before unpacking");
+  m_pendingFadc.data = nullptr;
+  m_currentFadcRecords = nullptr;
+  m_ppmVisitor = nullptr;
+  m_ppPayload = nullptr;
+  m_ppData = nullptr;
 }
 
 // ===========================================================================
@@ -62,7 +228,19 @@ StatusCode L1CaloByteStreamReadTool::initialize() {
   CHECK(m_errorTool.retrieve());
   CHECK(m_ppmMaps.retrieve());
   CHECK(m_cpmMaps.retrieve());
+  CHECK(m_jemMaps.retrieve());
   CHECK(m_robDataProvider.retrieve());
+
+  ServiceHandle<IIncidentSvc> incSvc("IncidentSvc", name());
+  CHECK(incSvc.retrieve());
+  incSvc->addListener(this, IncidentType::BeginEvent);
+
+  m_cpmSubBlock = new CpmSubBlockV2();
+  m_cmxCpSubBlock = new CmxCpSubBlock();
+  m_jemSubBlock = new JemSubBlockV2();
+  m_cmxJetSubBlock = new CmxJetSubBlock();
+  m_cmxEnergySubBlock = new CmxEnergySubBlock();
+  m_elementKey = new LVL1::JetElementKey();
   return StatusCode::SUCCESS;
 }
 // ===========================================================================
@@ -70,10 +248,24 @@ StatusCode L1CaloByteStreamReadTool::initialize() {
 
 StatusCode L1CaloByteStreamReadTool::finalize() {
   delete m_srcIdMap;
+  delete m_cpmSubBlock;
+  delete m_cmxCpSubBlock;
+  delete m_jemSubBlock;
+  delete m_cmxJetSubBlock;
+  delete m_cmxEnergySubBlock;
+  delete m_elementKey;
 
   return StatusCode::SUCCESS;
 }
 
+// Start of event - towers of the previous event are gone
+
+void L1CaloByteStreamReadTool::handle(const Incident& inc) {
+  if (inc.type() == IncidentType::BeginEvent) {
+    m_fadcRecords.clear();
+  }
+}
+
 // Conversion bytestream to trigger towers
 StatusCode L1CaloByteStreamReadTool::convert(
     const IROBDataProviderSvc::VROBFRAG& robFrags,
@@ -81,6 +273,20 @@ StatusCode L1CaloByteStreamReadTool::convert(
 
   m_triggerTowers = ttCollection;
   m_coolIds.clear();
+  // Other containers of this event keep their records
+  m_currentFadcRecords = m_lazyFadc? &m_fadcRecords[ttCollection]: nullptr;
+  if (m_fillChannelPresence) {
+    m_ppmChannelPresence.assign((8 << 10) / 32, 0);
+  }
+  processPpmRobs_(robFrags);
+  m_triggerTowers = nullptr;
+  m_currentFadcRecords = nullptr;
+  return StatusCode::SUCCESS;
+}
+
+// Unpack PPM ROB fragments, shared by towers and visitors
+void L1CaloByteStreamReadTool::processPpmRobs_(
+    const IROBDataProviderSvc::VROBFRAG& robFrags) {
   m_subDetectorID = eformat::TDAQ_CALO_PREPROC;
   m_requestedType = RequestType::PPM;
 
@@ -94,11 +300,31 @@ StatusCode L1CaloByteStreamReadTool::convert(
 
     }
   }
-  m_triggerTowers = nullptr;
+}
+
+// Unpack bytestream to a PPM visitor
+StatusCode L1CaloByteStreamReadTool::visitPpm(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    L1CaloPpmVisitor* visitor) {
+  const int sliceWindow = m_sliceWindow;
+  const bool lutOnly = m_lutOnly;
+  const bool lazyFadc = m_lazyFadc;
+  m_sliceWindow = -1;
+  m_lutOnly = false;
+  m_lazyFadc = false;
+  m_ppmVisitor = visitor;
+
+  // FADC records of towers decoded with LazyFadc are left alone
+  processPpmRobs_(robFrags);
+
+  m_ppmVisitor = nullptr;
+  m_sliceWindow = sliceWindow;
+  m_lutOnly = lutOnly;
+  m_lazyFadc = lazyFadc;
   return StatusCode::SUCCESS;
 }
 
-// Conversion bytestream to trigger towers
+// Conversion bytestream to CPM towers
 StatusCode L1CaloByteStreamReadTool::convert(
     const IROBDataProviderSvc::VROBFRAG& robFrags,
     xAOD::CPMTowerContainer* const cpmCollection) {
@@ -106,22 +332,9 @@ StatusCode L1CaloByteStreamReadTool::convert(
   ATH_MSG_DEBUG("Number of Calo Cluster Processor fragments: " << robFrags.size());
 
   m_cpmTowers = cpmCollection;
-  m_subDetectorID = eformat::TDAQ_CALO_CLUSTER_PROC_DAQ;
-  m_requestedType = RequestType::CPM;
-
-  ROBIterator rob = robFrags.begin();
-  ROBIterator robEnd = robFrags.end();
-
-  int robCounter = 1;
-  for (; rob != robEnd; ++rob, ++robCounter) {
-
-    StatusCode sc = processRobFragment_(rob, RequestType::CPM);
-    if (!sc.isSuccess()) {
-
-    }
-  }
+  StatusCode sc = convertCpJep_(robFrags, RequestType::CPM);
   m_cpmTowers = nullptr;
-  return StatusCode::SUCCESS;
+  return sc;
 }
 
 StatusCode L1CaloByteStreamReadTool::convert(
@@ -262,11 +475,9 @@ StatusCode L1CaloByteStreamReadTool::processRobFragment_(
     } else {
       switch(m_subDetectorID){
       case eformat::TDAQ_CALO_PREPROC:
+          if (indata == 0) m_ppPayload = payload;
           CHECK(processPpmWord_(*payload, indata));
           break;
-      case eformat::TDAQ_CALO_CLUSTER_PROC_DAQ:
-          CHECK(processCpWord_(*payload));
-          break;
       default:
         break;
       }
@@ -287,44 +498,17 @@ StatusCode L1CaloByteStreamReadTool::processPpmWord_(uint32_t word,
     return processPpmStandardR3V1_(word, indata);
   } else {
     ATH_MSG_ERROR("Unsupported PPM version:format (" 
-      << m_verCode << ":" << format 
+      << m_verCode << ":" << int(m_subBlockHeader.format())
       <<") combination");
     return StatusCode::FAILURE;
   }
   return StatusCode::SUCCESS;
 }
 
-StatusCode L1CaloByteStreamReadTool::processCpWord_(uint32_t word) {
-  if ((m_requestedType == RequestType::CPM) && CpmWord::isValid(word)) {
-    switch(m_verCode){
-      case 0x41:
-        CHECK(processCpmWordR4V1_(word));
-        break;
-      case 0x31:
-        // TODO
-        return StatusCode::FAILURE;
-        break;
-      default:
-        break;
-    }
-  }
-
-  return StatusCode::SUCCESS;
-}
-
-StatusCode L1CaloByteStreamReadTool::processCpmWordR4V1_(uint32_t word) {
-  CpmWord cpm(word);
-
-  CHECK(cpm.isValid());
-  CHECK(addCpmTower_(m_subBlockHeader.crate(), m_subBlockHeader.module(),
-      word));
-
-  return StatusCode::SUCCESS;
-}
-
 StatusCode L1CaloByteStreamReadTool::processPpmBlock_() {
   if (m_ppBlock.size() > 0) {
     m_ppPointer = 0;
+    m_ppData = m_ppBlock.data();
     if (m_subBlockHeader.format() == 0) {
       StatusCode sc = processPpmNeutral_();
       m_ppBlock.clear();
@@ -332,8 +516,8 @@ StatusCode L1CaloByteStreamReadTool::processPpmBlock_() {
       return sc;
     }
 
-    if (m_verCode == 0x31) {
-      StatusCode sc = processPpmCompressedR3V1_();
+    if (m_verCode == 0x21 || m_verCode == 0x31) {
+      StatusCode sc = processPpmBlockR3V1_();
       m_ppBlock.clear();
       CHECK(sc);
       return sc;
@@ -448,13 +632,38 @@ StatusCode L1CaloByteStreamReadTool::processPpmNeutral_() {
 }
 
 StatusCode L1CaloByteStreamReadTool::processPpmCompressedR3V1_() {
+  // Run-1 compression version is carried in the sequence number field
+  const uint8_t compVersion = m_subBlockHeader.seqNum();
+  const uint8_t format = m_subBlockHeader.format();
+  if (compVersion > 5 || (compVersion < 3 && format != 2)
+      || (compVersion == 5
+          && (m_rodRunNumber < 88701 || m_rodRunNumber > 88724))) {
+    ATH_MSG_ERROR("Unsupported PPM compression version:format ("
+      << int(compVersion) << ":" << int(format) << ") combination");
+    return StatusCode::FAILURE;
+  }
+  if (m_subBlockHeader.nSlice1() != 1 || m_subBlockHeader.nSlice2() != 5) {
+    ATH_MSG_ERROR("Unsupported number of slices for compressed PPM data");
+    return StatusCode::FAILURE;
+  }
+  // Version 1.00 has no format 6 and stores ADC samples in time order;
+  // versions from 1.02 take the baseline and trigger offsets relative
+  // to the user header
+  const bool v100 = compVersion == 0;
+  const bool v104 = compVersion >= 2;
+  const int lowerBound = v104? int(m_caloUserHeader.ppLowerBound()):
+    m_pedestal - 12;
+  const int trigOffset = v104?
+    int(m_caloUserHeader.ppFadc()) - int(m_caloUserHeader.lut()):
+    int(m_caloUserHeader.ppFadc());
+
   uint8_t chan = 0;
   m_ppPointer = 0;
   m_ppMaxBit = 31 * m_ppBlock.size();
   try{
     while (chan < 64) {
       uint8_t present = 1;
-      if (m_subBlockHeader.format() == 3) {
+      if (format == 3) {
         present = getPpmBytestreamField_(1); 
       } 
 
@@ -469,8 +678,8 @@ StatusCode L1CaloByteStreamReadTool::processPpmCompressedR3V1_() {
         std::vector<uint8_t> adcExt = {0 , 0, 0, 0, 0};
 
         uint8_t minHeader = getPpmBytestreamField_(4);
-        uint8_t minIndex = minHeader % 5;
-        if (minHeader < 15) { // Formats 0-5
+        uint8_t minIndex = minHeader < 10? minHeader % 5: minHeader - 10;
+        if (minHeader < 15 || v100) { // Formats 0-5
           if (minHeader < 10) { // Formats 0-1
             fmt = minHeader / 5;
           } else { // Formats 2-5
@@ -489,17 +698,18 @@ StatusCode L1CaloByteStreamReadTool::processPpmCompressedR3V1_() {
                 lutSat = getPpmBytestreamField_(1);
                 lutPeak = getPpmBytestreamField_(1);
               }
-
-              if (haveExt == 1){
-                for(uint8_t i = 0; i < 5; ++i) {
+              // Triggered slice takes its BCID bit from the LUT word,
+              // explicit bits win from version 1.02
+              for(int i = 0; i < 5; ++i) {
+                if (i == trigOffset && !(v104 && haveExt == 1)) {
+                  adcExt[i] = lutExt;
+                } else if (haveExt == 1) {
                   adcExt[i] = getPpmBytestreamField_(1);
                 }
-              } else {
-                adcExt[2] = lutExt;
               }
             }
           }
-          adcVal = getPpmAdcSamplesR3_(fmt, minIndex);
+          adcVal = getPpmAdcSamplesR3_(fmt, minIndex, lowerBound, v100);
         } else {
           uint8_t haveAdc = getPpmBytestreamField_(1);
           if (haveAdc == 1) {
@@ -520,9 +730,16 @@ StatusCode L1CaloByteStreamReadTool::processPpmCompressedR3V1_() {
           adcVal,
           adcExt
         ));
+      } else {
+        // Suppressed in readout, so read out as zero rather than missing
+        setPpmChannelPresent_(m_subBlockHeader.crate(),
+          m_subBlockHeader.module(), chan, true);
       }
       chan++;
     }
+    if (!v100) {
+      CHECK(skipPpmErrorsR3V1_(compVersion));
+    }
   }catch (const std::out_of_range& ex) {
       ATH_MSG_ERROR("Failed to decode ppm block " << ex.what());
       return StatusCode::FAILURE;
@@ -530,37 +747,65 @@ StatusCode L1CaloByteStreamReadTool::processPpmCompressedR3V1_() {
   return StatusCode::SUCCESS;
 }
 
+StatusCode L1CaloByteStreamReadTool::skipPpmErrorsR3V1_(uint8_t compVersion) {
+  // Per G-Link pin status and error words follow the channel data.
+  // They are only skipped: the xAOD towers carry no error word from this
+  // reader (error is always 0, as for Run 2), so pin errors are discarded.
+  const uint8_t statusBit = getPpmBytestreamField_(1);
+  const uint8_t errorBit = getPpmBytestreamField_(1);
+  if (statusBit || errorBit) {
+    // Before version 1.04 the MCM absent bit is counted as an error bit
+    const uint8_t statusBits = compVersion < 4? 4: 5;
+    const uint8_t errorBits = compVersion < 4? 7: 6;
+    const uint32_t pinMap = getPpmBytestreamField_(16);
+    for (uint8_t pin = 0; pin < 16; ++pin) {
+      if ((pinMap >> pin) & 0x1) {
+        if (statusBit) skipPpmBytestreamField_(statusBits);
+        if (errorBit) skipPpmBytestreamField_(errorBits);
+      }
+    }
+  }
+  if (compVersion >= 2) {
+    // Any further non-zero data indicates corruption
+    while (m_ppPointer + 31 <= m_ppMaxBit) {
+      if (getPpmBytestreamField_(31) != 0) {
+        ATH_MSG_ERROR("Excess data after compressed PPM sub-block");
+        return StatusCode::FAILURE;
+      }
+    }
+  }
+  return StatusCode::SUCCESS;
+}
+
 std::vector<uint16_t> L1CaloByteStreamReadTool::getPpmAdcSamplesR3_(
-  uint8_t format, uint8_t minIndex) {
+  uint8_t format, uint8_t minIndex, int lowerBound, bool timeOrdered) {
 
   std::vector<uint16_t> adc = {0, 0, 0, 0, 0};
-  uint8_t minAdc = 0;
 
-  for(uint8_t i = 0; i <5; ++i) {
-    uint8_t longField = 0;
-    uint8_t numBits = 0;
-    if (format > 2) {
-      longField = getPpmBytestreamField_(1);
-      numBits = longField == 0? 4: (format * 2);
-    } else {
-      numBits = i == 0? 4: (format + 2);
+  // Minimum first, short fields are relative to the lower bound
+  uint8_t longField = 0;
+  if (format > 2) {
+    longField = getPpmBytestreamField_(1);
+  }
+  const uint16_t minAdc = longField == 1?
+    getPpmBytestreamField_(format * 2):
+    getPpmBytestreamField_(4) + lowerBound;
+
+  // Then the other samples as differences from the minimum
+  for(uint8_t i = 0; i < 5; ++i) {
+    if (timeOrdered? (i == minIndex): (i == 0)) {
+      adc[i] = minAdc;
+      continue;
     }
-
-    if (i == 0) {
-      minAdc = getPpmBytestreamField_(numBits);
-      if (longField == 0) {
-        minAdc += m_caloUserHeader.ppLowerBound();
-      }
-    } else {
-        adc[i] = minAdc + getPpmBytestreamField_(numBits);
+    uint8_t numBits = format + 2;
+    if (format > 2) {
+      numBits = getPpmBytestreamField_(1) == 0? 4: (format * 2);
     }
+    adc[i] = minAdc + getPpmBytestreamField_(numBits);
   }
 
-  if (minIndex == 0) {
-    adc[0] = minAdc;
-  } else {
-    adc[0] = adc[minIndex];
-    adc[minIndex] = minAdc;
+  if (!timeOrdered && minIndex != 0) {
+    std::swap(adc[0], adc[minIndex]);
   }
   return adc;
 }
@@ -608,16 +853,15 @@ StatusCode L1CaloByteStreamReadTool::processPpmBlockR4V1_() {
     CHECK(processPpmStandardR4V1_());
     return StatusCode::SUCCESS;
   } else if (m_subBlockHeader.format() >= 2) {
-    // TODO: convert compressed
     CHECK(processPpmCompressedR4V1_());
-    return StatusCode::FAILURE;
+    return StatusCode::SUCCESS;
   }
   return StatusCode::FAILURE;
 }
 
 StatusCode L1CaloByteStreamReadTool::processPpmCompressedR4V1_() {
   m_ppPointer = 0;
-  m_ppMaxBit = 32 * m_ppBlock.size();
+  m_ppMaxBit = 31 * m_ppBlock.size();
 
   uint8_t numAdc = m_subBlockHeader.nSlice2();
   uint8_t  numLut = m_subBlockHeader.nSlice1();
@@ -627,113 +871,133 @@ StatusCode L1CaloByteStreamReadTool::processPpmCompressedR4V1_() {
     for(uint8_t chan = 0; chan < 64; ++chan) {
       uint8_t present = 1;
 
-      std::vector<uint8_t> haveLut(0, numLut);
-      std::vector<uint8_t> lcpVal(0, numLut);
+      std::vector<uint8_t> haveLut(numLut, 0);
+      std::vector<uint8_t> lcpVal(numLut, 0);
       
-      std::vector<uint8_t> lcpExt(0, numLut);
-      std::vector<uint8_t> lcpSat(0, numLut);
-      std::vector<uint8_t> lcpPeak(0, numLut);
-      std::vector<uint8_t> lcpBcidVec(0, numLut);
+      std::vector<uint8_t> lcpExt(numLut, 0);
+      std::vector<uint8_t> lcpSat(numLut, 0);
+      std::vector<uint8_t> lcpPeak(numLut, 0);
+      std::vector<uint8_t> lcpBcidVec(numLut, 0);
       
-      std::vector<uint8_t> ljeVal(0, numLut);
+      std::vector<uint8_t> ljeVal(numLut, 0);
       
-      std::vector<uint8_t> ljeLow(0, numLut);
-      std::vector<uint8_t> ljeHigh(0, numLut);
-      std::vector<uint8_t> ljeRes(0, numLut);
-      std::vector<uint8_t> ljeSat80Vec(0, numLut);
-
-      std::vector<uint16_t> adcVal(0, numAdc);
-      std::vector<uint8_t> adcExt(0, numAdc);
-      std::vector<int16_t> pedCor(0, numLut);
-      std::vector<uint8_t> pedEn(0, numLut);
+      std::vector<uint8_t> ljeLow(numLut, 0);
+      std::vector<uint8_t> ljeHigh(numLut, 0);
+      std::vector<uint8_t> ljeRes(numLut, 0);
+      std::vector<uint8_t> ljeSat80Vec(numLut, 0);
+
+      // FADC and pedestal correction are left empty in LUT-only mode
+      const bool skipFadc = m_lutOnly || m_lazyFadc;
+      std::vector<uint16_t> adcVal;
+      std::vector<uint8_t> adcExt(skipFadc? 0: numAdc, 0);
+      std::vector<int16_t> pedCor(skipFadc? 0: numLut, 0);
+      std::vector<uint8_t> pedEn(skipFadc? 0: numLut, 0);
   
       int8_t encoding = -1;
       int8_t minIndex = -1;
+      uint32_t extBit = s_noBit;
 
       if (m_subBlockHeader.format() == 3) {
         present = getPpmBytestreamField_(1);
-        if (present == 1) {
-          interpretPpmHeaderR4V1_(numAdc, encoding, minIndex);
-          CHECK((encoding != -1) && (minIndex != -1));
-
-          // First get the LIT related quantities
-          if (encoding < 3) {
-            // Get the peal finder bits
-            for(uint i=0; i < numLut; ++i) {
-              lcpPeak[i] = getPpmBytestreamField_(1);
-            }
-            // Get Sat80 low bits
-            if (encoding > 0) {
-              for (uint8_t i = 0; i < numLut; ++i) {
-                ljeLow[i] = getPpmBytestreamField_(1);
-              }
-            }
-            // Get LutCP and LutJEP values (these are
-            // only present if the peak finder is set).
-            if (encoding == 2) {
-              for (uint8_t i = 0; i < numLut; ++i) {
-                if (lcpPeak[i] == 1) {
-                  lcpVal[i] = getPpmBytestreamField_(4);
-                }
-              }
-              for(uint8_t i = 0; i < numLut; ++i) {
-                if (lcpPeak[i] == 1){
-                  ljeVal[i] = getPpmBytestreamField_(3);
-                }
-              }
-            }            
-          } else if (encoding < 6) {
-            // Get LUT presence flag for each LUT slice. 
-            for(uint8_t i = 0; i < numLut; ++i){
-              haveLut[i] = getPpmBytestreamField_(1);
-            }
-            // Get external BCID bits (if block is present).
-            uint8_t haveExt = getPpmBytestreamField_(1);
-            if (haveExt == 1) {
-              for (uint8_t i = 0; i < numAdc; ++i) {
-                adcExt[i] = getPpmBytestreamField_(1);
-              }
+      }
+      if (present == 0) {
+        // Suppressed in readout, so read out as zero rather than missing
+        setPpmChannelPresent_(m_subBlockHeader.crate(),
+          m_subBlockHeader.module(), chan, true);
+        continue;
+      }
+      interpretPpmHeaderR4V1_(numAdc, encoding, minIndex);
+      CHECK((encoding != -1) && (minIndex != -1));
+
+      // First get the LIT related quantities
+      if (encoding < 3) {
+        // Get the peal finder bits
+        for(uint i=0; i < numLut; ++i) {
+          lcpPeak[i] = getPpmBytestreamField_(1);
+        }
+        // Get Sat80 low bits
+        if (encoding > 0) {
+          for (uint8_t i = 0; i < numLut; ++i) {
+            ljeLow[i] = getPpmBytestreamField_(1);
+          }
+        }
+        // Get LutCP and LutJEP values (these are
+        // only present if the peak finder is set).
+        if (encoding == 2) {
+          for (uint8_t i = 0; i < numLut; ++i) {
+            if (lcpPeak[i] == 1) {
+              lcpVal[i] = getPpmBytestreamField_(4);
             }
-            
-            for(uint8_t i = 0; i < numLut; ++i){
-              if (haveLut[i] == 1) {
-                lcpVal[i] = getPpmBytestreamField_(8);
-                lcpExt[i] = getPpmBytestreamField_(1);
-                lcpSat[i] = getPpmBytestreamField_(1);
-                lcpPeak[i] = getPpmBytestreamField_(1);
-              }
+          }
+          for(uint8_t i = 0; i < numLut; ++i) {
+            if (lcpPeak[i] == 1){
+              ljeVal[i] = getPpmBytestreamField_(3);
             }
-            // Get JEP LUT values and corresponding bits.         
-            for(uint8_t i = 0; i < numLut; ++i){
-              if (haveLut[i] == 1) {
-                ljeVal[i] = getPpmBytestreamField_(8);
-                ljeLow[i] = getPpmBytestreamField_(1);
-                ljeHigh[i] = getPpmBytestreamField_(1);
-                ljeRes[i] = getPpmBytestreamField_(1);
-              }
+          }
+        }            
+      } else if (encoding < 6) {
+        // Get LUT presence flag for each LUT slice. 
+        for(uint8_t i = 0; i < numLut; ++i){
+          haveLut[i] = getPpmBytestreamField_(1);
+        }
+        // Get external BCID bits (if block is present).
+        uint8_t haveExt = getPpmBytestreamField_(1);
+        if (haveExt == 1) {
+          extBit = m_ppPointer;
+          if (skipFadc) {
+            skipPpmBytestreamField_(numAdc);
+          } else {
+            for (uint8_t i = 0; i < numAdc; ++i) {
+              adcExt[i] = getPpmBytestreamField_(1);
             }
-    
           }
-
         }
-      }
-       // Next get the ADC related quantities (all encodings).
-      adcVal = getPpmAdcSamplesR4_(encoding, minIndex);
-      // Finally get the pedestal correction.
-      if ((encoding < 3) || (encoding == 6)) {
-        for (uint8_t i = 0; i < numLut; ++i)
-        {
-          pedCor[i] = getPpmBytestreamField_(6) + pedCorBase;
+        
+        for(uint8_t i = 0; i < numLut; ++i){
+          if (haveLut[i] == 1) {
+            lcpVal[i] = getPpmBytestreamField_(8);
+            lcpExt[i] = getPpmBytestreamField_(1);
+            lcpSat[i] = getPpmBytestreamField_(1);
+            lcpPeak[i] = getPpmBytestreamField_(1);
+          }
+        }
+        // Get JEP LUT values and corresponding bits.         
+        for(uint8_t i = 0; i < numLut; ++i){
+          if (haveLut[i] == 1) {
+            ljeVal[i] = getPpmBytestreamField_(8);
+            ljeLow[i] = getPpmBytestreamField_(1);
+            ljeHigh[i] = getPpmBytestreamField_(1);
+            ljeRes[i] = getPpmBytestreamField_(1);
+          }
         }
+
+      }
+      if (skipFadc) {
+        // Step over the ADC and pedestal correction fields
+        setPendingFadc_(m_ppPointer, extBit, encoding, minIndex);
+        skipPpmAdcSamplesR4_(encoding);
+        const PpmR4Encoding& enc = ::ppmR4Encoding(encoding);
+        skipPpmBytestreamField_((enc.corrBits + enc.enabledBits) * numLut);
       } else {
-        // At the moment there is an enabled bit for every LUT slice
-        // (even though its really a global flag).
-        // The correction values is a twos complement signed value.
-        for (uint8_t i = 0; i < numLut; ++i)
-        {
-          uint16_t val = getPpmBytestreamField_(10);
-          pedCor[i] = (val & 0x1ff) - (val & 0x200);
-          pedEn[i] = getPpmBytestreamField_(1);
+        // Next get the ADC related quantities (all encodings).
+        adcVal = getPpmAdcSamplesR4_(numAdc, m_caloUserHeader.ppLowerBound(),
+          encoding, minIndex);
+        // Finally get the pedestal correction.
+        if (::ppmR4Encoding(encoding).enabledBits == 0) {
+          for (uint8_t i = 0; i < numLut; ++i)
+          {
+            pedCor[i] = getPpmBytestreamField_(6) + pedCorBase;
+          }
+        } else {
+          // At the moment there is an enabled bit for every LUT slice
+          // (even though its really a global flag).
+          // The correction values is a twos complement signed value.
+          for (uint8_t i = 0; i < numLut; ++i)
+          {
+            uint16_t val = getPpmBytestreamField_(10);
+            pedCor[i] = (val & 0x1ff) - (val & 0x200);
+            pedEn[i] = getPpmBytestreamField_(1);
+          }
         }
       }
 
@@ -755,89 +1019,69 @@ StatusCode L1CaloByteStreamReadTool::processPpmCompressedR4V1_() {
 
 void L1CaloByteStreamReadTool::interpretPpmHeaderR4V1_(uint8_t numAdc,
   int8_t& encoding, int8_t& minIndex) {
-  uint8_t minHeader = 0;
-
-  if (numAdc == 5) {
-    minHeader = getPpmBytestreamField_(4);
-    minIndex = minHeader % 5;
-    if (minHeader < 15){ // Encodings 0-5
-      if (minHeader < 10) {
-        encoding = minHeader / 5;
-      } else {
-        encoding = 2 + getPpmBytestreamField_(2);
-      }
-    } else {
-      encoding = 6;
-    }
-  } else {
-      uint8_t numBits = 0;
-      if (numAdc ==3) {
-        numBits = 2;
-      } else if (numAdc == 7) {
-        numBits = 3;
-      } else if (numAdc < 15) {
-        numBits = 4;
-      }
-
-      if (numBits > 0) {
-        uint8_t fieldSize = 1 << numBits;
-        minHeader = getPpmBytestreamField_(numBits);
-        uint8_t encValue = fieldSize - 1;
-        if (minHeader == encValue) { // Encoding 6
-          encoding = 6;
-          minIndex = 0; 
-        } else {
-          minHeader += getPpmBytestreamField_(2) << numBits;
-          minIndex = minHeader % fieldSize;
-          encValue = 3 * fieldSize;
-
-          if (minHeader < encValue) { // Encodings 0-2
-            encoding = minHeader / fieldSize;
-          } else {
-            encoding = 3 + getPpmBytestreamField_(2);
-          }
-        }
-      }
+  const PpmR4HeaderTable& table = ::s_ppmR4Headers[numAdc];
+  if (table.headerBits == 0) {
+    return;
+  }
+  const PpmR4Header& entry =
+    table.entries[getPpmBytestreamField_(table.headerBits)];
+  minIndex = entry.minIndex;
+  encoding = entry.encoding;
+  if (encoding < 0) {
+    const uint8_t select = getPpmBytestreamField_(2);
+    encoding = (entry.selectEscape && select == 3)?
+      3 + getPpmBytestreamField_(2): entry.selectBase + select;
   }
 }
 
 std::vector<uint16_t> L1CaloByteStreamReadTool::getPpmAdcSamplesR4_(
-  uint8_t encoding, uint8_t minIndex) {
-  uint8_t numAdc = m_subBlockHeader.nSlice2();
+  uint8_t numAdc, uint8_t lowerBound, uint8_t encoding, uint8_t minIndex) {
 
-  if (encoding == 6) {
-    uint16_t val = getPpmBytestreamField_(6);
-    return std::vector<uint16_t>(val, numAdc);
+  const PpmR4Encoding& enc = ::ppmR4Encoding(encoding);
+  if (enc.constant) {
+    uint16_t val = getPpmBytestreamField_(enc.minBits);
+    return std::vector<uint16_t>(numAdc, val);
+  }
+  if (minIndex >= numAdc) {
+    throw std::out_of_range("Ppm minimum index beyond last ADC slice");
+  }
+  std::vector<uint16_t> adc(numAdc, 0);
+  uint16_t minAdc = 0;
+  if (enc.longBits == 0) {
+    // Fixed widths, so one bounds check for the whole channel;
+    // minimum relative to the lower bound
+    const uint32_t numBits = enc.minBits + (numAdc - 1) * enc.diffBits;
+    if ((m_ppPointer + numBits) > m_ppMaxBit) {
+      throw std::out_of_range("Requested too much bits from ppm block");
+    }
+    uint32_t bit = m_ppPointer;
+    minAdc = ::ppmField(m_ppData, m_ppMaxBit, bit, enc.minBits) + lowerBound;
+    bit += enc.minBits;
+    for (uint8_t i = 1; i < numAdc; ++i) {
+      adc[i] = minAdc + ::ppmField(m_ppData, m_ppMaxBit, bit, enc.diffBits);
+      bit += enc.diffBits;
+    }
+    m_ppPointer = bit;
   } else {
-    std::vector<uint16_t> adc(0, numAdc);
-    uint8_t minAdc = 0;
+    // Each sample flags a short or long field
     for (uint8_t i = 0; i < numAdc; ++i) {
-      uint8_t longField = 0;
-      uint8_t numBits = 0;
-      if (encoding > 2) {
-        longField = getPpmBytestreamField_(1);
-        numBits = longField == 0? 5 : (encoding * 2);
-      } else {
-        numBits = i == 0? 5 : (encoding + 2);
-      }
-
+      const uint8_t longField = getPpmBytestreamField_(1);
+      const uint32_t value =
+        getPpmBytestreamField_(longField? enc.longBits: enc.minBits);
       if (i == 0) {
-        minAdc = getPpmBytestreamField_(numBits);
-        if (longField == 0) {
-          minAdc += m_caloUserHeader.ppLowerBound();
-        }
+        minAdc = longField? value: value + lowerBound;
       } else {
-        adc[i] = minAdc + getPpmBytestreamField_(numBits);
+        adc[i] = minAdc + value;
       }
     }
-    if (minIndex == 0) {
-      adc[0] = minAdc;
-    } else {
-      adc[0] = adc[minIndex];
-      adc[minIndex] = minAdc;
-    }
-    return adc;
   }
+  if (minIndex == 0) {
+    adc[0] = minAdc;
+  } else {
+    adc[0] = adc[minIndex];
+    adc[minIndex] = minAdc;
+  }
+  return adc;
 }
 
 StatusCode L1CaloByteStreamReadTool::processPpmBlockR3V1_() {
@@ -845,8 +1089,8 @@ StatusCode L1CaloByteStreamReadTool::processPpmBlockR3V1_() {
     CHECK(processPpmStandardR3V1_());
     return StatusCode::SUCCESS;
   } else if (m_subBlockHeader.format() >= 2) {
-    // TODO: convert compressed
-    return StatusCode::FAILURE;
+    CHECK(processPpmCompressedR3V1_());
+    return StatusCode::SUCCESS;
   }
   return StatusCode::FAILURE;
 }
@@ -861,6 +1105,15 @@ StatusCode L1CaloByteStreamReadTool::processPpmStandardR4V1_() {
   m_ppPointer = 0;
   m_ppMaxBit = 31 * m_ppBlock.size();
 
+  int lutFirst = 0;
+  int lutNum = 0;
+  int adcFirst = 0;
+  int adcNum = 0;
+  ppmSliceWindow_(numLut, m_caloUserHeader.lut(), m_sliceWindow,
+    lutFirst, lutNum);
+  ppmSliceWindow_(numAdc, m_caloUserHeader.ppFadc(), m_sliceWindow,
+    adcFirst, adcNum);
+
   for (uint8_t chan = 0; chan < 64; ++chan) {
     //for (uint8_t k = 0; k < 4; ++k) {
     std::vector<uint8_t> lcpVal;
@@ -876,25 +1129,41 @@ StatusCode L1CaloByteStreamReadTool::processPpmStandardR4V1_() {
     std::vector<int16_t> pedCor;
     std::vector<uint8_t> pedEn;
     try {
-      for (int i = 0; i < numLut; ++i) {
+      // Slices outside the window are skipped, not decoded
+      const int lutEnd = lutFirst + lutNum;
+      const int adcEnd = adcFirst + adcNum;
+      skipPpmBytestreamField_(11 * lutFirst);
+      for (int i = lutFirst; i < lutEnd; ++i) {
         lcpVal.push_back(getPpmBytestreamField_(8));
         lcpBcidVec.push_back(getPpmBytestreamField_(3));
       }
+      skipPpmBytestreamField_(11 * (numLut - lutEnd + lutFirst));
 
-      for (int i = 0; i < numLut; ++i) {
+      for (int i = lutFirst; i < lutEnd; ++i) {
         ljeVal.push_back(getPpmBytestreamField_(8));
         ljeSat80Vec.push_back(getPpmBytestreamField_(3));
       }
 
-      for (int i = 0; i < numAdc; ++i) {
-        adcVal.push_back(getPpmBytestreamField_(10));
-        adcExt.push_back(getPpmBytestreamField_(1));
-      }
+      if (m_lutOnly || m_lazyFadc) {
+        // Fixed width fields, so step over ADC and pedestal correction
+        skipPpmBytestreamField_(11 * (numLut - lutEnd));
+        setPendingFadc_(m_ppPointer, s_noBit, -1, -1);
+        skipPpmBytestreamField_(11 * (numAdc + numLut));
+      } else {
+        skipPpmBytestreamField_(11 * (numLut - lutEnd + adcFirst));
 
-      for (int i = 0; i < numLut; ++i) {
-        uint16_t pc = getPpmBytestreamField_(10);
-        pedCor.push_back(((((pc &(0x200))>>9)==1)?-1:+1) * (pc & 0x1ff));
-        pedEn.push_back(getPpmBytestreamField_(1));
+        for (int i = adcFirst; i < adcEnd; ++i) {
+          adcVal.push_back(getPpmBytestreamField_(10));
+          adcExt.push_back(getPpmBytestreamField_(1));
+        }
+        skipPpmBytestreamField_(11 * (numAdc - adcEnd + lutFirst));
+
+        for (int i = lutFirst; i < lutEnd; ++i) {
+          uint16_t pc = getPpmBytestreamField_(10);
+          pedCor.push_back(((((pc &(0x200))>>9)==1)?-1:+1) * (pc & 0x1ff));
+          pedEn.push_back(getPpmBytestreamField_(1));
+        }
+        skipPpmBytestreamField_(11 * (numLut - lutEnd));
       }
     } catch (const std::out_of_range& ex) {
       ATH_MSG_ERROR("Failed to decode ppm block " << ex.what());
@@ -937,12 +1206,24 @@ StatusCode L1CaloByteStreamReadTool::addTriggerTowerV2_(
   int error = 0;
   double eta = 0.;
   double phi = 0.;
+
+  // FADC position recorded for this channel by a LazyFadc read, if any
+  const PpmFadcRecord pendingFadc = m_pendingFadc;
+  m_pendingFadc.data = nullptr;
+
+  if (m_ppmVisitor) {
+    m_ppmVisitor->visit(::coolId(crate, module, channel), adcVal, lcpVal,
+        ljeVal, m_caloUserHeader.ppFadc(), m_caloUserHeader.lut());
+    return StatusCode::SUCCESS;
+  }
   
   bool isNotSpare = m_ppmMaps->mapping(crate, module, channel, eta, phi, layer);
   if (!isNotSpare && !m_ppmIsRetSpare && !m_ppmIsRetMuon){
     return StatusCode::SUCCESS;
   }
 
+  setPpmChannelPresent_(crate, module, channel, false);
+
   if (!isNotSpare) {
     const int pin  = channel % 16;
     const int asic = channel / 16;
@@ -954,8 +1235,19 @@ StatusCode L1CaloByteStreamReadTool::addTriggerTowerV2_(
   CHECK(m_coolIds.count(coolId) == 0);
   m_coolIds.insert(coolId);
 
+  // ADC not decoded (LutOnly, LazyFadc) can't be judged, so keep the tower
+  // rather than decide on the LUT alone
+  const bool haveAdc = !adcVal.empty() || m_subBlockHeader.nSlice2() == 0;
+  if (m_zeroSuppress && haveAdc && isSuppressed_(lcpVal, ljeVal, adcVal)) {
+    return StatusCode::SUCCESS;
+  }
+
   xAOD::TriggerTower* tt = new xAOD::TriggerTower();
   m_triggerTowers->push_back(tt);
+  if (m_currentFadcRecords) {
+    // Also kept with no data, so a lost record can be told apart
+    (*m_currentFadcRecords)[coolId] = pendingFadc;
+  }
   // tt->initialize(
   //         const uint_least32_t& coolId,
   //         const uint_least8_t& layer,
@@ -973,12 +1265,87 @@ StatusCode L1CaloByteStreamReadTool::addTriggerTowerV2_(
   //         const uint_least8_t& peak,
   //         const uint_least8_t& adcPeak
   // );
+  if (m_sliceWindow >= 0) {
+    // Formats which can't skip slices while unpacking are trimmed here
+    const uint8_t numLut = m_subBlockHeader.nSlice1();
+    const uint8_t numAdc = m_subBlockHeader.nSlice2();
+    int lutFirst = 0;
+    int lutNum = 0;
+    int adcFirst = 0;
+    int adcNum = 0;
+    ppmSliceWindow_(numLut, m_caloUserHeader.lut(), m_sliceWindow,
+      lutFirst, lutNum);
+    ppmSliceWindow_(numAdc, m_caloUserHeader.ppFadc(), m_sliceWindow,
+      adcFirst, adcNum);
+    tt->initialize(coolId, eta, phi,
+        windowSlices(lcpVal, numLut, lutFirst, lutNum),
+        windowSlices(ljeVal, numLut, lutFirst, lutNum),
+        windowSlices(pedCor, numLut, lutFirst, lutNum),
+        windowSlices(pedEn, numLut, lutFirst, lutNum),
+        windowSlices(lcpBcidVec, numLut, lutFirst, lutNum),
+        windowSlices(adcVal, numAdc, adcFirst, adcNum),
+        windowSlices(adcExt, numAdc, adcFirst, adcNum),
+        windowSlices(ljeSat80Vec, numLut, lutFirst, lutNum),
+        error, m_caloUserHeader.lut() - lutFirst,
+        m_caloUserHeader.ppFadc() - adcFirst);
+    return StatusCode::SUCCESS;
+  }
+
   tt->initialize(coolId, eta, phi, lcpVal, ljeVal, pedCor, pedEn,
       lcpBcidVec, adcVal, adcExt, ljeSat80Vec, error, m_caloUserHeader.lut(),
       m_caloUserHeader.ppFadc());
   return StatusCode::SUCCESS;
 }
 
+void L1CaloByteStreamReadTool::setPpmChannelPresent_(uint8_t crate,
+    uint8_t module, uint8_t channel, bool checkMapping) {
+  if (m_fillChannelPresence) {
+    if (checkMapping && !m_ppmIsRetSpare && !m_ppmIsRetMuon) {
+      // Unmapped channels make no tower, so are not present either
+      double eta = 0.;
+      double phi = 0.;
+      int layer = 0;
+      if (!m_ppmMaps->mapping(crate, module, channel, eta, phi, layer)) {
+        return;
+      }
+    }
+    const uint32_t index = (crate << 10) | (module << 6) | channel;
+    if (index / 32 < m_ppmChannelPresence.size()) {
+      m_ppmChannelPresence[index / 32] |= (1u << (index % 32));
+    }
+  }
+}
+
+bool L1CaloByteStreamReadTool::isSuppressed_(
+    const std::vector<uint8_t>& lcpVal,
+    const std::vector<uint8_t>& ljeVal,
+    const std::vector<uint16_t>& adcVal) const {
+  for (auto lut : lcpVal) {
+    if (lut) return false;
+  }
+  for (auto lut : ljeVal) {
+    if (lut) return false;
+  }
+  for (auto adc : adcVal) {
+    if (std::abs(int(adc) - m_zeroSuppressPedestal) > m_zeroSuppressBand) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const std::vector<uint32_t>& 
+L1CaloByteStreamReadTool::ppmChannelPresence() const {
+  return m_ppmChannelPresence;
+}
+
+bool L1CaloByteStreamReadTool::isPpmChannelPresent(uint8_t crate,
+    uint8_t module, uint8_t channel) const {
+  const uint32_t index = (crate << 10) | (module << 6) | channel;
+  return index / 32 < m_ppmChannelPresence.size() &&
+         ((m_ppmChannelPresence[index / 32] >> (index % 32)) & 1);
+}
+
 StatusCode L1CaloByteStreamReadTool::addTriggerTowerV1_(
     uint8_t crate,
     uint8_t module,
@@ -1031,40 +1398,6 @@ StatusCode L1CaloByteStreamReadTool::addTriggerTowerV1_(
    return StatusCode::SUCCESS;
 }
 
-StatusCode L1CaloByteStreamReadTool::addCpmTower_(
-    uint8_t crate,
-    uint8_t module,
-    const CpmWord& word) {
-  // TODO: Handle slices
-
-  std::vector<uint8_t> emEnergy { word.tower0Et()};
-  std::vector<uint8_t> hadEnergy { word.tower1Et()};
-  std::vector<uint8_t> emError { 0 };
-  std::vector<uint8_t> hadError { 0 };
-
-
-
-  uint8_t channel = word.ttPair(); // TODO: fix
-  double eta = 0.;
-  double phi = 0.;
-  int layer = 0;
-  int peak = 0;
-  m_cpmMaps->mapping(crate, module, channel, eta, phi, layer);
-
-  xAOD::CPMTower *cpm = new xAOD::CPMTower();
-  m_cpmTowers->push_back(cpm);
-
-  cpm->setEmEnergyVec(emEnergy);
-  cpm->setHadEnergyVec(hadEnergy);
-  cpm->setEmErrorVec(emError);
-  cpm->setHadErrorVec(hadError);
-  cpm->setEta(eta);
-  cpm->setPhi(phi);
-  cpm->setPeak(peak);
-
-  return StatusCode::SUCCESS;
-}
-
 // Return reference to vector with all possible Source Identifiers
 
 const std::vector<uint32_t>& L1CaloByteStreamReadTool::ppmSourceIDs(
@@ -1136,25 +1469,1144 @@ const std::vector<uint32_t>& L1CaloByteStreamReadTool::cpSourceIDs() {
 
 uint32_t L1CaloByteStreamReadTool::getPpmBytestreamField_(uint8_t numBits) {
   if ((m_ppPointer + numBits) <= m_ppMaxBit) {
-    uint8_t iWord = m_ppPointer / 31;
-    uint8_t iBit = m_ppPointer % 31;
+    const uint32_t result = ::ppmField(m_ppData, m_ppMaxBit, m_ppPointer, numBits);
     m_ppPointer += numBits;
+    return result;
+  }
 
-    uint32_t result;
-    if ((iBit + numBits) <= 31) {
-      result = ::bitFieldSize(m_ppBlock[iWord], iBit, numBits);
+  throw std::out_of_range("Requested too much bits from ppm block");
+}
+
+void L1CaloByteStreamReadTool::skipPpmBytestreamField_(uint32_t numBits) {
+  if ((m_ppPointer + numBits) > m_ppMaxBit) {
+    throw std::out_of_range("Requested too much bits from ppm block");
+  }
+  m_ppPointer += numBits;
+}
+
+void L1CaloByteStreamReadTool::skipPpmAdcSamplesR4_(uint8_t encoding) {
+  // Must consume exactly the bits read by getPpmAdcSamplesR4_
+  const uint8_t numAdc = m_subBlockHeader.nSlice2();
+  const PpmR4Encoding& enc = ::ppmR4Encoding(encoding);
+
+  if (enc.constant) {
+    skipPpmBytestreamField_(enc.minBits);
+  } else if (enc.longBits == 0) {
+    if (numAdc > 0) {
+      skipPpmBytestreamField_(enc.minBits + (numAdc - 1) * enc.diffBits);
+    }
+  } else {
+    for (uint8_t i = 0; i < numAdc; ++i) {
+      const uint8_t longField = getPpmBytestreamField_(1);
+      skipPpmBytestreamField_(longField? enc.longBits: enc.minBits);
+    }
+  }
+}
+
+void L1CaloByteStreamReadTool::setPendingFadc_(uint32_t adcBit,
+    uint32_t extBit, int8_t encoding, int8_t minIndex) {
+  if (!m_lazyFadc) return;
+  m_pendingFadc.data = m_ppPayload;
+  m_pendingFadc.maxBit = m_ppMaxBit;
+  m_pendingFadc.adcBit = adcBit;
+  m_pendingFadc.extBit = extBit;
+  m_pendingFadc.format = m_subBlockHeader.format();
+  m_pendingFadc.encoding = encoding;
+  m_pendingFadc.minIndex = minIndex;
+  m_pendingFadc.numAdc = m_subBlockHeader.nSlice2();
+  m_pendingFadc.numLut = m_subBlockHeader.nSlice1();
+  m_pendingFadc.lowerBound = m_caloUserHeader.ppLowerBound();
+  m_pendingFadc.lutPeak = m_caloUserHeader.lut();
+  m_pendingFadc.adcPeak = m_caloUserHeader.ppFadc();
+  m_pendingFadc.sliceWindow = m_sliceWindow;
+}
+
+StatusCode L1CaloByteStreamReadTool::decodeFadc(xAOD::TriggerTower* tt) {
+  auto records = m_fadcRecords.find(tt->container());
+  if (records == m_fadcRecords.end()) {
+    // Not read lazily this event
+    return StatusCode::SUCCESS;
+  }
+  auto itr = records->second.find(tt->coolId());
+  if (itr == records->second.end()) {
+    ATH_MSG_ERROR("No LazyFadc record for tower 0x" << MSG::hex
+      << tt->coolId() << MSG::dec);
+    return StatusCode::FAILURE;
+  }
+  if (!itr->second.data) {
+    // Nothing deferred or already decoded
+    return StatusCode::SUCCESS;
+  }
+  const PpmFadcRecord rec = itr->second;
+  itr->second.data = nullptr;
+
+  std::vector<uint16_t> adcVal;
+  std::vector<uint8_t> adcExt(rec.numAdc, 0);
+  std::vector<int16_t> pedCor(rec.numLut, 0);
+  std::vector<uint8_t> pedEn(rec.numLut, 0);
+
+  // Payload stays owned by the ROB data provider for the whole event
+  m_ppData = rec.data;
+  m_ppMaxBit = rec.maxBit;
+  try {
+    if (rec.format == 1) {
+      m_ppPointer = rec.adcBit;
+      for (uint8_t i = 0; i < rec.numAdc; ++i) {
+        adcVal.push_back(getPpmBytestreamField_(10));
+        adcExt[i] = getPpmBytestreamField_(1);
+      }
+      for (uint8_t i = 0; i < rec.numLut; ++i) {
+        uint16_t pc = getPpmBytestreamField_(10);
+        pedCor[i] = ((((pc &(0x200))>>9)==1)?-1:+1) * (pc & 0x1ff);
+        pedEn[i] = getPpmBytestreamField_(1);
+      }
     } else {
-      uint8_t nb1 = 31 - iBit;
-      uint8_t nb2 = numBits - nb1;
-      uint32_t field1 = ::bitFieldSize(m_ppBlock[iWord], iBit, nb1);
-      uint32_t field2 = ::bitFieldSize(m_ppBlock[iWord + 1], 0, nb2);
-      result = field1 | (field2 << nb1);
+      if (rec.extBit != s_noBit) {
+        m_ppPointer = rec.extBit;
+        for (uint8_t i = 0; i < rec.numAdc; ++i) {
+          adcExt[i] = getPpmBytestreamField_(1);
+        }
+      }
+      m_ppPointer = rec.adcBit;
+      adcVal = getPpmAdcSamplesR4_(rec.numAdc, rec.lowerBound, rec.encoding,
+        rec.minIndex);
+      if (::ppmR4Encoding(rec.encoding).enabledBits == 0) {
+        for (uint8_t i = 0; i < rec.numLut; ++i) {
+          pedCor[i] = getPpmBytestreamField_(6) - 20;
+        }
+      } else {
+        for (uint8_t i = 0; i < rec.numLut; ++i) {
+          uint16_t val = getPpmBytestreamField_(10);
+          pedCor[i] = (val & 0x1ff) - (val & 0x200);
+          pedEn[i] = getPpmBytestreamField_(1);
+        }
+      }
     }
+  } catch (const std::out_of_range& ex) {
+    ATH_MSG_ERROR("Failed to decode FADC data " << ex.what());
+    return StatusCode::FAILURE;
+  }
 
-    return result;
+  int lutFirst = 0;
+  int lutNum = rec.numLut;
+  int adcFirst = 0;
+  int adcNum = rec.numAdc;
+  if (rec.sliceWindow >= 0) {
+    ppmSliceWindow_(rec.numLut, rec.lutPeak, rec.sliceWindow,
+      lutFirst, lutNum);
+    ppmSliceWindow_(rec.numAdc, rec.adcPeak, rec.sliceWindow,
+      adcFirst, adcNum);
+  }
+  tt->setAdc(windowSlices(adcVal, rec.numAdc, adcFirst, adcNum));
+  tt->setBcidExt(windowSlices(adcExt, rec.numAdc, adcFirst, adcNum));
+  tt->setCorrection(windowSlices(pedCor, rec.numLut, lutFirst, lutNum));
+  tt->setCorrectionEnabled(windowSlices(pedEn, rec.numLut, lutFirst, lutNum));
+  return StatusCode::SUCCESS;
+}
+
+void L1CaloByteStreamReadTool::keepInterface(const std::string& auxKey,
+    SG::AuxVectorBase* container) {
+  // Replaces any container left over from an earlier event
+  m_interfaces[auxKey].reset(container);
+}
+
+void L1CaloByteStreamReadTool::ppmSliceWindow_(uint8_t numSlices, uint8_t peak,
+    int sliceWindow, int& firstSlice, int& numWindow) const {
+  if (peak >= numSlices) {
+    // Inconsistent header, keep everything
+    firstSlice = 0;
+    numWindow = numSlices;
+    return;
   }
+  ModifySlices::window(peak, numSlices, sliceWindow, firstSlice,
+    numWindow);
+}
+// ===========================================================================
+// CP and JEP
+// ===========================================================================
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXCPTobContainer* const tobCollection) {
+  m_cmxCpTobs = tobCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::CMX_CP_TOB);
+  m_cmxCpTobs = nullptr;
+  return sc;
+}
 
-  throw std::out_of_range("Requested too much bits from ppm block");
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXCPHitsContainer* const hitsCollection) {
+  m_cmxCpHits = hitsCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::CMX_CP_HITS);
+  m_cmxCpHits = nullptr;
+  return sc;
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::JetElementContainer* const jeCollection) {
+  m_jetElements = jeCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::JET_ELEMENT);
+  m_jetElements = nullptr;
+  return sc;
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::JEMEtSumsContainer* const etCollection) {
+  m_jemEtSums = etCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::JEM_ET_SUMS);
+  m_jemEtSums = nullptr;
+  return sc;
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXJetTobContainer* const tobCollection) {
+  m_cmxJetTobs = tobCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::CMX_JET_TOB);
+  m_cmxJetTobs = nullptr;
+  return sc;
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXJetHitsContainer* const hitsCollection) {
+  m_cmxJetHits = hitsCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::CMX_JET_HITS);
+  m_cmxJetHits = nullptr;
+  return sc;
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXEtSumsContainer* const sumsCollection) {
+  m_cmxEtSums = sumsCollection;
+  StatusCode sc = convertCpJep_(robFrags, RequestType::CMX_ET_SUMS);
+  m_cmxEtSums = nullptr;
+  return sc;
+}
+
+namespace {
+// Fetch ROB fragments for a CP or JEP collection and convert
+template <class Tool, class Container>
+StatusCode fetchAndConvert(Tool* tool, IROBDataProviderSvc* robDataProvider,
+    const std::vector<uint32_t>& vID, Container* const collection) {
+  IROBDataProviderSvc::VROBFRAG robFrags;
+  robDataProvider->getROBData(vID, robFrags, "L1CaloByteStreamReadTool");
+  return tool->convert(robFrags, collection);
+}
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::CMXCPTobContainer* const tobCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, cpSourceIDs(),
+    tobCollection);
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::CMXCPHitsContainer* const hitsCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, cpSourceIDs(),
+    hitsCollection);
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::JetElementContainer* const jeCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, jepSourceIDs(),
+    jeCollection);
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::JEMEtSumsContainer* const etCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, jepSourceIDs(),
+    etCollection);
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::CMXJetTobContainer* const tobCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, jepSourceIDs(),
+    tobCollection);
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::CMXJetHitsContainer* const hitsCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, jepSourceIDs(),
+    hitsCollection);
+}
+
+StatusCode L1CaloByteStreamReadTool::convert(
+    xAOD::CMXEtSumsContainer* const sumsCollection) {
+  return fetchAndConvert(this, &*m_robDataProvider, jepSourceIDs(),
+    sumsCollection);
+}
+
+const std::vector<uint32_t>& L1CaloByteStreamReadTool::jepSourceIDs() {
+  const int crates = 2;
+  const int crateOffsetHw = 12;
+
+  if (m_jepSourceIDs.empty()) {
+    const int maxCrates = crates + crateOffsetHw;
+    const int maxSlinks = m_srcIdMap->maxSlinks();
+    for (int hwCrate = crateOffsetHw; hwCrate < maxCrates; ++hwCrate) {
+      for (int slink = 0; slink < maxSlinks; ++slink) {
+        const int daqOrRoi = 0;
+        const uint32_t rodId = m_srcIdMap->getRodID(hwCrate, slink,
+            daqOrRoi, eformat::TDAQ_CALO_JET_PROC_DAQ);
+        const uint32_t robId = m_srcIdMap->getRobID(rodId);
+        m_jepSourceIDs.push_back(robId);
+      }
+    }
+  }
+  return m_jepSourceIDs;
+}
+
+StatusCode L1CaloByteStreamReadTool::convertCpJep_(
+    const IROBDataProviderSvc::VROBFRAG& robFrags,
+    RequestType requestedType) {
+  m_requestedType = requestedType;
+  if (requestedType == RequestType::CPM
+      || requestedType == RequestType::CMX_CP_TOB
+      || requestedType == RequestType::CMX_CP_HITS) {
+    m_subDetectorID = eformat::TDAQ_CALO_CLUSTER_PROC_DAQ;
+    m_cpJepCrateOffsetHw = 8;
+  } else {
+    m_subDetectorID = eformat::TDAQ_CALO_JET_PROC_DAQ;
+    m_cpJepCrateOffsetHw = 12;
+  }
+  m_cpmTowerStage.clear();
+  m_cmxCpTobStage.clear();
+  m_cmxCpHitsStage.clear();
+  m_jetElementStage.clear();
+  m_jemEtSumsStage.clear();
+  m_cmxJetTobStage.clear();
+  m_cmxJetHitsStage.clear();
+  m_cmxEtSumsStage.clear();
+
+  L1CaloRobIdSet dupCheck;
+  ROBIterator rob = robFrags.begin();
+  ROBIterator robEnd = robFrags.end();
+  for (; rob != robEnd; ++rob) {
+    // Skip duplicate fragments
+    const uint32_t robid = (*rob)->source_id();
+    if (!dupCheck.insert(robid)) {
+      m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_DUPLICATE_ROB);
+      ATH_MSG_DEBUG("Skipping duplicate ROB fragment");
+      continue;
+    }
+    processCpJepRobFragment_(rob);
+  }
+  // Slices of one object may come from several sub-blocks, so objects are
+  // only made once everything is unpacked
+  createStaged_();
+  return StatusCode::SUCCESS;
+}
+
+void L1CaloByteStreamReadTool::processCpJepRobFragment_(
+    const ROBIterator& robIter) {
+  auto rob = **robIter;
+  const uint32_t robid = rob.source_id();
+
+  ATH_MSG_DEBUG(
+      "Treating ROB fragment source id #" << MSG::hex << rob.rob_source_id());
+  // -------------------------------------------------------------------------
+  // Check Rob status
+  if (rob.nstatus() > 0) {
+    ROBPointer robData;
+    rob.status(robData);
+    if (*robData != 0) {
+      ATH_MSG_DEBUG("ROB status error - skipping fragment");
+      m_errorTool->robError(robid, *robData);
+      return;
+    }
+  }
+  // -------------------------------------------------------------------------
+  RODPointer payloadBeg;
+  RODPointer payloadEnd;
+  RODPointer payload;
+
+  rob.rod_data(payloadBeg);
+  payloadEnd = payloadBeg + rob.rod_ndata();
+  payload = payloadBeg;
+  if (payload == payloadEnd) {
+    ATH_MSG_DEBUG("ROB fragment empty");
+    return;
+  }
+  // -------------------------------------------------------------------------
+  // Check identifier
+  const uint32_t sourceID = rob.rod_source_id();
+  const int slink = m_srcIdMap->slink(sourceID);
+  const int rodCrate = m_srcIdMap->crate(sourceID);
+  if (m_srcIdMap->getRobID(sourceID) != robid
+      || m_srcIdMap->subDet(sourceID) != m_subDetectorID
+      || m_srcIdMap->daqOrRoi(sourceID) != 0
+      || (slink != 0 && slink != 2)
+      || rodCrate < m_cpJepCrateOffsetHw) {
+    m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_ROD_ID);
+    ATH_MSG_DEBUG("Wrong source identifier in data: ROD "
+      << MSG::hex << sourceID << "  ROB " << robid << MSG::dec);
+    return;
+  }
+  const int minorVersion = rob.rod_version() & 0xffff;
+  if (minorVersion <= m_srcIdMap->minorVersionPreLS1()) {
+    ATH_MSG_DEBUG("Skipping pre-LS1 data");
+    return;
+  }
+  ATH_MSG_DEBUG("Treating crate " << rodCrate << " slink " << slink);
+  // -------------------------------------------------------------------------
+  // First word should be User Header
+  if (!L1CaloUserHeader::isValid(*payload)) {
+    m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_USER_HEADER);
+    ATH_MSG_DEBUG("Invalid or missing user header");
+    return;
+  }
+  L1CaloUserHeader userHeader(*payload);
+  userHeader.setVersion(minorVersion);
+  if (userHeader.words() != 1) {
+    m_errorTool->rodError(robid, L1CaloSubBlock::ERROR_USER_HEADER);
+    ATH_MSG_DEBUG("Unexpected number of user header words: "
+      << userHeader.words());
+    return;
+  }
+  ++payload;
+  const bool isCp = m_subDetectorID == eformat::TDAQ_CALO_CLUSTER_PROC_DAQ;
+  const int trigSlice = isCp? userHeader.cpm(): userHeader.jem();
+  // -------------------------------------------------------------------------
+  // Check sub-block structure before creating any objects
+  if (m_validateRods) {
+    const int rodErr = L1CaloRodValidator::checkCpJep(payload, payloadEnd,
+      isCp, rodCrate, trigSlice);
+    if (rodErr != L1CaloSubBlock::ERROR_NONE) {
+      m_errorTool->rodError(robid, rodErr);
+      ATH_MSG_DEBUG("ROD structure check failed: " << rodErr);
+      return;
+    }
+  }
+  // -------------------------------------------------------------------------
+  // Loop over sub-blocks, only decoding those for the requested type
+  const RequestType req = m_requestedType;
+  m_rodErr = L1CaloSubBlock::ERROR_NONE;
+  while (payload != payloadEnd) {
+    if (L1CaloSubBlock::wordType(*payload) != L1CaloSubBlock::HEADER) {
+      ATH_MSG_DEBUG("Unexpected data sequence");
+      m_rodErr = L1CaloSubBlock::ERROR_MISSING_HEADER;
+      break;
+    }
+    L1CaloSubBlock* subBlock = 0;
+    if (CmxSubBlock::cmxBlock(*payload)) {
+      const CmxSubBlock::CmxFirmwareCode cmxType =
+        CmxSubBlock::cmxType(*payload);
+      if (isCp && cmxType == CmxSubBlock::CMX_CP) {
+        subBlock = m_cmxCpSubBlock;
+      } else if (!isCp && cmxType == CmxSubBlock::CMX_JET) {
+        subBlock = m_cmxJetSubBlock;
+      } else if (!isCp && cmxType == CmxSubBlock::CMX_ENERGY) {
+        subBlock = m_cmxEnergySubBlock;
+      } else {
+        ATH_MSG_DEBUG("Invalid CMX type in module field");
+        m_rodErr = L1CaloSubBlock::ERROR_MODULE_NUMBER;
+        break;
+      }
+    } else if (isCp) {
+      subBlock = m_cpmSubBlock;
+    } else {
+      subBlock = m_jemSubBlock;
+    }
+    subBlock->clear();
+    payload = subBlock->read(payload, payloadEnd);
+    if (subBlock->crate() != rodCrate) {
+      ATH_MSG_DEBUG("Inconsistent crate number in ROD source ID");
+      m_rodErr = L1CaloSubBlock::ERROR_CRATE_NUMBER;
+      break;
+    }
+    if (subBlock == m_cpmSubBlock) {
+      if (req == RequestType::CPM) decodeCpm_(trigSlice);
+    } else if (subBlock == m_cmxCpSubBlock) {
+      if (req == RequestType::CMX_CP_TOB || req == RequestType::CMX_CP_HITS) {
+        decodeCmxCp_(trigSlice);
+      }
+    } else if (subBlock == m_jemSubBlock) {
+      if (req == RequestType::JET_ELEMENT || req == RequestType::JEM_ET_SUMS) {
+        decodeJem_(trigSlice);
+      }
+    } else if (subBlock == m_cmxJetSubBlock) {
+      if (req == RequestType::CMX_JET_TOB || req == RequestType::CMX_JET_HITS) {
+        decodeCmxJet_(trigSlice);
+      }
+    } else if (req == RequestType::CMX_ET_SUMS) {
+      decodeCmxEnergy_(trigSlice);
+    }
+    if (m_rodErr != L1CaloSubBlock::ERROR_NONE) {
+      ATH_MSG_DEBUG("Sub-block decoding failed");
+      break;
+    }
+  }
+  if (m_rodErr != L1CaloSubBlock::ERROR_NONE) {
+    m_errorTool->rodError(robid, m_rodErr);
+  }
+}
+
+template <class SubBlock>
+bool L1CaloByteStreamReadTool::prepareSubBlock_(SubBlock* subBlock,
+    int trigSlice, SliceRange& range) {
+  const int timeslices = subBlock->timeslices();
+  const int sliceNum = subBlock->slice();
+  ATH_MSG_DEBUG("Crate " << subBlock->crate()
+    << "  Module " << subBlock->module()
+    << "  Total slices " << timeslices
+    << "  Slice " << sliceNum);
+  if (timeslices <= trigSlice) {
+    ATH_MSG_DEBUG("Triggered slice from header "
+      << "inconsistent with number of slices: "
+      << trigSlice << ", " << timeslices);
+    m_rodErr = L1CaloSubBlock::ERROR_SLICES;
+    return false;
+  }
+  if (timeslices <= sliceNum) {
+    ATH_MSG_DEBUG("Total slices inconsistent with slice number: "
+      << timeslices << ", " << sliceNum);
+    m_rodErr = L1CaloSubBlock::ERROR_SLICES;
+    return false;
+  }
+  // Slices to keep, skipping sub-blocks outside the window
+  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+  ModifySlices::window(trigSlice, timeslices, m_sliceWindow, range.first,
+    range.num);
+  if (!neutralFormat
+      && (sliceNum < range.first || sliceNum >= range.first + range.num)) {
+    return false;
+  }
+  range.peak = trigSlice - range.first;
+  range.begin = neutralFormat? range.first: sliceNum;
+  range.end = neutralFormat? range.first + range.num: sliceNum + 1;
+  // Unpack sub-block
+  if (subBlock->dataWords() && !subBlock->unpack()) {
+    ATH_MSG_DEBUG("Sub-block unpacking failed: "
+      << subBlock->unpackErrorMsg());
+    m_rodErr = subBlock->unpackErrorCode();
+    return false;
+  }
+  return true;
+}
+
+template <class Info>
+int L1CaloByteStreamReadTool::stageSlice_(L1CaloSliceStage<Info>& stage,
+    uint32_t key, const Info& info, const SliceRange& range, int sl,
+    int checkFields) {
+  const int index = stage.find(key);
+  if (index < 0) return stage.add(key, info, range.num, range.peak);
+  if (stage.slices(index) != range.num) {
+    m_rodErr = L1CaloSubBlock::ERROR_SLICES;
+    return -1;
+  }
+  if (stage.sliceSet(index, sl, checkFields)) {
+    m_rodErr = L1CaloSubBlock::ERROR_DUPLICATE_DATA;
+    return -1;
+  }
+  return index;
+}
+
+void L1CaloByteStreamReadTool::decodeCpm_(int trigCpm) {
+  CpmSubBlockV2* const subBlock = m_cpmSubBlock;
+  const int module = subBlock->module();
+  if (module < 1 || module > 14) {
+    ATH_MSG_DEBUG("Unexpected module number: " << module);
+    m_rodErr = L1CaloSubBlock::ERROR_MODULE_NUMBER;
+    return;
+  }
+  SliceRange range;
+  if (!prepareSubBlock_(subBlock, trigCpm, range)) return;
+
+  LVL1::DataError dErr;
+  dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
+  const int subStatus = dErr.error();
+  const int crate = subBlock->crate() - m_cpJepCrateOffsetHw;
+  const int channels = 80;
+  typedef CpmTowerInfo Info;
+  for (int slice = range.begin; slice < range.end; ++slice) {
+    const int sl = slice - range.first;
+    for (int chan = 0; chan < channels; ++chan) {
+      if (!subStatus && !subBlock->anyTowerData(chan)) continue;
+      const int em = subBlock->emData(slice, chan);
+      const int had = subBlock->hadData(slice, chan);
+      const int emErr = subBlock->emError(slice, chan);
+      const int hadErr = subBlock->hadError(slice, chan);
+      LVL1::DataError emErrBits(subStatus);
+      LVL1::DataError hadErrBits(subStatus);
+      if (emErr) {
+        emErrBits.set(LVL1::DataError::Parity, emErr & 0x1);
+        emErrBits.set(LVL1::DataError::LinkDown, (emErr >> 1) & 0x1);
+      }
+      if (hadErr) {
+        hadErrBits.set(LVL1::DataError::Parity, hadErr & 0x1);
+        hadErrBits.set(LVL1::DataError::LinkDown, (hadErr >> 1) & 0x1);
+      }
+      const int emErr1 = emErrBits.error();
+      const int hadErr1 = hadErrBits.error();
+      if (!(em || had || emErr1 || hadErr1)) continue;
+
+      double eta = 0.;
+      double phi = 0.;
+      int layer = 0;
+      if (!m_cpmMaps->mapping(crate, module, chan, eta, phi, layer)
+          || layer != 0) {
+        continue;
+      }
+      const uint32_t key = (crate << 10) | (module << 6) | chan;
+      const Info info = { float(eta), float(phi) };
+      const int tt = stageSlice_(m_cpmTowerStage, key, info, range, sl,
+        Info::FIELDS);
+      if (tt < 0) {
+        ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+        return;
+      }
+      m_cpmTowerStage.set(tt, Info::EM, sl, em);
+      m_cpmTowerStage.set(tt, Info::HAD, sl, had);
+      m_cpmTowerStage.set(tt, Info::EM_ERROR, sl, emErr1);
+      m_cpmTowerStage.set(tt, Info::HAD_ERROR, sl, hadErr1);
+    }
+  }
+}
+
+void L1CaloByteStreamReadTool::decodeCmxCp_(int trigCpm) {
+  CmxCpSubBlock* const subBlock = m_cmxCpSubBlock;
+  SliceRange range;
+  if (!prepareSubBlock_(subBlock, trigCpm, range)) return;
+
+  LVL1::DataError dErr;
+  dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
+  const int subStatus = dErr.error();
+  const int crate = subBlock->crate() - m_cpJepCrateOffsetHw;
+  const int cmx = subBlock->cmxPosition();
+  const int summing = subBlock->cmxSumming();
+  const int modules = 14;
+  const int maxTobs = 5;
+  typedef CmxCpTobInfo TobInfo;
+  typedef CmxCpHitsInfo HitsInfo;
+  for (int slice = range.begin; slice < range.end; ++slice) {
+    const int sl = slice - range.first;
+
+    if (m_requestedType == RequestType::CMX_CP_TOB) {
+      for (int cpm = 1; cpm <= modules; ++cpm) {
+        const unsigned int presenceMap = subBlock->presenceMap(slice, cpm);
+        for (int tob = 0; tob < maxTobs; ++tob) {
+          const int energy = subBlock->energy(slice, cpm, tob);
+          const int isolation = subBlock->isolation(slice, cpm, tob);
+          int error = subBlock->tobError(slice, cpm, tob);
+          if (energy == 0 && isolation == 0 && error == 0) break;
+          const int loc = subBlock->localCoord(slice, cpm, tob);
+          const int chip = subBlock->chip(slice, cpm, tob);
+          LVL1::DataError errBits(subStatus);
+          if (error) {
+            errBits.set(LVL1::DataError::Parity, (error & 0x1f) ? 1 : 0);
+            errBits.set(LVL1::DataError::ParityMerge, error);
+            errBits.set(LVL1::DataError::ParityPhase0, (error >> 1));
+            errBits.set(LVL1::DataError::ParityPhase1, (error >> 2));
+            errBits.set(LVL1::DataError::ParityPhase2, (error >> 3));
+            errBits.set(LVL1::DataError::ParityPhase3, (error >> 4));
+            errBits.set(LVL1::DataError::Overflow, (error >> 5));
+          }
+          error = errBits.error();
+          const uint32_t key = (((((((crate << 1) | cmx) << 4) | cpm) << 4)
+            | chip) << 2) | loc;
+          const TobInfo info = { uint8_t(crate), uint8_t(cmx), uint8_t(cpm),
+            uint8_t(chip), uint8_t(loc) };
+          const int tb = stageSlice_(m_cmxCpTobStage, key, info, range, sl,
+            TobInfo::PRESENCE_MAP);
+          if (tb < 0) {
+            ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+            return;
+          }
+          m_cmxCpTobStage.set(tb, TobInfo::ENERGY, sl, energy);
+          m_cmxCpTobStage.set(tb, TobInfo::ISOLATION, sl, isolation);
+          m_cmxCpTobStage.set(tb, TobInfo::TOB_ERROR, sl, error);
+          m_cmxCpTobStage.set(tb, TobInfo::PRESENCE_MAP, sl, presenceMap);
+        }
+      }
+    } else {
+      for (int source = 0; source < CmxCpSubBlock::MAX_SOURCE_ID; ++source) {
+        if (summing == CmxSubBlock::CRATE &&
+            (source == CmxCpSubBlock::REMOTE_0 ||
+             source == CmxCpSubBlock::REMOTE_1 ||
+             source == CmxCpSubBlock::REMOTE_2 ||
+             source == CmxCpSubBlock::TOTAL)) continue;
+        const unsigned int hits0 = subBlock->hits(slice, source, 0);
+        const unsigned int hits1 = subBlock->hits(slice, source, 1);
+        const int overflow = subBlock->roiOverflow(slice, source);
+        LVL1::DataError err0Bits(subStatus);
+        err0Bits.set(LVL1::DataError::Parity,
+          subBlock->hitsError(slice, source, 0));
+        err0Bits.set(LVL1::DataError::Overflow, overflow);
+        LVL1::DataError err1Bits(subStatus);
+        err1Bits.set(LVL1::DataError::Parity,
+          subBlock->hitsError(slice, source, 1));
+        err1Bits.set(LVL1::DataError::Overflow, overflow);
+        const int err0 = err0Bits.error();
+        const int err1 = err1Bits.error();
+        if (!(hits0 || hits1 || err0 || err1)) continue;
+
+        const uint32_t key = (((crate << 1) | cmx) << 8) | source;
+        const HitsInfo info = { uint8_t(crate), uint8_t(cmx),
+          uint8_t(source) };
+        const int ch = stageSlice_(m_cmxCpHitsStage, key, info, range, sl,
+          HitsInfo::FIELDS);
+        if (ch < 0) {
+          ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+          return;
+        }
+        m_cmxCpHitsStage.set(ch, HitsInfo::HITS0, sl, hits0);
+        m_cmxCpHitsStage.set(ch, HitsInfo::HITS1, sl, hits1);
+        m_cmxCpHitsStage.set(ch, HitsInfo::ERROR0, sl, err0);
+        m_cmxCpHitsStage.set(ch, HitsInfo::ERROR1, sl, err1);
+      }
+    }
+  }
+}
+
+void L1CaloByteStreamReadTool::decodeJem_(int trigJem) {
+  JemSubBlockV2* const subBlock = m_jemSubBlock;
+  SliceRange range;
+  if (!prepareSubBlock_(subBlock, trigJem, range)) return;
+
+  LVL1::DataError dErr;
+  dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
+  const int ssError = dErr.error();
+  const int crate = subBlock->crate() - m_cpJepCrateOffsetHw;
+  const int module = subBlock->module();
+  const int channels = 44;
+  typedef JetElementInfo ElementInfo;
+  typedef JemEtSumsInfo SumsInfo;
+  for (int slice = range.begin; slice < range.end; ++slice) {
+    const int sl = slice - range.first;
+
+    if (m_requestedType == RequestType::JET_ELEMENT) {
+      for (int chan = 0; chan < channels; ++chan) {
+        const JemJetElement jetEle(subBlock->jetElement(slice, chan));
+        if (!(jetEle.data() || ssError)) continue;
+        double eta = 0.;
+        double phi = 0.;
+        int layer = 0;
+        if (!m_jemMaps->mapping(crate, module, chan, eta, phi, layer)
+            || layer != 0) {
+          continue;
+        }
+        const uint32_t key = m_elementKey->jeKey(phi, eta);
+        const ElementInfo info = { float(eta), float(phi), key };
+        const int je = stageSlice_(m_jetElementStage, key, info, range, sl,
+          ElementInfo::LINK_ERROR);
+        if (je < 0) {
+          ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+          return;
+        }
+        LVL1::DataError emErrBits(ssError);
+        LVL1::DataError hadErrBits(ssError);
+        const int linkError = jetEle.linkError();
+        emErrBits.set(LVL1::DataError::Parity, jetEle.emParity());
+        emErrBits.set(LVL1::DataError::LinkDown, linkError);
+        hadErrBits.set(LVL1::DataError::Parity, jetEle.hadParity());
+        hadErrBits.set(LVL1::DataError::LinkDown, linkError >> 1);
+        m_jetElementStage.set(je, ElementInfo::EM, sl, jetEle.emData());
+        m_jetElementStage.set(je, ElementInfo::HAD, sl, jetEle.hadData());
+        m_jetElementStage.set(je, ElementInfo::EM_ERROR, sl,
+          emErrBits.error());
+        m_jetElementStage.set(je, ElementInfo::HAD_ERROR, sl,
+          hadErrBits.error());
+        m_jetElementStage.set(je, ElementInfo::LINK_ERROR, sl, linkError);
+      }
+    } else {
+      const unsigned int ex = subBlock->ex(slice);
+      const unsigned int ey = subBlock->ey(slice);
+      const unsigned int et = subBlock->et(slice);
+      if (!(ex | ey | et)) continue;
+      const uint32_t key = (crate << 4) | module;
+      const SumsInfo info = { uint8_t(crate), uint8_t(module) };
+      const int sums = stageSlice_(m_jemEtSumsStage, key, info, range, sl,
+        SumsInfo::FIELDS);
+      if (sums < 0) {
+        ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+        return;
+      }
+      m_jemEtSumsStage.set(sums, SumsInfo::EX, sl, ex);
+      m_jemEtSumsStage.set(sums, SumsInfo::EY, sl, ey);
+      m_jemEtSumsStage.set(sums, SumsInfo::ET, sl, et);
+    }
+  }
+}
+
+void L1CaloByteStreamReadTool::decodeCmxJet_(int trigJem) {
+  CmxJetSubBlock* const subBlock = m_cmxJetSubBlock;
+  SliceRange range;
+  if (!prepareSubBlock_(subBlock, trigJem, range)) return;
+
+  LVL1::DataError dErr;
+  dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
+  const int ssError = dErr.error();
+  const int crate = subBlock->crate() - m_cpJepCrateOffsetHw;
+  const int summing = subBlock->cmxSumming();
+  const bool neutralFormat = subBlock->format() == L1CaloSubBlock::NEUTRAL;
+  const int modules = 16;
+  const int maxTobs = 4;
+  const int maxSource = static_cast<int>(LVL1::CMXJetHits::MAX_SOURCE);
+  typedef CmxJetTobInfo TobInfo;
+  typedef CmxJetHitsInfo HitsInfo;
+  for (int slice = range.begin; slice < range.end; ++slice) {
+    const int sl = slice - range.first;
+
+    if (m_requestedType == RequestType::CMX_JET_TOB) {
+      for (int jem = 0; jem < modules; ++jem) {
+        const unsigned int presenceMap = subBlock->presenceMap(slice, jem);
+        for (int tob = 0; tob < maxTobs; ++tob) {
+          const int energyLarge = subBlock->energyLarge(slice, jem, tob);
+          const int energySmall = subBlock->energySmall(slice, jem, tob);
+          int error = subBlock->tobError(slice, jem, tob);
+          if (energyLarge == 0 && energySmall == 0 && error == 0) break;
+          const int loc = subBlock->localCoord(slice, jem, tob);
+          const int frame = subBlock->frame(slice, jem, tob);
+          LVL1::DataError errBits(ssError);
+          if (error) {
+            errBits.set(LVL1::DataError::Parity, error);
+            if (neutralFormat) {
+              const int parity = subBlock->parityBits(slice, jem);
+              errBits.set(LVL1::DataError::ParityPhase0, parity);
+              errBits.set(LVL1::DataError::ParityPhase1, (parity >> 1));
+              errBits.set(LVL1::DataError::ParityPhase2, (parity >> 2));
+              errBits.set(LVL1::DataError::ParityPhase3, (parity >> 3));
+            }
+          }
+          error = errBits.error();
+          const uint32_t key = (((((crate << 4) | jem) << 3) | frame) << 2)
+            | loc;
+          const TobInfo info = { uint8_t(crate), uint8_t(jem),
+            uint8_t(frame), uint8_t(loc) };
+          const int tb = stageSlice_(m_cmxJetTobStage, key, info, range, sl,
+            TobInfo::FIELDS);
+          if (tb < 0) {
+            ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+            return;
+          }
+          m_cmxJetTobStage.set(tb, TobInfo::ENERGY_LARGE, sl, energyLarge);
+          m_cmxJetTobStage.set(tb, TobInfo::ENERGY_SMALL, sl, energySmall);
+          m_cmxJetTobStage.set(tb, TobInfo::TOB_ERROR, sl, error);
+          m_cmxJetTobStage.set(tb, TobInfo::PRESENCE_MAP, sl, presenceMap);
+        }
+      }
+    } else {
+      for (int source = 0; source < maxSource; ++source) {
+        if (summing == CmxSubBlock::CRATE &&
+            (source == LVL1::CMXJetHits::REMOTE_MAIN ||
+             source == LVL1::CMXJetHits::TOTAL_MAIN ||
+             source == LVL1::CMXJetHits::REMOTE_FORWARD ||
+             source == LVL1::CMXJetHits::TOTAL_FORWARD)) continue;
+        const int sourceId = JepByteStreamV2Tool::jetSubBlockSourceId(source);
+        if (sourceId == CmxJetSubBlock::MAX_SOURCE_ID) continue;
+        const unsigned int hit0 = subBlock->hits(slice, sourceId, 0);
+        const unsigned int hit1 = subBlock->hits(slice, sourceId, 1);
+        const int err0 = subBlock->hitsError(slice, sourceId, 0);
+        const int err1 = subBlock->hitsError(slice, sourceId, 1);
+        LVL1::DataError err0Bits(ssError);
+        LVL1::DataError err1Bits(ssError);
+        err0Bits.set(LVL1::DataError::Parity, err0);
+        err1Bits.set(LVL1::DataError::Parity, err1 >> 1);
+        err0Bits.set(LVL1::DataError::Overflow, err0 >> 2);
+        err1Bits.set(LVL1::DataError::Overflow, err1 >> 2);
+        const int err0Out = err0Bits.error();
+        const int err1Out = err1Bits.error();
+        if (!(hit0 || hit1 || err0Out || err1Out)) continue;
+
+        const uint32_t key = (crate << 8) | source;
+        const HitsInfo info = { uint8_t(crate), uint8_t(source) };
+        const int jh = stageSlice_(m_cmxJetHitsStage, key, info, range, sl,
+          HitsInfo::FIELDS);
+        if (jh < 0) {
+          ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+          return;
+        }
+        m_cmxJetHitsStage.set(jh, HitsInfo::HITS0, sl, hit0);
+        m_cmxJetHitsStage.set(jh, HitsInfo::HITS1, sl, hit1);
+        m_cmxJetHitsStage.set(jh, HitsInfo::ERROR0, sl, err0Out);
+        m_cmxJetHitsStage.set(jh, HitsInfo::ERROR1, sl, err1Out);
+      }
+    }
+  }
+}
+
+void L1CaloByteStreamReadTool::decodeCmxEnergy_(int trigJem) {
+  CmxEnergySubBlock* const subBlock = m_cmxEnergySubBlock;
+  SliceRange range;
+  if (!prepareSubBlock_(subBlock, trigJem, range)) return;
+
+  LVL1::DataError dErr;
+  dErr.set(LVL1::DataError::SubStatusWord, subBlock->subStatus());
+  const int ssError = dErr.error();
+  const int crate = subBlock->crate() - m_cpJepCrateOffsetHw;
+  const int summing = subBlock->cmxSumming();
+  const int modules = 16;
+  const int maxSource = static_cast<int>(LVL1::CMXEtSums::MAX_SOURCE);
+  typedef CmxEtSumsInfo Info;
+  for (int slice = range.begin; slice < range.end; ++slice) {
+    const int sl = slice - range.first;
+
+    for (int source = 0; source < maxSource; ++source) {
+      if (source >= modules && summing == CmxSubBlock::CRATE &&
+          source != LVL1::CMXEtSums::LOCAL_STANDARD &&
+          source != LVL1::CMXEtSums::LOCAL_RESTRICTED) continue;
+      unsigned int ex = 0;
+      unsigned int ey = 0;
+      unsigned int et = 0;
+      LVL1::DataError exErrBits(ssError);
+      LVL1::DataError eyErrBits(ssError);
+      LVL1::DataError etErrBits(ssError);
+      if (source < modules) {
+        ex = subBlock->energy(slice, source, CmxEnergySubBlock::ENERGY_EX);
+        ey = subBlock->energy(slice, source, CmxEnergySubBlock::ENERGY_EY);
+        et = subBlock->energy(slice, source, CmxEnergySubBlock::ENERGY_ET);
+        exErrBits.set(LVL1::DataError::Parity,
+          subBlock->error(slice, source, CmxEnergySubBlock::ENERGY_EX) >> 1);
+        eyErrBits.set(LVL1::DataError::Parity,
+          subBlock->error(slice, source, CmxEnergySubBlock::ENERGY_EY) >> 1);
+        etErrBits.set(LVL1::DataError::Parity,
+          subBlock->error(slice, source, CmxEnergySubBlock::ENERGY_ET) >> 1);
+      } else {
+        CmxEnergySubBlock::SourceType srcType =
+          CmxEnergySubBlock::MAX_SOURCE_TYPE;
+        CmxEnergySubBlock::SumType sumType = CmxEnergySubBlock::MAX_SUM_TYPE;
+        CmxEnergySubBlock::HitsType hitType = CmxEnergySubBlock::MAX_HITS_TYPE;
+        JepByteStreamV2Tool::energySubBlockTypes(source, srcType, sumType,
+          hitType);
+        if (srcType != CmxEnergySubBlock::MAX_SOURCE_TYPE) {
+          ex = subBlock->energy(slice, srcType, sumType,
+            CmxEnergySubBlock::ENERGY_EX);
+          ey = subBlock->energy(slice, srcType, sumType,
+            CmxEnergySubBlock::ENERGY_EY);
+          et = subBlock->energy(slice, srcType, sumType,
+            CmxEnergySubBlock::ENERGY_ET);
+          const int exErr = subBlock->error(slice, srcType, sumType,
+            CmxEnergySubBlock::ENERGY_EX);
+          const int eyErr = subBlock->error(slice, srcType, sumType,
+            CmxEnergySubBlock::ENERGY_EY);
+          const int etErr = subBlock->error(slice, srcType, sumType,
+            CmxEnergySubBlock::ENERGY_ET);
+          exErrBits.set(LVL1::DataError::Overflow, exErr);
+          eyErrBits.set(LVL1::DataError::Overflow, eyErr);
+          etErrBits.set(LVL1::DataError::Overflow, etErr);
+          if (srcType == CmxEnergySubBlock::REMOTE) {
+            exErrBits.set(LVL1::DataError::Parity, exErr >> 1);
+            eyErrBits.set(LVL1::DataError::Parity, eyErr >> 1);
+            etErrBits.set(LVL1::DataError::Parity, etErr >> 1);
+          }
+        } else if (hitType != CmxEnergySubBlock::MAX_HITS_TYPE) {
+          ex = subBlock->hits(slice, hitType, sumType);
+          ey = ex;
+          et = ex;
+        }
+      }
+      const int exErr = exErrBits.error();
+      const int eyErr = eyErrBits.error();
+      const int etErr = etErrBits.error();
+      if (!(ex || ey || et || exErr || eyErr || etErr)) continue;
+
+      const uint32_t key = (crate << 8) | source;
+      const Info info = { uint8_t(crate), uint8_t(source) };
+      const int sums = stageSlice_(m_cmxEtSumsStage, key, info, range, sl,
+        Info::FIELDS);
+      if (sums < 0) {
+        ATH_MSG_DEBUG("Inconsistent or duplicate data for slice " << slice);
+        return;
+      }
+      m_cmxEtSumsStage.set(sums, Info::EX, sl, ex);
+      m_cmxEtSumsStage.set(sums, Info::EY, sl, ey);
+      m_cmxEtSumsStage.set(sums, Info::ET, sl, et);
+      m_cmxEtSumsStage.set(sums, Info::EX_ERROR, sl, exErr);
+      m_cmxEtSumsStage.set(sums, Info::EY_ERROR, sl, eyErr);
+      m_cmxEtSumsStage.set(sums, Info::ET_ERROR, sl, etErr);
+    }
+  }
+}
+
+namespace {
+// Set one multi-slice xAOD quantity from its staged slices
+template <class Stage, class Obj, typename T>
+void setStaged(const Stage& stage, int index, int field, Obj* obj,
+    void (Obj::*set)(const std::vector<T>&)) {
+  std::vector<T> vec;
+  stage.fieldVec(index, field, vec);
+  (obj->*set)(vec);
+}
+
+// Add a new object to an xAOD container, which must have its store
+template <class Obj>
+Obj* addObject(DataVector<Obj>* collection) {
+  Obj* obj = new Obj();
+  collection->push_back(obj);
+  return obj;
+}
+}
+
+void L1CaloByteStreamReadTool::createStaged_() {
+  switch (m_requestedType) {
+  case RequestType::CPM: {
+    typedef CpmTowerInfo Info;
+    typedef xAOD::CPMTower Tower;
+    const L1CaloSliceStage<Info>& stage(m_cpmTowerStage);
+    m_cpmTowers->reserve(m_cpmTowers->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Tower* tt = addObject(m_cpmTowers);
+      tt->setEta(info.eta);
+      tt->setPhi(info.phi);
+      tt->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::EM, tt, &Tower::setEmEnergyVec);
+      setStaged(stage, index, Info::HAD, tt, &Tower::setHadEnergyVec);
+      setStaged(stage, index, Info::EM_ERROR, tt, &Tower::setEmErrorVec);
+      setStaged(stage, index, Info::HAD_ERROR, tt, &Tower::setHadErrorVec);
+    }
+    break;
+  }
+  case RequestType::CMX_CP_TOB: {
+    typedef CmxCpTobInfo Info;
+    typedef xAOD::CMXCPTob Tob;
+    const L1CaloSliceStage<Info>& stage(m_cmxCpTobStage);
+    m_cmxCpTobs->reserve(m_cmxCpTobs->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Tob* tb = addObject(m_cmxCpTobs);
+      tb->setCrate(info.crate);
+      tb->setCmx(info.cmx);
+      tb->setCpm(info.cpm);
+      tb->setChip(info.chip);
+      tb->setLocation(info.loc);
+      tb->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::ENERGY, tb, &Tob::setEnergyVec);
+      setStaged(stage, index, Info::ISOLATION, tb, &Tob::setIsolationVec);
+      setStaged(stage, index, Info::TOB_ERROR, tb, &Tob::setErrorVec);
+      setStaged(stage, index, Info::PRESENCE_MAP, tb,
+        &Tob::setPresenceMapVec);
+    }
+    break;
+  }
+  case RequestType::CMX_CP_HITS: {
+    typedef CmxCpHitsInfo Info;
+    typedef xAOD::CMXCPHits Hits;
+    const L1CaloSliceStage<Info>& stage(m_cmxCpHitsStage);
+    m_cmxCpHits->reserve(m_cmxCpHits->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Hits* ch = addObject(m_cmxCpHits);
+      ch->setCrate(info.crate);
+      ch->setCmx(info.cmx);
+      ch->setSourceComponent(info.source);
+      ch->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::HITS0, ch, &Hits::setHitsVec0);
+      setStaged(stage, index, Info::HITS1, ch, &Hits::setHitsVec1);
+      setStaged(stage, index, Info::ERROR0, ch, &Hits::setErrorVec0);
+      setStaged(stage, index, Info::ERROR1, ch, &Hits::setErrorVec1);
+    }
+    break;
+  }
+  case RequestType::JET_ELEMENT: {
+    typedef JetElementInfo Info;
+    typedef xAOD::JetElement Element;
+    const L1CaloSliceStage<Info>& stage(m_jetElementStage);
+    m_jetElements->reserve(m_jetElements->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Element* je = addObject(m_jetElements);
+      je->setEta(info.eta);
+      je->setPhi(info.phi);
+      je->setKey(info.key);
+      je->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::EM, je, &Element::setEmJetElementETVec);
+      setStaged(stage, index, Info::HAD, je,
+        &Element::setHadJetElementETVec);
+      setStaged(stage, index, Info::EM_ERROR, je,
+        &Element::setEmJetElementErrorVec);
+      setStaged(stage, index, Info::HAD_ERROR, je,
+        &Element::setHadJetElementErrorVec);
+      setStaged(stage, index, Info::LINK_ERROR, je,
+        &Element::setLinkErrorVec);
+    }
+    break;
+  }
+  case RequestType::JEM_ET_SUMS: {
+    typedef JemEtSumsInfo Info;
+    typedef xAOD::JEMEtSums Sums;
+    const L1CaloSliceStage<Info>& stage(m_jemEtSumsStage);
+    m_jemEtSums->reserve(m_jemEtSums->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Sums* sums = addObject(m_jemEtSums);
+      sums->setCrate(info.crate);
+      sums->setModule(info.module);
+      sums->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::EX, sums, &Sums::setExVec);
+      setStaged(stage, index, Info::EY, sums, &Sums::setEyVec);
+      setStaged(stage, index, Info::ET, sums, &Sums::setEtVec);
+    }
+    break;
+  }
+  case RequestType::CMX_JET_TOB: {
+    typedef CmxJetTobInfo Info;
+    typedef xAOD::CMXJetTob Tob;
+    const L1CaloSliceStage<Info>& stage(m_cmxJetTobStage);
+    m_cmxJetTobs->reserve(m_cmxJetTobs->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Tob* tb = addObject(m_cmxJetTobs);
+      tb->setCrate(info.crate);
+      tb->setJem(info.jem);
+      tb->setFrame(info.frame);
+      tb->setLocation(info.loc);
+      tb->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::ENERGY_LARGE, tb,
+        &Tob::setEnergyLargeVec);
+      setStaged(stage, index, Info::ENERGY_SMALL, tb,
+        &Tob::setEnergySmallVec);
+      setStaged(stage, index, Info::TOB_ERROR, tb, &Tob::setErrorVec);
+      setStaged(stage, index, Info::PRESENCE_MAP, tb,
+        &Tob::setPresenceMapVec);
+    }
+    break;
+  }
+  case RequestType::CMX_JET_HITS: {
+    typedef CmxJetHitsInfo Info;
+    typedef xAOD::CMXJetHits Hits;
+    const L1CaloSliceStage<Info>& stage(m_cmxJetHitsStage);
+    m_cmxJetHits->reserve(m_cmxJetHits->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Hits* jh = addObject(m_cmxJetHits);
+      jh->setCrate(info.crate);
+      jh->setSourceComponent(info.source);
+      jh->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::HITS0, jh, &Hits::setHitsVec0);
+      setStaged(stage, index, Info::HITS1, jh, &Hits::setHitsVec1);
+      setStaged(stage, index, Info::ERROR0, jh, &Hits::setErrorVec0);
+      setStaged(stage, index, Info::ERROR1, jh, &Hits::setErrorVec1);
+    }
+    break;
+  }
+  case RequestType::CMX_ET_SUMS: {
+    typedef CmxEtSumsInfo Info;
+    typedef xAOD::CMXEtSums Sums;
+    const L1CaloSliceStage<Info>& stage(m_cmxEtSumsStage);
+    m_cmxEtSums->reserve(m_cmxEtSums->size() + stage.size());
+    for (int index = 0; index < stage.size(); ++index) {
+      const Info& info(stage.info(index));
+      Sums* sums = addObject(m_cmxEtSums);
+      sums->setCrate(info.crate);
+      sums->setSourceComponent(info.source);
+      sums->setPeak(stage.peak(index));
+      setStaged(stage, index, Info::EX, sums, &Sums::setExVec);
+      setStaged(stage, index, Info::EY, sums, &Sums::setEyVec);
+      setStaged(stage, index, Info::ET, sums, &Sums::setEtVec);
+      setStaged(stage, index, Info::EX_ERROR, sums, &Sums::setExErrorVec);
+      setStaged(stage, index, Info::EY_ERROR, sums, &Sums::setEyErrorVec);
+      setStaged(stage, index, Info::ET_ERROR, sums, &Sums::setEtErrorVec);
+    }
+    break;
+  }
+  default:
+    break;
+  }
 }
 // ===========================================================================
 } // end namespace
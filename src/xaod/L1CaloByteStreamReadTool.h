@@ -6,12 +6,18 @@
 // STD:
 // ===========================================================================
 #include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 // ===========================================================================
 // Athena:
 // ===========================================================================
 #include "AsgTools/AsgTool.h"
+#include "AthContainers/AuxVectorBase.h"
+#include "GaudiKernel/IIncidentListener.h"
 #include "GaudiKernel/ToolHandle.h"
 #include "GaudiKernel/ServiceHandle.h"
 
@@ -23,17 +29,28 @@
 
 #include "xAODTrigL1Calo/CPMTower.h"
 #include "xAODTrigL1Calo/CPMTowerContainer.h"
+#include "xAODTrigL1Calo/CMXCPTobContainer.h"
+#include "xAODTrigL1Calo/CMXCPHitsContainer.h"
+#include "xAODTrigL1Calo/JetElementContainer.h"
+#include "xAODTrigL1Calo/JEMEtSumsContainer.h"
+#include "xAODTrigL1Calo/CMXJetTobContainer.h"
+#include "xAODTrigL1Calo/CMXJetHitsContainer.h"
+#include "xAODTrigL1Calo/CMXEtSumsContainer.h"
 
 #include "CaloUserHeader.h"
 #include "SubBlockHeader.h"
 #include "SubBlockStatus.h"
-#include "CpmWord.h"
 
 #include "../L1CaloErrorByteStreamTool.h"
+#include "../L1CaloSliceStage.h"
 
 // ===========================================================================
 // Forward declarations
 // ===========================================================================
+class Incident;
+namespace LVL1 {
+  class JetElementKey;
+}
 
 
 // ===========================================================================
@@ -41,8 +58,13 @@ namespace LVL1BS {
 
 // Forward declarations
 class L1CaloSrcIdMap;
-class CpmWord;
 class L1CaloErrorByteStreamTool;
+class L1CaloPpmVisitor;
+class CpmSubBlockV2;
+class CmxCpSubBlock;
+class JemSubBlockV2;
+class CmxJetSubBlock;
+class CmxEnergySubBlock;
 // ===========================================================================
 
 /** Tool to perform ROB fragments to trigger towers and trigger towers
@@ -52,7 +74,8 @@ class L1CaloErrorByteStreamTool;
  * @author alexander.mazurov@cern.ch
  */
 
-class L1CaloByteStreamReadTool: public asg::AsgTool {
+class L1CaloByteStreamReadTool: public asg::AsgTool,
+                                virtual public IIncidentListener {
 	ASG_TOOL_INTERFACE(L1CaloByteStreamReadTool)
 	ASG_TOOL_CLASS0(L1CaloByteStreamReadTool)
 public:
@@ -62,6 +85,9 @@ public:
   virtual StatusCode initialize();
   virtual StatusCode finalize();
 
+  /// Forget the LazyFadc records of the previous event
+  virtual void handle(const Incident& inc);
+
   // =========================================================================
   /// Convert ROB fragments to trigger towers
   StatusCode convert(
@@ -70,6 +96,11 @@ public:
   );
   StatusCode convert(xAOD::TriggerTowerContainer* const ttCollection);
   StatusCode convert(const std::string& sgKey, xAOD::TriggerTowerContainer* const ttCollection);
+  /// Decode PPM ROB fragments passing each channel to the visitor instead
+  /// of making trigger towers. All slices are decoded whatever the
+  /// SliceWindow, LutOnly and LazyFadc settings.
+  StatusCode visitPpm(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    L1CaloPpmVisitor* visitor);
   // =========================================================================
   StatusCode convert(
       const IROBDataProviderSvc::VROBFRAG& robFrags,
@@ -79,20 +110,155 @@ public:
   StatusCode convert(const std::string& sgKey,
     xAOD::CPMTowerContainer* const cpmCollection);
   // =========================================================================
+  /// Convert ROB fragments to CMX-CP TOBs
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXCPTobContainer* const tobCollection);
+  StatusCode convert(xAOD::CMXCPTobContainer* const tobCollection);
+  /// Convert ROB fragments to CMX-CP hits
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXCPHitsContainer* const hitsCollection);
+  StatusCode convert(xAOD::CMXCPHitsContainer* const hitsCollection);
+  /// Convert ROB fragments to jet elements
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::JetElementContainer* const jeCollection);
+  StatusCode convert(xAOD::JetElementContainer* const jeCollection);
+  /// Convert ROB fragments to JEM energy sums
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::JEMEtSumsContainer* const etCollection);
+  StatusCode convert(xAOD::JEMEtSumsContainer* const etCollection);
+  /// Convert ROB fragments to CMX-Jet TOBs
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXJetTobContainer* const tobCollection);
+  StatusCode convert(xAOD::CMXJetTobContainer* const tobCollection);
+  /// Convert ROB fragments to CMX-Jet hits
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXJetHitsContainer* const hitsCollection);
+  StatusCode convert(xAOD::CMXJetHitsContainer* const hitsCollection);
+  /// Convert ROB fragments to CMX energy sums
+  StatusCode convert(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    xAOD::CMXEtSumsContainer* const sumsCollection);
+  StatusCode convert(xAOD::CMXEtSumsContainer* const sumsCollection);
+  // =========================================================================
   /// Return reference to vector with all possible Source Identifiers
   const std::vector<uint32_t>& ppmSourceIDs(const std::string& sgKey);
   const std::vector<uint32_t>& cpSourceIDs();
+  const std::vector<uint32_t>& jepSourceIDs();
+  // =========================================================================
+  /// PPM channels present in the bytestream of the last event, one bit per
+  /// (crate << 10) | (module << 6) | channel. Filled if ChannelPresence set.
+  const std::vector<uint32_t>& ppmChannelPresence() const;
+  bool isPpmChannelPresent(uint8_t crate, uint8_t module,
+    uint8_t channel) const;
+  /// Decode FADC samples and pedestal correction of a tower read with
+  /// LazyFadc set. Only valid for towers converted in the current event;
+  /// fails if the tower's container was read lazily but the tower has no
+  /// record.
+  StatusCode decodeFadc(xAOD::TriggerTower* tt);
+  // =========================================================================
+  /// Keep the interface container decoded along with an aux store, so the
+  /// interface converter can take it rather than building its own
+  void keepInterface(const std::string& auxKey, SG::AuxVectorBase* container);
+  /// Take the interface container kept for the given aux store, 0 if none
+  template <class ContainerT>
+  ContainerT* takeInterface(const std::string& auxKey,
+    const SG::IConstAuxStore* aux);
 
 private:
-  enum class RequestType { PPM, CPM, CMX };
+  enum class RequestType { PPM, CPM, CMX_CP_TOB, CMX_CP_HITS, JET_ELEMENT,
+    JEM_ET_SUMS, CMX_JET_TOB, CMX_JET_HITS, CMX_ET_SUMS };
   typedef IROBDataProviderSvc::VROBFRAG::const_iterator ROBIterator;
   typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      ROBPointer;
   typedef OFFLINE_FRAGMENTS_NAMESPACE::PointerType      RODPointer;
 
+  /// Position of the FADC data of one tower in the ROB payload.
+  /// data is 0 if nothing was deferred or it has been decoded.
+  struct PpmFadcRecord {
+    RODPointer data;
+    uint32_t maxBit;
+    uint32_t adcBit;
+    uint32_t extBit;
+    uint8_t format;
+    int8_t encoding;
+    int8_t minIndex;
+    uint8_t numAdc;
+    uint8_t numLut;
+    uint8_t lowerBound;
+    uint8_t lutPeak;
+    uint8_t adcPeak;
+    int sliceWindow;
+  };
+  typedef std::unordered_map<uint32_t, PpmFadcRecord> PpmFadcRecords;
+  static const uint32_t s_noBit = 0xffffffff;
+
+  /// Slices of the current CP/JEP sub-block to convert
+  struct SliceRange {
+    int first;
+    int num;
+    int begin;
+    int end;
+    int peak;
+  };
+
+  /// Staged CPM tower data
+  struct CpmTowerInfo {
+    enum { EM, HAD, EM_ERROR, HAD_ERROR, FIELDS };
+    float eta;
+    float phi;
+  };
+  /// Staged CMX-CP TOB data
+  struct CmxCpTobInfo {
+    enum { ENERGY, ISOLATION, TOB_ERROR, PRESENCE_MAP, FIELDS };
+    uint8_t crate;
+    uint8_t cmx;
+    uint8_t cpm;
+    uint8_t chip;
+    uint8_t loc;
+  };
+  /// Staged CMX-CP hits data
+  struct CmxCpHitsInfo {
+    enum { HITS0, HITS1, ERROR0, ERROR1, FIELDS };
+    uint8_t crate;
+    uint8_t cmx;
+    uint8_t source;
+  };
+  /// Staged jet element data
+  struct JetElementInfo {
+    enum { EM, HAD, EM_ERROR, HAD_ERROR, LINK_ERROR, FIELDS };
+    float eta;
+    float phi;
+    uint32_t key;
+  };
+  /// Staged JEM energy sums data
+  struct JemEtSumsInfo {
+    enum { EX, EY, ET, FIELDS };
+    uint8_t crate;
+    uint8_t module;
+  };
+  /// Staged CMX-Jet TOB data
+  struct CmxJetTobInfo {
+    enum { ENERGY_LARGE, ENERGY_SMALL, TOB_ERROR, PRESENCE_MAP, FIELDS };
+    uint8_t crate;
+    uint8_t jem;
+    uint8_t frame;
+    uint8_t loc;
+  };
+  /// Staged CMX-Jet hits data
+  struct CmxJetHitsInfo {
+    enum { HITS0, HITS1, ERROR0, ERROR1, FIELDS };
+    uint8_t crate;
+    uint8_t source;
+  };
+  /// Staged CMX energy sums data
+  struct CmxEtSumsInfo {
+    enum { EX, EY, ET, EX_ERROR, EY_ERROR, ET_ERROR, FIELDS };
+    uint8_t crate;
+    uint8_t source;
+  };
 
 private:
   StatusCode processRobFragment_(const ROBIterator& robFrag,
       const RequestType& requestedType);
+  void processPpmRobs_(const IROBDataProviderSvc::VROBFRAG& robFrags);
   
   // ==========================================================================
   // PPM
@@ -106,13 +272,22 @@ private:
   StatusCode processPpmStandardR3V1_();
   StatusCode processPpmStandardR3V1_(uint32_t word, int indata);
   StatusCode processPpmCompressedR3V1_();
-  std::vector<uint16_t> getPpmAdcSamplesR3_(uint8_t format, uint8_t minIndex);
+  StatusCode skipPpmErrorsR3V1_(uint8_t compVersion);
+  std::vector<uint16_t> getPpmAdcSamplesR3_(uint8_t format, uint8_t minIndex,
+    int lowerBound, bool timeOrdered);
   StatusCode processPpmCompressedR4V1_();
   void interpretPpmHeaderR4V1_(uint8_t numAdc, int8_t& encoding,
     int8_t& minIndex);
-  std::vector<uint16_t> getPpmAdcSamplesR4_(uint8_t encoding, uint8_t minIndex);
+  std::vector<uint16_t> getPpmAdcSamplesR4_(uint8_t numAdc, uint8_t lowerBound,
+    uint8_t encoding, uint8_t minIndex);
   StatusCode processPpmNeutral_();
   uint32_t getPpmBytestreamField_(uint8_t numBits);
+  void skipPpmBytestreamField_(uint32_t numBits);
+  void skipPpmAdcSamplesR4_(uint8_t encoding);
+  void ppmSliceWindow_(uint8_t numSlices, uint8_t peak, int sliceWindow,
+    int& firstSlice, int& numWindow) const;
+  void setPendingFadc_(uint32_t adcBit, uint32_t extBit, int8_t encoding,
+    int8_t minIndex);
   
   StatusCode addTriggerTowerV2_(
       uint8_t crate,
@@ -129,6 +304,14 @@ private:
       const std::vector<int16_t>& pedCor,
       const std::vector<uint8_t>& pedEn);
 
+  /// Mark channel present, checking it is mapped unless already known
+  void setPpmChannelPresent_(uint8_t crate, uint8_t module, uint8_t channel,
+    bool checkMapping);
+  bool isSuppressed_(
+      const std::vector<uint8_t>& lcpVal,
+      const std::vector<uint8_t>& ljeVal,
+      const std::vector<uint16_t>& adcVal) const;
+
   StatusCode addTriggerTowerV1_(
     uint8_t crate,
     uint8_t module,
@@ -148,19 +331,31 @@ private:
   );
 
   // ==========================================================================
-  // CPM
-  // ==========================================================================
-  StatusCode processCpWord_(uint32_t word);
-  StatusCode processCpmWordR4V1_(uint32_t word);
+  // CP and JEP
   // ==========================================================================
-
-  StatusCode addCpmTower_(uint8_t crate, uint8_t module, const CpmWord& word);
+  StatusCode convertCpJep_(const IROBDataProviderSvc::VROBFRAG& robFrags,
+    RequestType requestedType);
+  void processCpJepRobFragment_(const ROBIterator& robFrag);
+  template <class SubBlock>
+  bool prepareSubBlock_(SubBlock* subBlock, int trigSlice, SliceRange& range);
+  /// Find staged object or stage a new one, -1 if inconsistent slices
+  template <class Info>
+  int stageSlice_(L1CaloSliceStage<Info>& stage, uint32_t key,
+    const Info& info, const SliceRange& range, int sl, int checkFields);
+  void decodeCpm_(int trigCpm);
+  void decodeCmxCp_(int trigCpm);
+  void decodeJem_(int trigJem);
+  void decodeCmxJet_(int trigJem);
+  void decodeCmxEnergy_(int trigJem);
+  /// Create objects from staged slices once all ROBs are unpacked
+  void createStaged_();
 private:
   ServiceHandle<SegMemSvc> m_sms;
   ToolHandle<LVL1BS::L1CaloErrorByteStreamTool> m_errorTool;
   /// Channel mapping tool
   ToolHandle<LVL1::IL1CaloMappingTool> m_ppmMaps;
   ToolHandle<LVL1::IL1CaloMappingTool> m_cpmMaps;
+  ToolHandle<LVL1::IL1CaloMappingTool> m_jemMaps;
   /// Service for reading bytestream
   ServiceHandle<IROBDataProviderSvc> m_robDataProvider;
 
@@ -179,8 +374,35 @@ private:
   bool m_ppmIsRetSpare;
   std::vector<uint32_t> m_ppmSourceIDsSpare;
   std::vector<uint32_t> m_cpSourceIDs;
+  std::vector<uint32_t> m_jepSourceIDs;
   L1CaloSrcIdMap* m_srcIdMap;
 
+  /// Zero suppression of trigger towers
+  bool m_zeroSuppress;
+  int m_zeroSuppressPedestal;
+  int m_zeroSuppressBand;
+  /// Pedestal value for Run-1 compression versions 1.00 and 1.01
+  int m_pedestal;
+  /// Number of slices either side of triggered slice to read (-1 = all)
+  int m_sliceWindow;
+  /// Decode LUT data only, skipping FADC and pedestal correction
+  bool m_lutOnly;
+  /// Defer FADC and pedestal correction decoding until requested
+  bool m_lazyFadc;
+  /// Check CP and JEP ROD structure before unpacking
+  bool m_validateRods;
+  /// FADC records by coolId of each container converted with LazyFadc
+  /// this event, kept until the next BeginEvent
+  std::map<const SG::AuxVectorData*, PpmFadcRecords> m_fadcRecords;
+  /// Records of the container being converted, 0 unless LazyFadc
+  PpmFadcRecords* m_currentFadcRecords;
+  PpmFadcRecord m_pendingFadc;
+  /// Receives PPM channels in place of trigger towers if set
+  L1CaloPpmVisitor* m_ppmVisitor;
+  /// Channel presence bitmap
+  bool m_fillChannelPresence;
+  std::vector<uint32_t> m_ppmChannelPresence;
+
   uint32_t m_rodRunNumber;
   uint16_t m_rodVer;
   uint8_t m_verCode;
@@ -190,6 +412,8 @@ private:
   // ==========================================================================
   // For RUN2
   std::vector<uint32_t> m_ppBlock;
+  RODPointer m_ppPayload;
+  const uint32_t* m_ppData;
   uint32_t m_ppPointer;
   uint32_t m_ppMaxBit;
   // For RUN1
@@ -199,8 +423,56 @@ private:
 private:
   xAOD::TriggerTowerContainer* m_triggerTowers;
   xAOD::CPMTowerContainer* m_cpmTowers;
+  xAOD::CMXCPTobContainer* m_cmxCpTobs;
+  xAOD::CMXCPHitsContainer* m_cmxCpHits;
+  xAOD::JetElementContainer* m_jetElements;
+  xAOD::JEMEtSumsContainer* m_jemEtSums;
+  xAOD::CMXJetTobContainer* m_cmxJetTobs;
+  xAOD::CMXJetHitsContainer* m_cmxJetHits;
+  xAOD::CMXEtSumsContainer* m_cmxEtSums;
+  // ==========================================================================
+  // CP and JEP related structures
+  // ==========================================================================
+  CpmSubBlockV2* m_cpmSubBlock;
+  CmxCpSubBlock* m_cmxCpSubBlock;
+  JemSubBlockV2* m_jemSubBlock;
+  CmxJetSubBlock* m_cmxJetSubBlock;
+  CmxEnergySubBlock* m_cmxEnergySubBlock;
+  LVL1::JetElementKey* m_elementKey;
+  /// Slices staged for the requested type, by object key
+  L1CaloSliceStage<CpmTowerInfo> m_cpmTowerStage;
+  L1CaloSliceStage<CmxCpTobInfo> m_cmxCpTobStage;
+  L1CaloSliceStage<CmxCpHitsInfo> m_cmxCpHitsStage;
+  L1CaloSliceStage<JetElementInfo> m_jetElementStage;
+  L1CaloSliceStage<JemEtSumsInfo> m_jemEtSumsStage;
+  L1CaloSliceStage<CmxJetTobInfo> m_cmxJetTobStage;
+  L1CaloSliceStage<CmxJetHitsInfo> m_cmxJetHitsStage;
+  L1CaloSliceStage<CmxEtSumsInfo> m_cmxEtSumsStage;
+  int m_cpJepCrateOffsetHw;
+  int m_rodErr;
+  /// Interface containers waiting for their converter, by aux key
+  std::map<std::string, std::unique_ptr<SG::AuxVectorBase> > m_interfaces;
 };
 
+// ===========================================================================
+template <class ContainerT>
+ContainerT* L1CaloByteStreamReadTool::takeInterface(const std::string& auxKey,
+    const SG::IConstAuxStore* aux) {
+  auto itr = m_interfaces.find(auxKey);
+  if (itr == m_interfaces.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<SG::AuxVectorBase> kept(std::move(itr->second));
+  m_interfaces.erase(itr);
+  // Only valid if decoded along with this aux store
+  ContainerT* container = dynamic_cast<ContainerT*>(kept.get());
+  if (container == nullptr || container->getConstStore() != aux) {
+    return nullptr;
+  }
+  kept.release();
+  return container;
+}
+
 // ===========================================================================
 }// end namespace
 // ===========================================================================
@@ -0,0 +1,72 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOBYTESTREAMXAODCNV_H
+#define TRIGT1CALOBYTESTREAM_L1CALOBYTESTREAMXAODCNV_H
+
+#include <string>
+
+#include "GaudiKernel/ClassID.h"
+#include "GaudiKernel/Converter.h"
+#include "GaudiKernel/MsgStream.h"
+#include "GaudiKernel/ServiceHandle.h"
+#include "GaudiKernel/ToolHandle.h"
+
+#include "AthenaBaseComps/AthMessaging.h"
+
+class DataObject;
+class IOpaqueAddress;
+class ISvcLocator;
+class StatusCode;
+
+template <typename> class CnvFactory;
+
+// Externals
+extern long ByteStream_StorageType;
+
+
+namespace LVL1BS {
+class L1CaloByteStreamReadTool;
+
+/** ByteStream converter for the interface of L1Calo xAOD containers.
+ *
+ *  Takes the container decoded by L1CaloByteStreamAuxCnv if there is one,
+ *  otherwise links a new container to the aux store.
+ */
+
+template<typename ContainerT, typename AuxContainerT>
+class L1CaloByteStreamxAODCnv: public Converter, public ::AthMessaging {
+
+  friend class CnvFactory<L1CaloByteStreamxAODCnv<ContainerT, AuxContainerT> >;
+
+protected:
+
+  L1CaloByteStreamxAODCnv(ISvcLocator* svcloc);
+
+public:
+
+  virtual ~L1CaloByteStreamxAODCnv(){};
+
+  virtual StatusCode initialize();
+  /// Create interface container from ByteStream
+  virtual StatusCode createObj(IOpaqueAddress* pAddr, DataObject*& pObj);
+  /// Create ByteStream from interface container
+  virtual StatusCode createRep(DataObject* pObj, IOpaqueAddress*& pAddr);
+
+  //  Storage type and class ID
+  virtual long repSvcType() const { return ByteStream_StorageType;}
+  static  long storageType(){ return ByteStream_StorageType; }
+
+  static const CLID& classID();
+
+private:
+
+  /// Converter name
+  std::string m_name;
+
+  /// Tool holding the interface container decoded by the aux converter
+  ToolHandle<L1CaloByteStreamReadTool> m_readTool;
+};
+
+} // end namespace
+
+#include "L1CaloByteStreamxAODCnv.icc"
+
+#endif
@@ -0,0 +1,74 @@
+#include <cmath>
+#include <cstring>
+
+#include "L1CaloPpmAccumulator.h"
+
+namespace LVL1BS {
+
+L1CaloPpmAccumulator::L1CaloPpmAccumulator() :
+  m_channels(s_maxChannels) {
+  reset();
+}
+
+void L1CaloPpmAccumulator::visit(uint32_t coolId,
+    const std::vector<uint16_t>& adc,
+    const std::vector<uint8_t>& lutCp,
+    const std::vector<uint8_t>& /*lutJep*/,
+    uint8_t /*adcPeak*/, uint8_t /*lutPeak*/) {
+  const int idx = index(coolId);
+  if (idx < 0) return;
+  Channel& ch = m_channels[idx];
+
+  for (auto lut : lutCp) {
+    if (lut == s_lutSaturation) ++ch.lutSaturated;
+  }
+  if (adc.empty()) return;
+
+  ++ch.entries;
+  ch.samples += adc.size();
+  size_t peak = 0;
+  for (size_t i = 0; i < adc.size(); ++i) {
+    const uint32_t val = adc[i];
+    ch.adcSum += val;
+    ch.adcSum2 += val * val;
+    if (val >= s_adcSaturation) ++ch.adcSaturated;
+    if (val > adc[peak]) peak = i;
+  }
+  if (peak < size_t(s_maxSlices)) ++ch.peakSlice[peak];
+}
+
+void L1CaloPpmAccumulator::reset() {
+  std::memset(&m_channels[0], 0, m_channels.size() * sizeof(Channel));
+}
+
+int L1CaloPpmAccumulator::index(uint32_t coolId) {
+  const uint32_t crate = coolId >> 24;
+  const uint32_t module = (coolId >> 16) & 0xf;
+  const uint32_t pin = (coolId >> 8) & 0xff;
+  const uint32_t asic = coolId & 0xff;
+  if (crate >= 8 || pin >= 16 || asic >= 4) return -1;
+  return (crate << 10) | (module << 6) | (asic * 16 + pin);
+}
+
+double L1CaloPpmAccumulator::mean(int index) const {
+  const Channel& ch = m_channels[index];
+  return ch.samples ? double(ch.adcSum) / ch.samples : 0.;
+}
+
+double L1CaloPpmAccumulator::rms(int index) const {
+  const Channel& ch = m_channels[index];
+  if (!ch.samples) return 0.;
+  const double mu = mean(index);
+  const double var = double(ch.adcSum2) / ch.samples - mu * mu;
+  return (var > 0.) ? std::sqrt(var) : 0.;
+}
+
+double L1CaloPpmAccumulator::meanPeak(int index) const {
+  const Channel& ch = m_channels[index];
+  if (!ch.entries) return -1.;
+  double sum = 0.;
+  for (int i = 0; i < s_maxSlices; ++i) sum += double(i) * ch.peakSlice[i];
+  return sum / ch.entries;
+}
+
+} // end namespace
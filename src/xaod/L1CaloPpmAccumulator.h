@@ -0,0 +1,68 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOPPMACCUMULATOR_H
+#define TRIGT1CALOBYTESTREAM_L1CALOPPMACCUMULATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "L1CaloPpmVisitor.h"
+
+namespace LVL1BS {
+
+/** Per-channel PPM monitoring sums filled straight from the bytestream.
+ *
+ *  Keeps ADC sum and sum of squares, the slice of the ADC maximum and
+ *  saturation counts for every PPM channel in fixed-size storage, so
+ *  pedestal, noise and timing histograms can be filled at the end of a
+ *  run or lumiblock without making trigger towers for each event.
+ *  Channels are indexed by (crate << 10) | (module << 6) | channel.
+ */
+
+class L1CaloPpmAccumulator: public L1CaloPpmVisitor {
+public:
+  static const int s_maxChannels = 8 << 10;
+  static const int s_maxSlices = 15;
+  static const uint16_t s_adcSaturation = 0x3ff;
+  static const uint8_t s_lutSaturation = 0xff;
+
+  struct Channel {
+    /// Number of events with ADC data
+    uint32_t entries;
+    /// Number of ADC samples summed
+    uint32_t samples;
+    uint64_t adcSum;
+    uint64_t adcSum2;
+    /// Events with the ADC maximum in each slice
+    uint32_t peakSlice[s_maxSlices];
+    /// Saturated ADC samples and CP LUT slices
+    uint32_t adcSaturated;
+    uint32_t lutSaturated;
+  };
+
+  L1CaloPpmAccumulator();
+
+  virtual void visit(uint32_t coolId,
+    const std::vector<uint16_t>& adc,
+    const std::vector<uint8_t>& lutCp,
+    const std::vector<uint8_t>& lutJep,
+    uint8_t adcPeak, uint8_t lutPeak);
+
+  /// Zero all sums
+  void reset();
+
+  /// Channel index from PPM COOL ID, -1 if out of range
+  static int index(uint32_t coolId);
+  const Channel& channel(int index) const { return m_channels[index]; }
+
+  /// Mean and RMS of ADC samples, 0 if none
+  double mean(int index) const;
+  double rms(int index) const;
+  /// Mean slice of the ADC maximum, -1 if no entries
+  double meanPeak(int index) const;
+
+private:
+  std::vector<Channel> m_channels;
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TRIGT1CALOBYTESTREAM_L1CALOPPMVISITOR_H
+#define TRIGT1CALOBYTESTREAM_L1CALOPPMVISITOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace LVL1BS {
+
+/** Interface for consumers of PPM data straight from the bytestream.
+ *
+ *  L1CaloByteStreamReadTool::visitPpm calls visit() for each channel as
+ *  it is unpacked, without making trigger towers.  The vectors are only
+ *  valid during the call and are empty if the data was not present.
+ */
+
+class L1CaloPpmVisitor {
+public:
+  virtual ~L1CaloPpmVisitor() {}
+
+  /// Receive all slices of one channel
+  virtual void visit(uint32_t coolId,
+    const std::vector<uint16_t>& adc,
+    const std::vector<uint8_t>& lutCp,
+    const std::vector<uint8_t>& lutJep,
+    uint8_t adcPeak, uint8_t lutPeak) = 0;
+};
+
+} // end namespace
+
+#endif
@@ -69,17 +69,21 @@ StatusCode PpmByteStreamAuxCnv::createObj(IOpaqueAddress* pAddr,
   ATH_MSG_DEBUG("Creating Objects " << nm);
 
   auto aux = new xAOD::TriggerTowerAuxContainer();
-  xAOD::TriggerTowerContainer ttCollection;
-  ttCollection.setStore(aux);
+  auto ttCollection = new xAOD::TriggerTowerContainer();
+  ttCollection->setStore(aux);
 
-  StatusCode sc = m_readTool->convert(nm, &ttCollection);
+  StatusCode sc = m_readTool->convert(nm, ttCollection);
   if (sc.isFailure()) {
       ATH_MSG_ERROR("Failed to create Objects");
+      delete ttCollection;
       delete aux;
       return sc;
     }
-  ATH_MSG_VERBOSE(ToString(ttCollection));
+  ATH_MSG_VERBOSE(ToString(*ttCollection));
   ATH_MSG_DEBUG("Number of readed objects: " << aux->size());
+  // The interface container goes to PpmByteStreamxAODCnv, so the towers
+  // are decoded only once
+  m_readTool->keepInterface(nm, ttCollection);
   pObj = SG::asStorable(aux);
   
   return StatusCode::SUCCESS;
@@ -25,6 +25,7 @@
 #include "xAODTrigL1Calo/TriggerTowerAuxContainer.h"
 
 #include "PpmByteStreamxAODCnv.h"
+#include "L1CaloByteStreamReadTool.h"
 
 
 namespace LVL1BS {
@@ -32,7 +33,8 @@ namespace LVL1BS {
 PpmByteStreamxAODCnv::PpmByteStreamxAODCnv(ISvcLocator* svcloc) :
     Converter(ByteStream_StorageType, classID(), svcloc),
     AthMessaging(svcloc != 0 ? msgSvc() : 0, "PpmByteStreamxAODCnv"),
-    m_name("PpmByteStreamxAODCnv")
+    m_name("PpmByteStreamxAODCnv"),
+    m_readTool("LVL1BS::L1CaloByteStreamReadTool/L1CaloByteStreamReadTool")
 {
 
 }
@@ -54,6 +56,7 @@ StatusCode PpmByteStreamxAODCnv::initialize() {
       "Initializing " << m_name << " - package version " << PACKAGE_VERSION);
 
   CHECK(Converter::initialize());
+  CHECK(m_readTool.retrieve());
   return StatusCode::SUCCESS;
 }
 
@@ -70,17 +73,21 @@ StatusCode PpmByteStreamxAODCnv::createObj(IOpaqueAddress* pAddr,
   const std::string nmAux = nm + "Aux.";
   ATH_MSG_DEBUG("Creating xAOD::TriggerTower interface objects '" << nm << "'");
 
-  xAOD::TriggerTowerContainer* const ttCollection =
-      new xAOD::TriggerTowerContainer();
-
   // Create link with AUX container
   DataLink<xAOD::TriggerTowerAuxContainer> link(nmAux);
   ATH_MSG_DEBUG("Creating store with data link to '" << nmAux);
-  
-  for(size_t i=0; i < (*link).size(); ++i){
-     ttCollection->push_back(new xAOD::TriggerTower());
+
+  // Use the container the aux converter decoded into, if any
+  xAOD::TriggerTowerContainer* ttCollection =
+      m_readTool->takeInterface<xAOD::TriggerTowerContainer>(nmAux,
+        link.cptr());
+  if (ttCollection == nullptr) {
+    ttCollection = new xAOD::TriggerTowerContainer();
+    for(size_t i=0; i < (*link).size(); ++i){
+       ttCollection->push_back(new xAOD::TriggerTower());
+    }
+    ttCollection->setStore(link);
   }
-  ttCollection->setStore(link);
   
 
   pObj = SG::asStorable(ttCollection);
@@ -67,6 +67,9 @@ public:
 private:
   /// Converter name
   std::string m_name;
+
+  /// Tool holding the interface container decoded by the aux converter
+  ToolHandle<L1CaloByteStreamReadTool> m_readTool;
 };
 
 } // end namespace
@@ -0,0 +1,355 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "xAODTrigL1Calo/TriggerTower.h"
+
+#include "PpmColumnCache.h"
+
+namespace {
+// Columns are padded to keep every array aligned
+const size_t s_align = 8;
+
+size_t padded(size_t bytes) {
+  return (bytes + s_align - 1) & ~(s_align - 1);
+}
+
+template <typename T>
+size_t columnBytes(const std::vector<T>& column) {
+  return padded(column.size() * sizeof(T));
+}
+
+template <typename T>
+void appendVec(std::vector<T>& column, const std::vector<T>& vec) {
+  column.insert(column.end(), vec.begin(), vec.end());
+}
+
+// Take a column of n entries from the block, 0 if it runs off the end
+template <typename T>
+const T* takeColumn(const uint8_t*& pos, const uint8_t* end, size_t n) {
+  const size_t bytes = padded(n * sizeof(T));
+  if (bytes > size_t(end - pos)) return nullptr;
+  const T* column = reinterpret_cast<const T*>(pos);
+  pos += bytes;
+  return column;
+}
+
+// Slices of tower t, located by its field's offsets
+template <typename T>
+std::vector<T> toVec(const T* column, const uint32_t* begin, uint32_t t) {
+  return std::vector<T>(column + begin[t], column + begin[t + 1]);
+}
+}
+
+namespace LVL1BS {
+
+// ===========================================================================
+// Writer
+
+PpmColumnCacheWriter::PpmColumnCacheWriter() :
+  m_file(nullptr), m_eventsPerBlock(1) {
+}
+
+PpmColumnCacheWriter::~PpmColumnCacheWriter() {
+  close();
+}
+
+bool PpmColumnCacheWriter::open(const std::string& fileName,
+    int eventsPerBlock) {
+  close();
+  m_file = std::fopen(fileName.c_str(), "wb");
+  m_eventsPerBlock = (eventsPerBlock > 0) ? eventsPerBlock : 1;
+  clear_();
+  return m_file != nullptr;
+}
+
+bool PpmColumnCacheWriter::add(uint32_t run, uint64_t event,
+    const xAOD::TriggerTowerContainer& towers) {
+  if (!m_file) return false;
+  m_eventNumber.push_back(event);
+  m_runNumber.push_back(run);
+  for (const xAOD::TriggerTower* tt : towers) {
+    m_coolId.push_back(tt->coolId());
+    m_eta.push_back(tt->eta());
+    m_phi.push_back(tt->phi());
+    m_error.push_back(tt->error());
+    m_peak.push_back(tt->peak());
+    m_adcPeak.push_back(tt->adcPeak());
+    // Fields are stored as they are, they need not have the same length
+    addSlices_(PPM_LUT_CP, m_lutCp, tt->lut_cp());
+    addSlices_(PPM_LUT_JEP, m_lutJep, tt->lut_jep());
+    addSlices_(PPM_CORRECTION, m_correction, tt->correction());
+    addSlices_(PPM_CORRECTION_ENABLED, m_correctionEnabled,
+      tt->correctionEnabled());
+    addSlices_(PPM_BCID_VEC, m_bcidVec, tt->bcidVec());
+    addSlices_(PPM_SAT80, m_sat80, tt->sat80Vec());
+    addSlices_(PPM_ADC, m_adc, tt->adc());
+    addSlices_(PPM_BCID_EXT, m_bcidExt, tt->bcidExt());
+  }
+  m_towerBegin.push_back(m_coolId.size());
+  if (int(m_eventNumber.size()) >= m_eventsPerBlock) return writeBlock_();
+  return true;
+}
+
+bool PpmColumnCacheWriter::close() {
+  if (!m_file) return true;
+  bool ok = m_eventNumber.empty() || writeBlock_();
+  ok = (std::fclose(m_file) == 0) && ok;
+  m_file = nullptr;
+  return ok;
+}
+
+template <typename T>
+void PpmColumnCacheWriter::addSlices_(int field, std::vector<T>& column,
+    const std::vector<T>& slices) {
+  appendVec(column, slices);
+  m_sliceBegin[field].push_back(column.size());
+}
+
+template <typename T>
+bool PpmColumnCacheWriter::writeColumn_(const std::vector<T>& column) {
+  static const uint8_t zeros[s_align] = {};
+  const size_t bytes = column.size() * sizeof(T);
+  if (bytes && std::fwrite(column.data(), 1, bytes, m_file) != bytes) {
+    return false;
+  }
+  const size_t pad = padded(bytes) - bytes;
+  return std::fwrite(zeros, 1, pad, m_file) == pad;
+}
+
+bool PpmColumnCacheWriter::writeBlock_() {
+  PpmCacheHeader header;
+  header.magic = PpmCacheHeader::s_magic;
+  header.version = PpmCacheHeader::s_version;
+  header.nEvents = m_eventNumber.size();
+  header.nTowers = m_coolId.size();
+  header.nSlices[PPM_LUT_CP] = m_lutCp.size();
+  header.nSlices[PPM_LUT_JEP] = m_lutJep.size();
+  header.nSlices[PPM_CORRECTION] = m_correction.size();
+  header.nSlices[PPM_CORRECTION_ENABLED] = m_correctionEnabled.size();
+  header.nSlices[PPM_BCID_VEC] = m_bcidVec.size();
+  header.nSlices[PPM_SAT80] = m_sat80.size();
+  header.nSlices[PPM_ADC] = m_adc.size();
+  header.nSlices[PPM_BCID_EXT] = m_bcidExt.size();
+  header.blockSize = padded(sizeof(header))
+    + columnBytes(m_eventNumber) + columnBytes(m_runNumber)
+    + columnBytes(m_towerBegin)
+    + columnBytes(m_coolId) + columnBytes(m_eta) + columnBytes(m_phi)
+    + columnBytes(m_error) + columnBytes(m_peak) + columnBytes(m_adcPeak)
+    + columnBytes(m_lutCp) + columnBytes(m_lutJep)
+    + columnBytes(m_correction) + columnBytes(m_correctionEnabled)
+    + columnBytes(m_bcidVec) + columnBytes(m_sat80)
+    + columnBytes(m_adc) + columnBytes(m_bcidExt);
+  for (int f = 0; f < PPM_SLICE_FIELDS; ++f) {
+    header.blockSize += columnBytes(m_sliceBegin[f]);
+  }
+
+  std::vector<PpmCacheHeader> hvec(1, header);
+  const bool ok = writeColumn_(hvec)
+    && writeColumn_(m_eventNumber) && writeColumn_(m_runNumber)
+    && writeColumn_(m_towerBegin)
+    && writeColumn_(m_coolId) && writeColumn_(m_eta) && writeColumn_(m_phi)
+    && writeColumn_(m_error) && writeColumn_(m_peak)
+    && writeColumn_(m_adcPeak)
+    && writeColumn_(m_sliceBegin[PPM_LUT_CP]) && writeColumn_(m_lutCp)
+    && writeColumn_(m_sliceBegin[PPM_LUT_JEP]) && writeColumn_(m_lutJep)
+    && writeColumn_(m_sliceBegin[PPM_CORRECTION])
+    && writeColumn_(m_correction)
+    && writeColumn_(m_sliceBegin[PPM_CORRECTION_ENABLED])
+    && writeColumn_(m_correctionEnabled)
+    && writeColumn_(m_sliceBegin[PPM_BCID_VEC]) && writeColumn_(m_bcidVec)
+    && writeColumn_(m_sliceBegin[PPM_SAT80]) && writeColumn_(m_sat80)
+    && writeColumn_(m_sliceBegin[PPM_ADC]) && writeColumn_(m_adc)
+    && writeColumn_(m_sliceBegin[PPM_BCID_EXT]) && writeColumn_(m_bcidExt);
+
+  clear_();
+  return ok;
+}
+
+void PpmColumnCacheWriter::clear_() {
+  m_eventNumber.clear();
+  m_runNumber.clear();
+  m_towerBegin.assign(1, 0);
+  m_coolId.clear();
+  m_eta.clear();
+  m_phi.clear();
+  m_error.clear();
+  m_peak.clear();
+  m_adcPeak.clear();
+  for (int f = 0; f < PPM_SLICE_FIELDS; ++f) m_sliceBegin[f].assign(1, 0);
+  m_lutCp.clear();
+  m_lutJep.clear();
+  m_correction.clear();
+  m_correctionEnabled.clear();
+  m_bcidVec.clear();
+  m_sat80.clear();
+  m_adc.clear();
+  m_bcidExt.clear();
+}
+
+// ===========================================================================
+// Reader
+
+PpmColumnCacheReader::PpmColumnCacheReader() :
+  m_data(nullptr), m_size(0) {
+}
+
+PpmColumnCacheReader::~PpmColumnCacheReader() {
+  close();
+}
+
+bool PpmColumnCacheReader::open(const std::string& fileName) {
+  close();
+  const int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) return false;
+  m_data = static_cast<const uint8_t*>(data);
+  m_size = st.st_size;
+
+  // Only the block headers are touched here, the columns are paged in
+  // as events are read
+  uint64_t pos = 0;
+  while (pos < m_size) {
+    if (!indexBlock_(m_data + pos, m_size - pos)) {
+      close();
+      return false;
+    }
+    pos += m_blocks.back().header->blockSize;
+  }
+  return true;
+}
+
+void PpmColumnCacheReader::close() {
+  if (m_data) {
+    ::munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_blocks.clear();
+  m_events.clear();
+}
+
+bool PpmColumnCacheReader::indexBlock_(const uint8_t* block, uint64_t size) {
+  if (size < padded(sizeof(PpmCacheHeader))) return false;
+  const PpmCacheHeader* header =
+    reinterpret_cast<const PpmCacheHeader*>(block);
+  if (header->magic != PpmCacheHeader::s_magic
+      || header->version != PpmCacheHeader::s_version
+      || header->blockSize > size) {
+    return false;
+  }
+  const uint8_t* pos = block + padded(sizeof(PpmCacheHeader));
+  const uint8_t* end = block + header->blockSize;
+  const size_t nEvents = header->nEvents;
+  const size_t nTowers = header->nTowers;
+  const size_t nOffsets = nTowers + 1;
+  const uint32_t* nSlices = header->nSlices;
+  PpmCacheColumns c;
+  c.header = header;
+  c.eventNumber = takeColumn<uint64_t>(pos, end, nEvents);
+  c.runNumber = takeColumn<uint32_t>(pos, end, nEvents);
+  c.towerBegin = takeColumn<uint32_t>(pos, end, nEvents + 1);
+  c.coolId = takeColumn<uint32_t>(pos, end, nTowers);
+  c.eta = takeColumn<float>(pos, end, nTowers);
+  c.phi = takeColumn<float>(pos, end, nTowers);
+  c.error = takeColumn<uint16_t>(pos, end, nTowers);
+  c.peak = takeColumn<uint8_t>(pos, end, nTowers);
+  c.adcPeak = takeColumn<uint8_t>(pos, end, nTowers);
+  c.sliceBegin[PPM_LUT_CP] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.lutCp = takeColumn<uint8_t>(pos, end, nSlices[PPM_LUT_CP]);
+  c.sliceBegin[PPM_LUT_JEP] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.lutJep = takeColumn<uint8_t>(pos, end, nSlices[PPM_LUT_JEP]);
+  c.sliceBegin[PPM_CORRECTION] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.correction = takeColumn<int16_t>(pos, end, nSlices[PPM_CORRECTION]);
+  c.sliceBegin[PPM_CORRECTION_ENABLED] =
+    takeColumn<uint32_t>(pos, end, nOffsets);
+  c.correctionEnabled =
+    takeColumn<uint8_t>(pos, end, nSlices[PPM_CORRECTION_ENABLED]);
+  c.sliceBegin[PPM_BCID_VEC] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.bcidVec = takeColumn<uint8_t>(pos, end, nSlices[PPM_BCID_VEC]);
+  c.sliceBegin[PPM_SAT80] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.sat80 = takeColumn<uint8_t>(pos, end, nSlices[PPM_SAT80]);
+  c.sliceBegin[PPM_ADC] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.adc = takeColumn<uint16_t>(pos, end, nSlices[PPM_ADC]);
+  c.sliceBegin[PPM_BCID_EXT] = takeColumn<uint32_t>(pos, end, nOffsets);
+  c.bcidExt = takeColumn<uint8_t>(pos, end, nSlices[PPM_BCID_EXT]);
+  // A column running off the block leaves the rest misplaced
+  bool complete = c.eventNumber && c.runNumber && c.towerBegin && c.coolId
+    && c.eta && c.phi && c.error && c.peak && c.adcPeak && c.lutCp
+    && c.lutJep && c.correction && c.correctionEnabled && c.bcidVec
+    && c.sat80 && c.adc && c.bcidExt;
+  for (int f = 0; f < PPM_SLICE_FIELDS; ++f) {
+    complete = complete && c.sliceBegin[f];
+  }
+  if (!complete || pos != end) return false;
+  // Offsets must stay inside their columns
+  if (c.towerBegin[0] != 0 || c.towerBegin[nEvents] != nTowers) return false;
+  for (size_t i = 0; i < nEvents; ++i) {
+    if (c.towerBegin[i] > c.towerBegin[i + 1]) return false;
+  }
+  for (int f = 0; f < PPM_SLICE_FIELDS; ++f) {
+    const uint32_t* begin = c.sliceBegin[f];
+    if (begin[0] != 0 || begin[nTowers] != nSlices[f]) return false;
+    for (size_t i = 0; i < nTowers; ++i) {
+      if (begin[i] > begin[i + 1]) return false;
+    }
+  }
+  const uint32_t blockIndex = m_blocks.size();
+  m_blocks.push_back(c);
+  for (uint32_t i = 0; i < nEvents; ++i) {
+    m_events.push_back(std::make_pair(blockIndex, i));
+  }
+  return true;
+}
+
+uint32_t PpmColumnCacheReader::runNumber(size_t event) const {
+  const std::pair<uint32_t, uint32_t>& ev = m_events[event];
+  return m_blocks[ev.first].runNumber[ev.second];
+}
+
+uint64_t PpmColumnCacheReader::eventNumber(size_t event) const {
+  const std::pair<uint32_t, uint32_t>& ev = m_events[event];
+  return m_blocks[ev.first].eventNumber[ev.second];
+}
+
+const PpmCacheColumns& PpmColumnCacheReader::columns(size_t event,
+    uint32_t& begin, uint32_t& end) const {
+  const std::pair<uint32_t, uint32_t>& ev = m_events[event];
+  const PpmCacheColumns& c = m_blocks[ev.first];
+  begin = c.towerBegin[ev.second];
+  end = c.towerBegin[ev.second + 1];
+  return c;
+}
+
+void PpmColumnCacheReader::fill(size_t event,
+    xAOD::TriggerTowerContainer* towers) const {
+  uint32_t begin = 0;
+  uint32_t end = 0;
+  const PpmCacheColumns& c = columns(event, begin, end);
+  towers->reserve(towers->size() + (end - begin));
+  const uint32_t* const* sb = c.sliceBegin;
+  for (uint32_t t = begin; t < end; ++t) {
+    xAOD::TriggerTower* tt = new xAOD::TriggerTower();
+    towers->push_back(tt);
+    tt->initialize(c.coolId[t], c.eta[t], c.phi[t],
+        toVec(c.lutCp, sb[PPM_LUT_CP], t),
+        toVec(c.lutJep, sb[PPM_LUT_JEP], t),
+        toVec(c.correction, sb[PPM_CORRECTION], t),
+        toVec(c.correctionEnabled, sb[PPM_CORRECTION_ENABLED], t),
+        toVec(c.bcidVec, sb[PPM_BCID_VEC], t),
+        toVec(c.adc, sb[PPM_ADC], t),
+        toVec(c.bcidExt, sb[PPM_BCID_EXT], t),
+        toVec(c.sat80, sb[PPM_SAT80], t),
+        c.error[t], c.peak[t], c.adcPeak[t]);
+  }
+}
+
+} // end namespace
@@ -0,0 +1,161 @@
+#ifndef TRIGT1CALOBYTESTREAM_PPMCOLUMNCACHE_H
+#define TRIGT1CALOBYTESTREAM_PPMCOLUMNCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "xAODTrigL1Calo/TriggerTowerContainer.h"
+
+namespace LVL1BS {
+
+/** Columnar cache file of decoded PPM trigger towers.
+ *
+ *  The file is a sequence of blocks of up to EventsPerBlock events.
+ *  Each block has a fixed header followed by one fixed-width array per
+ *  field, 8-byte aligned: per-event run/event numbers and tower offsets,
+ *  per-tower fields, then for each slice field its per-tower offsets and
+ *  its slices, all slices of a tower contiguous.  Every slice field has
+ *  its own offsets, so towers with some fields empty (Run 1, LutOnly)
+ *  are rebuilt exactly.
+ *  The reader maps the file and returns views straight into it, so
+ *  reloading costs I/O only.
+ */
+
+/// Trigger tower fields with one entry per slice
+enum PpmCacheSliceField { PPM_LUT_CP, PPM_LUT_JEP, PPM_CORRECTION,
+  PPM_CORRECTION_ENABLED, PPM_BCID_VEC, PPM_SAT80, PPM_ADC, PPM_BCID_EXT,
+  PPM_SLICE_FIELDS };
+
+/// Block header as stored in the file
+struct PpmCacheHeader {
+  static const uint32_t s_magic = 0x4b43314c;  // "L1CK"
+  static const uint32_t s_version = 2;
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nEvents;
+  uint32_t nTowers;
+  /// Total number of slices of each slice field
+  uint32_t nSlices[PPM_SLICE_FIELDS];
+  uint64_t blockSize;
+};
+
+/// View of the columns of one block in the mapped file
+struct PpmCacheColumns {
+  const PpmCacheHeader* header;
+  // Per event, towerBegin has nEvents+1 entries
+  const uint64_t* eventNumber;
+  const uint32_t* runNumber;
+  const uint32_t* towerBegin;
+  // Per tower
+  const uint32_t* coolId;
+  const float* eta;
+  const float* phi;
+  const uint16_t* error;
+  const uint8_t* peak;
+  const uint8_t* adcPeak;
+  // Offsets of each slice field, nTowers+1 entries
+  const uint32_t* sliceBegin[PPM_SLICE_FIELDS];
+  // Per slice
+  const uint8_t* lutCp;
+  const uint8_t* lutJep;
+  const int16_t* correction;
+  const uint8_t* correctionEnabled;
+  const uint8_t* bcidVec;
+  const uint8_t* sat80;
+  const uint16_t* adc;
+  const uint8_t* bcidExt;
+};
+
+/** Writes trigger towers to a PPM column cache file. */
+
+class PpmColumnCacheWriter {
+public:
+  PpmColumnCacheWriter();
+  ~PpmColumnCacheWriter();
+
+  /// Create the file, false on failure
+  bool open(const std::string& fileName, int eventsPerBlock);
+  /// Add the towers of one event
+  bool add(uint32_t run, uint64_t event,
+    const xAOD::TriggerTowerContainer& towers);
+  /// Write any pending events and close the file
+  bool close();
+  bool isOpen() const { return m_file != nullptr; }
+
+private:
+  PpmColumnCacheWriter(const PpmColumnCacheWriter&);
+  PpmColumnCacheWriter& operator=(const PpmColumnCacheWriter&);
+
+  bool writeBlock_();
+  template <typename T>
+  bool writeColumn_(const std::vector<T>& column);
+  template <typename T>
+  void addSlices_(int field, std::vector<T>& column,
+    const std::vector<T>& slices);
+  /// Reset block columns after writing
+  void clear_();
+
+  std::FILE* m_file;
+  int m_eventsPerBlock;
+
+  std::vector<uint64_t> m_eventNumber;
+  std::vector<uint32_t> m_runNumber;
+  std::vector<uint32_t> m_towerBegin;
+  std::vector<uint32_t> m_coolId;
+  std::vector<float> m_eta;
+  std::vector<float> m_phi;
+  std::vector<uint16_t> m_error;
+  std::vector<uint8_t> m_peak;
+  std::vector<uint8_t> m_adcPeak;
+  std::vector<uint32_t> m_sliceBegin[PPM_SLICE_FIELDS];
+  std::vector<uint8_t> m_lutCp;
+  std::vector<uint8_t> m_lutJep;
+  std::vector<int16_t> m_correction;
+  std::vector<uint8_t> m_correctionEnabled;
+  std::vector<uint8_t> m_bcidVec;
+  std::vector<uint8_t> m_sat80;
+  std::vector<uint16_t> m_adc;
+  std::vector<uint8_t> m_bcidExt;
+};
+
+/** Memory-maps a PPM column cache file for reading. */
+
+class PpmColumnCacheReader {
+public:
+  PpmColumnCacheReader();
+  ~PpmColumnCacheReader();
+
+  /// Map the file and index its blocks, false if missing or corrupt
+  bool open(const std::string& fileName);
+  void close();
+  bool isOpen() const { return m_data != nullptr; }
+
+  /// Number of events in the file
+  size_t events() const { return m_events.size(); }
+  uint32_t runNumber(size_t event) const;
+  uint64_t eventNumber(size_t event) const;
+  /// Columns holding an event, with its range of tower indices
+  const PpmCacheColumns& columns(size_t event, uint32_t& begin,
+    uint32_t& end) const;
+  /// Create the trigger towers of an event
+  void fill(size_t event, xAOD::TriggerTowerContainer* towers) const;
+
+private:
+  PpmColumnCacheReader(const PpmColumnCacheReader&);
+  PpmColumnCacheReader& operator=(const PpmColumnCacheReader&);
+
+  bool indexBlock_(const uint8_t* block, uint64_t size);
+
+  const uint8_t* m_data;
+  size_t m_size;
+  std::vector<PpmCacheColumns> m_blocks;
+  /// Block and position in block of each event
+  std::vector<std::pair<uint32_t, uint32_t> > m_events;
+};
+
+} // end namespace
+
+#endif
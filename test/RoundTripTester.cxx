@@ -0,0 +1,814 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "GaudiKernel/ISvcLocator.h"
+#include "GaudiKernel/MsgStream.h"
+#include "GaudiKernel/StatusCode.h"
+#include "eformat/write/eformat.h"
+
+#include "TrigT1CaloEvent/CMXCPHits.h"
+#include "TrigT1CaloEvent/CMXCPTob.h"
+#include "TrigT1CaloEvent/CMXEtSums.h"
+#include "TrigT1CaloEvent/CMXJetHits.h"
+#include "TrigT1CaloEvent/CMXJetTob.h"
+#include "TrigT1CaloEvent/CPBSCollectionV2.h"
+#include "TrigT1CaloEvent/CPMTower.h"
+#include "TrigT1CaloEvent/JEMEtSums.h"
+#include "TrigT1CaloEvent/JEPBSCollectionV2.h"
+#include "TrigT1CaloEvent/JetElement.h"
+#include "TrigT1CaloEvent/TriggerTower.h"
+#include "TrigT1CaloMappingToolInterfaces/IL1CaloMappingTool.h"
+#include "TrigT1CaloUtils/DataError.h"
+#include "TrigT1CaloUtils/JetElementKey.h"
+#include "TrigT1CaloUtils/TriggerTowerKey.h"
+#include "TrigT1Interfaces/TrigT1CaloDefs.h"
+
+#include "xAODTrigL1Calo/CPMTowerAuxContainer.h"
+#include "xAODTrigL1Calo/CPMTowerContainer.h"
+#include "xAODTrigL1Calo/JEMEtSumsAuxContainer.h"
+#include "xAODTrigL1Calo/JEMEtSumsContainer.h"
+#include "xAODTrigL1Calo/JetElementAuxContainer.h"
+#include "xAODTrigL1Calo/JetElementContainer.h"
+#include "xAODTrigL1Calo/TriggerTowerAuxContainer.h"
+#include "xAODTrigL1Calo/TriggerTowerContainer.h"
+
+#include "../src/CpByteStreamV2Tool.h"
+#include "../src/JepByteStreamV2Tool.h"
+#include "../src/PpmByteStreamV1Tool.h"
+#include "../src/PpmByteStreamV2Tool.h"
+#include "../src/xaod/L1CaloByteStreamReadTool.h"
+
+#include "RoundTripTester.h"
+
+namespace {
+
+const int s_ppmCrates   = 8;
+const int s_ppmModules  = 16;
+const int s_ppmChannels = 64;
+const int s_cpmCrates   = 4;
+const int s_cpmModules  = 14;
+const int s_cpmChannels = 64;
+const int s_jemCrates   = 2;
+const int s_jemModules  = 16;
+const int s_jemChannels = 44;
+
+const int          s_maxTowerEnergy   = 0xff;
+const int          s_maxElementEnergy = 0x1ff;
+const unsigned int s_energySumMask    = 0x3fff;
+const int          s_maxAdc           = 0x3ff;
+
+typedef std::chrono::steady_clock Clock;
+
+/// Microseconds since start
+double elapsed(const Clock::time_point& start)
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+/// Compare vectors of different integer types element by element
+template <typename T1, typename T2>
+bool sameVec(const std::vector<T1>& vec1, const std::vector<T2>& vec2)
+{
+  if (vec1.size() != vec2.size()) return false;
+  for (size_t i = 0; i < vec1.size(); ++i) {
+    if (static_cast<long>(vec1[i]) != static_cast<long>(vec2[i])) return false;
+  }
+  return true;
+}
+
+} // end anonymous namespace
+
+namespace LVL1BS {
+
+RoundTripTester::RoundTripTester(const std::string& name,
+                                 ISvcLocator* pSvcLocator)
+                 : AthAlgorithm(name, pSvcLocator),
+  m_ppmTool("LVL1BS::PpmByteStreamV1Tool/PpmByteStreamV1Tool"),
+  m_ppmXaodTool("LVL1BS::PpmByteStreamV2Tool/PpmByteStreamV2Tool"),
+  m_cpTool("LVL1BS::CpByteStreamV2Tool/CpByteStreamV2Tool"),
+  m_jepTool("LVL1BS::JepByteStreamV2Tool/JepByteStreamV2Tool"),
+  m_readTool("LVL1BS::L1CaloByteStreamReadTool/L1CaloByteStreamReadTool"),
+  m_ppmMaps("LVL1::PpmMappingTool/PpmMappingTool"),
+  m_cpmMaps("LVL1::CpmMappingTool/CpmMappingTool"),
+  m_jemMaps("LVL1::JemMappingTool/JemMappingTool"),
+  m_towerKey(0), m_elementKey(0), m_mismatches(0), m_eventMismatches(0)
+{
+  declareProperty("PpmByteStreamV1Tool", m_ppmTool);
+  declareProperty("PpmByteStreamV2Tool", m_ppmXaodTool);
+  declareProperty("CpByteStreamV2Tool",  m_cpTool);
+  declareProperty("JepByteStreamV2Tool", m_jepTool);
+  declareProperty("L1CaloByteStreamReadTool", m_readTool);
+  declareProperty("PpmMappingTool", m_ppmMaps);
+  declareProperty("CpmMappingTool", m_cpmMaps);
+  declareProperty("JemMappingTool", m_jemMaps);
+
+  declareProperty("RandomSeed",  m_seed        = 12345);
+  declareProperty("SlicesLUT",   m_slicesLut   = 1);
+  declareProperty("SlicesFADC",  m_slicesFadc  = 5);
+  declareProperty("SlicesCPJEP", m_slicesCpJep = 1);
+  declareProperty("Occupancy",   m_occupancy   = 0.05,
+                  "Fraction of channels with energy");
+  declareProperty("MeanEnergy",  m_meanEnergy  = 5.,
+                  "Mean energy (GeV) of channels with energy");
+  declareProperty("ErrorRate",   m_errorRate   = 0.001,
+                  "Fraction of channels with energy given a parity error");
+  declareProperty("Pedestal",    m_pedestal    = 32);
+  declareProperty("Noise",       m_noise       = 1.);
+  declareProperty("AbortOnMismatch",  m_abortOnMismatch = true);
+  declareProperty("MaxMismatchPrint", m_maxPrint        = 20);
+}
+
+RoundTripTester::~RoundTripTester()
+{
+}
+
+// Initialize
+
+#ifndef PACKAGE_VERSION
+#define PACKAGE_VERSION "unknown"
+#endif
+
+StatusCode RoundTripTester::initialize()
+{
+  msg(MSG::INFO) << "Initializing " << name() << " - package version "
+                 << /* version() */ PACKAGE_VERSION << endreq;
+
+  StatusCode sc = m_ppmTool.retrieve();
+  if (sc.isSuccess()) sc = m_ppmXaodTool.retrieve();
+  if (sc.isSuccess()) sc = m_cpTool.retrieve();
+  if (sc.isSuccess()) sc = m_jepTool.retrieve();
+  if (sc.isSuccess()) sc = m_readTool.retrieve();
+  if (sc.isSuccess()) sc = m_ppmMaps.retrieve();
+  if (sc.isSuccess()) sc = m_cpmMaps.retrieve();
+  if (sc.isSuccess()) sc = m_jemMaps.retrieve();
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Failed to retrieve tools" << endreq;
+    return sc;
+  }
+
+  m_towerKey   = new LVL1::TriggerTowerKey();
+  m_elementKey = new LVL1::JetElementKey();
+  m_random.seed(m_seed);
+
+  // Tower key and layer of each PPM channel, by cool ID as in xAOD
+
+  for (int crate = 0; crate < s_ppmCrates; ++crate) {
+    for (int module = 0; module < s_ppmModules; ++module) {
+      for (int channel = 0; channel < s_ppmChannels; ++channel) {
+        double eta = 0.;
+	double phi = 0.;
+	int layer = 0;
+	if (!m_ppmMaps->mapping(crate, module, channel, eta, phi, layer)) {
+	  continue;
+        }
+	const unsigned int coolId = (crate << 24) | (1 << 20) | (module << 16)
+	                          | ((channel % 16) << 8) | (channel / 16);
+        m_coolIdMap.insert(std::make_pair(coolId,
+	                   std::make_pair(m_towerKey->ttKey(phi, eta), layer)));
+      }
+    }
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+// Execute
+
+StatusCode RoundTripTester::execute()
+{
+  m_eventMismatches = 0;
+
+  StatusCode sc = testPpm();
+  if (sc.isSuccess()) sc = testCp();
+  if (sc.isSuccess()) sc = testJep();
+  if (sc.isFailure()) return sc;
+
+  if (m_eventMismatches) {
+    msg(MSG::ERROR) << m_eventMismatches << " mismatches in this event"
+                    << endreq;
+    if (m_abortOnMismatch) return StatusCode::FAILURE;
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+// Finalize
+
+StatusCode RoundTripTester::finalize()
+{
+  printTiming("PPM", m_ppmTiming);
+  printTiming("CP",  m_cpTiming);
+  printTiming("JEP", m_jepTiming);
+  msg(MSG::INFO) << "Total mismatches: " << m_mismatches << endreq;
+
+  delete m_elementKey;
+  delete m_towerKey;
+
+  return StatusCode::SUCCESS;
+}
+
+// Encode and decode trigger towers
+
+StatusCode RoundTripTester::testPpm()
+{
+  TriggerTowerCollection ttIn;
+  makeTriggerTowers(&ttIn);
+
+  RawEventWrite re;
+  Clock::time_point start = Clock::now();
+  StatusCode sc = m_ppmTool->convert(&ttIn, &re);
+  m_ppmTiming.encode += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Trigger tower encoding failed" << endreq;
+    return sc;
+  }
+  m_ppmTiming.words += readBack(&re);
+  ++m_ppmTiming.events;
+
+  // Legacy tool, towers owned by the tool
+  TriggerTowerCollection ttLegacy(SG::VIEW_ELEMENTS);
+  m_ppmTool->sourceIDs(LVL1::TrigT1CaloDefs::TriggerTowerLocation);
+  start = Clock::now();
+  sc = m_ppmTool->convert(m_robFrags, &ttLegacy);
+  m_ppmTiming.decodeLegacy += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Legacy trigger tower decoding failed" << endreq;
+    return sc;
+  }
+
+  // Legacy xAOD tool
+  xAOD::TriggerTowerAuxContainer legacyAux;
+  xAOD::TriggerTowerContainer ttLegacyXaod;
+  ttLegacyXaod.setStore(&legacyAux);
+  m_ppmXaodTool->sourceIDs(LVL1::TrigT1CaloDefs::xAODTriggerTowerLocation);
+  start = Clock::now();
+  sc = m_ppmXaodTool->convert(m_robFrags, &ttLegacyXaod);
+  m_ppmTiming.decodeLegacyXaod += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Legacy xAOD trigger tower decoding failed" << endreq;
+    return sc;
+  }
+
+  // xAOD reader
+  xAOD::TriggerTowerAuxContainer aux;
+  xAOD::TriggerTowerContainer ttXaod;
+  ttXaod.setStore(&aux);
+  m_readTool->ppmSourceIDs(LVL1::TrigT1CaloDefs::xAODTriggerTowerLocation);
+  start = Clock::now();
+  sc = m_readTool->convert(m_robFrags, &ttXaod);
+  m_ppmTiming.decodeXaod += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "xAOD trigger tower decoding failed" << endreq;
+    return sc;
+  }
+
+  // Legacy towers against input
+
+  std::map<unsigned int, const LVL1::TriggerTower*> inMap;
+  for (const LVL1::TriggerTower* tt : ttIn) inMap[tt->key()] = tt;
+  check(ttLegacy.size() == ttIn.size(), "PPM", "legacy tower count", 0);
+  for (const LVL1::TriggerTower* tt : ttLegacy) {
+    const unsigned int key = tt->key();
+    auto itr = inMap.find(key);
+    if (!check(itr != inMap.end(), "PPM", "legacy tower key", key)) continue;
+    const LVL1::TriggerTower* const in = itr->second;
+    check(sameVec(tt->emLUT(), in->emLUT())
+          && sameVec(tt->emADC(), in->emADC())
+          && sameVec(tt->emBCIDvec(), in->emBCIDvec())
+          && sameVec(tt->emBCIDext(), in->emBCIDext())
+          && tt->emError() == in->emError()
+          && tt->emPeak() == in->emPeak()
+          && tt->emADCPeak() == in->emADCPeak(),
+          "PPM", "legacy EM tower", key);
+    check(sameVec(tt->hadLUT(), in->hadLUT())
+          && sameVec(tt->hadADC(), in->hadADC())
+          && sameVec(tt->hadBCIDvec(), in->hadBCIDvec())
+          && sameVec(tt->hadBCIDext(), in->hadBCIDext())
+          && tt->hadError() == in->hadError()
+          && tt->hadPeak() == in->hadPeak()
+          && tt->hadADCPeak() == in->hadADCPeak(),
+          "PPM", "legacy Had tower", key);
+  }
+
+  // xAOD reader towers against input
+
+  std::map<unsigned int, const xAOD::TriggerTower*> xaodMap;
+  for (const xAOD::TriggerTower* tt : ttXaod) xaodMap[tt->coolId()] = tt;
+  check(xaodMap.size() == m_coolIdMap.size(), "PPM", "xAOD tower count", 0);
+  for (const xAOD::TriggerTower* tt : ttXaod) {
+    const unsigned int coolId = tt->coolId();
+    auto itc = m_coolIdMap.find(coolId);
+    if (!check(itc != m_coolIdMap.end(), "PPM", "xAOD cool ID", coolId)) {
+      continue;
+    }
+    auto itr = inMap.find(itc->second.first);
+    if (!check(itr != inMap.end(), "PPM", "xAOD tower key", coolId)) continue;
+    const LVL1::TriggerTower* const in = itr->second;
+    const bool em = (itc->second.second == 0);
+    check(sameVec(tt->lut_cp(), (em) ? in->emLUT() : in->hadLUT())
+          && sameVec(tt->adc(), (em) ? in->emADC() : in->hadADC())
+          && sameVec(tt->bcidVec(), (em) ? in->emBCIDvec() : in->hadBCIDvec())
+          && sameVec(tt->bcidExt(), (em) ? in->emBCIDext() : in->hadBCIDext())
+          && tt->peak() == ((em) ? in->emPeak() : in->hadPeak())
+          && tt->adcPeak() == ((em) ? in->emADCPeak() : in->hadADCPeak()),
+          "PPM", "xAOD tower", coolId);
+  }
+
+  // Legacy xAOD towers against xAOD reader
+
+  size_t legacyCount = 0;
+  for (const xAOD::TriggerTower* tt : ttLegacyXaod) {
+    const unsigned int coolId = tt->coolId();
+    if (coolId == 0) continue;   // unused pool entry
+    ++legacyCount;
+    auto itr = xaodMap.find(coolId);
+    if (!check(itr != xaodMap.end(), "PPM", "legacy xAOD cool ID", coolId)) {
+      continue;
+    }
+    const xAOD::TriggerTower* const tt2 = itr->second;
+    check(sameVec(tt->lut_cp(), tt2->lut_cp())
+          && sameVec(tt->lut_jep(), tt2->lut_jep())
+          && sameVec(tt->correction(), tt2->correction())
+          && sameVec(tt->correctionEnabled(), tt2->correctionEnabled())
+          && sameVec(tt->bcidVec(), tt2->bcidVec())
+          && sameVec(tt->adc(), tt2->adc())
+          && sameVec(tt->bcidExt(), tt2->bcidExt())
+          && sameVec(tt->sat80Vec(), tt2->sat80Vec())
+          && tt->errorWord() == tt2->errorWord()
+          && tt->peak() == tt2->peak()
+          && tt->adcPeak() == tt2->adcPeak(),
+          "PPM", "legacy xAOD tower", coolId);
+  }
+  check(legacyCount == xaodMap.size(), "PPM", "legacy xAOD tower count", 0);
+
+  return StatusCode::SUCCESS;
+}
+
+// Encode and decode CPM towers
+
+StatusCode RoundTripTester::testCp()
+{
+  CpmTowerCollection towers;
+  const DataVector<LVL1::CMXCPTob>  tobs;
+  const DataVector<LVL1::CMXCPHits> hits;
+  makeCpmTowers(&towers);
+  const LVL1::CPBSCollectionV2 cp(&towers, &tobs, &hits);
+
+  RawEventWrite re;
+  Clock::time_point start = Clock::now();
+  StatusCode sc = m_cpTool->convert(&cp, &re);
+  m_cpTiming.encode += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "CPM tower encoding failed" << endreq;
+    return sc;
+  }
+  m_cpTiming.words += readBack(&re);
+  ++m_cpTiming.events;
+
+  CpmTowerCollection towersLegacy;
+  m_cpTool->sourceIDs(LVL1::TrigT1CaloDefs::CPMTowerLocation);
+  start = Clock::now();
+  sc = m_cpTool->convert(m_robFrags, &towersLegacy);
+  m_cpTiming.decodeLegacy += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Legacy CPM tower decoding failed" << endreq;
+    return sc;
+  }
+
+  xAOD::CPMTowerAuxContainer aux;
+  xAOD::CPMTowerContainer towersXaod;
+  towersXaod.setStore(&aux);
+  start = Clock::now();
+  sc = m_readTool->convert(m_robFrags, &towersXaod);
+  m_cpTiming.decodeXaod += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "xAOD CPM tower decoding failed" << endreq;
+    return sc;
+  }
+
+  std::map<unsigned int, const LVL1::CPMTower*> inMap;
+  for (const LVL1::CPMTower* tt : towers) {
+    inMap[m_towerKey->ttKey(tt->phi(), tt->eta())] = tt;
+  }
+
+  check(towersLegacy.size() == towers.size(), "CP", "legacy tower count", 0);
+  for (const LVL1::CPMTower* tt : towersLegacy) {
+    const unsigned int key = m_towerKey->ttKey(tt->phi(), tt->eta());
+    auto itr = inMap.find(key);
+    if (!check(itr != inMap.end(), "CP", "legacy tower key", key)) continue;
+    const LVL1::CPMTower* const in = itr->second;
+    check(sameVec(tt->emEnergyVec(), in->emEnergyVec())
+          && sameVec(tt->hadEnergyVec(), in->hadEnergyVec())
+          && sameVec(tt->emErrorVec(), in->emErrorVec())
+          && sameVec(tt->hadErrorVec(), in->hadErrorVec())
+          && tt->peak() == in->peak(),
+          "CP", "legacy tower", key);
+  }
+
+  check(towersXaod.size() == towers.size(), "CP", "xAOD tower count", 0);
+  for (const xAOD::CPMTower* tt : towersXaod) {
+    const unsigned int key = m_towerKey->ttKey(tt->phi(), tt->eta());
+    auto itr = inMap.find(key);
+    if (!check(itr != inMap.end(), "CP", "xAOD tower key", key)) continue;
+    const LVL1::CPMTower* const in = itr->second;
+    check(sameVec(tt->emEnergyVec(), in->emEnergyVec())
+          && sameVec(tt->hadEnergyVec(), in->hadEnergyVec())
+          && sameVec(tt->emErrorVec(), in->emErrorVec())
+          && sameVec(tt->hadErrorVec(), in->hadErrorVec())
+          && tt->peak() == in->peak(),
+          "CP", "xAOD tower", key);
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+// Encode and decode jet elements and energy sums
+
+StatusCode RoundTripTester::testJep()
+{
+  JetElementCollection elements;
+  EnergySumsCollection sums;
+  const DataVector<LVL1::CMXJetTob>  tobs;
+  const DataVector<LVL1::CMXJetHits> hits;
+  const DataVector<LVL1::CMXEtSums>  cmxSums;
+  makeJetElements(&elements, &sums);
+  const LVL1::JEPBSCollectionV2 jep(&elements, &sums, &tobs, &hits, &cmxSums);
+
+  RawEventWrite re;
+  Clock::time_point start = Clock::now();
+  StatusCode sc = m_jepTool->convert(&jep, &re);
+  m_jepTiming.encode += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Jet element encoding failed" << endreq;
+    return sc;
+  }
+  m_jepTiming.words += readBack(&re);
+  ++m_jepTiming.events;
+
+  JetElementCollection elementsLegacy;
+  EnergySumsCollection sumsLegacy;
+  m_jepTool->sourceIDs(LVL1::TrigT1CaloDefs::JetElementLocation);
+  start = Clock::now();
+  sc = m_jepTool->convert(m_robFrags, &elementsLegacy);
+  if (sc.isSuccess()) sc = m_jepTool->convert(m_robFrags, &sumsLegacy);
+  m_jepTiming.decodeLegacy += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "Legacy jet element decoding failed" << endreq;
+    return sc;
+  }
+
+  xAOD::JetElementAuxContainer elementsAux;
+  xAOD::JetElementContainer elementsXaod;
+  elementsXaod.setStore(&elementsAux);
+  xAOD::JEMEtSumsAuxContainer sumsAux;
+  xAOD::JEMEtSumsContainer sumsXaod;
+  sumsXaod.setStore(&sumsAux);
+  start = Clock::now();
+  sc = m_readTool->convert(m_robFrags, &elementsXaod);
+  if (sc.isSuccess()) sc = m_readTool->convert(m_robFrags, &sumsXaod);
+  m_jepTiming.decodeXaod += elapsed(start);
+  if (sc.isFailure()) {
+    msg(MSG::ERROR) << "xAOD jet element decoding failed" << endreq;
+    return sc;
+  }
+
+  // Jet elements
+
+  std::map<unsigned int, const LVL1::JetElement*> inMap;
+  for (const LVL1::JetElement* je : elements) inMap[je->key()] = je;
+
+  check(elementsLegacy.size() == elements.size(), "JEP",
+        "legacy jet element count", 0);
+  for (const LVL1::JetElement* je : elementsLegacy) {
+    const unsigned int key = je->key();
+    auto itr = inMap.find(key);
+    if (!check(itr != inMap.end(), "JEP", "legacy jet element key", key)) {
+      continue;
+    }
+    const LVL1::JetElement* const in = itr->second;
+    check(sameVec(je->emEnergyVec(), in->emEnergyVec())
+          && sameVec(je->hadEnergyVec(), in->hadEnergyVec())
+          && sameVec(je->emErrorVec(), in->emErrorVec())
+          && sameVec(je->hadErrorVec(), in->hadErrorVec())
+          && sameVec(je->linkErrorVec(), in->linkErrorVec())
+          && je->peak() == in->peak(),
+          "JEP", "legacy jet element", key);
+  }
+
+  check(elementsXaod.size() == elements.size(), "JEP",
+        "xAOD jet element count", 0);
+  for (const xAOD::JetElement* je : elementsXaod) {
+    const unsigned int key = je->key();
+    auto itr = inMap.find(key);
+    if (!check(itr != inMap.end(), "JEP", "xAOD jet element key", key)) {
+      continue;
+    }
+    const LVL1::JetElement* const in = itr->second;
+    check(sameVec(je->emJetElementETVec(), in->emEnergyVec())
+          && sameVec(je->hadJetElementETVec(), in->hadEnergyVec())
+          && sameVec(je->emJetElementErrorVec(), in->emErrorVec())
+          && sameVec(je->hadJetElementErrorVec(), in->hadErrorVec())
+          && sameVec(je->linkErrorVec(), in->linkErrorVec())
+          && je->peak() == in->peak(),
+          "JEP", "xAOD jet element", key);
+  }
+
+  // Energy sums
+
+  std::map<unsigned int, const LVL1::JEMEtSums*> sumsMap;
+  for (const LVL1::JEMEtSums* et : sums) {
+    sumsMap[et->crate() * s_jemModules + et->module()] = et;
+  }
+
+  check(sumsLegacy.size() == sums.size(), "JEP", "legacy energy sums count", 0);
+  for (const LVL1::JEMEtSums* et : sumsLegacy) {
+    const unsigned int key = et->crate() * s_jemModules + et->module();
+    auto itr = sumsMap.find(key);
+    if (!check(itr != sumsMap.end(), "JEP", "legacy energy sums module", key)) {
+      continue;
+    }
+    const LVL1::JEMEtSums* const in = itr->second;
+    check(sameVec(et->EtVec(), in->EtVec())
+          && sameVec(et->ExVec(), in->ExVec())
+          && sameVec(et->EyVec(), in->EyVec())
+          && et->peak() == in->peak(),
+          "JEP", "legacy energy sums", key);
+  }
+
+  check(sumsXaod.size() == sums.size(), "JEP", "xAOD energy sums count", 0);
+  for (const xAOD::JEMEtSums* et : sumsXaod) {
+    const unsigned int key = et->crate() * s_jemModules + et->module();
+    auto itr = sumsMap.find(key);
+    if (!check(itr != sumsMap.end(), "JEP", "xAOD energy sums module", key)) {
+      continue;
+    }
+    const LVL1::JEMEtSums* const in = itr->second;
+    check(sameVec(et->etVec(), in->EtVec())
+          && sameVec(et->exVec(), in->ExVec())
+          && sameVec(et->eyVec(), in->EyVec())
+          && et->peak() == in->peak(),
+          "JEP", "xAOD energy sums", key);
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+// Generate trigger towers for all mapped PPM channels
+
+void RoundTripTester::makeTriggerTowers(TriggerTowerCollection* const ttCollection)
+{
+  std::map<unsigned int, LVL1::TriggerTower*> ttMap;
+  const std::vector<int> dummy;
+  std::vector<int> lut;
+  std::vector<int> bcidLut;
+  std::vector<int> fadc;
+  std::vector<int> bcidFadc;
+  const int peakLut  = m_slicesLut / 2;
+  const int peakFadc = m_slicesFadc / 2;
+  for (int crate = 0; crate < s_ppmCrates; ++crate) {
+    for (int module = 0; module < s_ppmModules; ++module) {
+      for (int channel = 0; channel < s_ppmChannels; ++channel) {
+        double eta = 0.;
+	double phi = 0.;
+	int layer = 0;
+	if (!m_ppmMaps->mapping(crate, module, channel, eta, phi, layer)) {
+	  continue;
+        }
+	const unsigned int key = m_towerKey->ttKey(phi, eta);
+	LVL1::TriggerTower* tt = 0;
+	std::map<unsigned int, LVL1::TriggerTower*>::iterator itt =
+	                                                       ttMap.find(key);
+	if (itt == ttMap.end()) {
+	  tt = new LVL1::TriggerTower(phi, eta, key,
+	                              dummy, dummy, dummy, dummy, 0, 0, 0,
+	                              dummy, dummy, dummy, dummy, 0, 0, 0);
+          ttMap.insert(std::make_pair(key, tt));
+	  ttCollection->push_back(tt);
+        } else tt = itt->second;
+	makePulse(lut, bcidLut, fadc, bcidFadc);
+	if (layer == 0) {
+	  tt->addEM(fadc, lut, bcidFadc, bcidLut, 0, peakLut, peakFadc);
+        } else {
+	  tt->addHad(fadc, lut, bcidFadc, bcidLut, 0, peakLut, peakFadc);
+        }
+      }
+    }
+  }
+}
+
+// Generate FADC and LUT slices for one channel.
+// Pedestal plus noise, with a pulse of about 4 ADC counts per GeV on the
+// triggered slice for channels with energy.
+
+void RoundTripTester::makePulse(std::vector<int>& lut,
+                                std::vector<int>& bcidLut,
+                                std::vector<int>& fadc,
+				std::vector<int>& bcidFadc)
+{
+  static const int shapeSize = 3;
+  static const double shape[shapeSize] = { 1., 0.45, 0.1 };
+  std::normal_distribution<double> noise(m_pedestal, m_noise);
+  const int peakLut  = m_slicesLut / 2;
+  const int peakFadc = m_slicesFadc / 2;
+  const int et = randomEnergy(s_maxTowerEnergy);
+  fadc.resize(m_slicesFadc);
+  bcidFadc.assign(m_slicesFadc, 0);
+  for (int sl = 0; sl < m_slicesFadc; ++sl) {
+    double adc = noise(m_random);
+    const int dist = std::abs(sl - peakFadc);
+    if (et && dist < shapeSize) adc += 4. * et * shape[dist];
+    fadc[sl] = std::min(std::max(int(std::lround(adc)), 0), s_maxAdc);
+  }
+  lut.assign(m_slicesLut, 0);
+  bcidLut.assign(m_slicesLut, 0);
+  if (et) {
+    lut[peakLut] = et;
+    bcidLut[peakLut] = 0x4;
+  }
+}
+
+// Generate CPM towers
+
+void RoundTripTester::makeCpmTowers(CpmTowerCollection* const cpmCollection)
+{
+  std::vector<int> emEnergy;
+  std::vector<int> hadEnergy;
+  std::vector<int> emError;
+  std::vector<int> hadError;
+  const int peak = m_slicesCpJep / 2;
+  for (int crate = 0; crate < s_cpmCrates; ++crate) {
+    for (int module = 1; module <= s_cpmModules; ++module) {
+      for (int chan = 0; chan < s_cpmChannels; ++chan) {
+        double eta = 0.;
+	double phi = 0.;
+	int layer = 0;
+	if (!m_cpmMaps->mapping(crate, module, chan, eta, phi, layer)
+	    || layer != 0) continue;
+        const int em  = randomEnergy(s_maxTowerEnergy);
+	const int had = randomEnergy(s_maxTowerEnergy);
+	if (!em && !had) continue;
+	emEnergy.assign(m_slicesCpJep, 0);
+	hadEnergy.assign(m_slicesCpJep, 0);
+	emError.assign(m_slicesCpJep, 0);
+	hadError.assign(m_slicesCpJep, 0);
+	emEnergy[peak]  = em;
+	hadEnergy[peak] = had;
+	if (em)  emError[peak]  = randomError();
+	if (had) hadError[peak] = randomError();
+	cpmCollection->push_back(new LVL1::CPMTower(phi, eta,
+	                         emEnergy, emError, hadEnergy, hadError, peak));
+      }
+    }
+  }
+}
+
+// Generate jet elements and the JEM energy sums they add up to
+
+void RoundTripTester::makeJetElements(JetElementCollection* const jeCollection,
+                                      EnergySumsCollection* const etCollection)
+{
+  std::vector<int> emEnergy;
+  std::vector<int> hadEnergy;
+  std::vector<int> emError;
+  std::vector<int> hadError;
+  const std::vector<int> linkError(m_slicesCpJep, 0);
+  std::vector<unsigned int> etVec;
+  std::vector<unsigned int> exVec;
+  std::vector<unsigned int> eyVec;
+  const int peak = m_slicesCpJep / 2;
+  for (int crate = 0; crate < s_jemCrates; ++crate) {
+    for (int module = 0; module < s_jemModules; ++module) {
+      unsigned int et = 0;
+      double ex = 0.;
+      double ey = 0.;
+      for (int chan = 0; chan < s_jemChannels; ++chan) {
+        double eta = 0.;
+	double phi = 0.;
+	int layer = 0;
+	if (!m_jemMaps->mapping(crate, module, chan, eta, phi, layer)
+	    || layer != 0) continue;
+        const int em  = randomEnergy(s_maxElementEnergy);
+	const int had = randomEnergy(s_maxElementEnergy);
+	if (!em && !had) continue;
+	emEnergy.assign(m_slicesCpJep, 0);
+	hadEnergy.assign(m_slicesCpJep, 0);
+	emError.assign(m_slicesCpJep, 0);
+	hadError.assign(m_slicesCpJep, 0);
+	emEnergy[peak]  = em;
+	hadEnergy[peak] = had;
+	if (em)  emError[peak]  = randomError();
+	if (had) hadError[peak] = randomError();
+	jeCollection->push_back(new LVL1::JetElement(phi, eta,
+	                        emEnergy, hadEnergy, m_elementKey->jeKey(phi, eta),
+				emError, hadError, linkError, peak));
+        et += em + had;
+	ex += (em + had) * std::cos(phi);
+	ey += (em + had) * std::sin(phi);
+      }
+      if (et) {
+        // Ex and Ey are two's complement in the sub-block
+        etVec.assign(m_slicesCpJep, 0);
+	exVec.assign(m_slicesCpJep, 0);
+	eyVec.assign(m_slicesCpJep, 0);
+	etVec[peak] = std::min(et, s_energySumMask);
+	exVec[peak] = static_cast<unsigned int>(std::lround(ex)) & s_energySumMask;
+	eyVec[peak] = static_cast<unsigned int>(std::lround(ey)) & s_energySumMask;
+	etCollection->push_back(new LVL1::JEMEtSums(crate, module,
+	                                            etVec, exVec, eyVec, peak));
+      }
+    }
+  }
+}
+
+// Random tower or jet element energy, 0 if channel empty
+
+int RoundTripTester::randomEnergy(const int maxEnergy)
+{
+  std::uniform_real_distribution<double> flat(0., 1.);
+  if (flat(m_random) >= m_occupancy) return 0;
+  std::exponential_distribution<double> spectrum(1. / m_meanEnergy);
+  return std::min(1 + static_cast<int>(spectrum(m_random)), maxEnergy);
+}
+
+// Random error word, parity error only as that survives the round trip
+
+int RoundTripTester::randomError()
+{
+  std::uniform_real_distribution<double> flat(0., 1.);
+  if (flat(m_random) >= m_errorRate) return 0;
+  LVL1::DataError err;
+  err.set(LVL1::DataError::Parity, 1);
+  return err.error();
+}
+
+// Copy an encoded event into ROB fragments as they would be read back
+
+uint32_t RoundTripTester::readBack(RawEventWrite* const re)
+{
+  const eformat::write::node_t* const top = re->bind();
+  const uint32_t size = re->size_word();
+  m_buffer.resize(size);
+  eformat::write::copy(*top, &m_buffer[0], size);
+  const OFFLINE_FRAGMENTS_NAMESPACE::FullEventFragment event(&m_buffer[0]);
+  const uint32_t nrobs = event.nchildren();
+  m_fragments.clear();
+  m_fragments.reserve(nrobs);
+  uint32_t words = 0;
+  for (uint32_t i = 0; i < nrobs; ++i) {
+    OFFLINE_FRAGMENTS_NAMESPACE::PointerType rob;
+    event.child(rob, i);
+    m_fragments.push_back(ROBFragment(rob));
+    words += m_fragments.back().fragment_size_word();
+  }
+  m_robFrags.clear();
+  for (uint32_t i = 0; i < nrobs; ++i) m_robFrags.push_back(&m_fragments[i]);
+  return words;
+}
+
+// Count and report a mismatch
+
+bool RoundTripTester::check(const bool ok, const char* const type,
+                            const char* const what, const unsigned int key)
+{
+  if (ok) return true;
+  if (m_mismatches < m_maxPrint) {
+    msg(MSG::ERROR) << type << " mismatch: " << what << " key " << MSG::hex
+                    << key << MSG::dec << endreq;
+  }
+  ++m_mismatches;
+  ++m_eventMismatches;
+  return false;
+}
+
+// Print timing summary for one data type.
+// Throughput is in MB/s of ROB fragment data.
+
+void RoundTripTester::printTiming(const std::string& type,
+                                  const Timing& timing) const
+{
+  if (timing.events == 0) return;
+  const double events = timing.events;
+  const double bytes  = 4. * timing.words;
+  msg(MSG::INFO) << type << ": " << timing.events << " events, "
+                 << timing.words / events << " words/event" << endreq;
+  msg(MSG::INFO) << type << " encode:             "
+                 << timing.encode / events << " us/event, "
+		 << bytes / timing.encode << " MB/s" << endreq;
+  msg(MSG::INFO) << type << " legacy decode:      "
+                 << timing.decodeLegacy / events << " us/event, "
+		 << bytes / timing.decodeLegacy << " MB/s" << endreq;
+  if (timing.decodeLegacyXaod > 0.) {
+    msg(MSG::INFO) << type << " legacy xAOD decode: "
+                   << timing.decodeLegacyXaod / events << " us/event, "
+		   << bytes / timing.decodeLegacyXaod << " MB/s" << endreq;
+  }
+  msg(MSG::INFO) << type << " xAOD reader decode: "
+                 << timing.decodeXaod / events << " us/event, "
+		 << bytes / timing.decodeXaod << " MB/s" << endreq;
+}
+
+} // end namespace
@@ -0,0 +1,170 @@
+#ifndef TRIGT1CALOBYTESTREAM_ROUNDTRIPTESTER_H
+#define TRIGT1CALOBYTESTREAM_ROUNDTRIPTESTER_H
+
+#include <stdint.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AthenaBaseComps/AthAlgorithm.h"
+#include "ByteStreamCnvSvcBase/IROBDataProviderSvc.h"
+#include "ByteStreamData/RawEvent.h"
+#include "DataModel/DataVector.h"
+#include "GaudiKernel/ToolHandle.h"
+
+class ISvcLocator;
+class StatusCode;
+
+namespace LVL1 {
+  class CPMTower;
+  class IL1CaloMappingTool;
+  class JEMEtSums;
+  class JetElement;
+  class JetElementKey;
+  class TriggerTower;
+  class TriggerTowerKey;
+}
+
+namespace LVL1BS {
+
+class CpByteStreamV2Tool;
+class JepByteStreamV2Tool;
+class L1CaloByteStreamReadTool;
+class PpmByteStreamV1Tool;
+class PpmByteStreamV2Tool;
+
+/** Algorithm to test bytestream encoding against decoding.
+ *
+ *  Each event generates random but plausible trigger towers, CPM towers,
+ *  jet elements and JEM energy sums, encodes them with the bytestream
+ *  writers and decodes the result with the legacy tools and with the
+ *  xAOD reader.  Every decoded collection must match the input exactly.
+ *  Needs no input file; encoding and decoding times are printed at
+ *  finalize.
+ *
+ *  Trigger towers are written in Run 1 format as there is no Run 2 PPM
+ *  writer.  CMX objects are not generated.
+ */
+
+class RoundTripTester : public AthAlgorithm {
+
+ public:
+   RoundTripTester(const std::string& name, ISvcLocator* pSvcLocator);
+   virtual ~RoundTripTester();
+
+   virtual StatusCode initialize();
+   virtual StatusCode execute();
+   virtual StatusCode finalize();
+
+ private:
+   typedef DataVector<LVL1::TriggerTower> TriggerTowerCollection;
+   typedef DataVector<LVL1::CPMTower>     CpmTowerCollection;
+   typedef DataVector<LVL1::JetElement>   JetElementCollection;
+   typedef DataVector<LVL1::JEMEtSums>    EnergySumsCollection;
+   typedef OFFLINE_FRAGMENTS_NAMESPACE::ROBFragment ROBFragment;
+
+   /// Accumulated sizes and times (microseconds) for one data type
+   struct Timing {
+     Timing() : events(0), words(0.), encode(0.), decodeLegacy(0.),
+                decodeLegacyXaod(0.), decodeXaod(0.) {}
+     int    events;
+     double words;
+     double encode;
+     double decodeLegacy;
+     double decodeLegacyXaod;
+     double decodeXaod;
+   };
+
+   /// Encode and decode trigger towers
+   StatusCode testPpm();
+   /// Encode and decode CPM towers
+   StatusCode testCp();
+   /// Encode and decode jet elements and energy sums
+   StatusCode testJep();
+
+   /// Generate trigger towers for all mapped PPM channels
+   void makeTriggerTowers(TriggerTowerCollection* ttCollection);
+   /// Generate FADC and LUT slices for one channel
+   void makePulse(std::vector<int>& lut, std::vector<int>& bcidLut,
+                  std::vector<int>& fadc, std::vector<int>& bcidFadc);
+   /// Generate CPM towers
+   void makeCpmTowers(CpmTowerCollection* cpmCollection);
+   /// Generate jet elements and the matching JEM energy sums
+   void makeJetElements(JetElementCollection* jeCollection,
+                        EnergySumsCollection* etCollection);
+   /// Random tower or jet element energy, 0 if channel empty
+   int randomEnergy(int maxEnergy);
+   /// Random error word, parity error only
+   int randomError();
+
+   /// Copy an encoded event into ROB fragments, return number of words
+   uint32_t readBack(RawEventWrite* re);
+
+   /// Count and report a mismatch, return ok
+   bool check(bool ok, const char* type, const char* what, unsigned int key);
+   /// Print timing summary for one data type
+   void printTiming(const std::string& type, const Timing& timing) const;
+
+   /// Writers and legacy readers
+   ToolHandle<PpmByteStreamV1Tool>      m_ppmTool;
+   ToolHandle<PpmByteStreamV2Tool>      m_ppmXaodTool;
+   ToolHandle<CpByteStreamV2Tool>       m_cpTool;
+   ToolHandle<JepByteStreamV2Tool>      m_jepTool;
+   /// xAOD reader
+   ToolHandle<L1CaloByteStreamReadTool> m_readTool;
+   /// Channel mapping tools
+   ToolHandle<LVL1::IL1CaloMappingTool> m_ppmMaps;
+   ToolHandle<LVL1::IL1CaloMappingTool> m_cpmMaps;
+   ToolHandle<LVL1::IL1CaloMappingTool> m_jemMaps;
+   /// Trigger tower key provider
+   LVL1::TriggerTowerKey* m_towerKey;
+   /// Jet element key provider
+   LVL1::JetElementKey*   m_elementKey;
+
+   /// Random number seed
+   int    m_seed;
+   /// Number of LUT and FADC slices
+   int    m_slicesLut;
+   int    m_slicesFadc;
+   /// Number of CPM and JEM slices
+   int    m_slicesCpJep;
+   /// Fraction of channels with energy
+   double m_occupancy;
+   /// Mean energy of occupied channels (GeV)
+   double m_meanEnergy;
+   /// Fraction of occupied channels with a parity error
+   double m_errorRate;
+   /// FADC pedestal and noise (ADC counts)
+   int    m_pedestal;
+   double m_noise;
+   /// Fail the event on any mismatch
+   bool   m_abortOnMismatch;
+   /// Maximum number of mismatches to print
+   int    m_maxPrint;
+
+   /// Random number generator
+   std::mt19937 m_random;
+   /// Tower key and layer by cool ID for PPM channels
+   std::map<unsigned int, std::pair<unsigned int, int> > m_coolIdMap;
+
+   /// Encoded event and its ROB fragments
+   std::vector<uint32_t>    m_buffer;
+   std::vector<ROBFragment> m_fragments;
+   IROBDataProviderSvc::VROBFRAG m_robFrags;
+
+   /// Mismatch counts
+   int m_mismatches;
+   int m_eventMismatches;
+   /// Timing for each data type
+   Timing m_ppmTiming;
+   Timing m_cpTiming;
+   Timing m_jepTiming;
+
+};
+
+} // end namespace
+
+#endif
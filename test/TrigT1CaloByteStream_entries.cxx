@@ -57,12 +57,16 @@
 #include "../src/JepByteStreamV1Tool.h"
 #include "../src/JepRoiByteStreamV1Tool.h"
 // Both
+#include "../src/PpmByteStreamV1Tool.h"
+#include "../src/PpmByteStreamV2Tool.h"
 #include "../src/RodHeaderByteStreamTool.h"
 #include "../src/L1CaloErrorByteStreamTool.h"
 
 #include "../src/PpmByteStreamSubsetTool.h"
 #include "../src/TriggerTowerSelectionTool.h"
 #include "../src/TrigT1CaloDataAccess.h"
+#include "../src/xaod/L1CaloByteStreamReadTool.h"
+#include "../src/L1CaloDecodeAlg.h"
 
 // Post-LS1
 #include "CpmTesterV2.h"
@@ -78,6 +82,7 @@
 #include "PpmTester.h"
 #include "RodTester.h"
 #include "ErrorTester.h"
+#include "RoundTripTester.h"
 
 namespace LVL1BS {
 
@@ -165,12 +170,15 @@ DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, CpmRoiByteStreamV1Tool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, JepByteStreamV1Tool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, JepRoiByteStreamV1Tool )
 // Both
+DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, PpmByteStreamV1Tool )
+DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, PpmByteStreamV2Tool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, RodHeaderByteStreamTool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, L1CaloErrorByteStreamTool )
 
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, PpmByteStreamSubsetTool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, TriggerTowerSelectionTool )
 DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, TrigT1CaloDataAccess )
+DECLARE_NAMESPACE_TOOL_FACTORY( LVL1BS, L1CaloByteStreamReadTool )
 
 // Post-LS1
 DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, CpmTesterV2 )
@@ -184,8 +192,10 @@ DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, JemTesterV1 )
 DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, PpmTester )
 DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, RodTester )
 DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, ErrorTester )
+DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, RoundTripTester )
 DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, PpmSubsetTester )
 DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, PpmMappingTester )
+DECLARE_NAMESPACE_ALGORITHM_FACTORY( LVL1BS, L1CaloDecodeAlg )
 
 DECLARE_FACTORY_ENTRIES( TrigT1CaloByteStream )
 {
@@ -234,12 +244,14 @@ DECLARE_FACTORY_ENTRIES( TrigT1CaloByteStream )
   DECLARE_NAMESPACE_TOOL( LVL1BS, JepRoiByteStreamV1Tool )
   // Both
   DECLARE_NAMESPACE_TOOL( LVL1BS, PpmByteStreamV1Tool )
+  DECLARE_NAMESPACE_TOOL( LVL1BS, PpmByteStreamV2Tool )
   DECLARE_NAMESPACE_TOOL( LVL1BS, RodHeaderByteStreamTool )
   DECLARE_NAMESPACE_TOOL( LVL1BS, L1CaloErrorByteStreamTool )
 
   DECLARE_NAMESPACE_TOOL( LVL1BS, PpmByteStreamSubsetTool )
   DECLARE_NAMESPACE_TOOL( LVL1BS, TriggerTowerSelectionTool )
   DECLARE_NAMESPACE_TOOL( LVL1BS, TrigT1CaloDataAccess )
+  DECLARE_NAMESPACE_TOOL( LVL1BS, L1CaloByteStreamReadTool )
 
   // Post-LS1
   DECLARE_NAMESPACE_ALGORITHM( LVL1BS, CpmTesterV2 )
@@ -253,6 +265,8 @@ DECLARE_FACTORY_ENTRIES( TrigT1CaloByteStream )
   DECLARE_NAMESPACE_ALGORITHM( LVL1BS, PpmTester )
   DECLARE_NAMESPACE_ALGORITHM( LVL1BS, RodTester )
   DECLARE_NAMESPACE_ALGORITHM( LVL1BS, ErrorTester )
+  DECLARE_NAMESPACE_ALGORITHM( LVL1BS, RoundTripTester )
   DECLARE_NAMESPACE_ALGORITHM( LVL1BS, PpmSubsetTester )
   DECLARE_NAMESPACE_ALGORITHM( LVL1BS, PpmMappingTester )
+  DECLARE_NAMESPACE_ALGORITHM( LVL1BS, L1CaloDecodeAlg )
 }